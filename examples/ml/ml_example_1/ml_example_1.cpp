@@ -19,7 +19,7 @@
 
 #include "cubeai/base/cubeai_types.h"
 #include "cubeai/base/cubeai_data_paths.h"
-#include "cubeai/optimization/optimizer_type.h"
+#include "cubeai/maths/optimization/optimizer_type.h"
 #include "cubeai/ml/loss_type.h"
 #include "cubeai/ml/pytorch_supervised_trainer.h"
 #include "cubeai/ml/pytorch_loss_wrapper.h"
@@ -37,7 +37,7 @@ using cubeai::ml::pytorch::PyTorchLossWrapper;
 using cubeai::ml::LossType;
 using cubeai::ml::pytorch::PyTorchSupervisedTrainer;
 using cubeai::ml::pytorch::PyTorchSupervisedTrainerConfig;
-using cubeai::optim::OptimzerType;
+using cubeai::maths::optim::OptimzerType;
 
 
 const uint_t input_size = 784;
@@ -122,6 +122,10 @@ using namespace example21;
       config.batch_size = batch_size;
       config.device = device;
       config.optim_type = OptimzerType::SGD;
+      config.n_workers = 2;
+      config.prefetch_depth = 4;
+      config.pin_memory = cuda_available;
+      config.output_stream = &std::cout;
 
       std::map<std::string, std::any> optim_ops;
       optim_ops["lr"] = std::any(learning_rate);
@@ -159,7 +163,7 @@ using namespace example21;
 
       for (const auto& batch : *test_loader) {
 
-          auto data = batch.data.view({batch_size, -1}).to(device);
+          auto data = batch.data.view({batch.data.size(0), -1}).to(device);
           auto target = batch.target.to(device);
 
           auto output = model.forward(data);
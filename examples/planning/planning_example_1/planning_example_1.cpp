@@ -0,0 +1,275 @@
+/**
+  * Benchmark of A* on large occupancy grids. AStarSearch works over vertex
+  * ids with dense cost arrays, a closed bitset and an indexed heap with
+  * decrease-key. It is compared with the containers of the previous
+  * a_star_search: a std::priority_queue of vertex copies, a std::set of
+  * explored vertices and a std::multimap of parents. The previous version
+  * also searched the explored set with std::find_if, which is quadratic,
+  * so that variant only runs on a small grid
+  *
+ */
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/planning/a_star_search.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace planning_example_1
+{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::AStarSearch;
+
+const uint_t SMALL_GRID_SIZE = 100;
+const uint_t LARGE_GRID_SIZE = 3163; // ~10M cells
+const uint_t N_QUERIES = 5;
+const real_t OBSTACLE_DENSITY = 0.2;
+const uint_t SEED = 42;
+
+///
+/// \brief 4-connected occupancy grid with unit costs
+///
+class Grid
+{
+public:
+
+    Grid(uint_t size, real_t density, uint_t seed);
+
+    uint_t n_vertices()const{return size_ * size_;}
+    uint_t size()const{return size_;}
+    bool is_free(uint_t v)const{return !blocked_[v];}
+
+    template<typename Fn>
+    void for_each_neighbor(uint_t v, Fn&& fn)const{
+
+        const auto x = v % size_;
+        const auto y = v / size_;
+
+        if(x > 0 && !blocked_[v - 1]) fn(v - 1, 1.0);
+        if(x + 1 < size_ && !blocked_[v + 1]) fn(v + 1, 1.0);
+        if(y > 0 && !blocked_[v - size_]) fn(v - size_, 1.0);
+        if(y + 1 < size_ && !blocked_[v + size_]) fn(v + size_, 1.0);
+    }
+
+    real_t manhattan(uint_t v, uint_t w)const{
+
+        const auto dx = std::abs(static_cast<long>(v % size_) - static_cast<long>(w % size_));
+        const auto dy = std::abs(static_cast<long>(v / size_) - static_cast<long>(w / size_));
+        return static_cast<real_t>(dx + dy);
+    }
+
+private:
+
+    uint_t size_;
+    std::vector<bool> blocked_;
+};
+
+Grid::Grid(uint_t size, real_t density, uint_t seed)
+    :
+      size_(size),
+      blocked_(size * size, false)
+{
+    std::mt19937 gen(seed);
+    std::bernoulli_distribution dist(density);
+    for(uint_t v=0; v<blocked_.size(); ++v){
+        blocked_[v] = dist(gen);
+    }
+
+    // keep the corners free
+    blocked_[0] = false;
+    blocked_[blocked_.size() - 1] = false;
+}
+
+///
+/// \brief The vertex copy the previous implementation queued
+///
+struct Node
+{
+    uint_t id;
+    real_t g_cost;
+    real_t f_cost;
+};
+
+struct NodeCompare
+{
+    bool operator()(const Node& n1, const Node& n2)const{return n1.f_cost > n2.f_cost;}
+};
+
+struct NodeIdCompare
+{
+    bool operator()(const Node& n1, const Node& n2)const{return n1.id > n2.id;}
+};
+
+///
+/// \brief The previous a_star_search, with the open set
+/// kept as lazy duplicates since std::priority_queue has no
+/// contains(). linear_scan searches explored with std::find_if
+/// as the previous version did, otherwise with std::set::find
+///
+std::multimap<uint_t, uint_t>
+previous_a_star(const Grid& grid, uint_t start, uint_t goal, bool linear_scan, uint_t& n_expanded){
+
+    std::multimap<uint_t, uint_t> came_from;
+    std::set<Node, NodeIdCompare> explored;
+    std::priority_queue<Node, std::vector<Node>, NodeCompare> open;
+    std::vector<real_t> g_cost(grid.n_vertices(), std::numeric_limits<real_t>::max());
+
+    g_cost[start] = 0.0;
+    open.push(Node{start, 0.0, grid.manhattan(start, goal)});
+    n_expanded = 0;
+
+    while(!open.empty()){
+
+        const Node cv = open.top();
+        open.pop();
+
+        if(cv.id == goal){
+            break;
+        }
+
+        if(explored.find(cv) != explored.end()){
+            continue;
+        }
+
+        explored.insert(cv);
+        n_expanded += 1;
+
+        grid.for_each_neighbor(cv.id, [&](uint_t nid, real_t cost){
+
+            if(linear_scan){
+                auto itr = std::find_if(explored.begin(), explored.end(),
+                                        [=](const Node& n){return n.id == nid;});
+                if(itr != explored.end()){
+                    return;
+                }
+            }
+            else if(explored.find(Node{nid, 0.0, 0.0}) != explored.end()){
+                return;
+            }
+
+            const auto tg_cost = cv.g_cost + cost;
+            if(tg_cost >= g_cost[nid]){
+                return;
+            }
+
+            auto lb = came_from.lower_bound(nid);
+            if(lb != came_from.end() && lb->first == nid){
+                lb->second = cv.id;
+            }
+            else{
+                came_from.insert(lb, std::make_pair(nid, cv.id));
+            }
+
+            g_cost[nid] = tg_cost;
+            open.push(Node{nid, tg_cost, tg_cost + grid.manhattan(nid, goal)});
+        });
+    }
+
+    return came_from;
+}
+
+///
+/// \brief Random free start/goal pairs
+///
+std::vector<std::pair<uint_t, uint_t>>
+make_queries(const Grid& grid, uint_t n){
+
+    std::mt19937 gen(SEED);
+    std::uniform_int_distribution<uint_t> dist(0, grid.n_vertices() - 1);
+
+    std::vector<std::pair<uint_t, uint_t>> queries;
+    queries.push_back({0, grid.n_vertices() - 1});
+
+    while(queries.size() < n){
+
+        auto s = dist(gen);
+        auto g = dist(gen);
+        if(grid.is_free(s) && grid.is_free(g)){
+            queries.push_back({s, g});
+        }
+    }
+
+    return queries;
+}
+
+template<typename Fn>
+real_t
+time_ms(Fn fn){
+
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<real_t, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void
+run(const std::string& name, const Grid& grid, bool run_linear_scan, bool run_previous){
+
+    std::cout<<name<<": "<<grid.size()<<"x"<<grid.size()<<" cells"<<std::endl;
+
+    AStarSearch<real_t> engine(grid.n_vertices());
+
+    for(const auto& [start, goal] : make_queries(grid, N_QUERIES)){
+
+        const auto g = goal;
+        bool found = false;
+        auto engine_ms = time_ms([&](){
+            found = engine.search(grid, start, goal, [&grid, g](uint_t v){return grid.manhattan(v, g);});
+        });
+
+        std::cout<<"    query "<<start<<" -> "<<goal<<" found="<<found
+                 <<" cost="<<engine.g_cost(goal)<<std::endl;
+        std::cout<<"        AStarSearch..............: "<<engine_ms<<" ms, expanded="<<engine.n_expanded()<<std::endl;
+
+        if(run_previous){
+
+            uint_t n_expanded = 0;
+            auto previous_ms = time_ms([&](){previous_a_star(grid, start, goal, false, n_expanded);});
+            std::cout<<"        previous containers......: "<<previous_ms<<" ms, expanded="<<n_expanded
+                     <<" speedup="<<previous_ms / engine_ms<<std::endl;
+        }
+
+        if(run_linear_scan){
+
+            uint_t n_expanded = 0;
+            auto previous_ms = time_ms([&](){previous_a_star(grid, start, goal, true, n_expanded);});
+            std::cout<<"        previous with find_if....: "<<previous_ms<<" ms, expanded="<<n_expanded
+                     <<" speedup="<<previous_ms / engine_ms<<std::endl;
+        }
+    }
+}
+
+}
+
+int main(){
+
+    using namespace planning_example_1;
+
+    try{
+
+        Grid small_grid(SMALL_GRID_SIZE, OBSTACLE_DENSITY, SEED);
+        run("Small grid", small_grid, true, true);
+
+        Grid large_grid(LARGE_GRID_SIZE, OBSTACLE_DENSITY, SEED);
+        run("Large grid", large_grid, false, true);
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
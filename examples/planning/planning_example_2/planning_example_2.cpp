@@ -0,0 +1,166 @@
+/**
+  * A* and Jump Point Search on implicit occupancy grids. GridGraph keeps
+  * one bit per cell and computes the neighbours on the fly, so a 10M cell
+  * map takes about 1.2MB instead of the gigabytes of a materialised graph.
+  * The example compares the expansions and the runtime of A* and of Jump
+  * Point Search on a 2D map with random obstacles and on a map of rooms,
+  * and runs A* on a 3D grid. Jump Point Search pays off on maps with open
+  * areas; on densely cluttered maps the jumps are short and the scans cost
+  * more than the expansions they save
+  *
+ */
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/data_structs/grid_graph.h"
+#include "cubeai/planning/a_star_search.h"
+#include "cubeai/planning/jump_point_search.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace planning_example_2
+{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::GridGraph;
+using cubeai::GridConnectivity;
+using cubeai::AStarSearch;
+using cubeai::JumpPointSearch;
+
+const uint_t NX = 4096;
+const uint_t NY = 2560;
+const uint_t N_3D = 128;
+const uint_t ROOM_SIZE = 64;
+const uint_t N_QUERIES = 5;
+const uint_t SEED = 42;
+
+template<typename Fn>
+real_t
+time_ms(Fn fn){
+
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<real_t, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+template<uint_t dim>
+void
+add_random_obstacles(GridGraph<dim>& grid, real_t density){
+
+    std::mt19937 gen(SEED);
+    std::bernoulli_distribution dist(density);
+    for(uint_t v=0; v<grid.n_vertices(); ++v){
+        grid.set_blocked(v, dist(gen));
+    }
+}
+
+///
+/// \brief Walls every ROOM_SIZE cells with a door in the middle of every wall
+///
+void
+add_rooms(GridGraph<2>& grid){
+
+    for(uint_t y=0; y<NY; ++y){
+        for(uint_t x=0; x<NX; ++x){
+
+            const auto on_vertical_wall = x % ROOM_SIZE == 0 && y % ROOM_SIZE != ROOM_SIZE / 2;
+            const auto on_horizontal_wall = y % ROOM_SIZE == 0 && x % ROOM_SIZE != ROOM_SIZE / 2;
+            grid.set_blocked(grid.id({x, y}), on_vertical_wall || on_horizontal_wall);
+        }
+    }
+}
+
+std::vector<std::pair<uint_t, uint_t>>
+make_queries(const GridGraph<2>& grid){
+
+    std::mt19937 gen(SEED);
+    std::uniform_int_distribution<uint_t> dist(0, grid.n_vertices() - 1);
+
+    std::vector<std::pair<uint_t, uint_t>> queries;
+    while(queries.size() < N_QUERIES){
+
+        auto s = dist(gen);
+        auto g = dist(gen);
+        if(grid.is_free(s) && grid.is_free(g)){
+            queries.push_back({s, g});
+        }
+    }
+
+    return queries;
+}
+
+void
+compare(const std::string& name, const GridGraph<2>& grid){
+
+    std::cout<<name<<": "<<NX<<"x"<<NY<<" cells, "<<grid.n_blocked()<<" blocked, "
+             <<grid.memory_bytes()<<" bytes"<<std::endl;
+
+    AStarSearch<real_t> astar(grid.n_vertices());
+    JumpPointSearch jps(grid);
+
+    for(const auto& [start, goal] : make_queries(grid)){
+
+        const auto g = goal;
+        bool found = false;
+        auto astar_ms = time_ms([&](){
+            found = astar.search(grid, start, goal, [&grid, g](uint_t v){return grid.heuristic(v, g);});
+        });
+
+        auto jps_ms = time_ms([&](){jps.search(start, goal);});
+
+        std::cout<<"    query "<<start<<" -> "<<goal<<" found="<<found
+                 <<" A* cost="<<astar.g_cost(goal)<<" JPS cost="<<jps.cost(goal)<<std::endl;
+        std::cout<<"        A*..: "<<astar_ms<<" ms, expanded="<<astar.n_expanded()
+                 <<" touched="<<astar.n_touched()<<std::endl;
+        std::cout<<"        JPS.: "<<jps_ms<<" ms, expanded="<<jps.n_expanded()
+                 <<" scanned="<<jps.n_scanned()<<" speedup="<<astar_ms / jps_ms<<std::endl;
+    }
+}
+
+}
+
+int main(){
+
+    using namespace planning_example_2;
+
+    try{
+
+        GridGraph<2> random_grid({NX, NY}, GridConnectivity::FULL);
+        add_random_obstacles(random_grid, 0.2);
+        compare("Random obstacles", random_grid);
+
+        GridGraph<2> rooms_grid({NX, NY}, GridConnectivity::FULL);
+        add_rooms(rooms_grid);
+        compare("Rooms", rooms_grid);
+
+        GridGraph<3> grid_3d({N_3D, N_3D, N_3D}, GridConnectivity::FULL);
+        add_random_obstacles(grid_3d, 0.2);
+        grid_3d.set_blocked(0, false);
+
+        const auto goal = grid_3d.n_vertices() - 1;
+        grid_3d.set_blocked(goal, false);
+
+        AStarSearch<real_t> astar(grid_3d.n_vertices());
+        bool found = false;
+        auto ms = time_ms([&](){
+            found = astar.search(grid_3d, 0, goal, [&grid_3d, goal](uint_t v){return grid_3d.heuristic(v, goal);});
+        });
+
+        std::cout<<"3D grid: "<<N_3D<<"^3 cells, "<<grid_3d.memory_bytes()<<" bytes"<<std::endl;
+        std::cout<<"    corner to corner found="<<found<<" cost="<<astar.g_cost(goal)
+                 <<" "<<ms<<" ms, expanded="<<astar.n_expanded()<<std::endl;
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
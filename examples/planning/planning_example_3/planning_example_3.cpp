@@ -0,0 +1,114 @@
+/**
+  * Long range queries with A* and bidirectional A*. The example runs the
+  * same queries across a 4096x2560 grid with random obstacles with A*,
+  * bidirectional A* and bidirectional A* with the backward search on a
+  * second thread, and reports the expanded vertices and the runtime. The
+  * queries are repeated without a heuristic. Bidirectional search pays off
+  * when the heuristic is weak; the octile distance on an open grid is
+  * already tight and A* is hard to beat there. The concurrent search needs
+  * a second core to pay off
+  *
+ */
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/data_structs/grid_graph.h"
+#include "cubeai/planning/a_star_search.h"
+#include "cubeai/planning/bidirectional_a_star_search.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace planning_example_3
+{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::GridGraph;
+using cubeai::GridConnectivity;
+using cubeai::AStarSearch;
+using cubeai::BidirectionalAStarSearch;
+
+const uint_t NX = 4096;
+const uint_t NY = 2560;
+const real_t DENSITY = 0.2;
+const uint_t N_QUERIES = 5;
+const uint_t SEED = 42;
+
+template<typename Fn>
+real_t
+time_ms(Fn fn){
+
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<real_t, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+}
+
+int main(){
+
+    using namespace planning_example_3;
+
+    try{
+
+        GridGraph<2> grid({NX, NY}, GridConnectivity::FULL);
+
+        std::mt19937 gen(SEED);
+        std::bernoulli_distribution blocked(DENSITY);
+        for(uint_t v=0; v<grid.n_vertices(); ++v){
+            grid.set_blocked(v, blocked(gen));
+        }
+
+        AStarSearch<real_t> astar(grid.n_vertices());
+        BidirectionalAStarSearch<real_t> bidirectional(grid.n_vertices());
+        BidirectionalAStarSearch<real_t> concurrent(grid.n_vertices(), true);
+
+        // across the middle of the map
+        std::uniform_int_distribution<uint_t> jitter(0, 99);
+        uint_t n_queries = 0;
+        while(n_queries < N_QUERIES){
+
+            const auto start = grid.id({NX / 4 + jitter(gen), NY / 2 + jitter(gen)});
+            const auto goal = grid.id({3 * NX / 4 - jitter(gen), NY / 2 - jitter(gen)});
+            if(grid.is_blocked(start) || grid.is_blocked(goal)){
+                continue;
+            }
+
+            n_queries += 1;
+            auto h_goal = [&grid, goal](uint_t v){return grid.heuristic(v, goal);};
+            auto h_start = [&grid, start](uint_t v){return grid.heuristic(start, v);};
+
+            auto astar_ms = time_ms([&](){astar.search(grid, start, goal, h_goal);});
+            auto bidirectional_ms = time_ms([&](){bidirectional.search(grid, start, goal, h_goal, h_start);});
+            auto concurrent_ms = time_ms([&](){concurrent.search(grid, start, goal, h_goal, h_start);});
+
+            std::cout<<"query "<<start<<" -> "<<goal<<" A* cost="<<astar.g_cost(goal)
+                     <<" bidirectional cost="<<bidirectional.cost()
+                     <<" concurrent cost="<<concurrent.cost()<<std::endl;
+            std::cout<<"    A*...........................: "<<astar_ms<<" ms, expanded="<<astar.n_expanded()<<std::endl;
+            std::cout<<"    bidirectional................: "<<bidirectional_ms<<" ms, expanded="<<bidirectional.n_expanded()<<std::endl;
+            std::cout<<"    concurrent...................: "<<concurrent_ms<<" ms, expanded="<<concurrent.n_expanded()<<std::endl;
+
+            // without a heuristic A* is Dijkstra and the two
+            // searches each cover about half of the distance
+            auto zero = [](uint_t){return 0.0;};
+            auto dijkstra_ms = time_ms([&](){astar.search(grid, start, goal, zero);});
+            auto bidirectional_dijkstra_ms = time_ms([&](){bidirectional.search(grid, start, goal, zero, zero);});
+
+            std::cout<<"    Dijkstra.....................: "<<dijkstra_ms<<" ms, expanded="<<astar.n_expanded()<<std::endl;
+            std::cout<<"    bidirectional Dijkstra.......: "<<bidirectional_dijkstra_ms<<" ms, expanded="
+                     <<bidirectional.n_expanded()<<std::endl;
+        }
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
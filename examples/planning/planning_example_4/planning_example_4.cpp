@@ -0,0 +1,156 @@
+/**
+  * Replanning latency of D* Lite against A* from scratch. A robot crosses
+  * a 2048x2048 grid with random obstacles. At every cycle it moves one cell
+  * along its path and its sensor reports a few cells that changed around
+  * it. D* Lite repairs its previous search, A* searches again. The example
+  * reports the latency of the two per cycle
+  *
+ */
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/data_structs/grid_graph.h"
+#include "cubeai/planning/a_star_search.h"
+#include "cubeai/planning/d_star_lite.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace planning_example_4
+{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::GridGraph;
+using cubeai::GridConnectivity;
+using cubeai::AStarSearch;
+using cubeai::DStarLite;
+
+const uint_t N = 2048;
+const real_t DENSITY = 0.2;
+const uint_t N_CYCLES = 200;
+const uint_t N_CHANGES = 10;
+const long SENSOR_RANGE = 20;
+const uint_t SEED = 42;
+
+template<typename Fn>
+real_t
+time_ms(Fn fn){
+
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<real_t, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void
+report(const char* name, std::vector<real_t>& latencies, uint_t n_expanded){
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto mean = std::accumulate(latencies.begin(), latencies.end(), 0.0) / latencies.size();
+
+    std::cout<<name<<" mean="<<mean<<" ms, median="<<latencies[latencies.size() / 2]
+             <<" ms, max="<<latencies.back()<<" ms, expanded="<<n_expanded<<std::endl;
+}
+
+}
+
+int main(){
+
+    using namespace planning_example_4;
+
+    try{
+
+        GridGraph<2> grid({N, N}, GridConnectivity::FULL);
+
+        std::mt19937 gen(SEED);
+        std::bernoulli_distribution blocked(DENSITY);
+        for(uint_t v=0; v<grid.n_vertices(); ++v){
+            grid.set_blocked(v, blocked(gen));
+        }
+
+        auto start = grid.id({100, 100});
+        const auto goal = grid.id({N - 100, N - 100});
+        grid.set_blocked(start, false);
+        grid.set_blocked(goal, false);
+
+        auto h = [&grid](uint_t v, uint_t w){return grid.heuristic(v, w);};
+        DStarLite planner(grid, h);
+        planner.initialize(start, goal);
+
+        auto initial_ms = time_ms([&](){planner.plan();});
+        std::cout<<"Initial D* Lite plan: "<<initial_ms<<" ms, cost="<<planner.cost()
+                 <<" expanded="<<planner.n_expanded()<<std::endl;
+
+        AStarSearch<real_t> astar(grid.n_vertices());
+
+        std::vector<real_t> d_star_latency;
+        std::vector<real_t> astar_latency;
+        uint_t d_star_expanded = 0;
+        uint_t astar_expanded = 0;
+
+        std::uniform_int_distribution<long> offset(-SENSOR_RANGE, SENSOR_RANGE);
+        std::vector<uint_t> changed;
+
+        for(uint_t cycle=0; cycle<N_CYCLES; ++cycle){
+
+            const auto path = planner.path();
+            if(path.size() < 2){
+                break;
+            }
+
+            start = path[1];
+            planner.set_start(start);
+
+            // the sensor reports cells around the robot
+            changed.clear();
+            const auto c = grid.cell(start);
+            for(uint_t i=0; i<N_CHANGES; ++i){
+
+                const auto x = static_cast<long>(c[0]) + offset(gen);
+                const auto y = static_cast<long>(c[1]) + offset(gen);
+                if(x < 0 || y < 0 || x >= static_cast<long>(N) || y >= static_cast<long>(N)){
+                    continue;
+                }
+
+                const auto v = grid.id({static_cast<uint_t>(x), static_cast<uint_t>(y)});
+                if(v == start || v == goal){
+                    continue;
+                }
+
+                grid.set_blocked(v, !grid.is_blocked(v));
+                changed.push_back(v);
+            }
+
+            d_star_latency.push_back(time_ms([&](){
+                planner.update_cells(changed);
+                planner.plan();
+            }));
+            d_star_expanded += planner.n_expanded();
+
+            astar_latency.push_back(time_ms([&](){
+                astar.search(grid, start, goal, [&grid, goal](uint_t v){return grid.heuristic(v, goal);});
+            }));
+            astar_expanded += astar.n_expanded();
+
+            if(cycle % 50 == 0){
+                std::cout<<"cycle "<<cycle<<" D* Lite cost="<<planner.cost()
+                         <<" A* cost="<<astar.g_cost(goal)<<std::endl;
+            }
+        }
+
+        report("D* Lite replanning.:", d_star_latency, d_star_expanded);
+        report("A* from scratch....:", astar_latency, astar_expanded);
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+/**
+  * Growing a large RRT. The vertices of the tree are indexed by a kd-tree
+  * that is updated on every insertion, so finding the vertex nearest to a
+  * sample does not scan the tree. The example grows a tree of one million
+  * vertices in a 2D square and compares the time of nearest neighbour
+  * queries on the final tree against a linear scan
+  *
+ */
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/planning/rapidly_exploring_random_tree.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace planning_example_5
+{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::RRT;
+
+typedef std::array<real_t, 2> State;
+typedef RRT<State, real_t> Tree;
+
+const uint_t N_VERTICES = 1000000;
+const uint_t N_QUERIES = 100;
+const real_t SIZE = 100.0;
+const real_t STEP = 0.5;
+const uint_t SEED = 42;
+
+template<typename Fn>
+real_t
+time_ms(Fn fn){
+
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<real_t, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+struct EuclideanMetric
+{
+    template<typename VertexTp>
+    real_t operator()(const VertexTp& v1, const VertexTp& v2)const{
+        return std::hypot(v1.data[0] - v2.data[0], v1.data[1] - v2.data[1]);
+    }
+};
+
+struct StateSelector
+{
+    mutable std::mt19937 gen{SEED};
+    State operator()()const{
+        std::uniform_real_distribution<real_t> dist(0.0, SIZE);
+        return {dist(gen), dist(gen)};
+    }
+};
+
+struct Dynamics
+{
+    template<typename VertexTp>
+    std::tuple<State, real_t> operator()(const VertexTp& xnear, const State& xrand)const{
+
+        const auto dx = xrand[0] - xnear.data[0];
+        const auto dy = xrand[1] - xnear.data[1];
+        const auto d = std::hypot(dx, dy);
+        if(d <= STEP){
+            return {xrand, d};
+        }
+
+        return {State{xnear.data[0] + STEP * dx / d, xnear.data[1] + STEP * dy / d}, STEP};
+    }
+};
+
+}
+
+int main(){
+
+    using namespace planning_example_5;
+
+    try{
+
+        Tree tree;
+        tree.reserve(N_VERTICES);
+
+        StateSelector selector;
+        Dynamics dynamics;
+        EuclideanMetric metric;
+
+        Tree::vertex_t xinit;
+        xinit.data = {0.5 * SIZE, 0.5 * SIZE};
+
+        auto build_ms = time_ms([&](){tree.build(N_VERTICES - 1, xinit, selector, metric, dynamics);});
+        std::cout<<"Built a tree with "<<tree.n_vertices()<<" vertices in "<<build_ms<<" ms"
+                 <<" (kd-tree depth "<<tree.index().depth()<<")"<<std::endl;
+
+        std::vector<Tree::vertex_t> queries(N_QUERIES);
+        for(auto& q : queries){
+            q.data = selector();
+        }
+
+        real_t checksum_index = 0.0;
+        auto index_ms = time_ms([&](){
+            for(const auto& q : queries){
+                checksum_index += metric(tree.find_nearest_neighbor(q, metric), q);
+            }
+        });
+
+        real_t checksum_scan = 0.0;
+        auto scan_ms = time_ms([&](){
+            for(const auto& q : queries){
+
+                auto best = std::numeric_limits<real_t>::max();
+                for(uint_t v=0; v<tree.n_vertices(); ++v){
+                    best = std::min(best, metric(tree.get_vertex(v), q));
+                }
+                checksum_scan += best;
+            }
+        });
+
+        std::cout<<"Nearest neighbour with the index: "<<index_ms / N_QUERIES<<" ms per query"<<std::endl;
+        std::cout<<"Nearest neighbour by linear scan: "<<scan_ms / N_QUERIES<<" ms per query"<<std::endl;
+        std::cout<<"Same answers: "<<std::boolalpha<<(checksum_index == checksum_scan)<<std::endl;
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
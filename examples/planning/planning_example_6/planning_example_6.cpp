@@ -0,0 +1,141 @@
+/**
+  * RRT* in a square with random disc obstacles. The example shows the cost
+  * of the path going down as the tree grows and then grows the largest tree
+  * again with the samples drawn and checked on worker threads while the
+  * main thread inserts them. The obstacles are checked one by one so
+  * rejecting a sample is not cheap, which is the work the workers take off
+  * the main thread. The speedup depends on the cores of the machine
+  *
+ */
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/planning/rrt_star.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace planning_example_6
+{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::RRTStar;
+using cubeai::RRTStarConfig;
+
+typedef std::array<real_t, 2> State;
+
+const real_t SIZE = 100.0;
+const uint_t N_DISCS = 600;
+const real_t MAX_RADIUS = 2.0;
+const uint_t SEED = 42;
+
+template<typename Fn>
+real_t
+time_ms(Fn fn){
+
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<real_t, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+struct DiscChecker
+{
+    std::vector<std::array<real_t, 3>> discs;
+
+    bool is_free(const State& p)const{
+        for(const auto& d : discs){
+            if((p[0] - d[0]) * (p[0] - d[0]) + (p[1] - d[1]) * (p[1] - d[1]) <= d[2] * d[2]){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool is_segment_free(const State& a, const State& b)const{
+
+        const auto vx = b[0] - a[0];
+        const auto vy = b[1] - a[1];
+        const auto len2 = vx * vx + vy * vy;
+
+        for(const auto& d : discs){
+
+            auto t = len2 > 0.0 ? ((d[0] - a[0]) * vx + (d[1] - a[1]) * vy) / len2 : 0.0;
+            t = std::clamp(t, 0.0, 1.0);
+            const auto px = a[0] + t * vx - d[0];
+            const auto py = a[1] + t * vy - d[1];
+            if(px * px + py * py <= d[2] * d[2]){
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+}
+
+int main(){
+
+    using namespace planning_example_6;
+
+    try{
+
+        const State start{2.0, 2.0};
+        const State goal{SIZE - 2.0, SIZE - 2.0};
+
+        DiscChecker checker;
+        std::mt19937 gen(SEED);
+        std::uniform_real_distribution<real_t> position(0.0, SIZE);
+        std::uniform_real_distribution<real_t> radius(0.5, MAX_RADIUS);
+        while(checker.discs.size() < N_DISCS){
+
+            const std::array<real_t, 3> d{position(gen), position(gen), radius(gen)};
+            if(std::hypot(d[0] - start[0], d[1] - start[1]) > d[2] &&
+               std::hypot(d[0] - goal[0], d[1] - goal[1]) > d[2]){
+                checker.discs.push_back(d);
+            }
+        }
+
+        RRTStarConfig config;
+        config.max_step = 3.0;
+        config.goal_radius = 1.0;
+
+        std::cout<<"Straight line: "<<std::hypot(goal[0] - start[0], goal[1] - start[1])<<std::endl;
+
+        for(uint_t n : {2000, 8000, 32000}){
+
+            config.n_iterations = n;
+            RRTStar<2, DiscChecker> planner(config, {0.0, 0.0}, {SIZE, SIZE}, checker);
+
+            bool found = false;
+            auto ms = time_ms([&](){found = planner.plan(start, goal);});
+            std::cout<<"iterations="<<n<<" found="<<found<<" cost="<<planner.cost()
+                     <<" time="<<ms<<" ms checks="<<planner.n_collision_checks()
+                     <<" rewires="<<planner.n_rewires()<<std::endl;
+        }
+
+        const auto n_threads = std::max(1u, std::thread::hardware_concurrency() - 1);
+        config.n_sampling_threads = n_threads;
+
+        RRTStar<2, DiscChecker> planner(config, {0.0, 0.0}, {SIZE, SIZE}, checker);
+
+        bool found = false;
+        auto ms = time_ms([&](){found = planner.plan(start, goal);});
+        std::cout<<"iterations="<<config.n_iterations<<" with "<<n_threads<<" sampling threads found="
+                 <<found<<" cost="<<planner.cost()<<" time="<<ms<<" ms"<<std::endl;
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,247 @@
+/**
+  * Dynamic window approach for a differential drive robot that drives
+  * through a field of point obstacles to a goal. The window is sampled
+  * with about one thousand (v, w) candidates every control cycle and the
+  * example reports the time of a cycle with the candidates rolled out
+  * on one thread and with the blocks of candidates rolled out in parallel.
+  * The speedup of the parallel rollout depends on the cores of the machine.
+  * Finally the obstacles are sampled densely on the boundary of discs, as
+  * a scan would return them, and stored in a distance map so that the
+  * distance of a trajectory point to the obstacles is a lookup. The cycle
+  * with the scan points and with the map are timed at the same states.
+  * The map moves every point to the center of its cell and truncates the
+  * distances at max_distance, so the two rarely pick the same (v, w).
+  * Instead the cost, measured with the points, of the candidate the map
+  * picks is compared with the best cost to a relative tolerance
+  *
+ */
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/math_constants.h"
+#include "cubeai/planning/diff_drive_dynamic_window.h"
+#include "cubeai/planning/obstacle_distance_map.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace planning_example_7
+{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::MathConsts;
+using cubeai::planning::DiffDriveDW;
+using cubeai::planning::DiffDriveDWConfig;
+using cubeai::planning::ObstacleDistanceMap;
+
+const real_t SIZE = 20.0;
+const uint_t N_OBSTACLES = 100;
+const uint_t N_SCAN_POINTS = 40;
+const real_t DISC_RADIUS = 0.05;
+const uint_t MAX_CYCLES = 1000;
+const uint_t SEED = 42;
+const real_t COST_TOLERANCE = 0.01;
+
+template<typename Fn>
+real_t
+time_ms(Fn fn){
+
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<real_t, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+DiffDriveDWConfig
+make_config(bool parallel){
+
+    DiffDriveDWConfig config;
+    config.max_speed = 1.0;
+    config.min_speed = -0.5;
+    config.max_yaw_rate = 40.0 * MathConsts::PI / 180.0;
+    config.max_accel = 0.2;
+    config.max_delta_yaw_rate = 40.0 * MathConsts::PI / 180.0;
+    config.dt = 0.1;
+    config.min_cost = 0.0;
+    config.v_reso = 0.001;
+    config.yawrate_reso = 0.32 * MathConsts::PI / 180.0;
+    config.robot_radius = 0.5;
+    config.skip_n = 2;
+    config.predict_time = 3.0;
+    config.speed_cost_gain = 1.0;
+    config.to_goal_cost_gain = 0.15;
+    config.obstacle_cost_gain = 1.0;
+    config.robot_stuck_flag_cons = 0.001;
+    config.parallel_rollout = parallel;
+    return config;
+}
+
+void
+drive(const std::vector<std::array<real_t, 2>>& obstacles, bool parallel, const std::string& label){
+
+    const DiffDriveDW::goal_t goal({SIZE - 1.0, SIZE - 1.0});
+    DiffDriveDW::state_t state = {0.0, 0.0, MathConsts::PI / 8.0, 0.0, 0.0};
+    DiffDriveDW dw(state, make_config(parallel), goal, {0.0, 0.0});
+
+    uint_t cycles = 0;
+    uint_t candidates = 0;
+    real_t total_ms = 0.0;
+    real_t worst_ms = 0.0;
+    bool reached = false;
+
+    for(; cycles < MAX_CYCLES && !reached; ++cycles){
+
+        auto best = DiffDriveDW::npos;
+        const auto ms = time_ms([&](){best = dw.dwa_control(obstacles);});
+        total_ms += ms;
+        worst_ms = std::max(worst_ms, ms);
+        candidates += dw.n_candidates();
+
+        if(best == DiffDriveDW::npos){
+            std::cout<<"Every candidate collides at cycle "<<cycles<<std::endl;
+            break;
+        }
+
+        // move the robot with the control for one step
+        const auto [v, w] = dw.get_control();
+        state[DiffDriveDW::THETA] += w * 0.1;
+        state[DiffDriveDW::X] += v * std::cos(state[DiffDriveDW::THETA]) * 0.1;
+        state[DiffDriveDW::Y] += v * std::sin(state[DiffDriveDW::THETA]) * 0.1;
+        state[DiffDriveDW::V] = v;
+        state[DiffDriveDW::W] = w;
+        dw.update_state(state);
+
+        reached = std::hypot(state[0] - goal[0], state[1] - goal[1]) <= 0.5;
+    }
+
+    std::cout<<label<<" reached="<<reached<<" cycles="<<cycles
+             <<" candidates/cycle="<<candidates / std::max(cycles, uint_t(1))
+             <<" mean="<<total_ms / std::max(cycles, uint_t(1))<<" ms"
+             <<" worst="<<worst_ms<<" ms"<<std::endl;
+}
+
+// drive with the scan points and time the cycle with
+// the points and with the distance map at every state.
+// Both windows hold the same candidates so the choice of
+// the map can be costed with the points
+void
+compare(const std::vector<std::array<real_t, 2>>& scan, const ObstacleDistanceMap& map){
+
+    const DiffDriveDW::goal_t goal({SIZE - 1.0, SIZE - 1.0});
+    DiffDriveDW::state_t state = {0.0, 0.0, MathConsts::PI / 8.0, 0.0, 0.0};
+    DiffDriveDW with_points(state, make_config(false), goal, {0.0, 0.0});
+    DiffDriveDW with_map(state, make_config(false), goal, {0.0, 0.0});
+
+    uint_t cycles = 0;
+    uint_t close_cost = 0;
+    real_t worst_excess = 0.0;
+    real_t points_ms = 0.0;
+    real_t map_ms = 0.0;
+    bool reached = false;
+
+    for(; cycles < MAX_CYCLES && !reached; ++cycles){
+
+        auto best = DiffDriveDW::npos;
+        auto map_best = DiffDriveDW::npos;
+        points_ms += time_ms([&](){best = with_points.dwa_control(scan);});
+        map_ms += time_ms([&](){map_best = with_map.dwa_control(map);});
+
+        if(best == DiffDriveDW::npos){
+            std::cout<<"Every candidate collides at cycle "<<cycles<<std::endl;
+            break;
+        }
+
+        // the excess cost of the candidate of the map, infinite
+        // if it collides with the points
+        const auto best_cost = with_points.candidate_cost(best);
+        const auto map_cost = map_best == DiffDriveDW::npos ? std::numeric_limits<real_t>::infinity()
+                                                            : with_points.candidate_cost(map_best);
+        const auto excess = (map_cost - best_cost) / std::max(std::abs(best_cost), real_t(1.0e-12));
+        close_cost += excess <= COST_TOLERANCE;
+        worst_excess = std::max(worst_excess, excess);
+
+        const auto [v, w] = with_points.get_control();
+        state[DiffDriveDW::THETA] += w * 0.1;
+        state[DiffDriveDW::X] += v * std::cos(state[DiffDriveDW::THETA]) * 0.1;
+        state[DiffDriveDW::Y] += v * std::sin(state[DiffDriveDW::THETA]) * 0.1;
+        state[DiffDriveDW::V] = v;
+        state[DiffDriveDW::W] = w;
+        with_points.update_state(state);
+        with_map.update_state(state);
+
+        reached = std::hypot(state[0] - goal[0], state[1] - goal[1]) <= 0.5;
+    }
+
+    const auto n = static_cast<real_t>(std::max(cycles, uint_t(1)));
+    std::cout<<scan.size()<<" scan points reached="<<reached<<" cycles="<<cycles
+             <<" points mean="<<points_ms / n<<" ms map mean="<<map_ms / n<<" ms"<<std::endl;
+    std::cout<<"the control of the map costs at most "<<100.0 * COST_TOLERANCE<<"% more than the best in "
+             <<close_cost<<" of "<<cycles<<" cycles, worst excess "<<100.0 * worst_excess<<"%"<<std::endl;
+}
+
+}
+
+int main(){
+
+    using namespace planning_example_7;
+
+    try{
+
+        std::mt19937 gen(SEED);
+        std::uniform_real_distribution<real_t> position(1.0, SIZE - 2.0);
+
+        std::vector<std::array<real_t, 2>> obstacles;
+        while(obstacles.size() < N_OBSTACLES){
+            const std::array<real_t, 2> o = {position(gen), position(gen)};
+            if(std::hypot(o[0], o[1]) > 2.0 && std::hypot(o[0] - SIZE + 1.0, o[1] - SIZE + 1.0) > 2.0){
+                obstacles.push_back(o);
+            }
+        }
+
+        drive(obstacles, false, "serial  ");
+        drive(obstacles, true, "parallel");
+
+        // every obstacle is a disc seen as points on its boundary
+        std::vector<std::array<real_t, 2>> scan;
+        for(const auto& o : obstacles){
+            for(uint_t i=0; i<N_SCAN_POINTS; ++i){
+                const auto angle = 2.0 * MathConsts::PI * i / N_SCAN_POINTS;
+                scan.push_back({o[0] + DISC_RADIUS * std::cos(angle), o[1] + DISC_RADIUS * std::sin(angle)});
+            }
+        }
+
+        ObstacleDistanceMap map(-1.0, -1.0, 440, 440, 0.05, 2.0);
+        auto ms = time_ms([&](){map.add_points(scan); map.update();});
+        std::cout<<"map of "<<scan.size()<<" points built in "<<ms<<" ms"<<std::endl;
+
+        // a new scan where one obstacle moved
+        std::vector<std::array<real_t, 2>> moved(scan.begin(), scan.begin() + N_SCAN_POINTS);
+        ms = time_ms([&](){
+            map.remove_points(moved);
+            for(auto& p : moved){
+                p[0] += 0.2;
+            }
+            map.add_points(moved);
+            map.update();
+        });
+        std::copy(moved.begin(), moved.end(), scan.begin());
+        std::cout<<"map updated for a moved obstacle in "<<ms<<" ms"<<std::endl;
+
+        compare(scan, map);
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
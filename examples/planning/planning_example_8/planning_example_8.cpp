@@ -0,0 +1,167 @@
+/**
+  * A roadmap over a grid of points, every point connected to its eight
+  * neighbours, stored in a BoostSerialGraph and converted to a CSRGraph.
+  * The example counts the bytes allocated by each representation and
+  * times a sweep over all the neighbours and A* queries on both. The
+  * allocations are counted by replacing the global operator new
+  *
+ */
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/data_structs/boost_serial_graph.h"
+#include "cubeai/data_structs/csr_graph.h"
+#include "cubeai/planning/a_star_search.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <vector>
+
+namespace planning_example_8
+{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::AStarSearch;
+using cubeai::BoostSerialGraph;
+using cubeai::build_csr_graph;
+
+const uint_t N = 300;
+const uint_t N_QUERIES = 20;
+const uint_t SEED = 42;
+
+uint_t allocated_bytes = 0;
+
+template<typename Fn>
+real_t
+time_ms(Fn fn){
+
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<real_t, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+struct Point
+{
+    real_t x{0.0};
+    real_t y{0.0};
+};
+
+typedef BoostSerialGraph<Point, real_t> graph_t;
+
+real_t
+distance(const graph_t::vertex_t& v, const graph_t::vertex_t& w){
+    return std::hypot(v.data.x - w.data.x, v.data.y - w.data.y);
+}
+
+}
+
+void* operator new(std::size_t size){
+
+    planning_example_8::allocated_bytes += size;
+    if(auto* p = std::malloc(size)){
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p)noexcept{std::free(p);}
+void operator delete(void* p, std::size_t)noexcept{std::free(p);}
+
+int main(){
+
+    using namespace planning_example_8;
+
+    try{
+
+        auto bytes = allocated_bytes;
+        graph_t graph(N * N);
+        for(uint_t v=0; v<N * N; ++v){
+            graph.get_vertex(v).data = Point{static_cast<real_t>(v % N), static_cast<real_t>(v / N)};
+        }
+
+        for(uint_t y=0; y<N; ++y){
+            for(uint_t x=0; x<N; ++x){
+
+                const auto v = y * N + x;
+                if(x + 1 < N) graph.add_edge(v, v + 1).get_data() = 1.0;
+                if(y + 1 < N) graph.add_edge(v, v + N).get_data() = 1.0;
+                if(x + 1 < N && y + 1 < N) graph.add_edge(v, v + N + 1).get_data() = std::sqrt(2.0);
+                if(x > 0 && y + 1 < N) graph.add_edge(v, v + N - 1).get_data() = std::sqrt(2.0);
+            }
+        }
+
+        const auto boost_bytes = allocated_bytes - bytes;
+
+        bytes = allocated_bytes;
+        cubeai::CSRGraph<real_t> csr;
+        auto ms = time_ms([&](){csr = build_csr_graph(graph);});
+        const auto csr_bytes = csr.memory_bytes();
+
+        const auto csr32 = build_csr_graph<float, std::uint32_t>(graph, distance);
+
+        std::cout<<"vertices="<<graph.n_vertices()<<" edges="<<graph.n_edges()<<std::endl;
+        std::cout<<"BoostSerialGraph allocated "<<boost_bytes / 1024<<" KB"<<std::endl;
+        std::cout<<"CSRGraph<real_t, uint_t> "<<csr_bytes / 1024<<" KB, built in "<<ms<<" ms"<<std::endl;
+        std::cout<<"CSRGraph<float, uint32_t> "<<csr32.memory_bytes() / 1024<<" KB"<<std::endl;
+
+        auto cost = [](const graph_t::vertex_t& v, const graph_t::vertex_t& w){return distance(v, w);};
+        cubeai::astar_impl::BoostGraphView<graph_t, decltype(cost)> view(graph, cost);
+
+        // sum the weights of all the arcs
+        real_t sum_view = 0.0;
+        real_t sum_csr = 0.0;
+        const auto view_ms = time_ms([&](){
+            for(uint_t v=0; v<view.n_vertices(); ++v){
+                view.for_each_neighbor(v, [&](uint_t, real_t c){sum_view += c;});
+            }
+        });
+
+        const auto csr_ms = time_ms([&](){
+            for(uint_t v=0; v<csr.n_vertices(); ++v){
+                csr.for_each_neighbor(v, [&](uint_t, real_t c){sum_csr += c;});
+            }
+        });
+
+        std::cout<<"neighbour sweep: BoostSerialGraph "<<view_ms<<" ms, CSRGraph "<<csr_ms
+                 <<" ms (sums "<<sum_view<<" "<<sum_csr<<")"<<std::endl;
+
+        AStarSearch<real_t> astar(graph.n_vertices());
+        std::mt19937 gen(SEED);
+        std::uniform_int_distribution<uint_t> vertex(0, graph.n_vertices() - 1);
+
+        real_t astar_view_ms = 0.0;
+        real_t astar_csr_ms = 0.0;
+        for(uint_t q=0; q<N_QUERIES; ++q){
+
+            const auto start = vertex(gen);
+            const auto goal = vertex(gen);
+            auto h = [&](uint_t v){return distance(graph.get_vertex(v), graph.get_vertex(goal));};
+
+            real_t cost_view = 0.0;
+            astar_view_ms += time_ms([&](){astar.search(view, start, goal, h); cost_view = astar.g_cost(goal);});
+            astar_csr_ms += time_ms([&](){astar.search(csr, start, goal, h);});
+
+            if(std::abs(cost_view - astar.g_cost(goal)) > 1.0e-9){
+                std::cout<<"Different costs for query "<<q<<std::endl;
+            }
+        }
+
+        std::cout<<"A* mean query: BoostSerialGraph "<<astar_view_ms / N_QUERIES<<" ms, CSRGraph "
+                 <<astar_csr_ms / N_QUERIES<<" ms"<<std::endl;
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,206 @@
+/**
+  * Preprocessing of a large roadmap before A* queries. The roadmap is a
+  * grid of points, every point connected to its eight neighbours, with
+  * a fraction of the points blocked, stored in a CSRGraph. The example
+  * times breadth first search, delta-stepping shortest paths and the
+  * connected components on one thread and in parallel chunks. The
+  * components reject the queries whose ends are not connected without a
+  * search and the distances to a goal, computed once, are an exact
+  * heuristic for the A* queries that share the goal. The speedup of the
+  * parallel runs depends on the cores of the machine
+  *
+ */
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/data_structs/csr_graph.h"
+#include "cubeai/data_structs/csr_graph_algorithms.h"
+#include "cubeai/planning/a_star_search.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace planning_example_9
+{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::AStarSearch;
+using cubeai::CSRAlgorithmsConfig;
+using cubeai::CSRGraph;
+using cubeai::CSRGraphBuilder;
+
+const uint_t N = 1000;
+const real_t BLOCKED = 0.55;
+const uint_t N_QUERIES = 20;
+const uint_t SEED = 42;
+
+template<typename Fn>
+real_t
+time_ms(Fn fn){
+
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<real_t, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+CSRGraph<real_t>
+make_roadmap(std::vector<bool>& blocked){
+
+    std::mt19937 gen(SEED);
+    std::bernoulli_distribution block(BLOCKED);
+
+    blocked.resize(N * N);
+    for(uint_t v=0; v<N * N; ++v){
+        blocked[v] = block(gen);
+    }
+
+    CSRGraphBuilder<real_t> builder(N * N);
+    builder.reserve(8 * N * N);
+
+    auto connect = [&](uint_t v, uint_t w, real_t c){
+        if(!blocked[v] && !blocked[w]){
+            builder.add_edge(v, w, c);
+        }
+    };
+
+    for(uint_t y=0; y<N; ++y){
+        for(uint_t x=0; x<N; ++x){
+
+            const auto v = y * N + x;
+            if(x + 1 < N) connect(v, v + 1, 1.0);
+            if(y + 1 < N) connect(v, v + N, 1.0);
+            if(x + 1 < N && y + 1 < N) connect(v, v + N + 1, std::sqrt(2.0));
+            if(x > 0 && y + 1 < N) connect(v, v + N - 1, std::sqrt(2.0));
+        }
+    }
+
+    return builder.build();
+}
+
+void
+run(const CSRGraph<real_t>& roadmap, uint_t source, bool parallel, const std::string& label){
+
+    CSRAlgorithmsConfig config;
+    config.parallel = parallel;
+
+    std::vector<uint_t> level;
+    std::vector<uint_t> parent;
+    std::vector<real_t> dist;
+    std::vector<uint_t> component;
+
+    uint_t n_levels = 0;
+    uint_t n_components = 0;
+    const auto bfs_ms = time_ms([&](){n_levels = cubeai::bfs_levels(roadmap, source, level, parent, config);});
+    const auto sssp_ms = time_ms([&](){cubeai::delta_stepping(roadmap, source, 0.0, dist, parent, config);});
+    const auto cc_ms = time_ms([&](){n_components = cubeai::connected_components(roadmap, component, config);});
+
+    std::cout<<label<<" bfs "<<bfs_ms<<" ms ("<<n_levels<<" levels)"
+             <<" delta-stepping "<<sssp_ms<<" ms"
+             <<" components "<<cc_ms<<" ms ("<<n_components<<")"<<std::endl;
+}
+
+}
+
+int main(){
+
+    using namespace planning_example_9;
+
+    try{
+
+        std::vector<bool> blocked;
+        const auto roadmap = make_roadmap(blocked);
+        std::cout<<"vertices="<<roadmap.n_vertices()<<" arcs="<<roadmap.n_arcs()<<std::endl;
+
+        // the goal is the free point closest to the centre
+        uint_t goal = N * (N / 2) + N / 2;
+        while(blocked[goal]){
+            ++goal;
+        }
+
+        run(roadmap, goal, false, "serial  ");
+        run(roadmap, goal, true, "parallel");
+
+        // the blocked points are components of one vertex
+        std::vector<uint_t> component;
+        const auto n_components = cubeai::connected_components(roadmap, component);
+        std::vector<uint_t> size(n_components, 0);
+        for(const auto c : component){
+            ++size[c];
+        }
+
+        std::cout<<"the goal is in a component of "<<size[component[goal]]<<" vertices"<<std::endl;
+
+        // the graph is undirected so the distances from the goal are the distances to it
+        std::vector<real_t> to_goal;
+        std::vector<uint_t> parent;
+        cubeai::delta_stepping(roadmap, goal, 0.0, to_goal, parent);
+
+        auto octile = [&](uint_t v){
+            const auto dx = std::abs(static_cast<real_t>(v % N) - static_cast<real_t>(goal % N));
+            const auto dy = std::abs(static_cast<real_t>(v / N) - static_cast<real_t>(goal / N));
+            return std::max(dx, dy) + (std::sqrt(2.0) - 1.0) * std::min(dx, dy);
+        };
+
+        auto exact = [&](uint_t v){return to_goal[v];};
+
+        AStarSearch<real_t> astar(roadmap.n_vertices());
+        std::mt19937 gen(SEED);
+        std::uniform_int_distribution<uint_t> vertex(0, roadmap.n_vertices() - 1);
+
+        uint_t rejected = 0;
+        uint_t touched_octile = 0;
+        uint_t touched_exact = 0;
+        real_t octile_ms = 0.0;
+        real_t exact_ms = 0.0;
+        real_t reject_ms = 0.0;
+
+        for(uint_t q=0; q<N_QUERIES; ++q){
+
+            auto start = vertex(gen);
+            while(blocked[start]){
+                start = vertex(gen);
+            }
+
+            if(component[start] != component[goal]){
+
+                // the search without the components expands the whole region of start
+                reject_ms += time_ms([&](){astar.search(roadmap, start, goal, octile);});
+                ++rejected;
+                continue;
+            }
+
+            octile_ms += time_ms([&](){astar.search(roadmap, start, goal, octile);});
+            touched_octile += astar.n_touched();
+            const auto cost = astar.g_cost(goal);
+
+            exact_ms += time_ms([&](){astar.search(roadmap, start, goal, exact);});
+            touched_exact += astar.n_touched();
+
+            if(std::abs(cost - astar.g_cost(goal)) > 1.0e-9){
+                std::cout<<"Different costs for query "<<q<<std::endl;
+            }
+        }
+
+        const auto n_solved = std::max(N_QUERIES - rejected, uint_t(1));
+        std::cout<<rejected<<" of "<<N_QUERIES<<" queries rejected by the components, "
+                 <<"a search would spend "<<reject_ms / std::max(rejected, uint_t(1))<<" ms on each"<<std::endl;
+        std::cout<<"A* mean query: octile heuristic "<<octile_ms / n_solved<<" ms ("
+                 <<touched_octile / n_solved<<" vertices), exact heuristic "
+                 <<exact_ms / n_solved<<" ms ("<<touched_exact / n_solved<<" vertices)"<<std::endl;
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
@@ -3,11 +3,11 @@
 #if defined(USE_PYTORCH) && defined(USE_RLENVS_CPP)
 
 #include "cubeai/base/cubeai_types.h"
-#include "cubeai/maths/statistics/distributions/torch_categorical.h"
 #include "cubeai/rl/trainers/rl_serial_agent_trainer.h"
 #include "cubeai/rl/algorithms/actor_critic/a2c.h"
 #include "cubeai/maths/optimization/optimizer_type.h"
 #include "cubeai/maths/optimization/pytorch_optimizer_factory.h"
+#include "cubeai/rl/worlds/serial_vector_env.h"
 #include "rlenvs/envs/gymnasium/classic_control/cart_pole_env.h"
 
 #include <iostream>
@@ -21,13 +21,15 @@ const std::string SERVER_URL = "http://0.0.0.0:8001/api";
 using cubeai::real_t;
 using cubeai::uint_t;
 using cubeai::torch_tensor_t;
-using cubeai::maths::stats::TorchCategorical;
 using cubeai::rl::algos::ac::A2CConfig;
 using cubeai::rl::algos::ac::A2CSolver;
 using cubeai::rl::RLSerialAgentTrainer;
 using cubeai::rl::RLSerialTrainerConfig;
+using cubeai::rl::envs::SerialVectorEnv;
 using rlenvs_cpp::envs::gymnasium::CartPoleActionsEnum;
 
+const uint_t N_ENVS = 4;
+
 
 // create the Action and the Critic networks
 class ActorNetImpl: public torch::nn::Module
@@ -38,9 +40,9 @@ public:
     ActorNetImpl(uint_t state_size, uint_t action_size);
 
 
+    // returns the action logits. The solver builds the
+    // categorical distribution from them with log_softmax
     torch_tensor_t forward(torch_tensor_t state);
-    torch_tensor_t log_probabilities(torch_tensor_t actions);
-    torch_tensor_t sample();
 
 
 private:
@@ -48,9 +50,6 @@ private:
     torch::nn::Linear linear1_;
     torch::nn::Linear linear2_;
     torch::nn::Linear linear3_;
-
-    // the underlying distribution used to sample actions
-    TorchCategorical distribution_;
 };
 
 ActorNetImpl::ActorNetImpl(uint_t state_size, uint_t action_size)
@@ -71,20 +70,7 @@ ActorNetImpl::forward(torch_tensor_t state){
 
     auto output = torch::nn::functional::relu(linear1_(state));
     output = torch::nn::functional::relu(linear2_(output));
-    output = linear3_(output);
-    const torch_tensor_t probs = torch::nn::functional::softmax(output,-1);
-    distribution_.build_from_probabilities(probs);
-    return probs;
-}
-
-torch_tensor_t
-ActorNetImpl::sample(){
-    return distribution_.sample();
-}
-
-torch_tensor_t
-ActorNetImpl::log_probabilities(torch_tensor_t actions){
-    return distribution_.log_prob(actions);
+    return linear3_(output);
 }
 
 
@@ -131,7 +117,8 @@ TORCH_MODULE(ActorNet);
 TORCH_MODULE(CriticNet);
 
 
-typedef  rlenvs_cpp::envs::gymnasium::CartPole env_type;
+typedef  rlenvs_cpp::envs::gymnasium::CartPole cart_pole_type;
+typedef  SerialVectorEnv<cart_pole_type> env_type;
 
 
 }
@@ -143,21 +130,26 @@ int main(){
 
     try{
 
-        // create the environment
-        env_type env(SERVER_URL);
-
-        std::cout<<"Environment URL: "<<env.get_url()<<std::endl;
+        // create the environments
         std::unordered_map<std::string, std::any> options;
 
-        std::cout<<"Creating the environment..."<<std::endl;
-        env.make("v1", options);
-        env.reset();
+        std::cout<<"Creating the environments..."<<std::endl;
+        env_type env(N_ENVS, [&options](){
+            auto cart_pole = std::make_unique<cart_pole_type>(SERVER_URL);
+            cart_pole -> make("v1", options);
+            return cart_pole;
+        });
+
         std::cout<<"Done..."<<std::endl;
-        std::cout<<"Number of actions="<<env.n_actions()<<std::endl;
+        std::cout<<"Number of environments="<<env.n_copies()<<std::endl;
+        std::cout<<"Number of actions="<<env.env(0).n_actions()<<std::endl;
 
 
         A2CConfig a2c_config;
-        ActorNet policy(4, env.n_actions());
+        a2c_config.n_iterations_per_episode = 32;
+        a2c_config.beta = 0.01;
+        a2c_config.max_grad_norm = 0.5;
+        ActorNet policy(4, env.env(0).n_actions());
         CriticNet critic(4);
 
 
@@ -179,6 +171,8 @@ int main(){
                            policy_optimizer, critic_optimizer);
 
         RLSerialTrainerConfig config;
+        config.n_episodes = 1000;
+        config.output_msg_frequency = 50;
         RLSerialAgentTrainer<env_type, solver_type> trainer(config, solver);
         trainer.train(env);
 
@@ -16,7 +16,7 @@
 #include "cubeai/rl/trainers/rl_serial_agent_trainer.h"
 #include "cubeai/maths/optimization/optimizer_type.h"
 #include "cubeai/maths/optimization/pytorch_optimizer_factory.h"
-#include "cubeai/maths/statistics/distributions/torch_categorical.h"
+#include "cubeai/rl/worlds/serial_vector_env.h"
 
 #include "rlenvs/envs/gymnasium/classic_control/cart_pole_env.h"
 #include <torch/torch.h>
@@ -27,6 +27,7 @@
 #include <any>
 #include <filesystem>
 #include <map>
+#include <memory>
 
 namespace rl_example_13{
 
@@ -43,9 +44,11 @@ using cubeai::rl::algos::pg::ReinforceSolver;
 using cubeai::rl::algos::pg::ReinforceConfig;
 using cubeai::rl::RLSerialAgentTrainer;
 using cubeai::rl::RLSerialTrainerConfig;
-using cubeai::maths::stats::TorchCategorical;
+using cubeai::rl::envs::SerialVectorEnv;
 using rlenvs_cpp::envs::gymnasium::CartPole;
 
+const uint_t N_ENVS = 4;
+
 // The class that models the Policy network to train
 class PolicyNetImpl: public torch::nn::Module
 {
@@ -54,26 +57,14 @@ public:
 
     PolicyNetImpl();
 
+    // maps a batch of states to the action logits
     torch_tensor_t forward(torch_tensor_t);
 
-    template<typename StateTp>
-    std::tuple<uint_t, real_t> act(const StateTp& state);
-
-    template<typename LossValuesTp>
-    void update_policy_loss(const LossValuesTp& vals);
-
-    void step_backward_policy_loss();
-
-    torch_tensor_t compute_loss(){return loss_;}
-
 private:
 
    torch::nn::Linear fc1_;
    torch::nn::Linear fc2_;
 
-   // placeholder for the loss
-   torch_tensor_t loss_;
-
 };
 
 
@@ -86,46 +77,17 @@ PolicyNetImpl::PolicyNetImpl()
     register_module("fc2", fc2_);
 }
 
-template<typename LossValuesTp>
-void
-PolicyNetImpl::update_policy_loss(const LossValuesTp& vals){
-
-     torch_tensor_t torch_vals = torch::tensor(vals);
-
-     // specify that we require the gradient
-     loss_ = torch::cat(torch::tensor(vals, torch::requires_grad())).sum();
-}
-
-void
-PolicyNetImpl::step_backward_policy_loss(){
-    loss_.backward();
-}
-
 torch_tensor_t
 PolicyNetImpl::forward(torch_tensor_t x){
 
     x = F::relu(fc1_->forward(x));
-    x = fc2_->forward(x);
-    return F::softmax(x, F::SoftmaxFuncOptions(0));
+    return fc2_->forward(x);
 }
 
 
-template<typename StateTp>
-std::tuple<uint_t, real_t>
-PolicyNetImpl::act(const StateTp& state){
-
-    auto torch_state = torch::tensor(state);
-
-    auto probs = forward(torch_state);
-    auto m = TorchCategorical(probs, false);
-    auto action = m.sample();
-    return std::make_tuple(action.item().toLong(), m.log_prob(action).item().to<real_t>());
-
-}
-
 TORCH_MODULE(PolicyNet);
 
-typedef CartPole env_type;
+typedef SerialVectorEnv<CartPole> env_type;
 }
 
 
@@ -140,28 +102,35 @@ int main(){
         std::filesystem::create_directories("experiments/" + EXPERIMENT_ID);
         torch::manual_seed(42);
 
-        auto env = CartPole(SERVER_URL);
-        std::cout<<"Environment URL: "<<env.get_url()<<std::endl;
-
-        std::cout<<"Creating the environment..."<<std::endl;
+        std::cout<<"Creating the environments..."<<std::endl;
         std::unordered_map<std::string, std::any> options;
 
         // with Gymnasium v0 is not working
-        env.make("v1", options);
-        env.reset();
+        env_type env(N_ENVS, [&options](){
+            auto cart_pole = std::make_unique<CartPole>(SERVER_URL);
+            cart_pole -> make("v1", options);
+            return cart_pole;
+        });
 
         std::cout<<"Done..."<<std::endl;
-        std::cout<<"Number of actions="<<env.n_actions()<<std::endl;
+        std::cout<<"Number of environments="<<env.n_copies()<<std::endl;
+        std::cout<<"Number of actions="<<env.env(0).n_actions()<<std::endl;
 
         PolicyNet policy;
 
         //auto optimizer_ptr = std::make_unique<torch::optim::Adam>(policy->parameters(),
         //                                                          torch::optim::AdamOptions(1e-2));
 
-        typedef ReinforceSolver<CartPole, PolicyNet> solver_type;
+        typedef ReinforceSolver<env_type, PolicyNet> solver_type;
 
-        // reinforce options
-        ReinforceConfig opts = {1000, 100, 100, 100, 1.0e-2, 0.1, 195.0};
+        // reinforce options. Every update uses
+        // one episode from each environment
+        ReinforceConfig opts;
+        opts.max_itrs_per_episode = 500;
+        opts.n_episodes_per_update = N_ENVS;
+        opts.gamma = 0.99;
+        opts.use_baseline = true;
+        opts.normalize_returns = true;
 
         std::map<std::string, std::any> opt_options;
         opt_options.insert(std::make_pair("lr", 0.001));
@@ -179,7 +148,6 @@ int main(){
         config.n_episodes = 10;
         config.output_msg_frequency = 10;
         RLSerialAgentTrainer<env_type, solver_type> trainer(config, solver);
-        trainer.train(env);
 
         auto info = trainer.train(env);
         std::cout<<"Trainer info: "<<info<<std::endl;
@@ -0,0 +1,197 @@
+#include "cubeai/base/cubeai_config.h"
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/algorithms/td/sarsa.h"
+#include "cubeai/rl/algorithms/td/sarsa_lambda.h"
+#include "cubeai/rl/algorithms/td/watkins_q_lambda.h"
+#include "cubeai/rl/algorithms/td/n_step_sarsa.h"
+#include "cubeai/rl/policies/epsilon_greedy_policy.h"
+#include "cubeai/rl/trainers/rl_serial_agent_trainer.h"
+#include "cubeai/rl/episode_info.h"
+#include "cubeai/rl/worlds/grid_world.h"
+
+#include <iostream>
+#include <chrono>
+#include <string>
+
+namespace rl_example_20
+{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::DynMat;
+using cubeai::rl::EpisodeInfo;
+using cubeai::rl::policies::EpsilonGreedyPolicy;
+using cubeai::rl::policies::EpsilonDecayOption;
+using cubeai::rl::algos::td::SarsaSolver;
+using cubeai::rl::algos::td::SarsaConfig;
+using cubeai::rl::algos::td::SarsaLambdaSolver;
+using cubeai::rl::algos::td::SarsaLambdaConfig;
+using cubeai::rl::algos::td::WatkinsQLambda;
+using cubeai::rl::algos::td::QLambdaConfig;
+using cubeai::rl::algos::td::NStepSarsa;
+using cubeai::rl::algos::td::NStepSarsaConfig;
+using cubeai::rl::algos::td::TDAlgoBase;
+using cubeai::rl::RLSerialAgentTrainer;
+using cubeai::rl::RLSerialTrainerConfig;
+
+const uint_t GRID_SIZE = 512;
+const uint_t N_EPISODES = 50;
+const uint_t N_DENSE_EPISODES = 2;
+const uint_t MAX_ITRS = 5000;
+const uint_t SEED = 42;
+const real_t GAMMA = 0.99;
+const real_t ETA = 0.1;
+const real_t LAMBDA = 0.9;
+const real_t EPS = 0.1;
+
+typedef cubeai::rl::envs::GridWorld env_type;
+
+///
+/// \brief SARSA(lambda) with a dense eligibility matrix. Every step
+/// touches the whole n_states x n_actions table. Used as the baseline
+///
+template<typename EnvTp, typename ActionSelector>
+class DenseSarsaLambda final: public TDAlgoBase<EnvTp>
+{
+public:
+
+    DenseSarsaLambda(SarsaLambdaConfig config, const ActionSelector& selector)
+        :
+          config_(config),
+          action_selector_(selector)
+    {}
+
+    virtual void actions_before_training_begins(EnvTp& env){
+        q_table_ = DynMat<real_t>::Zero(env.n_states(), env.n_actions());
+        traces_ = DynMat<real_t>::Zero(env.n_states(), env.n_actions());
+    }
+
+    virtual void actions_after_training_ends(EnvTp&){}
+
+    virtual void actions_before_episode_begins(EnvTp&, uint_t){traces_.setZero();}
+
+    virtual EpisodeInfo on_training_episode(EnvTp& env, uint_t episode_idx){
+
+        auto start = std::chrono::steady_clock::now();
+        EpisodeInfo info;
+
+        auto episode_score = 0.0;
+        auto state = env.reset().observation();
+        auto action = action_selector_(q_table_, state);
+
+        uint_t itr = 0;
+        for(; itr < config_.max_num_iterations_per_episode; ++itr){
+
+            auto time_step = env.step(action);
+            auto next_state = time_step.observation();
+            episode_score += time_step.reward();
+
+            traces_(state, action) = 1.0;
+            auto next_action = action_selector_(q_table_, next_state);
+            auto q_next = time_step.done() ? 0.0 : q_table_(next_state, next_action);
+            auto td_error = time_step.reward() + config_.gamma * q_next - q_table_(state, action);
+
+            q_table_ += (config_.eta * td_error) * traces_;
+            traces_ *= config_.gamma * config_.lambda;
+
+            if(time_step.done()){
+                break;
+            }
+
+            state = next_state;
+            action = next_action;
+        }
+
+        std::chrono::duration<real_t> elapsed_seconds = std::chrono::steady_clock::now() - start;
+        info.episode_index = episode_idx;
+        info.episode_reward = episode_score;
+        info.episode_iterations = itr;
+        info.total_time = elapsed_seconds;
+        return info;
+    }
+
+private:
+
+    SarsaLambdaConfig config_;
+    ActionSelector action_selector_;
+    DynMat<real_t> q_table_;
+    DynMat<real_t> traces_;
+};
+
+///
+/// \brief Train the given agent and report the time per environment step
+///
+template<typename AgentType>
+void
+run_benchmark(const std::string& name, AgentType& agent, uint_t n_episodes){
+
+    env_type env(GRID_SIZE);
+
+    RLSerialTrainerConfig trainer_config;
+    trainer_config.n_episodes = n_episodes;
+    trainer_config.tolerance = 1.0e-8;
+
+    RLSerialAgentTrainer<env_type, AgentType> trainer(trainer_config, agent);
+
+    auto result = trainer.train(env);
+
+    auto total_steps = env.n_steps();
+    auto ns_per_step = 1.0e9 * result.total_time.count() / static_cast<real_t>(total_steps);
+
+    std::cout<<name<<": episodes="<<trainer.n_itrs_per_episode().size()
+             <<" steps="<<total_steps
+             <<" total time="<<result.total_time.count()<<"s"
+             <<" time/step="<<ns_per_step<<"ns"<<std::endl;
+}
+
+}
+
+int main(){
+
+    using namespace rl_example_20;
+
+    try{
+
+        std::cout<<"Grid "<<GRID_SIZE<<"x"<<GRID_SIZE<<" states="<<GRID_SIZE * GRID_SIZE<<" actions=4"<<std::endl;
+
+        {
+            SarsaConfig config = {N_EPISODES, 1.0e-8, GAMMA, ETA, MAX_ITRS};
+            SarsaSolver<env_type, EpsilonGreedyPolicy> agent(config, EpsilonGreedyPolicy(EPS, SEED));
+            run_benchmark("SARSA (one step)   ", agent, N_EPISODES);
+        }
+
+        {
+            SarsaLambdaConfig config = {N_EPISODES, 1.0e-8, GAMMA, ETA, LAMBDA, MAX_ITRS};
+            SarsaLambdaSolver<env_type, EpsilonGreedyPolicy> agent(config, EpsilonGreedyPolicy(EPS, SEED));
+            run_benchmark("SARSA(lambda) sparse", agent, N_EPISODES);
+            std::cout<<"    active traces at the end="<<agent.traces().size()<<std::endl;
+        }
+
+        {
+            QLambdaConfig config = {N_EPISODES, 1.0e-8, GAMMA, ETA, LAMBDA, MAX_ITRS};
+            WatkinsQLambda<env_type, EpsilonGreedyPolicy> agent(config, EpsilonGreedyPolicy(EPS, SEED));
+            run_benchmark("Q(lambda) sparse    ", agent, N_EPISODES);
+        }
+
+        {
+            NStepSarsaConfig config = {N_EPISODES, 1.0e-8, GAMMA, ETA, 8, MAX_ITRS};
+            NStepSarsa<env_type, EpsilonGreedyPolicy> agent(config, EpsilonGreedyPolicy(EPS, SEED));
+            run_benchmark("8-step SARSA        ", agent, N_EPISODES);
+        }
+
+        {
+            SarsaLambdaConfig config = {N_DENSE_EPISODES, 1.0e-8, GAMMA, ETA, LAMBDA, MAX_ITRS};
+            DenseSarsaLambda<env_type, EpsilonGreedyPolicy> agent(config, EpsilonGreedyPolicy(EPS, SEED));
+            run_benchmark("SARSA(lambda) dense ", agent, N_DENSE_EPISODES);
+        }
+
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
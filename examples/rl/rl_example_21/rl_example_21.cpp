@@ -0,0 +1,116 @@
+#include "cubeai/base/cubeai_config.h"
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/algorithms/td/q_learning.h"
+#include "cubeai/rl/algorithms/td/expected_sarsa.h"
+#include "cubeai/rl/policies/epsilon_greedy_policy.h"
+#include "cubeai/rl/trainers/rl_serial_agent_trainer.h"
+#include "cubeai/rl/worlds/grid_world.h"
+#include "cubeai/utils/instrumentation.h"
+
+#include <iostream>
+#include <string>
+
+namespace rl_example_21
+{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::rl::policies::EpsilonGreedyPolicy;
+using cubeai::rl::algos::td::QLearning;
+using cubeai::rl::algos::td::QLearningConfig;
+using cubeai::rl::algos::td::ExpectedSARSA;
+using cubeai::rl::algos::td::ExpectedSARSAConfig;
+using cubeai::rl::RLSerialAgentTrainer;
+using cubeai::rl::RLSerialTrainerConfig;
+using cubeai::utils::Instrumentation;
+using cubeai::utils::InstrumentationPhase;
+using cubeai::utils::InstrumentationCounter;
+
+typedef cubeai::rl::envs::GridWorld env_type;
+
+const uint_t GRID_SIZE = 256;
+const uint_t N_EPISODES = 200;
+const uint_t MAX_ITRS = 10000;
+const uint_t SEED = 42;
+const real_t GAMMA = 0.99;
+const real_t ETA = 0.1;
+const real_t EPS = 0.1;
+
+///
+/// \brief Train the given agent and report the time per environment step
+///
+template<typename AgentType>
+real_t
+run_benchmark(const std::string& name, AgentType& agent){
+
+    env_type env(GRID_SIZE);
+
+    RLSerialTrainerConfig trainer_config;
+    trainer_config.n_episodes = N_EPISODES;
+    trainer_config.tolerance = 1.0e-8;
+
+    RLSerialAgentTrainer<env_type, AgentType> trainer(trainer_config, agent);
+    auto result = trainer.train(env);
+
+    auto ns_per_step = 1.0e9 * result.total_time.count() / static_cast<real_t>(env.n_steps());
+
+    std::cout<<name<<": steps="<<env.n_steps()
+             <<" total time="<<result.total_time.count()<<"s"
+             <<" time/step="<<ns_per_step<<"ns"<<std::endl;
+
+    return ns_per_step;
+}
+
+}
+
+int main(){
+
+    using namespace rl_example_21;
+
+    try{
+
+        QLearningConfig qlearn_config = {N_EPISODES, 1.0e-8, GAMMA, ETA, MAX_ITRS};
+        QLearning<env_type, EpsilonGreedyPolicy> qlearning(qlearn_config, EpsilonGreedyPolicy(EPS, SEED));
+        auto qlearning_time = run_benchmark("QLearning    ", qlearning);
+
+        ExpectedSARSAConfig esarsa_config = {N_EPISODES, 1.0e-8, GAMMA, ETA, MAX_ITRS};
+        ExpectedSARSA<env_type, EpsilonGreedyPolicy> esarsa(esarsa_config, EpsilonGreedyPolicy(EPS, SEED));
+        auto esarsa_time = run_benchmark("ExpectedSARSA", esarsa);
+
+        std::cout<<"ExpectedSARSA/QLearning time per step ratio="<<esarsa_time / qlearning_time<<std::endl;
+
+        // rerun QLearning with the instrumentation enabled to
+        // see where the training time goes
+        Instrumentation::enable();
+
+        QLearning<env_type, EpsilonGreedyPolicy> instrumented(qlearn_config, EpsilonGreedyPolicy(EPS, SEED));
+
+        env_type env(GRID_SIZE);
+        RLSerialTrainerConfig trainer_config;
+        trainer_config.n_episodes = N_EPISODES;
+        trainer_config.tolerance = 1.0e-8;
+
+        RLSerialAgentTrainer<env_type, QLearning<env_type, EpsilonGreedyPolicy>> trainer(trainer_config, instrumented);
+        auto result = trainer.train(env);
+
+        auto totals = Instrumentation::snapshot();
+        std::cout<<"Instrumented QLearning total time="<<result.total_time.count()<<"s"<<std::endl;
+        std::cout<<"    env step.........: "<<totals.phase_time(InstrumentationPhase::ENV_STEP)<<"s"<<std::endl;
+        std::cout<<"    action selection.: "<<totals.phase_time(InstrumentationPhase::ACTION_SELECTION)<<"s"<<std::endl;
+        std::cout<<"    update...........: "<<totals.phase_time(InstrumentationPhase::UPDATE)<<"s"<<std::endl;
+        std::cout<<"    steps/s..........: "<<totals.count(InstrumentationCounter::STEPS) / result.total_time.count()<<std::endl;
+        std::cout<<"    allocations/step.: "<<static_cast<real_t>(totals.count(InstrumentationCounter::ALLOCATIONS)) /
+                                           static_cast<real_t>(totals.count(InstrumentationCounter::STEPS))<<std::endl;
+
+        trainer.instrumentation().write_csv("rl_example_21_instrumentation.csv");
+        Instrumentation::disable();
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
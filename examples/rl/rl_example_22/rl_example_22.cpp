@@ -0,0 +1,144 @@
+#include "cubeai/base/cubeai_config.h"
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/episode_info.h"
+#include "cubeai/rl/trainers/rl_serial_agent_trainer.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace rl_example_22
+{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::rl::EpisodeInfo;
+using cubeai::rl::RLSerialAgentTrainer;
+using cubeai::rl::RLSerialTrainerConfig;
+using cubeai::rl::LogOverflowPolicy;
+
+const uint_t N_EPISODES = 1000000;
+const uint_t LOG_BUFFER_CAPACITY = 1 << 16;
+
+///
+/// \brief Environment that does nothing
+///
+struct NullEnv
+{};
+
+///
+/// \brief Agent whose episodes take no time so that
+/// only the overhead of the trainer is measured
+///
+struct NullAgent
+{
+    void actions_before_training_begins(NullEnv&){}
+    void actions_after_training_ends(NullEnv&){}
+    void actions_before_episode_begins(NullEnv&, uint_t){}
+    void actions_after_episode_ends(NullEnv&, uint_t, const EpisodeInfo&){}
+
+    EpisodeInfo on_training_episode(NullEnv&, uint_t episode_idx){
+
+        EpisodeInfo info;
+        info.episode_index = episode_idx;
+        info.episode_iterations = 1;
+        info.episode_reward = -1.0;
+        info.total_time = std::chrono::duration<real_t>(0.0);
+        return info;
+    }
+};
+
+///
+/// \brief Train with the given logging frequency and
+/// return the time per episode in ns. With LogOverflowPolicy::DROP
+/// the training thread never waits for the writer, the records
+/// it cannot keep up with are lost
+///
+real_t
+run_trainer(const std::string& name, uint_t output_msg_frequency, std::ostream& out,
+            LogOverflowPolicy overflow=LogOverflowPolicy::BLOCK){
+
+    NullEnv env;
+    NullAgent agent;
+
+    RLSerialTrainerConfig trainer_config;
+    trainer_config.n_episodes = N_EPISODES;
+    trainer_config.tolerance = 1.0e-8;
+    trainer_config.output_msg_frequency = output_msg_frequency;
+    trainer_config.output_stream = &out;
+    trainer_config.log_buffer_capacity = LOG_BUFFER_CAPACITY;
+    trainer_config.log_flush_interval = std::chrono::milliseconds(10);
+    trainer_config.log_overflow = overflow;
+
+    RLSerialAgentTrainer<NullEnv, NullAgent> trainer(trainer_config, agent);
+    auto result = trainer.train(env);
+
+    auto ns_per_episode = 1.0e9 * result.total_time.count() / static_cast<real_t>(N_EPISODES);
+
+    std::cout<<name<<": total time="<<result.total_time.count()<<"s"
+             <<" time/episode="<<ns_per_episode<<"ns"
+             <<" written="<<trainer.log_sink().n_written()
+             <<" dropped="<<trainer.log_sink().n_dropped()<<std::endl;
+
+    return ns_per_episode;
+}
+
+///
+/// \brief The loop the trainer used to run. Formats every
+/// logged episode on the training thread and flushes with std::endl
+///
+real_t
+run_synchronous(const std::string& name, uint_t output_msg_frequency, std::ostream& out){
+
+    NullEnv env;
+    NullAgent agent;
+
+    auto start = std::chrono::steady_clock::now();
+    for(uint_t episode_counter=0; episode_counter<N_EPISODES; ++episode_counter){
+
+        auto episode_info = agent.on_training_episode(env, episode_counter);
+
+        if(episode_counter % output_msg_frequency  == 0){
+            out<<episode_info<<std::endl;
+        }
+    }
+
+    std::chrono::duration<real_t> elapsed = std::chrono::steady_clock::now() - start;
+    auto ns_per_episode = 1.0e9 * elapsed.count() / static_cast<real_t>(N_EPISODES);
+
+    std::cout<<name<<": total time="<<elapsed.count()<<"s"
+             <<" time/episode="<<ns_per_episode<<"ns"<<std::endl;
+
+    return ns_per_episode;
+}
+
+}
+
+int main(){
+
+    using namespace rl_example_22;
+
+    try{
+
+        std::ofstream out("rl_example_22_log.txt");
+
+        run_trainer("No logging             ", cubeai::CubeAIConsts::INVALID_SIZE_TYPE, out);
+        auto async_100 = run_trainer("Async logging every 100", 100, out);
+        auto async_1 = run_trainer("Async logging every 1  ", 1, out);
+        run_trainer("Async every 1, dropping", 1, out, LogOverflowPolicy::DROP);
+        auto sync_100 = run_synchronous("Sync logging every 100 ", 100, out);
+        auto sync_1 = run_synchronous("Sync logging every 1   ", 1, out);
+
+        std::cout<<"Sync/async time per episode ratio (every 100)="<<sync_100 / async_100<<std::endl;
+        std::cout<<"Sync/async time per episode ratio (every 1)..="<<sync_1 / async_1<<std::endl;
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+#include "cubeai/base/cubeai_config.h"
+
+#if defined(USE_PYTORCH) && defined(USE_RLENVS_CPP)
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/trainers/rl_serial_agent_trainer.h"
+#include "cubeai/rl/algorithms/actor_critic/ppo.h"
+#include "cubeai/maths/optimization/optimizer_type.h"
+#include "cubeai/utils/instrumentation.h"
+#include "cubeai/rl/worlds/serial_vector_env.h"
+#include "rlenvs/envs/gymnasium/classic_control/cart_pole_env.h"
+
+#include <iostream>
+#include <iostream>
+#include <unordered_map>
+
+namespace rl_example_23{
+
+const std::string SERVER_URL = "http://0.0.0.0:8001/api";
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::torch_tensor_t;
+using cubeai::rl::algos::ac::PPOConfig;
+using cubeai::rl::algos::ac::PPOSolver;
+using cubeai::utils::Instrumentation;
+using cubeai::utils::InstrumentationPhase;
+using cubeai::utils::InstrumentationCounter;
+using cubeai::rl::RLSerialAgentTrainer;
+using cubeai::rl::RLSerialTrainerConfig;
+using cubeai::rl::envs::SerialVectorEnv;
+using rlenvs_cpp::envs::gymnasium::CartPoleActionsEnum;
+
+const uint_t N_ENVS = 4;
+
+
+// create the Action and the Critic networks
+class ActorNetImpl: public torch::nn::Module
+{
+public:
+
+    // constructor
+    ActorNetImpl(uint_t state_size, uint_t action_size);
+
+
+    // returns the action logits. The solver builds the
+    // categorical distribution from them with log_softmax
+    torch_tensor_t forward(torch_tensor_t state);
+
+
+private:
+
+    torch::nn::Linear linear1_;
+    torch::nn::Linear linear2_;
+    torch::nn::Linear linear3_;
+};
+
+ActorNetImpl::ActorNetImpl(uint_t state_size, uint_t action_size)
+:
+torch::nn::Module(),
+linear1_(nullptr),
+linear2_(nullptr),
+linear3_(nullptr)
+{
+   linear1_ = register_module("linear1_", torch::nn::Linear(state_size, 128));
+   linear2_ = register_module("linea2_", torch::nn::Linear(128, 256));
+   linear3_ = register_module("linear3_", torch::nn::Linear(256, action_size));
+}
+
+
+torch_tensor_t
+ActorNetImpl::forward(torch_tensor_t state){
+
+    auto output = torch::nn::functional::relu(linear1_(state));
+    output = torch::nn::functional::relu(linear2_(output));
+    return linear3_(output);
+}
+
+
+class CriticNetImpl: public torch::nn::Module
+{
+public:
+
+    // constructor
+    CriticNetImpl(uint_t state_size);
+
+    torch_tensor_t forward(torch_tensor_t state);
+
+private:
+
+    torch::nn::Linear linear1_;
+    torch::nn::Linear linear2_;
+    torch::nn::Linear linear3_;
+
+};
+
+
+CriticNetImpl::CriticNetImpl(uint_t state_size)
+:
+torch::nn::Module(),
+linear1_(nullptr),
+linear2_(nullptr),
+linear3_(nullptr)
+{
+   linear1_ = register_module("linear1_", torch::nn::Linear(state_size, 128));
+   linear2_ = register_module("linea2_", torch::nn::Linear(128, 256));
+   linear3_ = register_module("linear3_", torch::nn::Linear(256, 1));
+}
+
+torch_tensor_t
+CriticNetImpl::forward(torch_tensor_t state){
+
+    auto output = torch::nn::functional::relu(linear1_(state));
+    output = torch::nn::functional::relu(linear2_(output));
+    output = linear3_(output);
+    return output;
+}
+
+TORCH_MODULE(ActorNet);
+TORCH_MODULE(CriticNet);
+
+
+typedef  rlenvs_cpp::envs::gymnasium::CartPole cart_pole_type;
+typedef  SerialVectorEnv<cart_pole_type> env_type;
+
+
+}
+
+
+int main(){
+
+    using namespace rl_example_23;
+
+    try{
+
+        // create the environments
+        std::unordered_map<std::string, std::any> options;
+
+        std::cout<<"Creating the environments..."<<std::endl;
+        env_type env(N_ENVS, [&options](){
+            auto cart_pole = std::make_unique<cart_pole_type>(SERVER_URL);
+            cart_pole -> make("v1", options);
+            return cart_pole;
+        });
+
+        std::cout<<"Done..."<<std::endl;
+        std::cout<<"Number of environments="<<env.n_copies()<<std::endl;
+        std::cout<<"Number of actions="<<env.env(0).n_actions()<<std::endl;
+
+
+        PPOConfig ppo_config;
+        ppo_config.n_iterations_per_episode = 128;
+        ppo_config.n_epochs = 4;
+        ppo_config.batch_size = 64;
+        ppo_config.optimizer_type = cubeai::maths::optim::OptimzerType::ADAM;
+        ppo_config.learning_rate = 3.0e-4;
+
+        ActorNet policy(4, env.env(0).n_actions());
+        CriticNet critic(4);
+
+        typedef PPOSolver<env_type, ActorNet, CriticNet> solver_type;
+        solver_type solver(ppo_config, policy, critic);
+
+        RLSerialTrainerConfig config;
+        config.n_episodes = 200;
+        config.output_msg_frequency = 10;
+        RLSerialAgentTrainer<env_type, solver_type> trainer(config, solver);
+
+        Instrumentation::enable();
+        auto result = trainer.train(env);
+        auto totals = Instrumentation::snapshot();
+
+        std::cout<<"Total time="<<result.total_time.count()<<"s"<<std::endl;
+        std::cout<<"    env step.........: "<<totals.phase_time(InstrumentationPhase::ENV_STEP)<<"s"<<std::endl;
+        std::cout<<"    action selection.: "<<totals.phase_time(InstrumentationPhase::ACTION_SELECTION)<<"s"<<std::endl;
+        std::cout<<"    loss.............: "<<totals.phase_time(InstrumentationPhase::LOSS)<<"s"<<std::endl;
+        std::cout<<"    update...........: "<<totals.phase_time(InstrumentationPhase::UPDATE)<<"s"<<std::endl;
+        std::cout<<"    steps/s..........: "<<totals.count(InstrumentationCounter::STEPS) / result.total_time.count()<<std::endl;
+        std::cout<<"    updates..........: "<<totals.count(InstrumentationCounter::UPDATES)<<std::endl;
+        std::cout<<"Last approx KL="<<solver.last_stats().approx_kl
+                 <<" clip fraction="<<solver.last_stats().clip_fraction<<std::endl;
+
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
+#else
+#include <iostream>
+
+int main(){
+
+    std::cout<<"This example requires the flag USE_RLENVS_CPP to be true."<<std::endl;
+    std::cout<<"Reconfigures and rebuild the library by setting the flag USE_RLENVS_CPP  to ON."<<std::endl;
+    return 1;
+}
+#endif
@@ -0,0 +1,143 @@
+#include "cubeai/base/cubeai_config.h"
+
+#if defined(USE_PYTORCH) && defined(USE_RLENVS_CPP)
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/trainers/rl_serial_agent_trainer.h"
+#include "cubeai/rl/agents/torch_agents/dqn_agent.h"
+#include "cubeai/maths/optimization/optimizer_type.h"
+#include "cubeai/utils/instrumentation.h"
+#include "rlenvs/envs/gymnasium/classic_control/cart_pole_env.h"
+
+#include <iostream>
+#include <unordered_map>
+
+namespace rl_example_24{
+
+const std::string SERVER_URL = "http://0.0.0.0:8001/api";
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::torch_tensor_t;
+using cubeai::rl::pytorch::DQNAgentConfig;
+using cubeai::rl::pytorch::DQNAgent;
+using cubeai::utils::Instrumentation;
+using cubeai::utils::InstrumentationPhase;
+using cubeai::utils::InstrumentationCounter;
+using cubeai::rl::RLSerialAgentTrainer;
+using cubeai::rl::RLSerialTrainerConfig;
+
+
+// the Q-network
+class QNetImpl: public torch::nn::Module
+{
+public:
+
+    // constructor
+    QNetImpl(uint_t state_size, uint_t action_size);
+
+    torch_tensor_t forward(torch_tensor_t state);
+
+private:
+
+    torch::nn::Linear linear1_;
+    torch::nn::Linear linear2_;
+    torch::nn::Linear linear3_;
+};
+
+QNetImpl::QNetImpl(uint_t state_size, uint_t action_size)
+:
+torch::nn::Module(),
+linear1_(nullptr),
+linear2_(nullptr),
+linear3_(nullptr)
+{
+   linear1_ = register_module("linear1_", torch::nn::Linear(state_size, 128));
+   linear2_ = register_module("linear2_", torch::nn::Linear(128, 128));
+   linear3_ = register_module("linear3_", torch::nn::Linear(128, action_size));
+}
+
+torch_tensor_t
+QNetImpl::forward(torch_tensor_t state){
+
+    auto output = torch::nn::functional::relu(linear1_(state));
+    output = torch::nn::functional::relu(linear2_(output));
+    return linear3_(output);
+}
+
+TORCH_MODULE(QNet);
+
+typedef  rlenvs_cpp::envs::gymnasium::CartPole env_type;
+
+}
+
+
+int main(){
+
+    using namespace rl_example_24;
+
+    try{
+
+        std::unordered_map<std::string, std::any> options;
+
+        std::cout<<"Creating the environment..."<<std::endl;
+        env_type env(SERVER_URL);
+        env.make("v1", options);
+        std::cout<<"Done..."<<std::endl;
+        std::cout<<"Number of actions="<<env.n_actions()<<std::endl;
+
+        DQNAgentConfig dqn_config;
+        dqn_config.n_itrs_per_episode = 500;
+        dqn_config.optim_type = cubeai::maths::optim::OptimzerType::ADAM;
+        dqn_config.optim_options["lr"] = static_cast<real_t>(1.0e-3);
+        dqn_config.buffer_size = 10000;
+        dqn_config.batch_size = 64;
+        dqn_config.warmup_steps = 1000;
+        dqn_config.double_dqn = true;
+        dqn_config.tau = 0.005;
+        dqn_config.eps_decay_steps = 10000;
+
+        QNet online(4, env.n_actions());
+        QNet target(4, env.n_actions());
+
+        typedef DQNAgent<env_type, QNet> agent_type;
+        agent_type agent(dqn_config, online, target);
+
+        RLSerialTrainerConfig config;
+        config.n_episodes = 300;
+        config.output_msg_frequency = 10;
+        RLSerialAgentTrainer<env_type, agent_type> trainer(config, agent);
+
+        Instrumentation::enable();
+        auto result = trainer.train(env);
+        auto totals = Instrumentation::snapshot();
+
+        std::cout<<"Total time="<<result.total_time.count()<<"s"<<std::endl;
+        std::cout<<"    env step.........: "<<totals.phase_time(InstrumentationPhase::ENV_STEP)<<"s"<<std::endl;
+        std::cout<<"    action selection.: "<<totals.phase_time(InstrumentationPhase::ACTION_SELECTION)<<"s"<<std::endl;
+        std::cout<<"    loss.............: "<<totals.phase_time(InstrumentationPhase::LOSS)<<"s"<<std::endl;
+        std::cout<<"    update...........: "<<totals.phase_time(InstrumentationPhase::UPDATE)<<"s"<<std::endl;
+        std::cout<<"    steps/s..........: "<<totals.count(InstrumentationCounter::STEPS) / result.total_time.count()<<std::endl;
+        std::cout<<"    updates..........: "<<agent.n_updates()<<std::endl;
+        std::cout<<"Last loss="<<agent.last_loss()<<" epsilon="<<agent.epsilon()<<std::endl;
+
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
+#else
+#include <iostream>
+
+int main(){
+
+    std::cout<<"This example requires the flags USE_PYTORCH and USE_RLENVS_CPP to be true."<<std::endl;
+    std::cout<<"Reconfigures and rebuild the library by setting the flags USE_PYTORCH and USE_RLENVS_CPP to ON."<<std::endl;
+    return 1;
+}
+#endif
@@ -0,0 +1,187 @@
+#include "cubeai/base/cubeai_config.h"
+
+#ifdef USE_PYTORCH
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/policy_server.h"
+
+#include <torch/torch.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace rl_example_25
+{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::torch_tensor_t;
+using cubeai::rl::PolicyServer;
+using cubeai::rl::PolicyServerConfig;
+using cubeai::rl::export_policy;
+
+const uint_t STATE_SIZE = 8;
+const uint_t N_ACTIONS = 4;
+const uint_t N_WARMUP = 1000;
+const uint_t N_ACTIONS_TO_SERVE = 20000;
+const std::string POLICY_FILE = "rl_example_25_policy.pt";
+
+// the policy to serve
+class PolicyNetImpl: public torch::nn::Module
+{
+public:
+
+    PolicyNetImpl(uint_t state_size, uint_t action_size);
+
+    torch_tensor_t forward(torch_tensor_t state);
+
+private:
+
+    torch::nn::Linear linear1_;
+    torch::nn::Linear linear2_;
+    torch::nn::Linear linear3_;
+};
+
+PolicyNetImpl::PolicyNetImpl(uint_t state_size, uint_t action_size)
+:
+torch::nn::Module(),
+linear1_(nullptr),
+linear2_(nullptr),
+linear3_(nullptr)
+{
+   linear1_ = register_module("linear1_", torch::nn::Linear(state_size, 64));
+   linear2_ = register_module("linear2_", torch::nn::Linear(64, 64));
+   linear3_ = register_module("linear3_", torch::nn::Linear(64, action_size));
+}
+
+torch_tensor_t
+PolicyNetImpl::forward(torch_tensor_t state){
+
+    auto output = torch::relu(linear1_(state));
+    output = torch::relu(linear2_(output));
+    return torch::softmax(linear3_(output), -1);
+}
+
+TORCH_MODULE(PolicyNet);
+
+///
+/// \brief Print the p50 and p99 of the latencies in us
+///
+void
+report(const std::string& name, std::vector<real_t>& latencies){
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto p50 = latencies[latencies.size() / 2];
+    const auto p99 = latencies[(latencies.size() * 99) / 100];
+
+    std::cout<<name<<": p50="<<p50<<"us p99="<<p99<<"us"<<std::endl;
+}
+
+///
+/// \brief Time every action of the given acting function
+///
+template<typename ActFn>
+std::vector<real_t>
+measure(ActFn act, const std::vector<std::vector<float>>& observations){
+
+    uint_t checksum = 0;
+    for(uint_t i=0; i<N_WARMUP; ++i){
+        checksum += act(observations[i % observations.size()]);
+    }
+
+    std::vector<real_t> latencies;
+    latencies.reserve(N_ACTIONS_TO_SERVE);
+
+    for(uint_t i=0; i<N_ACTIONS_TO_SERVE; ++i){
+
+        const auto& obs = observations[i % observations.size()];
+
+        auto start = std::chrono::steady_clock::now();
+        checksum += act(obs);
+        std::chrono::duration<real_t, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        latencies.push_back(elapsed.count());
+    }
+
+    // keep the actions alive
+    if(checksum == cubeai::CubeAIConsts::INVALID_SIZE_TYPE){
+        std::cout<<checksum<<std::endl;
+    }
+
+    return latencies;
+}
+
+}
+
+int main(){
+
+    using namespace rl_example_25;
+
+    try{
+
+        torch::manual_seed(42);
+        torch::set_num_threads(1);
+
+        // "train" a policy and export it
+        PolicyNet trained(STATE_SIZE, N_ACTIONS);
+        export_policy(trained, POLICY_FILE);
+
+        std::mt19937 generator(42);
+        std::normal_distribution<float> dist;
+        std::vector<std::vector<float>> observations(256, std::vector<float>(STATE_SIZE));
+        for(auto& obs : observations){
+            std::generate(obs.begin(), obs.end(), [&](){return dist(generator);});
+        }
+
+        // the acting path of the training code: a new tensor per
+        // observation and a forward that records autograd
+        auto naive_latencies = measure([&trained](const std::vector<float>& obs){
+            auto state = torch::tensor(obs).unsqueeze(0);
+            return static_cast<uint_t>(trained -> forward(state).argmax(1).item<int64_t>());
+        }, observations);
+
+        // reload the policy in a fresh module served by the PolicyServer
+        PolicyServerConfig config;
+        config.observation_size = STATE_SIZE;
+
+        PolicyServer<PolicyNet> server(config, PolicyNet(STATE_SIZE, N_ACTIONS));
+        server.load(POLICY_FILE);
+
+        auto server_latencies = measure([&server](const std::vector<float>& obs){
+            return server.act(obs);
+        }, observations);
+
+        // both paths should agree on the greedy actions
+        uint_t mismatches = 0;
+        for(const auto& obs : observations){
+            torch::NoGradGuard no_grad;
+            auto expected = trained -> forward(torch::tensor(obs).unsqueeze(0)).argmax(1).item<int64_t>();
+            mismatches += static_cast<uint_t>(expected) != server.act(obs) ? 1 : 0;
+        }
+
+        report("Autograd forward, new tensor per action", naive_latencies);
+        report("PolicyServer (InferenceMode, staging) ", server_latencies);
+        std::cout<<"Mismatched actions="<<mismatches<<std::endl;
+    }
+    catch(std::exception& e){
+        std::cout<<e.what()<<std::endl;
+    }
+    catch(...){
+
+        std::cout<<"Unknown exception occured"<<std::endl;
+    }
+    return 0;
+}
+#else
+#include <iostream>
+
+int main(){
+
+    std::cout<<"This example requires the flag USE_PYTORCH to be true."<<std::endl;
+    std::cout<<"Reconfigures and rebuild the library by setting the flag USE_PYTORCH to ON."<<std::endl;
+    return 1;
+}
+#endif
@@ -3,7 +3,7 @@
 
 #include "cubeai/base/cubeai_types.h"
 #include "cubeai/base/cubeai_consts.h"
-//#include "kernel/geometry/generic_line.h"
+#include "cubeai/geom_primitives/generic_line.h"
 
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/adjacency_list.hpp>
@@ -64,7 +64,7 @@ public:
     ///
     /// \brief edge_t The edge type
     ///
-    typedef GenericLine<vertex_t, EdgeData> edge_t;
+    typedef geom_primitives::GenericLine<vertex_t, EdgeData> edge_t;
 
 private:
 
@@ -177,7 +177,7 @@ public:
     ///
     /// \brief Clear the graph
     ///
-    void clear(){g_.clear();}
+    void clear(){g_.clear(); descriptors_.clear();}
 
 private:
 
@@ -185,13 +185,28 @@ private:
     /// \brief The actual graph
     ///
     graph_type g_;
+
+    ///
+    /// \brief The descriptor of every vertex indexed by the vertex id.
+    /// The vertices are stored in a list so boost::vertex(i, g_)
+    /// walks i elements, the table makes the access by id O(1)
+    ///
+    std::vector<vertex_descriptor_t> descriptors_;
 };
 
 template<typename VertexData,typename EdgeData>
 BoostSerialGraph<VertexData,EdgeData>::BoostSerialGraph(uint_t nv)
 :
-g_(nv)
-{}
+g_(nv),
+descriptors_()
+{
+    descriptors_.reserve(nv);
+    auto [start, end] = boost::vertices(g_);
+    for(; start != end; ++start){
+        g_[*start].id = descriptors_.size();
+        descriptors_.push_back(*start);
+    }
+}
 
 template<typename VertexData, typename EdgeData>
 typename BoostSerialGraph<VertexData,EdgeData>::vertex_t&
@@ -203,6 +218,7 @@ BoostSerialGraph<VertexData,EdgeData>::add_vertex(const VertexData& data){
 
     //add a new vertex
     vertex_descriptor_t a = boost::add_vertex(g_);
+    descriptors_.push_back(a);
     vertex_t& v = g_[a];
     v.data = data;
     v.id = idx;
@@ -230,8 +246,8 @@ BoostSerialGraph<VertexData,EdgeData>::add_edge(uint_t v1, uint_t v2){
     bool condition;
 
     // get the vertices that correspond to the indices
-    vertex_descriptor_t a = boost::vertex(v1, g_);
-    vertex_descriptor_t b = boost::vertex(v2, g_);
+    vertex_descriptor_t a = descriptors_[v1];
+    vertex_descriptor_t b = descriptors_[v2];
     uint_t idx = n_edges();
 
     // create an edge
@@ -255,7 +271,7 @@ BoostSerialGraph<VertexData,EdgeData>::get_vertex(uint_t i)const{
     }
 
     typedef typename BoostSerialGraph<VertexData,EdgeData>::vertex_descriptor_t vertex_descriptor_t;
-    vertex_descriptor_t a = boost::vertex(i,g_);
+    vertex_descriptor_t a = descriptors_[i];
     return g_[a];
 }
 
@@ -308,7 +324,7 @@ BoostSerialGraph<VertexData,EdgeData>::get_vertex_neighbors_ids(uint_t id)const{
         ++start;
     }
 
-    neighbors;
+    return neighbors;
 }
 
 
@@ -329,8 +345,8 @@ BoostSerialGraph<VertexData,EdgeData>::get_edge(uint_t v1, uint_t v2)const{
 
         typedef typename BoostSerialGraph<VertexData,EdgeData>::vertex_descriptor_t vertex_descriptor_t;
         typedef typename BoostSerialGraph<VertexData,EdgeData>::edge_descriptor_t edge_descriptor_t;
-        vertex_descriptor_t a = boost::vertex(v1,g_);
-        vertex_descriptor_t b = boost::vertex(v2,g_);
+        vertex_descriptor_t a = descriptors_[v1];
+        vertex_descriptor_t b = descriptors_[v2];
 
         std::pair<edge_descriptor_t,bool> rslt = boost::edge(a,b,g_);
 
@@ -362,7 +378,7 @@ BoostSerialGraph<VertexData,EdgeData>::get_vertex_neighbors(uint_t i)const{
     }
 
     typedef typename BoostSerialGraph<VertexData,EdgeData>::vertex_descriptor_t vertex_descriptor_t;
-    vertex_descriptor_t a = boost::vertex(i,g_);
+    vertex_descriptor_t a = descriptors_[i];
     return boost::adjacent_vertices(a, g_);
 }
 
@@ -0,0 +1,398 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include "cubeai/base/cubeai_types.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cubeai{
+
+///
+/// \brief The CSRGraph class. Immutable directed graph in compressed sparse
+/// row form: the arcs leaving v are targets()[offsets()[v], offsets()[v + 1])
+/// with the matching weights, sorted by target. An undirected edge is stored
+/// as two arcs. Three flat arrays hold the whole graph so iterating the
+/// neighbours of a vertex is a scan over contiguous memory. IndexTp is the
+/// type of the stored vertex ids and offsets, std::uint32_t halves the
+/// memory of the topology for graphs with fewer than 2^32 arcs. Graphs are
+/// made by CSRGraphBuilder or build_csr_graph. The class models
+/// astar_graph_concept
+///
+template<typename WeightTp=real_t, typename IndexTp=uint_t>
+class CSRGraph
+{
+public:
+
+    static_assert(std::is_unsigned_v<IndexTp>, "IndexTp should be an unsigned integer");
+
+    typedef WeightTp weight_type;
+    typedef IndexTp index_type;
+
+    ///
+    /// \brief CSRGraph. The graph with no vertices
+    ///
+    CSRGraph()=default;
+
+    ///
+    /// \brief CSRGraph. Take over the arrays. offsets has n_vertices + 1
+    /// non decreasing entries starting at 0 and ending at the number of arcs,
+    /// the targets of every vertex are sorted
+    ///
+    CSRGraph(std::vector<IndexTp>&& offsets, std::vector<IndexTp>&& targets, std::vector<WeightTp>&& weights);
+
+    ///
+    /// \brief n_vertices. Number of vertices
+    ///
+    uint_t n_vertices()const noexcept{return offsets_.empty() ? 0 : offsets_.size() - 1;}
+
+    ///
+    /// \brief n_arcs. Number of directed arcs
+    ///
+    uint_t n_arcs()const noexcept{return targets_.size();}
+
+    ///
+    /// \brief degree. Number of arcs leaving v
+    ///
+    uint_t degree(uint_t v)const noexcept{return offsets_[v + 1] - offsets_[v];}
+
+    ///
+    /// \brief neighbors. The targets of the arcs leaving v
+    ///
+    std::span<const IndexTp> neighbors(uint_t v)const noexcept;
+
+    ///
+    /// \brief neighbor_weights. The weights of the arcs leaving v
+    ///
+    std::span<const WeightTp> neighbor_weights(uint_t v)const noexcept;
+
+    ///
+    /// \brief for_each_neighbor. Call fn(w, weight) for every arc v -> w
+    ///
+    template<typename Fn>
+    void for_each_neighbor(uint_t v, Fn&& fn)const;
+
+    ///
+    /// \brief find_arc. The position of the first arc v -> w
+    /// in targets() or n_arcs() if there is none. O(log degree)
+    ///
+    uint_t find_arc(uint_t v, uint_t w)const noexcept;
+
+    ///
+    /// \brief has_arc
+    ///
+    bool has_arc(uint_t v, uint_t w)const noexcept{return find_arc(v, w) != n_arcs();}
+
+    ///
+    /// \brief weight. The weight of the first arc v -> w. Infinite if there is none
+    ///
+    WeightTp weight(uint_t v, uint_t w)const noexcept;
+
+    ///
+    /// \brief The arrays of the graph
+    ///
+    const std::vector<IndexTp>& offsets()const noexcept{return offsets_;}
+    const std::vector<IndexTp>& targets()const noexcept{return targets_;}
+    const std::vector<WeightTp>& weights()const noexcept{return weights_;}
+
+    ///
+    /// \brief memory_bytes. The bytes held by the arrays
+    ///
+    uint_t memory_bytes()const noexcept;
+
+private:
+
+    std::vector<IndexTp> offsets_;
+    std::vector<IndexTp> targets_;
+    std::vector<WeightTp> weights_;
+};
+
+///
+/// \brief The CSRGraphBuilder class. Collects arcs in any order and
+/// builds a CSRGraph with counting sorts in O(vertices + arcs)
+///
+template<typename WeightTp=real_t, typename IndexTp=uint_t>
+class CSRGraphBuilder
+{
+public:
+
+    typedef CSRGraph<WeightTp, IndexTp> graph_type;
+
+    ///
+    /// \brief CSRGraphBuilder. A graph with n vertices and no arcs
+    ///
+    explicit CSRGraphBuilder(uint_t n_vertices);
+
+    ///
+    /// \brief reserve. Allocate space for n arcs
+    ///
+    void reserve(uint_t n){arcs_.reserve(n);}
+
+    ///
+    /// \brief add_arc. Add the arc v -> w
+    ///
+    void add_arc(uint_t v, uint_t w, WeightTp weight);
+
+    ///
+    /// \brief add_edge. Add the arcs v -> w and w -> v
+    ///
+    void add_edge(uint_t v, uint_t w, WeightTp weight);
+
+    ///
+    /// \brief n_arcs. The number of arcs added
+    ///
+    uint_t n_arcs()const noexcept{return arcs_.size();}
+
+    ///
+    /// \brief build. Make the graph. The builder is left empty
+    ///
+    graph_type build();
+
+private:
+
+    struct Arc
+    {
+        IndexTp source;
+        IndexTp target;
+        WeightTp weight;
+    };
+
+    uint_t n_vertices_;
+    std::vector<Arc> arcs_;
+};
+
+///
+/// \brief build_csr_graph. The CSRGraph of a BoostSerialGraph, or of any graph
+/// with n_vertices(), get_vertex(id), get_vertex_neighbors(id) and
+/// get_vertex(adjacency_iterator). Every edge becomes two arcs and the vertex
+/// ids are kept. The weight of the arc v -> w is cost(get_vertex(v), get_vertex(w))
+///
+template<typename WeightTp=real_t, typename IndexTp=uint_t, typename GraphTp, typename CostFn>
+CSRGraph<WeightTp, IndexTp>
+build_csr_graph(const GraphTp& graph, const CostFn& cost);
+
+///
+/// \brief build_csr_graph. As above with the weight of an arc
+/// given by the data of its edge
+///
+template<typename WeightTp=real_t, typename IndexTp=uint_t, typename GraphTp>
+CSRGraph<WeightTp, IndexTp>
+build_csr_graph(const GraphTp& graph);
+
+template<typename WeightTp, typename IndexTp>
+CSRGraph<WeightTp, IndexTp>::CSRGraph(std::vector<IndexTp>&& offsets, std::vector<IndexTp>&& targets,
+                                      std::vector<WeightTp>&& weights)
+    :
+      offsets_(std::move(offsets)),
+      targets_(std::move(targets)),
+      weights_(std::move(weights))
+{
+    if(targets_.size() != weights_.size()){
+        throw std::logic_error("The number of targets " + std::to_string(targets_.size()) +
+                               " is not the number of weights " + std::to_string(weights_.size()));
+    }
+
+    if(offsets_.empty()){
+        if(!targets_.empty()){
+            throw std::logic_error("A graph with arcs should have offsets");
+        }
+        return;
+    }
+
+    if(offsets_.front() != 0 || offsets_.back() != targets_.size() ||
+       !std::is_sorted(offsets_.begin(), offsets_.end())){
+        throw std::logic_error("The offsets should increase from 0 to the number of arcs");
+    }
+
+    const auto n = n_vertices();
+    for(uint_t v=0; v<n; ++v){
+
+        const auto begin = targets_.begin() + offsets_[v];
+        const auto end = targets_.begin() + offsets_[v + 1];
+        if(!std::is_sorted(begin, end) || (begin != end && *(end - 1) >= n)){
+            throw std::logic_error("The targets of vertex " + std::to_string(v) + " are not sorted vertex ids");
+        }
+    }
+}
+
+template<typename WeightTp, typename IndexTp>
+std::span<const IndexTp>
+CSRGraph<WeightTp, IndexTp>::neighbors(uint_t v)const noexcept{
+    return std::span<const IndexTp>(targets_.data() + offsets_[v], degree(v));
+}
+
+template<typename WeightTp, typename IndexTp>
+std::span<const WeightTp>
+CSRGraph<WeightTp, IndexTp>::neighbor_weights(uint_t v)const noexcept{
+    return std::span<const WeightTp>(weights_.data() + offsets_[v], degree(v));
+}
+
+template<typename WeightTp, typename IndexTp>
+template<typename Fn>
+void
+CSRGraph<WeightTp, IndexTp>::for_each_neighbor(uint_t v, Fn&& fn)const{
+
+    const auto end = offsets_[v + 1];
+    for(auto a = offsets_[v]; a < end; ++a){
+        fn(static_cast<uint_t>(targets_[a]), weights_[a]);
+    }
+}
+
+template<typename WeightTp, typename IndexTp>
+uint_t
+CSRGraph<WeightTp, IndexTp>::find_arc(uint_t v, uint_t w)const noexcept{
+
+    const auto begin = targets_.begin() + offsets_[v];
+    const auto end = targets_.begin() + offsets_[v + 1];
+    const auto itr = std::lower_bound(begin, end, w, [](IndexTp t, uint_t x){return t < x;});
+
+    if(itr == end || *itr != w){
+        return n_arcs();
+    }
+
+    return static_cast<uint_t>(itr - targets_.begin());
+}
+
+template<typename WeightTp, typename IndexTp>
+WeightTp
+CSRGraph<WeightTp, IndexTp>::weight(uint_t v, uint_t w)const noexcept{
+
+    const auto a = find_arc(v, w);
+    return a == n_arcs() ? std::numeric_limits<WeightTp>::infinity() : weights_[a];
+}
+
+template<typename WeightTp, typename IndexTp>
+uint_t
+CSRGraph<WeightTp, IndexTp>::memory_bytes()const noexcept{
+
+    return offsets_.capacity() * sizeof(IndexTp) + targets_.capacity() * sizeof(IndexTp) +
+            weights_.capacity() * sizeof(WeightTp);
+}
+
+template<typename WeightTp, typename IndexTp>
+CSRGraphBuilder<WeightTp, IndexTp>::CSRGraphBuilder(uint_t n_vertices)
+    :
+      n_vertices_(n_vertices),
+      arcs_()
+{
+    if(n_vertices_ > std::numeric_limits<IndexTp>::max()){
+        throw std::logic_error("The number of vertices " + std::to_string(n_vertices_) +
+                               " does not fit the index type");
+    }
+}
+
+template<typename WeightTp, typename IndexTp>
+void
+CSRGraphBuilder<WeightTp, IndexTp>::add_arc(uint_t v, uint_t w, WeightTp weight){
+
+    if(v >= n_vertices_ || w >= n_vertices_){
+        throw std::logic_error("Arc (" + std::to_string(v) + ", " + std::to_string(w) +
+                               ") not in a graph with " + std::to_string(n_vertices_) + " vertices");
+    }
+
+    arcs_.push_back(Arc{static_cast<IndexTp>(v), static_cast<IndexTp>(w), weight});
+}
+
+template<typename WeightTp, typename IndexTp>
+void
+CSRGraphBuilder<WeightTp, IndexTp>::add_edge(uint_t v, uint_t w, WeightTp weight){
+
+    add_arc(v, w, weight);
+    add_arc(w, v, weight);
+}
+
+template<typename WeightTp, typename IndexTp>
+typename CSRGraphBuilder<WeightTp, IndexTp>::graph_type
+CSRGraphBuilder<WeightTp, IndexTp>::build(){
+
+    if(arcs_.size() > std::numeric_limits<IndexTp>::max()){
+        throw std::logic_error("The number of arcs " + std::to_string(arcs_.size()) +
+                               " does not fit the index type");
+    }
+
+    // two counting sorts, by target and then by source, give
+    // rows sorted by target with equal arcs in insertion order
+    const auto count = [this](auto key){
+
+        std::vector<IndexTp> offsets(n_vertices_ + 1, 0);
+        for(const auto& arc : arcs_){
+            ++offsets[key(arc) + 1];
+        }
+
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        return offsets;
+    };
+
+    auto by_target = count([](const Arc& arc){return arc.target;});
+    std::vector<IndexTp> order(arcs_.size());
+    for(uint_t a=0; a<arcs_.size(); ++a){
+        order[by_target[arcs_[a].target]++] = static_cast<IndexTp>(a);
+    }
+
+    by_target.clear();
+    by_target.shrink_to_fit();
+
+    auto offsets = count([](const Arc& arc){return arc.source;});
+    std::vector<IndexTp> next(offsets.begin(), offsets.end() - 1);
+    std::vector<IndexTp> targets(arcs_.size());
+    std::vector<WeightTp> weights(arcs_.size());
+    for(const auto a : order){
+
+        const auto& arc = arcs_[a];
+        const auto pos = next[arc.source]++;
+        targets[pos] = arc.target;
+        weights[pos] = arc.weight;
+    }
+
+    arcs_.clear();
+    arcs_.shrink_to_fit();
+
+    return graph_type(std::move(offsets), std::move(targets), std::move(weights));
+}
+
+template<typename WeightTp, typename IndexTp, typename GraphTp, typename CostFn>
+CSRGraph<WeightTp, IndexTp>
+build_csr_graph(const GraphTp& graph, const CostFn& cost){
+
+    const auto n = graph.n_vertices();
+
+    // the adjacency of an undirected graph lists
+    // both directions, one arc is added per entry
+    CSRGraphBuilder<WeightTp, IndexTp> builder(n);
+    builder.reserve(2 * graph.n_edges());
+
+    for(uint_t v=0; v<n; ++v){
+
+        const auto& cv = graph.get_vertex(v);
+        auto [begin, end] = graph.get_vertex_neighbors(v);
+        for(; begin != end; ++begin){
+
+            const auto& nv = graph.get_vertex(begin);
+            builder.add_arc(v, nv.id, static_cast<WeightTp>(cost(cv, nv)));
+        }
+    }
+
+    return builder.build();
+}
+
+template<typename WeightTp, typename IndexTp, typename GraphTp>
+CSRGraph<WeightTp, IndexTp>
+build_csr_graph(const GraphTp& graph){
+
+    typedef typename GraphTp::vertex_t vertex_t;
+    return build_csr_graph<WeightTp, IndexTp>(graph, [&graph](const vertex_t& v, const vertex_t& w){
+        return graph.get_edge(v.id, w.id).get_data();
+    });
+}
+
+}
+
+#endif // CSR_GRAPH_H
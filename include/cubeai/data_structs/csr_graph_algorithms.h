@@ -0,0 +1,435 @@
+#ifndef CSR_GRAPH_ALGORITHMS_H
+#define CSR_GRAPH_ALGORITHMS_H
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/data_structs/csr_graph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <execution>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace cubeai{
+
+///
+/// \brief The CSRAlgorithmsConfig struct. Controls how the graph
+/// algorithms split their work. The vertices of a frontier, or of the
+/// graph, are processed in chunks of chunk_size and the chunks run in
+/// parallel with std::execution::par when parallel is true
+///
+struct CSRAlgorithmsConfig
+{
+    bool parallel{true};
+    uint_t chunk_size{1024};
+};
+
+namespace csr_impl{
+
+///
+/// \brief n_chunks. The number of chunks that [0, n) is split in
+///
+inline
+uint_t
+n_chunks(uint_t n, const CSRAlgorithmsConfig& config){
+
+    if(config.chunk_size == 0){
+        throw std::logic_error("chunk_size should be positive");
+    }
+
+    return (n + config.chunk_size - 1) / config.chunk_size;
+}
+
+///
+/// \brief for_each_chunk. Call fn(c, begin, end) for the chunks
+/// [begin, end) of [0, n), c is the index of the chunk
+///
+template<typename Fn>
+void
+for_each_chunk(uint_t n, const CSRAlgorithmsConfig& config, std::vector<uint_t>& chunks, Fn&& fn){
+
+    const auto n_chunks = csr_impl::n_chunks(n, config);
+    chunks.resize(n_chunks);
+    for(uint_t c=0; c<n_chunks; ++c){
+        chunks[c] = c;
+    }
+
+    auto run = [&](uint_t c){
+        fn(c, c * config.chunk_size, std::min(n, (c + 1) * config.chunk_size));
+    };
+
+    if(config.parallel && n_chunks > 1){
+        std::for_each(std::execution::par, chunks.begin(), chunks.end(), run);
+    }
+    else{
+        std::for_each(chunks.begin(), chunks.end(), run);
+    }
+}
+
+///
+/// \brief find_root. The root of v in a union-find forest that other
+/// threads may be linking. Halves the path on the way up
+///
+inline
+uint_t
+find_root(std::vector<uint_t>& parent, uint_t v){
+
+    while(true){
+
+        std::atomic_ref<uint_t> pv(parent[v]);
+        const auto p = pv.load(std::memory_order_relaxed);
+        if(p == v){
+            return v;
+        }
+
+        // the grandparent is an ancestor of v whatever
+        // the other threads did meanwhile
+        const auto gp = std::atomic_ref<uint_t>(parent[p]).load(std::memory_order_relaxed);
+        pv.store(gp, std::memory_order_relaxed);
+        v = gp;
+    }
+}
+
+///
+/// \brief unite. Join the trees of v and w. The root with the larger id
+/// is linked under the other so no cycle can form
+///
+inline
+void
+unite(std::vector<uint_t>& parent, uint_t v, uint_t w){
+
+    while(true){
+
+        v = find_root(parent, v);
+        w = find_root(parent, w);
+        if(v == w){
+            return;
+        }
+
+        if(v < w){
+            std::swap(v, w);
+        }
+
+        // v may have been linked since it was found
+        auto expected = v;
+        if(std::atomic_ref<uint_t>(parent[v]).compare_exchange_weak(expected, w, std::memory_order_relaxed)){
+            return;
+        }
+    }
+}
+
+}
+
+///
+/// \brief bfs_levels. Level synchronous breadth first search from source.
+/// level[v] is the number of arcs on a shortest path from source to v,
+/// CubeAIConsts::INVALID_SIZE_TYPE if v is not reachable. parent[v] is the
+/// predecessor of v on such a path, the source and the unreachable vertices
+/// have no parent. The vertices of a level are expanded in parallel chunks;
+/// a vertex joins the next level through a compare and swap on its level so
+/// it is claimed exactly once. Returns the number of levels
+///
+template<typename WeightTp, typename IndexTp>
+uint_t
+bfs_levels(const CSRGraph<WeightTp, IndexTp>& graph, uint_t source,
+           std::vector<uint_t>& level, std::vector<uint_t>& parent,
+           const CSRAlgorithmsConfig& config=CSRAlgorithmsConfig());
+
+///
+/// \brief delta_stepping. Single source shortest paths for non negative
+/// weights. The tentative distances are kept in buckets of width delta. The
+/// queued distances span at most max weight / delta + 1 buckets so the
+/// buckets are reused cyclically. The vertices of the first non empty bucket
+/// relax their light arcs,
+/// weight <= delta, in parallel chunks until the bucket stays empty and then
+/// relax their heavy arcs once. The relaxations of a chunk are collected and
+/// applied after the chunks finish so the distances are written by one
+/// thread. delta <= 0 uses the mean arc weight. dist[v] is infinite and
+/// parent[v] is CubeAIConsts::INVALID_SIZE_TYPE for unreachable vertices.
+/// Arcs with infinite weight are ignored
+///
+template<typename WeightTp, typename IndexTp>
+void
+delta_stepping(const CSRGraph<WeightTp, IndexTp>& graph, uint_t source, WeightTp delta,
+               std::vector<WeightTp>& dist, std::vector<uint_t>& parent,
+               const CSRAlgorithmsConfig& config=CSRAlgorithmsConfig());
+
+///
+/// \brief connected_components. Components of the graph with the arcs taken
+/// as undirected edges, so weakly connected components of a directed graph.
+/// The arcs are united in parallel chunks in a lock free union-find forest.
+/// component[v] is in [0, number of components) and the components are
+/// numbered in the order of their smallest vertex. Returns the number of
+/// components
+///
+template<typename WeightTp, typename IndexTp>
+uint_t
+connected_components(const CSRGraph<WeightTp, IndexTp>& graph, std::vector<uint_t>& component,
+                     const CSRAlgorithmsConfig& config=CSRAlgorithmsConfig());
+
+template<typename WeightTp, typename IndexTp>
+uint_t
+bfs_levels(const CSRGraph<WeightTp, IndexTp>& graph, uint_t source,
+           std::vector<uint_t>& level, std::vector<uint_t>& parent,
+           const CSRAlgorithmsConfig& config){
+
+    const auto npos = CubeAIConsts::INVALID_SIZE_TYPE;
+    const auto n = graph.n_vertices();
+    if(source >= n){
+        throw std::logic_error("Source " + std::to_string(source) + " not in [0, " + std::to_string(n) + ")");
+    }
+
+    const auto& offsets = graph.offsets();
+    const auto& targets = graph.targets();
+
+    level.assign(n, npos);
+    parent.assign(n, npos);
+    level[source] = 0;
+
+    std::vector<uint_t> frontier(1, source);
+    std::vector<std::vector<uint_t>> next;
+    std::vector<uint_t> chunks;
+
+    uint_t depth = 0;
+    while(!frontier.empty()){
+
+        const auto next_level = depth + 1;
+        next.resize(csr_impl::n_chunks(frontier.size(), config));
+
+        csr_impl::for_each_chunk(frontier.size(), config, chunks, [&](uint_t c, uint_t begin, uint_t end){
+
+            auto& out = next[c];
+            out.clear();
+
+            for(auto i=begin; i<end; ++i){
+
+                const auto v = frontier[i];
+                for(auto a = offsets[v]; a < offsets[v + 1]; ++a){
+
+                    const uint_t w = targets[a];
+                    std::atomic_ref<uint_t> lw(level[w]);
+                    if(lw.load(std::memory_order_relaxed) != npos){
+                        continue;
+                    }
+
+                    auto expected = npos;
+                    if(lw.compare_exchange_strong(expected, next_level, std::memory_order_relaxed)){
+                        parent[w] = v;
+                        out.push_back(w);
+                    }
+                }
+            }
+        });
+
+        frontier.clear();
+        for(const auto& out : next){
+            frontier.insert(frontier.end(), out.begin(), out.end());
+        }
+
+        ++depth;
+    }
+
+    return depth;
+}
+
+template<typename WeightTp, typename IndexTp>
+void
+delta_stepping(const CSRGraph<WeightTp, IndexTp>& graph, uint_t source, WeightTp delta,
+               std::vector<WeightTp>& dist, std::vector<uint_t>& parent,
+               const CSRAlgorithmsConfig& config){
+
+    const auto npos = CubeAIConsts::INVALID_SIZE_TYPE;
+    const auto inf = std::numeric_limits<WeightTp>::infinity();
+    const auto n = graph.n_vertices();
+    if(source >= n){
+        throw std::logic_error("Source " + std::to_string(source) + " not in [0, " + std::to_string(n) + ")");
+    }
+
+    const auto& offsets = graph.offsets();
+    const auto& targets = graph.targets();
+    const auto& weights = graph.weights();
+
+    if(std::any_of(weights.begin(), weights.end(), [](WeightTp w){return w < WeightTp(0) || std::isnan(w);})){
+        throw std::logic_error("delta_stepping needs non negative weights");
+    }
+
+    if(!(delta > WeightTp(0))){
+
+        WeightTp sum = 0;
+        uint_t n_finite = 0;
+        for(const auto w : weights){
+            if(w != inf){
+                sum += w;
+                ++n_finite;
+            }
+        }
+
+        delta = n_finite != 0 && sum > WeightTp(0) ? sum / static_cast<WeightTp>(n_finite) : WeightTp(1);
+    }
+
+    dist.assign(n, inf);
+    parent.assign(n, npos);
+
+    // the distances queued whilst bucket b is processed are below
+    // (b + 1) * delta + max weight, so they fall in the next
+    // ceil(max weight / delta) buckets and the slots can be reused
+    WeightTp max_weight = 0;
+    for(const auto w : weights){
+        if(w != inf){
+            max_weight = std::max(max_weight, w);
+        }
+    }
+
+    const auto n_slots = static_cast<uint_t>(std::ceil(max_weight / delta)) + 1;
+
+    // the bucket each vertex is queued in, a vertex may be
+    // listed in older buckets too and those entries are skipped
+    std::vector<uint_t> queued_in(n, npos);
+    std::vector<std::vector<uint_t>> buckets(n_slots);
+    auto bucket_of = [delta](WeightTp d){return static_cast<uint_t>(d / delta);};
+
+    auto enqueue = [&](uint_t v){
+        const auto b = bucket_of(dist[v]);
+        buckets[b % n_slots].push_back(v);
+        queued_in[v] = b;
+    };
+
+    struct Request
+    {
+        WeightTp d;
+        uint_t v;
+        uint_t from;
+    };
+
+    std::vector<std::vector<Request>> requests;
+    std::vector<uint_t> chunks;
+
+    // relax the light or the heavy arcs of the vertices
+    auto relax = [&](const std::vector<uint_t>& vertices, bool light){
+
+        requests.resize(csr_impl::n_chunks(vertices.size(), config));
+        csr_impl::for_each_chunk(vertices.size(), config, chunks, [&](uint_t c, uint_t begin, uint_t end){
+
+            auto& out = requests[c];
+            out.clear();
+
+            for(auto i=begin; i<end; ++i){
+
+                const auto v = vertices[i];
+                const auto dv = dist[v];
+                for(auto a = offsets[v]; a < offsets[v + 1]; ++a){
+
+                    const auto w = weights[a];
+                    if((w <= delta) != light || w == inf){
+                        continue;
+                    }
+
+                    const uint_t u = targets[a];
+                    const auto d = dv + w;
+                    if(d < dist[u]){
+                        out.push_back(Request{d, u, v});
+                    }
+                }
+            }
+        });
+
+        for(const auto& out : requests){
+            for(const auto& r : out){
+
+                if(r.d < dist[r.v]){
+                    dist[r.v] = r.d;
+                    parent[r.v] = r.from;
+                    if(queued_in[r.v] != bucket_of(r.d)){
+                        enqueue(r.v);
+                    }
+                }
+            }
+        }
+    };
+
+    dist[source] = WeightTp(0);
+    enqueue(source);
+
+    std::vector<uint_t> frontier;
+    std::vector<uint_t> settled;
+    std::vector<std::uint8_t> is_settled(n, 0);
+
+    // stop once a full turn over the slots finds them empty
+    uint_t n_empty = 0;
+    for(uint_t b=0; n_empty < n_slots; ++b){
+
+        auto& bucket = buckets[b % n_slots];
+        if(bucket.empty()){
+            ++n_empty;
+            continue;
+        }
+
+        n_empty = 0;
+        settled.clear();
+        while(!bucket.empty()){
+
+            frontier.clear();
+            for(const auto v : bucket){
+                if(queued_in[v] == b){
+                    queued_in[v] = npos;
+                    frontier.push_back(v);
+                    if(!is_settled[v]){
+                        is_settled[v] = 1;
+                        settled.push_back(v);
+                    }
+                }
+            }
+
+            bucket.clear();
+            relax(frontier, true);
+        }
+
+        // the distances of the bucket are final
+        relax(settled, false);
+    }
+}
+
+template<typename WeightTp, typename IndexTp>
+uint_t
+connected_components(const CSRGraph<WeightTp, IndexTp>& graph, std::vector<uint_t>& component,
+                     const CSRAlgorithmsConfig& config){
+
+    const auto n = graph.n_vertices();
+    const auto& offsets = graph.offsets();
+    const auto& targets = graph.targets();
+
+    std::vector<uint_t> parent(n);
+    for(uint_t v=0; v<n; ++v){
+        parent[v] = v;
+    }
+
+    std::vector<uint_t> chunks;
+    csr_impl::for_each_chunk(n, config, chunks, [&](uint_t, uint_t begin, uint_t end){
+        for(auto v=begin; v<end; ++v){
+            for(auto a = offsets[v]; a < offsets[v + 1]; ++a){
+                csr_impl::unite(parent, v, targets[a]);
+            }
+        }
+    });
+
+    // every tree is rooted at its smallest vertex
+    // so the roots are met in increasing order
+    component.resize(n);
+    uint_t n_components = 0;
+    for(uint_t v=0; v<n; ++v){
+
+        const auto root = csr_impl::find_root(parent, v);
+        component[v] = root == v ? n_components++ : component[root];
+    }
+
+    return n_components;
+}
+
+}
+
+#endif // CSR_GRAPH_ALGORITHMS_H
@@ -0,0 +1,516 @@
+#ifndef DYNAMIC_KD_TREE_H
+#define DYNAMIC_KD_TREE_H
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace cubeai {
+namespace containers {
+
+///
+/// \brief The DynamicKDTree class. A kd-tree over points in R^dim that
+/// grows one point at a time, meant as the spatial index of structures
+/// such as the RRT whose vertices arrive incrementally. A point is
+/// identified by its insertion index so the ids match the ids of the
+/// structure that is indexed. The nodes are stored in a flat array, the
+/// insertion and the queries are iterative and do not allocate per node.
+/// Points that arrive in a spatially coherent order, e.g. the vertices of
+/// a tree that grows outwards, would make a deep tree, so the tree is kept
+/// balanced the way a scapegoat tree is: when a point lands deeper than
+/// log(n)/log(1/alpha) the subtree of its highest ancestor with a child
+/// holding more than alpha of its points is rebuilt around medians. The
+/// depth stays O(log n) and an insertion costs O(log^2 n) amortized.
+/// The queries keep their stack in scratch members reused across calls,
+/// so a tree should not be queried from several threads at once
+///
+template<uint_t dim, typename RealTp=real_t>
+class DynamicKDTree
+{
+public:
+
+    static_assert (dim > 0, "The dimension of a DynamicKDTree should be positive");
+
+    ///
+    /// \brief real_type The type of the coordinates
+    ///
+    typedef RealTp real_type;
+
+    ///
+    /// \brief point_type The type of a point
+    ///
+    typedef std::array<real_type, dim> point_type;
+
+    ///
+    /// \brief npos The id returned when there is no point
+    ///
+    static constexpr uint_t npos = CubeAIConsts::INVALID_SIZE_TYPE;
+
+    ///
+    /// \brief Constructor. Reserve space for the given number of points
+    ///
+    explicit DynamicKDTree(uint_t capacity=0);
+
+    ///
+    /// \brief insert. Add a point to the tree and return its id
+    ///
+    uint_t insert(const point_type& p);
+
+    ///
+    /// \brief point. The point with the given id
+    ///
+    const point_type& point(uint_t id)const{return nodes_[id].point;}
+
+    ///
+    /// \brief nearest. The id of the point closest to q in the
+    /// Euclidean distance or npos if the tree is empty
+    ///
+    uint_t nearest(const point_type& q)const;
+
+    ///
+    /// \brief nearest. The id of the point that minimizes distance(id)
+    /// or npos if the tree is empty. distance(id) is the distance of q
+    /// to the point id in any metric that is bounded below by the
+    /// absolute difference of every coordinate, e.g. L1, L2 or L-infinity.
+    /// The bound is what allows a subtree to be skipped
+    ///
+    template<typename DistanceFn>
+    uint_t nearest(const point_type& q, const DistanceFn& distance)const;
+
+    ///
+    /// \brief radius_search. Fill out with the ids of the points
+    /// within Euclidean distance r of q. The order is unspecified
+    ///
+    void radius_search(const point_type& q, real_type r, std::vector<uint_t>& out)const;
+
+    ///
+    /// \brief rebuild. Rebuild the whole tree around medians.
+    /// The ids of the points do not change
+    ///
+    void rebuild();
+
+    ///
+    /// \brief reserve. Reserve space for the given number of points
+    ///
+    void reserve(uint_t capacity);
+
+    ///
+    /// \brief clear. Remove every point
+    ///
+    void clear()noexcept;
+
+    ///
+    /// \brief size. The number of points
+    ///
+    uint_t size()const noexcept{return nodes_.size();}
+
+    ///
+    /// \brief empty. Returns true if there are no points
+    ///
+    bool empty()const noexcept{return nodes_.empty();}
+
+    ///
+    /// \brief depth. The number of nodes on the longest root to leaf path
+    ///
+    uint_t depth()const;
+
+    ///
+    /// \brief n_rebuilds. The number of subtrees rebuilt since the tree was cleared
+    ///
+    uint_t n_rebuilds()const noexcept{return n_rebuilds_;}
+
+private:
+
+    ///
+    /// \brief alpha_ The fraction of the points of a subtree
+    /// a child may hold before the subtree is out of balance
+    ///
+    static constexpr real_t alpha_ = 0.75;
+
+    ///
+    /// \brief The Node struct. A point, the subtrees with the points
+    /// below and above it along the split axis and the split axis.
+    /// The fields a query reads are kept together
+    ///
+    struct Node
+    {
+        point_type point;
+        std::array<uint_t, 2> children;
+        std::uint8_t axis;
+    };
+
+    ///
+    /// \brief The Pending struct. A subtree still to be visited by a query
+    /// and a lower bound on the distance of its points to the query point
+    ///
+    struct Pending
+    {
+        uint_t node;
+        real_type bound;
+    };
+
+    std::vector<Node> nodes_;
+
+    ///
+    /// \brief sizes_ The number of points in the subtree of every node.
+    /// Only the insertion reads them so they are kept out of the nodes
+    ///
+    std::vector<uint_t> sizes_;
+    uint_t root_;
+    uint_t n_rebuilds_;
+
+    ///
+    /// \brief path_ Scratch space for the path of an insertion
+    ///
+    std::vector<uint_t> path_;
+
+    ///
+    /// \brief pending_ Scratch stack of nearest_, kept to not
+    /// allocate per query. Its size is bounded by the depth
+    ///
+    mutable std::vector<Pending> pending_;
+
+    ///
+    /// \brief visit_ Scratch stack of radius_search
+    ///
+    mutable std::vector<uint_t> visit_;
+
+    ///
+    /// \brief max_depth_ The number of nodes a root to leaf path may have
+    ///
+    uint_t max_depth_()const noexcept{
+        return 2 + static_cast<uint_t>(std::log(static_cast<real_t>(nodes_.size()) + 1.0) / -std::log(alpha_));
+    }
+
+    ///
+    /// \brief nearest_. The nearest neighbour search. gap(d) turns the
+    /// difference d along the split axis into a bound on the distance
+    ///
+    template<typename DistanceFn, typename GapFn>
+    uint_t nearest_(const point_type& q, const DistanceFn& distance, const GapFn& gap)const;
+
+    ///
+    /// \brief rebuild_. Rebuild the subtree rooted at *slot
+    ///
+    void rebuild_(uint_t* slot);
+
+    real_type squared_distance_(const point_type& a, const point_type& b)const noexcept;
+};
+
+template<uint_t dim, typename RealTp>
+DynamicKDTree<dim, RealTp>::DynamicKDTree(uint_t capacity)
+    :
+      nodes_(),
+      sizes_(),
+      root_(npos),
+      n_rebuilds_(0),
+      path_(),
+      pending_(),
+      visit_()
+{
+    reserve(capacity);
+}
+
+template<uint_t dim, typename RealTp>
+void
+DynamicKDTree<dim, RealTp>::reserve(uint_t capacity){
+
+    nodes_.reserve(capacity);
+    sizes_.reserve(capacity);
+}
+
+template<uint_t dim, typename RealTp>
+void
+DynamicKDTree<dim, RealTp>::clear()noexcept{
+
+    nodes_.clear();
+    sizes_.clear();
+    root_ = npos;
+    n_rebuilds_ = 0;
+}
+
+template<uint_t dim, typename RealTp>
+uint_t
+DynamicKDTree<dim, RealTp>::insert(const point_type& p){
+
+    const uint_t id = nodes_.size();
+    nodes_.push_back({p, {npos, npos}, 0});
+    sizes_.push_back(1);
+
+    if(root_ == npos){
+        root_ = id;
+        return id;
+    }
+
+    path_.clear();
+    auto node = root_;
+    while(true){
+
+        path_.push_back(node);
+        sizes_[node] += 1;
+
+        const auto a = nodes_[node].axis;
+        auto& child = nodes_[node].children[p[a] < nodes_[node].point[a] ? 0 : 1];
+        if(child == npos){
+            child = id;
+            nodes_[id].axis = static_cast<std::uint8_t>((a + 1) % dim);
+            break;
+        }
+
+        node = child;
+    }
+
+    if(path_.size() + 1 <= max_depth_()){
+        return id;
+    }
+
+    // the point is too deep, rebuild the subtree of the
+    // highest ancestor on the path that is out of balance
+    for(uint_t i=0; i<path_.size(); ++i){
+
+        const auto child = i + 1 < path_.size() ? path_[i + 1] : id;
+        if(static_cast<real_t>(sizes_[child]) > alpha_ * static_cast<real_t>(sizes_[path_[i]])){
+
+            auto* slot = &root_;
+            if(i != 0){
+                auto& parent = nodes_[path_[i - 1]];
+                slot = &parent.children[parent.children[0] == path_[i] ? 0 : 1];
+            }
+
+            rebuild_(slot);
+            break;
+        }
+    }
+
+    return id;
+}
+
+template<uint_t dim, typename RealTp>
+typename DynamicKDTree<dim, RealTp>::real_type
+DynamicKDTree<dim, RealTp>::squared_distance_(const point_type& a, const point_type& b)const noexcept{
+
+    real_type d = 0;
+    for(uint_t i=0; i<dim; ++i){
+        d += (a[i] - b[i]) * (a[i] - b[i]);
+    }
+    return d;
+}
+
+template<uint_t dim, typename RealTp>
+template<typename DistanceFn, typename GapFn>
+uint_t
+DynamicKDTree<dim, RealTp>::nearest_(const point_type& q, const DistanceFn& distance, const GapFn& gap)const{
+
+    if(root_ == npos){
+        return npos;
+    }
+
+    auto best = std::numeric_limits<real_type>::max();
+    auto best_id = root_;
+
+    auto& stack = pending_;
+    stack.clear();
+    stack.push_back({root_, 0});
+
+    while(!stack.empty()){
+
+        const auto [node, bound] = stack.back();
+        stack.pop_back();
+
+        if(bound >= best){
+            continue;
+        }
+
+        const auto d = static_cast<real_type>(distance(node));
+        if(d < best){
+            best = d;
+            best_id = node;
+        }
+
+        // the side of q is visited first so it goes on top
+        const auto& n = nodes_[node];
+        const auto diff = q[n.axis] - n.point[n.axis];
+        const auto near = n.children[diff < 0 ? 0 : 1];
+        const auto far = n.children[diff < 0 ? 1 : 0];
+
+        if(far != npos){
+            stack.push_back({far, std::max(bound, gap(diff))});
+        }
+
+        if(near != npos){
+            stack.push_back({near, bound});
+        }
+    }
+
+    return best_id;
+}
+
+template<uint_t dim, typename RealTp>
+uint_t
+DynamicKDTree<dim, RealTp>::nearest(const point_type& q)const{
+
+    // squared distances keep the square root out of the loop
+    return nearest_(q, [this, &q](uint_t id){return squared_distance_(nodes_[id].point, q);},
+                       [](real_type diff){return diff * diff;});
+}
+
+template<uint_t dim, typename RealTp>
+template<typename DistanceFn>
+uint_t
+DynamicKDTree<dim, RealTp>::nearest(const point_type& q, const DistanceFn& distance)const{
+
+    return nearest_(q, distance, [](real_type diff){return std::abs(diff);});
+}
+
+template<uint_t dim, typename RealTp>
+void
+DynamicKDTree<dim, RealTp>::radius_search(const point_type& q, real_type r, std::vector<uint_t>& out)const{
+
+    out.clear();
+    if(root_ == npos){
+        return;
+    }
+
+    const auto r2 = r * r;
+
+    auto& stack = visit_;
+    stack.clear();
+    stack.push_back(root_);
+
+    while(!stack.empty()){
+
+        const auto node = stack.back();
+        stack.pop_back();
+
+        const auto& n = nodes_[node];
+        if(squared_distance_(n.point, q) <= r2){
+            out.push_back(node);
+        }
+
+        const auto diff = q[n.axis] - n.point[n.axis];
+        const auto near = n.children[diff < 0 ? 0 : 1];
+        const auto far = n.children[diff < 0 ? 1 : 0];
+
+        if(near != npos){
+            stack.push_back(near);
+        }
+
+        if(far != npos && diff * diff <= r2){
+            stack.push_back(far);
+        }
+    }
+}
+
+template<uint_t dim, typename RealTp>
+void
+DynamicKDTree<dim, RealTp>::rebuild(){
+
+    if(root_ != npos){
+        rebuild_(&root_);
+    }
+}
+
+template<uint_t dim, typename RealTp>
+void
+DynamicKDTree<dim, RealTp>::rebuild_(uint_t* slot){
+
+    // collect the points of the subtree
+    std::vector<uint_t> ids;
+    ids.reserve(sizes_[*slot]);
+    ids.push_back(*slot);
+    for(uint_t i=0; i<ids.size(); ++i){
+        for(auto child : nodes_[ids[i]].children){
+            if(child != npos){
+                ids.push_back(child);
+            }
+        }
+    }
+
+    // the ranges [begin, end) of ids still to be split, the node
+    // slot the median of a range is written to and the split axis
+    struct Range
+    {
+        uint_t begin;
+        uint_t end;
+        uint_t* slot;
+        std::uint8_t axis;
+    };
+
+    std::vector<Range> stack;
+    stack.push_back({0, static_cast<uint_t>(ids.size()), slot, nodes_[*slot].axis});
+
+    while(!stack.empty()){
+
+        const auto range = stack.back();
+        stack.pop_back();
+
+        if(range.begin == range.end){
+            *range.slot = npos;
+            continue;
+        }
+
+        // the points equal to the median on the
+        // axis go right as they do on insertion
+        const auto a = range.axis;
+        auto first = ids.begin() + range.begin;
+        auto last = ids.begin() + range.end;
+        auto mid = first + (range.end - range.begin) / 2;
+        std::nth_element(first, mid, last, [this, a](uint_t i, uint_t j){return nodes_[i].point[a] < nodes_[j].point[a];});
+
+        const auto key = nodes_[*mid].point[a];
+        mid = std::partition(first, mid, [this, a, key](uint_t i){return nodes_[i].point[a] < key;});
+
+        const auto node = *mid;
+        const auto split = static_cast<uint_t>(mid - ids.begin());
+        *range.slot = node;
+        nodes_[node].axis = a;
+        sizes_[node] = range.end - range.begin;
+
+        const auto next = static_cast<std::uint8_t>((a + 1) % dim);
+        stack.push_back({range.begin, split, &nodes_[node].children[0], next});
+        stack.push_back({split + 1, range.end, &nodes_[node].children[1], next});
+    }
+
+    n_rebuilds_ += 1;
+}
+
+template<uint_t dim, typename RealTp>
+uint_t
+DynamicKDTree<dim, RealTp>::depth()const{
+
+    if(root_ == npos){
+        return 0;
+    }
+
+    uint_t result = 0;
+    std::vector<std::pair<uint_t, uint_t>> stack;
+    stack.push_back({root_, 1});
+
+    while(!stack.empty()){
+
+        const auto [node, level] = stack.back();
+        stack.pop_back();
+        result = std::max(result, level);
+
+        for(auto child : nodes_[node].children){
+            if(child != npos){
+                stack.push_back({child, level + 1});
+            }
+        }
+    }
+
+    return result;
+}
+
+}
+
+}
+
+#endif // DYNAMIC_KD_TREE_H
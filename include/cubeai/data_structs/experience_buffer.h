@@ -9,6 +9,8 @@
 
 
 #include <random>
+#include <stdexcept>
+#include <vector>
 
 namespace cubeai{
 namespace containers {
@@ -95,10 +97,27 @@ public:
     ///
     /// \brief sample. Sample batch_size experiences from the
     /// buffer and transfer them in the BatchTp container.
+    /// The BatchTp should expose push_back. Uses a generator
+    /// seeded with the given seed
     ///
     template<typename BatchTp>
     void sample(uint_t batch_size, BatchTp& batch, uint_t seed=42)const;
 
+    ///
+    /// \brief sample. Sample batch_size experiences uniformly with
+    /// replacement using the given generator and push them in the batch
+    ///
+    template<typename BatchTp, typename GeneratorTp>
+    void sample(uint_t batch_size, BatchTp& batch, GeneratorTp& generator)const;
+
+    ///
+    /// \brief sample_indices. Fill indices with batch_size positions drawn
+    /// uniformly with replacement. Does not allocate once indices has the
+    /// capacity. Lets the caller gather the experiences into its own storage
+    ///
+    template<typename GeneratorTp>
+    void sample_indices(uint_t batch_size, std::vector<uint_t>& indices, GeneratorTp& generator)const;
+
     iterator begin(){return buffer_.begin();}
     iterator end(){return buffer_.end();}
 
@@ -137,7 +156,42 @@ template<typename ExperienceTp>
 template<typename BatchTp>
 void
 ExperienceBuffer<ExperienceTp>::sample(uint_t batch_size, BatchTp& batch, uint_t seed)const{
-    throw std::logic_error("This function is not implemented!!!");
+
+    std::mt19937 generator(seed);
+    sample(batch_size, batch, generator);
+}
+
+template<typename ExperienceTp>
+template<typename BatchTp, typename GeneratorTp>
+void
+ExperienceBuffer<ExperienceTp>::sample(uint_t batch_size, BatchTp& batch, GeneratorTp& generator)const{
+
+    if(buffer_.empty()){
+        throw std::logic_error("Cannot sample from an empty ExperienceBuffer");
+    }
+
+    std::uniform_int_distribution<uint_t> dist(0, buffer_.size() - 1);
+    for(uint_t i=0; i<batch_size; ++i){
+        batch.push_back(buffer_[dist(generator)]);
+    }
+}
+
+template<typename ExperienceTp>
+template<typename GeneratorTp>
+void
+ExperienceBuffer<ExperienceTp>::sample_indices(uint_t batch_size, std::vector<uint_t>& indices,
+                                              GeneratorTp& generator)const{
+
+    if(buffer_.empty()){
+        throw std::logic_error("Cannot sample from an empty ExperienceBuffer");
+    }
+
+    indices.resize(batch_size);
+
+    std::uniform_int_distribution<uint_t> dist(0, buffer_.size() - 1);
+    for(auto& idx : indices){
+        idx = dist(generator);
+    }
 }
 
 }
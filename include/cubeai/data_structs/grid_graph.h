@@ -0,0 +1,407 @@
+#ifndef GRID_GRAPH_H
+#define GRID_GRAPH_H
+
+#include "cubeai/base/cubeai_types.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace cubeai{
+
+///
+/// \brief The GridConnectivity enum. FACE connects a cell to the cells
+/// sharing a face (4 in 2D, 6 in 3D). FULL also adds the diagonal cells
+/// (8 in 2D, 26 in 3D)
+///
+enum class GridConnectivity{FACE, FULL};
+
+///
+/// \brief The GridGraph class. Implicit graph over a 2D or 3D occupancy grid.
+/// Only the occupancy is stored, one bit per cell; the vertices are the cell
+/// ids id = x + nx * (y + ny * z) and the neighbours are computed when they
+/// are asked for. A diagonal move is allowed only if every cell it passes by,
+/// i.e. every cell reached by a subset of its unit steps, is free, so paths
+/// never cut corners. The cost of a move is its Euclidean length in cells.
+/// The class models astar_graph_concept
+///
+template<uint_t dim>
+class GridGraph
+{
+public:
+
+    static_assert(dim == 2 || dim == 3, "GridGraph supports 2D and 3D grids");
+
+    typedef std::array<uint_t, dim> index_type;
+
+    ///
+    /// \brief Constructor. All the cells are free
+    ///
+    explicit GridGraph(const index_type& sizes, GridConnectivity connectivity=GridConnectivity::FULL);
+
+    ///
+    /// \brief n_vertices. Number of cells
+    ///
+    uint_t n_vertices()const noexcept{return n_cells_;}
+
+    ///
+    /// \brief sizes. Number of cells along every axis
+    ///
+    const index_type& sizes()const noexcept{return sizes_;}
+
+    ///
+    /// \brief connectivity
+    ///
+    GridConnectivity connectivity()const noexcept{return connectivity_;}
+
+    ///
+    /// \brief id. The vertex id of the cell
+    ///
+    uint_t id(const index_type& cell)const noexcept;
+
+    ///
+    /// \brief cell. The cell of the vertex id
+    ///
+    index_type cell(uint_t v)const noexcept;
+
+    ///
+    /// \brief is_blocked
+    ///
+    bool is_blocked(uint_t v)const noexcept{return (bits_[v >> 6] >> (v & 63)) & 1;}
+
+    ///
+    /// \brief is_free
+    ///
+    bool is_free(uint_t v)const noexcept{return !is_blocked(v);}
+
+    ///
+    /// \brief is_free. Also false for cells outside the grid
+    ///
+    bool is_free(const std::array<long, dim>& cell)const noexcept;
+
+    ///
+    /// \brief set_blocked
+    ///
+    void set_blocked(uint_t v, bool blocked=true)noexcept;
+
+    ///
+    /// \brief clear. Free all the cells
+    ///
+    void clear()noexcept{std::fill(bits_.begin(), bits_.end(), 0);}
+
+    ///
+    /// \brief n_blocked. Number of blocked cells
+    ///
+    uint_t n_blocked()const noexcept;
+
+    ///
+    /// \brief memory_bytes. Bytes used by the occupancy
+    ///
+    uint_t memory_bytes()const noexcept{return bits_.size() * sizeof(std::uint64_t);}
+
+    ///
+    /// \brief for_each_neighbor. Call fn(w, cost) for every free
+    /// neighbour w the move from v to w is allowed to. A blocked
+    /// cell has no neighbours, so every edge exists both ways
+    ///
+    template<typename Fn>
+    void for_each_neighbor(uint_t v, Fn&& fn)const;
+
+    ///
+    /// \brief for_each_adjacent. Call fn(w) for every cell a move from v
+    /// ends at, free or not. These are the cells whose edges change when
+    /// v is blocked or freed
+    ///
+    template<typename Fn>
+    void for_each_adjacent(uint_t v, Fn&& fn)const;
+
+    ///
+    /// \brief heuristic. The cost from v to w on the grid without obstacles.
+    /// Manhattan distance for FACE connectivity and its octile generalization
+    /// for FULL. Admissible and consistent
+    ///
+    real_t heuristic(uint_t v, uint_t w)const noexcept;
+
+private:
+
+    ///
+    /// \brief The Move struct. A precomputed neighbour offset
+    ///
+    struct Move
+    {
+        std::array<int, dim> offset;
+        std::int64_t delta;
+        real_t cost;
+
+        ///
+        /// \brief The id deltas of the cells the move passes by
+        ///
+        std::array<std::int64_t, 6> passes;
+        uint_t n_passes;
+    };
+
+    index_type sizes_;
+    index_type strides_;
+    uint_t n_cells_;
+    GridConnectivity connectivity_;
+    std::vector<std::uint64_t> bits_;
+    std::vector<Move> moves_;
+
+    void build_moves_();
+
+    ///
+    /// \brief inside_. Whether the move from the cell stays in the grid
+    ///
+    bool inside_(const index_type& c, const Move& move)const noexcept;
+};
+
+template<uint_t dim>
+GridGraph<dim>::GridGraph(const index_type& sizes, GridConnectivity connectivity)
+    :
+      sizes_(sizes),
+      strides_(),
+      n_cells_(1),
+      connectivity_(connectivity),
+      bits_(),
+      moves_()
+{
+    for(uint_t i=0; i<dim; ++i){
+
+        if(sizes_[i] == 0){
+            throw std::logic_error("GridGraph sizes should be positive");
+        }
+
+        strides_[i] = n_cells_;
+        n_cells_ *= sizes_[i];
+    }
+
+    bits_.assign((n_cells_ + 63) / 64, 0);
+    build_moves_();
+}
+
+template<uint_t dim>
+void
+GridGraph<dim>::build_moves_(){
+
+    const auto n_offsets = dim == 2 ? 9 : 27;
+    for(int o=0; o<n_offsets; ++o){
+
+        Move move;
+        int code = o;
+        uint_t n_nonzero = 0;
+        for(uint_t i=0; i<dim; ++i){
+            move.offset[i] = code % 3 - 1;
+            code /= 3;
+            n_nonzero += move.offset[i] != 0 ? 1 : 0;
+        }
+
+        if(n_nonzero == 0 || (connectivity_ == GridConnectivity::FACE && n_nonzero != 1)){
+            continue;
+        }
+
+        move.delta = 0;
+        for(uint_t i=0; i<dim; ++i){
+            move.delta += move.offset[i] * static_cast<std::int64_t>(strides_[i]);
+        }
+
+        move.cost = std::sqrt(static_cast<real_t>(n_nonzero));
+
+        // every proper non-empty subset of the unit steps
+        // of the move gives a cell the move passes by
+        move.n_passes = 0;
+        const uint_t full_mask = (1u << dim) - 1;
+        uint_t step_mask = 0;
+        for(uint_t i=0; i<dim; ++i){
+            step_mask |= move.offset[i] != 0 ? (1u << i) : 0;
+        }
+
+        for(uint_t subset=1; subset<full_mask + 1; ++subset){
+
+            if((subset & step_mask) != subset || subset == step_mask){
+                continue;
+            }
+
+            std::int64_t delta = 0;
+            for(uint_t i=0; i<dim; ++i){
+                if(subset & (1u << i)){
+                    delta += move.offset[i] * static_cast<std::int64_t>(strides_[i]);
+                }
+            }
+
+            move.passes[move.n_passes++] = delta;
+        }
+
+        moves_.push_back(move);
+    }
+
+    // face moves first, they are the cheapest
+    std::stable_sort(moves_.begin(), moves_.end(),
+                     [](const Move& m1, const Move& m2){return m1.cost < m2.cost;});
+}
+
+template<uint_t dim>
+uint_t
+GridGraph<dim>::id(const index_type& cell)const noexcept{
+
+    uint_t v = 0;
+    for(uint_t i=0; i<dim; ++i){
+        v += cell[i] * strides_[i];
+    }
+
+    return v;
+}
+
+template<uint_t dim>
+typename GridGraph<dim>::index_type
+GridGraph<dim>::cell(uint_t v)const noexcept{
+
+    index_type c;
+    for(uint_t i=0; i<dim; ++i){
+        c[i] = v % sizes_[i];
+        v /= sizes_[i];
+    }
+
+    return c;
+}
+
+template<uint_t dim>
+bool
+GridGraph<dim>::is_free(const std::array<long, dim>& cell)const noexcept{
+
+    uint_t v = 0;
+    for(uint_t i=0; i<dim; ++i){
+
+        if(cell[i] < 0 || cell[i] >= static_cast<long>(sizes_[i])){
+            return false;
+        }
+
+        v += static_cast<uint_t>(cell[i]) * strides_[i];
+    }
+
+    return is_free(v);
+}
+
+template<uint_t dim>
+void
+GridGraph<dim>::set_blocked(uint_t v, bool blocked)noexcept{
+
+    const auto mask = std::uint64_t(1) << (v & 63);
+    if(blocked){
+        bits_[v >> 6] |= mask;
+    }
+    else{
+        bits_[v >> 6] &= ~mask;
+    }
+}
+
+template<uint_t dim>
+uint_t
+GridGraph<dim>::n_blocked()const noexcept{
+
+    uint_t n = 0;
+    for(auto word : bits_){
+        n += std::popcount(word);
+    }
+
+    return n;
+}
+
+template<uint_t dim>
+bool
+GridGraph<dim>::inside_(const index_type& c, const Move& move)const noexcept{
+
+    for(uint_t i=0; i<dim; ++i){
+
+        if((move.offset[i] < 0 && c[i] == 0) ||
+           (move.offset[i] > 0 && c[i] + 1 == sizes_[i])){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<uint_t dim>
+template<typename Fn>
+void
+GridGraph<dim>::for_each_neighbor(uint_t v, Fn&& fn)const{
+
+    if(is_blocked(v)){
+        return;
+    }
+
+    const auto c = cell(v);
+
+    for(const auto& move : moves_){
+
+        if(!inside_(c, move)){
+            continue;
+        }
+
+        const auto w = static_cast<uint_t>(static_cast<std::int64_t>(v) + move.delta);
+        if(is_blocked(w)){
+            continue;
+        }
+
+        auto passes = true;
+        for(uint_t p=0; p<move.n_passes; ++p){
+
+            if(is_blocked(static_cast<uint_t>(static_cast<std::int64_t>(v) + move.passes[p]))){
+                passes = false;
+                break;
+            }
+        }
+
+        if(passes){
+            fn(w, move.cost);
+        }
+    }
+}
+
+template<uint_t dim>
+template<typename Fn>
+void
+GridGraph<dim>::for_each_adjacent(uint_t v, Fn&& fn)const{
+
+    const auto c = cell(v);
+    for(const auto& move : moves_){
+
+        if(inside_(c, move)){
+            fn(static_cast<uint_t>(static_cast<std::int64_t>(v) + move.delta));
+        }
+    }
+}
+
+template<uint_t dim>
+real_t
+GridGraph<dim>::heuristic(uint_t v, uint_t w)const noexcept{
+
+    const auto cv = cell(v);
+    const auto cw = cell(w);
+
+    std::array<real_t, 3> d = {0.0, 0.0, 0.0};
+    for(uint_t i=0; i<dim; ++i){
+        d[i] = cv[i] > cw[i] ? static_cast<real_t>(cv[i] - cw[i]) : static_cast<real_t>(cw[i] - cv[i]);
+    }
+
+    if(connectivity_ == GridConnectivity::FACE){
+        return d[0] + d[1] + d[2];
+    }
+
+    // largest first. Move diagonally along all the
+    // axes, then along two and the rest straight
+    std::sort(d.begin(), d.end(), std::greater<real_t>());
+    const auto sqrt2 = std::sqrt(2.0);
+    const auto sqrt3 = std::sqrt(3.0);
+    return d[0] + (sqrt2 - 1.0) * d[1] + (sqrt3 - sqrt2) * d[2];
+}
+
+}
+
+#endif // GRID_GRAPH_H
@@ -0,0 +1,415 @@
+#ifndef BINARY_CHECKPOINT_H
+#define BINARY_CHECKPOINT_H
+
+/**
+  * Binary checkpoints of the training state. A Checkpoint is an in memory
+  * snapshot made of named arrays: Q-tables, value functions, serialized
+  * modules and optimizers, counters and random engine states. Taking the
+  * snapshot is a copy into a buffer whose capacity is reused. The snapshot
+  * is written by an AsyncCheckpointWriter on a background thread so that the
+  * training loop never waits for the file system. A MappedCheckpoint maps the
+  * file into memory and exposes the arrays as views without reading the whole
+  * file first.
+  *
+  * File layout, native byte order:
+  *
+  *   header (64 bytes): magic, version, n_entries, table offset, file size
+  *   data: the arrays, each one starting at a 64 byte aligned offset
+  *   table: one CheckpointEntry per array
+  *
+  */
+
+#include "cubeai/base/cubeai_types.h"
+
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cubeai{
+namespace io{
+
+///
+/// \brief The CheckpointDataType enum. The type of the elements of an entry
+///
+enum class CheckpointDataType: std::uint32_t {BYTES=0, FLOAT32, FLOAT64, INT32, INT64, UINT32, UINT64};
+
+///
+/// \brief checkpoint_data_type. The CheckpointDataType of T
+///
+template<typename T>
+constexpr CheckpointDataType
+checkpoint_data_type(){
+
+    if constexpr(std::is_same_v<T, float>){ return CheckpointDataType::FLOAT32;}
+    else if constexpr(std::is_same_v<T, double>){ return CheckpointDataType::FLOAT64;}
+    else if constexpr(std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == 4){ return CheckpointDataType::INT32;}
+    else if constexpr(std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == 8){ return CheckpointDataType::INT64;}
+    else if constexpr(std::is_integral_v<T> && std::is_unsigned_v<T> && sizeof(T) == 4){ return CheckpointDataType::UINT32;}
+    else if constexpr(std::is_integral_v<T> && std::is_unsigned_v<T> && sizeof(T) == 8){ return CheckpointDataType::UINT64;}
+    else if constexpr(sizeof(T) == 1){ return CheckpointDataType::BYTES;}
+    else{
+        static_assert(sizeof(T) == 0, "Type not supported by the checkpoints");
+    }
+}
+
+///
+/// \brief The CheckpointEntry struct. Describes one array of a checkpoint.
+/// Matrices are stored column major like DynMat
+///
+struct CheckpointEntry
+{
+    static constexpr uint_t MAX_NAME_SIZE = 63;
+
+    char name[MAX_NAME_SIZE + 1];
+    CheckpointDataType dtype;
+    std::uint32_t reserved;
+    std::uint64_t rows;
+    std::uint64_t cols;
+    std::uint64_t offset;
+    std::uint64_t nbytes;
+};
+
+///
+/// \brief The Checkpoint class. In memory snapshot of the training state.
+/// clear() keeps the capacity so taking a snapshot of the same state again
+/// does not allocate
+///
+class Checkpoint
+{
+public:
+
+    ///
+    /// \brief ALIGNMENT. The offset of every array is a multiple of it
+    ///
+    static constexpr uint_t ALIGNMENT = 64;
+
+    ///
+    /// \brief add. Add a copy of the matrix
+    ///
+    void add(const std::string& name, const DynMat<real_t>& mat);
+
+    ///
+    /// \brief add. Add a copy of the row vector
+    ///
+    void add(const std::string& name, const DynVec<real_t>& vec);
+
+    ///
+    /// \brief add. Add a copy of the vector
+    ///
+    template<typename T>
+    void add(const std::string& name, const std::vector<T>& vec);
+
+    ///
+    /// \brief add_scalar. Add a single value, e.g. a step counter
+    ///
+    template<typename T>
+    void add_scalar(const std::string& name, T value);
+
+    ///
+    /// \brief add_bytes. Add an opaque blob, e.g. a serialized module
+    ///
+    void add_bytes(const std::string& name, std::string_view bytes);
+
+    ///
+    /// \brief add_rng. Add the state of a standard random engine
+    ///
+    template<typename EngineType>
+    void add_rng(const std::string& name, const EngineType& engine);
+
+    ///
+    /// \brief contains
+    ///
+    bool contains(const std::string& name)const noexcept;
+
+    ///
+    /// \brief clear. Remove all the entries and keep the memory
+    ///
+    void clear()noexcept;
+
+    ///
+    /// \brief n_entries
+    ///
+    uint_t n_entries()const noexcept{return entries_.size();}
+
+    ///
+    /// \brief data_size. Number of bytes of the data region
+    ///
+    uint_t data_size()const noexcept{return data_.size();}
+
+    ///
+    /// \brief entries
+    ///
+    const std::vector<CheckpointEntry>& entries()const noexcept{return entries_;}
+
+    ///
+    /// \brief data. The data region. The offsets of the entries are relative to it
+    ///
+    const char* data()const noexcept{return data_.data();}
+
+    ///
+    /// \brief swap
+    ///
+    void swap(Checkpoint& other)noexcept;
+
+private:
+
+    std::vector<CheckpointEntry> entries_;
+    std::vector<char> data_;
+
+    ///
+    /// \brief append_. Add an entry and return where its bytes go
+    ///
+    char* append_(const std::string& name, CheckpointDataType dtype,
+                  uint_t rows, uint_t cols, uint_t nbytes);
+};
+
+///
+/// \brief write_checkpoint. Write the checkpoint to the file. The bytes go to
+/// filename.tmp which is renamed to filename when complete, so the file is
+/// either the previous checkpoint or the new one but never a partial write
+///
+void write_checkpoint(const Checkpoint& checkpoint, const std::string& filename);
+
+///
+/// \brief The AsyncCheckpointWriter class. Writes checkpoints on a background
+/// thread. submit() swaps the snapshot with the pending one; the caller gets
+/// back a buffer to fill next time and nothing is copied. At most one snapshot
+/// is pending: if the writer is still busy when a new one arrives, the pending
+/// snapshot is replaced by the newer one and counted as skipped
+///
+class AsyncCheckpointWriter: private boost::noncopyable
+{
+public:
+
+    AsyncCheckpointWriter();
+
+    ///
+    /// \brief Destructor. Writes the pending snapshot and stops the thread
+    ///
+    ~AsyncCheckpointWriter();
+
+    ///
+    /// \brief submit. Queue the snapshot for writing to the file. On
+    /// return snapshot holds an older buffer with undefined content.
+    /// Starts the writer thread the first time
+    ///
+    void submit(Checkpoint& snapshot, const std::string& filename);
+
+    ///
+    /// \brief wait. Block until the pending snapshot is written
+    ///
+    void wait();
+
+    ///
+    /// \brief stop. Write the pending snapshot and stop the thread
+    ///
+    void stop();
+
+    ///
+    /// \brief n_written. Number of checkpoints written
+    ///
+    uint_t n_written()const noexcept{return n_written_.load(std::memory_order_relaxed);}
+
+    ///
+    /// \brief n_skipped. Number of snapshots replaced before they were written
+    ///
+    uint_t n_skipped()const noexcept{return n_skipped_.load(std::memory_order_relaxed);}
+
+    ///
+    /// \brief last_error. The message of the last failed write. Empty if none failed
+    ///
+    std::string last_error()const;
+
+private:
+
+    Checkpoint pending_;
+    std::string pending_filename_;
+    bool has_pending_;
+    bool writing_;
+    bool stop_writer_;
+
+    std::string last_error_;
+    std::atomic<uint_t> n_written_;
+    std::atomic<uint_t> n_skipped_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::thread writer_thread_;
+
+    ///
+    /// \brief writer_loop_. The body of the writer thread
+    ///
+    void writer_loop_();
+};
+
+///
+/// \brief The MappedCheckpoint class. Read only memory mapping of a checkpoint
+/// file. The views it returns are valid while the object is alive
+///
+class MappedCheckpoint: private boost::noncopyable
+{
+public:
+
+    ///
+    /// \brief Constructor. Map the file and validate the header and the table
+    ///
+    explicit MappedCheckpoint(const std::string& filename);
+
+    ///
+    /// \brief Destructor. Unmap the file
+    ///
+    ~MappedCheckpoint();
+
+    ///
+    /// \brief contains
+    ///
+    bool contains(const std::string& name)const noexcept;
+
+    ///
+    /// \brief n_entries
+    ///
+    uint_t n_entries()const noexcept{return n_entries_;}
+
+    ///
+    /// \brief entry. Throws std::logic_error if there is no such entry
+    ///
+    const CheckpointEntry& entry(const std::string& name)const;
+
+    ///
+    /// \brief data. Pointer to the elements of the entry. Throws
+    /// std::logic_error if the element type is not T
+    ///
+    template<typename T>
+    const T* data(const std::string& name)const;
+
+    ///
+    /// \brief matrix. View of the entry as a matrix
+    ///
+    Eigen::Map<const DynMat<real_t>> matrix(const std::string& name)const;
+
+    ///
+    /// \brief row_vector. View of the entry as a row vector
+    ///
+    Eigen::Map<const DynVec<real_t>> row_vector(const std::string& name)const;
+
+    ///
+    /// \brief read. Copy the entry into the vector
+    ///
+    template<typename T>
+    void read(const std::string& name, std::vector<T>& out)const;
+
+    ///
+    /// \brief scalar. The value of a single element entry
+    ///
+    template<typename T>
+    T scalar(const std::string& name)const;
+
+    ///
+    /// \brief bytes. View of the entry as bytes
+    ///
+    std::string_view bytes(const std::string& name)const;
+
+    ///
+    /// \brief load_rng. Restore the state of the random engine
+    ///
+    template<typename EngineType>
+    void load_rng(const std::string& name, EngineType& engine)const;
+
+private:
+
+    const char* base_;
+    uint_t size_;
+    uint_t n_entries_;
+    const CheckpointEntry* table_;
+
+    const CheckpointEntry& typed_entry_(const std::string& name, CheckpointDataType dtype)const;
+};
+
+template<typename T>
+void
+Checkpoint::add(const std::string& name, const std::vector<T>& vec){
+
+    const auto nbytes = vec.size() * sizeof(T);
+    auto* dest = append_(name, checkpoint_data_type<T>(), vec.size(), 1, nbytes);
+    if(nbytes != 0){
+        std::memcpy(dest, vec.data(), nbytes);
+    }
+}
+
+template<typename T>
+void
+Checkpoint::add_scalar(const std::string& name, T value){
+
+    auto* dest = append_(name, checkpoint_data_type<T>(), 1, 1, sizeof(T));
+    std::memcpy(dest, &value, sizeof(T));
+}
+
+template<typename EngineType>
+void
+Checkpoint::add_rng(const std::string& name, const EngineType& engine){
+
+    // the standard engines only expose their
+    // state through the stream operators
+    std::ostringstream stream;
+    stream << engine;
+    add_bytes(name, stream.str());
+}
+
+template<typename T>
+const T*
+MappedCheckpoint::data(const std::string& name)const{
+
+    const auto& e = typed_entry_(name, checkpoint_data_type<T>());
+    return reinterpret_cast<const T*>(base_ + e.offset);
+}
+
+template<typename T>
+void
+MappedCheckpoint::read(const std::string& name, std::vector<T>& out)const{
+
+    const auto& e = typed_entry_(name, checkpoint_data_type<T>());
+    const auto* begin = reinterpret_cast<const T*>(base_ + e.offset);
+    out.assign(begin, begin + e.nbytes / sizeof(T));
+}
+
+template<typename T>
+T
+MappedCheckpoint::scalar(const std::string& name)const{
+
+    const auto& e = typed_entry_(name, checkpoint_data_type<T>());
+    if(e.nbytes != sizeof(T)){
+        throw std::logic_error("Checkpoint entry " + name + " is not a scalar");
+    }
+
+    T value;
+    std::memcpy(&value, base_ + e.offset, sizeof(T));
+    return value;
+}
+
+template<typename EngineType>
+void
+MappedCheckpoint::load_rng(const std::string& name, EngineType& engine)const{
+
+    std::istringstream stream{std::string(bytes(name))};
+    stream >> engine;
+
+    if(stream.fail()){
+        throw std::runtime_error("Invalid random engine state in checkpoint entry " + name);
+    }
+}
+
+}
+}
+
+#endif // BINARY_CHECKPOINT_H
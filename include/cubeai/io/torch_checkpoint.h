@@ -0,0 +1,125 @@
+#ifndef TORCH_CHECKPOINT_H
+#define TORCH_CHECKPOINT_H
+
+#include "cubeai/base/cubeai_config.h"
+
+#ifdef USE_PYTORCH
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/io/binary_checkpoint.h"
+
+#include <torch/torch.h>
+#include <ATen/CPUGeneratorImpl.h>
+
+#include <mutex>
+#include <sstream>
+#include <string>
+
+namespace cubeai{
+namespace io{
+
+///
+/// \brief add_module. Add the parameters and the buffers of the module
+/// serialized with torch::serialize::OutputArchive
+///
+template<typename ModuleType>
+void
+add_module(Checkpoint& checkpoint, const std::string& name, const ModuleType& module){
+
+    torch::serialize::OutputArchive archive;
+    module -> save(archive);
+
+    std::ostringstream stream;
+    archive.save_to(stream);
+    checkpoint.add_bytes(name, stream.str());
+}
+
+///
+/// \brief load_module. Load the parameters and the buffers of the module
+/// directly from the mapped bytes
+///
+template<typename ModuleType>
+void
+load_module(const MappedCheckpoint& checkpoint, const std::string& name,
+            ModuleType& module, torch::Device device=torch::kCPU){
+
+    const auto bytes = checkpoint.bytes(name);
+
+    torch::serialize::InputArchive archive;
+    archive.load_from(bytes.data(), bytes.size(), device);
+    module -> load(archive);
+}
+
+///
+/// \brief add_optimizer. Add the state of the optimizer,
+/// e.g. the moments of Adam
+///
+inline
+void
+add_optimizer(Checkpoint& checkpoint, const std::string& name, const torch::optim::Optimizer& optimizer){
+
+    torch::serialize::OutputArchive archive;
+    optimizer.save(archive);
+
+    std::ostringstream stream;
+    archive.save_to(stream);
+    checkpoint.add_bytes(name, stream.str());
+}
+
+///
+/// \brief load_optimizer. Restore the state of the optimizer. The optimizer
+/// should be built over the parameters of the restored module
+///
+inline
+void
+load_optimizer(const MappedCheckpoint& checkpoint, const std::string& name,
+               torch::optim::Optimizer& optimizer, torch::Device device=torch::kCPU){
+
+    const auto bytes = checkpoint.bytes(name);
+
+    torch::serialize::InputArchive archive;
+    archive.load_from(bytes.data(), bytes.size(), device);
+    optimizer.load(archive);
+}
+
+///
+/// \brief add_torch_rng. Add the state of the default CPU generator of
+/// PyTorch, the one used by torch::rand, dropout and the samplers
+///
+inline
+void
+add_torch_rng(Checkpoint& checkpoint, const std::string& name){
+
+    auto generator = at::detail::getDefaultCPUGenerator();
+
+    torch_tensor_t state;
+    {
+        std::lock_guard<std::mutex> lock(generator.mutex());
+        state = generator.get_state();
+    }
+
+    checkpoint.add_bytes(name, std::string_view(reinterpret_cast<const char*>(state.data_ptr<uint8_t>()),
+                                                static_cast<uint_t>(state.numel())));
+}
+
+///
+/// \brief load_torch_rng. Restore the state of the default CPU generator
+///
+inline
+void
+load_torch_rng(const MappedCheckpoint& checkpoint, const std::string& name){
+
+    const auto bytes = checkpoint.bytes(name);
+    auto state = torch::empty({static_cast<int64_t>(bytes.size())}, torch::TensorOptions().dtype(torch::kUInt8));
+    std::memcpy(state.data_ptr<uint8_t>(), bytes.data(), bytes.size());
+
+    auto generator = at::detail::getDefaultCPUGenerator();
+    std::lock_guard<std::mutex> lock(generator.mutex());
+    generator.set_state(state);
+}
+
+}
+}
+
+#endif
+#endif // TORCH_CHECKPOINT_H
@@ -42,6 +42,7 @@ build_pytorch_optimizer(OptimzerType type, torch::nn::Module& model, const torch
 /// \param type
 /// \param model
 /// \return
+inline
 std::unique_ptr<torch::optim::Optimizer>
 build_pytorch_optimizer(OptimzerType type, torch::nn::Module& model, std::unique_ptr<torch::optim::OptimizerOptions>& options){
     return build_pytorch_optimizer(type, model, *options.get());
@@ -13,12 +13,28 @@
 #include "cubeai/maths/statistics/distributions/torch_distribution.h"
 
 #include <torch/torch.h>
+#include <vector>
 
 
 namespace cubeai {
 namespace maths {
 namespace stats {
 
+///
+/// \brief The CategoricalSamplingType enum. How TorchCategorical
+/// draws samples. GUMBEL_MAX takes the argmax of the logits perturbed with
+/// Gumbel noise, INVERSE_CDF searches uniform draws in the cumulative
+/// probabilities. Both draw all the samples of a batch at once
+///
+enum class CategoricalSamplingType: int {GUMBEL_MAX=0, INVERSE_CDF};
+
+///
+/// \brief The TorchCategorical class. Categorical distribution over the last
+/// dimension of a batch of logits or probabilities, e.g. the [n_envs, n_actions]
+/// output of a policy network. The normalized logits are computed once when
+/// the distribution is built and sampling, log_prob and entropy work on the
+/// whole batch with a handful of kernels
+///
 class TorchCategorical final : public TorchDistributionBase
 {
 
@@ -39,7 +55,8 @@ public:
      * to represent logits
      *
      */
-    TorchCategorical(torch_tensor_t probs, bool do_build_from_logits=false);
+    TorchCategorical(torch_tensor_t probs, bool do_build_from_logits=false,
+                     CategoricalSamplingType sampling_type=CategoricalSamplingType::GUMBEL_MAX);
 
     ///
     /// \brief ~TorchCategorical. Destructor
@@ -47,23 +64,33 @@ public:
     virtual ~TorchCategorical() = default;
 
     ///
-    /// \brief entropy
-    /// \return
+    /// \brief entropy. The entropy of every distribution in the batch
     ///
     virtual torch_tensor_t entropy() override;
 
     ///
-    /// \brief log_prob
-    /// \param value
-    /// \return
+    /// \brief log_prob. The log-probability of the given values. When
+    /// value has the batch shape the log-probabilities are gathered
+    /// straight from the normalized logits
     ///
     virtual torch_tensor_t log_prob(torch_tensor_t value) override;
 
     ///
-    ///
+    /// \brief sample. Draw samples of shape sample_shape + batch_shape
+    /// with the configured sampling method. The samples are int64
     ///
     virtual torch_tensor_t sample(c10::ArrayRef<int64_t> sample_shape = {})override;
 
+    ///
+    /// \brief set_sampling_type
+    ///
+    void set_sampling_type(CategoricalSamplingType type)noexcept{sampling_type_ = type;}
+
+    ///
+    /// \brief sampling_type
+    ///
+    CategoricalSamplingType sampling_type()const noexcept{return sampling_type_;}
+
 
     /**
      * @brief build the distribution form logits
@@ -81,16 +108,27 @@ public:
     torch_tensor_t get_logits()const { return logits_; }
 
     ///
-    /// \brief get_probs
-    /// \return
+    /// \brief get_probs. When the distribution was built from
+    /// logits the probabilities are computed on the first call
     ///
-    torch_tensor_t get_probs()const { return probs_; }
+    torch_tensor_t get_probs();
 
 private:
   torch_tensor_t probs_;
   torch_tensor_t logits_;
   torch_tensor_t param_;
   int num_events_;
+  CategoricalSamplingType sampling_type_{CategoricalSamplingType::GUMBEL_MAX};
+
+  ///
+  /// \brief sample_gumbel_max_
+  ///
+  torch_tensor_t sample_gumbel_max_(const std::vector<int64_t>& sample_shape);
+
+  ///
+  /// \brief sample_inverse_cdf_
+  ///
+  torch_tensor_t sample_inverse_cdf_(const std::vector<int64_t>& sample_shape);
 
 };
 }
@@ -7,15 +7,21 @@
 
 #include "cubeai/base/cubeai_types.h"
 #include "cubeai/base/cubeai_consts.h"
-#include "cubeai/optimization/optimizer_type.h"
-#include "cubeai/optimization/pytorch_optimizer_factory.h"
+#include "cubeai/maths/optimization/optimizer_type.h"
+#include "cubeai/maths/optimization/pytorch_optimizer_factory.h"
 #include "cubeai/ml/pytorch_loss_wrapper.h"
 #include <torch/torch.h>
+#include <ATen/autocast_mode.h>
 
 #include <boost/noncopyable.hpp>
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <optional>
+#include <ostream>
 #include <map>
 #include <any>
+#include <vector>
 
 namespace cubeai{
 namespace ml{
@@ -37,10 +43,60 @@ struct PyTorchSupervisedTrainerConfig
     uint_t batch_size;
 
     ///
+    /// \brief n_workers. Number of threads that load and collate
+    /// the batches. Zero loads them on the training thread
     ///
+    uint_t n_workers;
+
+    ///
+    /// \brief prefetch_depth. Maximum number of batches prepared ahead
+    /// of the training step. Only used when n_workers is positive
+    ///
+    uint_t prefetch_depth;
+
+    ///
+    /// \brief drop_last. Skip the last batch of an epoch if it has
+    /// fewer than batch_size examples
+    ///
+    bool drop_last;
+
+    ///
+    /// \brief pin_memory. Pin the batches before they are copied to a
+    /// CUDA device so that the copy runs asynchronously
+    ///
+    bool pin_memory;
+
+    ///
+    /// \brief use_bf16_autocast. Run the forward pass and the loss under
+    /// CPU autocast with bfloat16. The parameters and the gradients stay in
+    /// the default dtype. Only used when the device is the CPU
+    ///
+    bool use_bf16_autocast;
+
+    ///
+    /// \brief accumulation_steps. Accumulate the gradients of this many
+    /// batches before every optimizer step. The effective batch size is
+    /// batch_size * accumulation_steps
+    ///
+    uint_t accumulation_steps;
+
+    ///
+    /// \brief max_grad_norm. Clip the norm of the accumulated gradients
+    /// before every optimizer step. Non positive values disable clipping
+    ///
+    real_t max_grad_norm;
+
+    ///
+    /// \brief show_loss_info. Write a line per epoch to output_stream
     ///
     bool show_loss_info{true};
 
+    ///
+    /// \brief output_stream. Where the epoch information goes.
+    /// Nothing is written if it is null
+    ///
+    std::ostream* output_stream;
+
     ///
     /// \brief device
     ///
@@ -49,7 +105,7 @@ struct PyTorchSupervisedTrainerConfig
     ///
     /// \brief optim_type
     ///
-    cubeai::optim::OptimzerType optim_type;
+    maths::optim::OptimzerType optim_type;
 
     ///
     /// \brief optim_options
@@ -67,13 +123,81 @@ PyTorchSupervisedTrainerConfig::PyTorchSupervisedTrainerConfig()
     :
     n_epochs(100),
     batch_size(50),
+    n_workers(0),
+    prefetch_depth(2),
+    drop_last(false),
+    pin_memory(false),
+    use_bf16_autocast(false),
+    accumulation_steps(1),
+    max_grad_norm(0.0),
     show_loss_info(true),
+    output_stream(nullptr),
     device(torch::kCPU),
-    optim_type(cubeai::optim::OptimzerType::INVALID_TYPE),
+    optim_type(maths::optim::OptimzerType::INVALID_TYPE),
     optim_options()
 {}
 
+///
+/// \brief The CPUAutocastGuard class. Enables bfloat16 autocast on
+/// the CPU for its lifetime and restores the previous state after
+///
+class CPUAutocastGuard: private boost::noncopyable
+{
+public:
+
+    CPUAutocastGuard()
+        :
+          prev_enabled_(at::autocast::is_cpu_enabled()),
+          prev_dtype_(at::autocast::get_autocast_cpu_dtype())
+    {
+        at::autocast::set_cpu_enabled(true);
+        at::autocast::set_autocast_cpu_dtype(at::kBFloat16);
+        at::autocast::increment_nesting();
+    }
+
+    ~CPUAutocastGuard(){
+
+        // the cast weights are cached while autocast
+        // is active, drop them when the last guard goes
+        if(at::autocast::decrement_nesting() == 0){
+            at::autocast::clear_cache();
+        }
+
+        at::autocast::set_cpu_enabled(prev_enabled_);
+        at::autocast::set_autocast_cpu_dtype(prev_dtype_);
+    }
+
+private:
+
+    bool prev_enabled_;
+    at::ScalarType prev_dtype_;
+};
+
+///
+/// \brief The EpochStats struct. What the trainer records for every epoch
+///
+struct EpochStats
+{
+    uint_t epoch;
+    uint_t n_samples;
+    real_t mean_loss;
+    real_t accuracy;
+    real_t samples_per_second;
+    std::chrono::duration<real_t> total_time;
+};
+
 
+/**
+ * @brief The PyTorchSupervisedTrainer class. Trains a model on a data set
+ * whose examples are stacked into batches. The batches are loaded by
+ * n_workers threads and up to prefetch_depth of them are prepared ahead.
+ * The loop is pipelined: the next batch is fetched and its copy to the
+ * device is issued before the step on the current batch runs, so on a CUDA
+ * device with pinned memory the transfer overlaps with the computation.
+ * Optionally the forward pass runs under bfloat16 CPU autocast and the
+ * gradients of accumulation_steps batches are accumulated, and clipped,
+ * before every optimizer step
+ */
 template<typename ModelType>
 class PyTorchSupervisedTrainer: private boost::noncopyable
 {
@@ -88,10 +212,15 @@ public:
 
 
     ///
+    /// \brief train. Train the model on the data set
     ///
+    template<typename TrainDataSetType>
+    void train(TrainDataSetType& data_set, const PyTorchLossWrapper& wrapper );
+
+    ///
+    /// \brief epoch_stats. The statistics of every epoch of the last train call
     ///
-    template<typename TrainDataLoaderType>
-    void train(TrainDataLoaderType& data_loader, const PyTorchLossWrapper& wrapper );
+    const std::vector<EpochStats>& epoch_stats()const noexcept{return epoch_stats_;}
 
 protected:
 
@@ -105,76 +234,183 @@ protected:
     ///
     model_type& model_;
 
+    ///
+    /// \brief epoch_stats_
+    ///
+    std::vector<EpochStats> epoch_stats_;
+
+    ///
+    /// \brief to_device_. Move the batch tensor to the device,
+    /// asynchronously if it is pinned
+    ///
+    torch_tensor_t to_device_(torch_tensor_t tensor)const;
+
 };
 
 template<typename ModelType>
 PyTorchSupervisedTrainer<ModelType>::PyTorchSupervisedTrainer(PyTorchSupervisedTrainerConfig config, model_type& model)
     :
     config_(config),
-    model_(model)
+    model_(model),
+    epoch_stats_()
 {}
 
+template<typename ModelType>
+torch_tensor_t
+PyTorchSupervisedTrainer<ModelType>::to_device_(torch_tensor_t tensor)const{
+
+    if(!config_.device.is_cuda()){
+        return tensor.to(config_.device);
+    }
+
+    if(config_.pin_memory){
+        tensor = tensor.pin_memory();
+    }
+
+    return tensor.to(config_.device, /*non_blocking=*/config_.pin_memory);
+}
+
 template<typename ModelType>
 template<typename TrainDataSetType>
 void
 PyTorchSupervisedTrainer<ModelType>::train(TrainDataSetType& data_set, const PyTorchLossWrapper& loss_wrapper ){
 
-    // create the optimizer and
-    // Set floating point output precision
-    std::cout << std::fixed << std::setprecision(4);
+    // Number of samples in the training set. Query
+    // it before the data set is moved into the loader
+    const auto num_train_samples = data_set.size().value();
+    const auto n_epochs = config_.n_epochs;
+
+    auto loader_options = torch::data::DataLoaderOptions(config_.batch_size)
+            .workers(config_.n_workers)
+            .drop_last(config_.drop_last);
+
+    if(config_.n_workers != 0){
+        loader_options.max_jobs(std::max(config_.prefetch_depth, config_.n_workers));
+    }
 
     // Data loaders
     auto train_loader = torch::data::make_data_loader<torch::data::samplers::RandomSampler>(
-            std::move(data_set), config_.batch_size);
-
-    // Number of samples in the training set
-    const auto num_train_samples = data_set.size().value();
-    const auto n_epochs = config_.n_epochs;
+            std::move(data_set), loader_options);
 
-    const auto optim_ops = cubeai::optim::pytorch::build_pytorch_optimizer_options(config_.optim_type, config_.optim_options);
+    const auto optim_ops = maths::optim::pytorch::build_pytorch_optimizer_options(config_.optim_type, config_.optim_options);
 
     // build optimizer
-    auto optimizer = cubeai::optim::pytorch::build_pytorch_optimizer(config_.optim_type, model_, *optim_ops.get());
+    auto optimizer = maths::optim::pytorch::build_pytorch_optimizer(config_.optim_type, model_, *optim_ops.get());
 
+    epoch_stats_.clear();
+    epoch_stats_.reserve(n_epochs);
+
+    const auto use_autocast = config_.use_bf16_autocast && !config_.device.is_cuda();
+    const auto accumulation_steps = std::max(config_.accumulation_steps, static_cast<uint_t>(1));
+
+    // every batch contributes loss / accumulation_steps so that the
+    // accumulated gradient is the mean over the effective batch. A last
+    // incomplete group of an epoch is stepped with the same scaling
+    const auto loss_scale = 1.0 / static_cast<real_t>(accumulation_steps);
 
     // Train the model
     for (size_t epoch = 0; epoch != n_epochs; ++epoch) {
 
+        auto start = std::chrono::steady_clock::now();
+
         // Initialize running metrics
         auto running_loss = 0.0;
         uint_t num_correct = 0;
+        uint_t num_samples = 0;
 
-        for (auto& batch : *train_loader) {
+        uint_t n_accumulated = 0;
+        optimizer->zero_grad();
 
-            auto data = batch.data.view({static_cast<long int>(config_.batch_size), -1}).to(config_.device);
-            auto target = batch.target.to(config_.device);
+        auto batch_itr = train_loader->begin();
+        auto batch_end = train_loader->end();
 
-            // Forward pass
-            auto output = model_.forward(data);
-
-            // Calculate loss. Use cross_entropy
-            auto loss = loss_wrapper.calculate(output, target); //torch::nn::functional::cross_entropy(output, target);
+        if(batch_itr == batch_end){
+            continue;
+        }
 
-            // Update running loss
+        // the batch the step runs on. The view uses the actual
+        // batch size so that the last partial batch is handled
+        auto data = to_device_(batch_itr->data.view({batch_itr->data.size(0), -1}));
+        auto target = to_device_(batch_itr->target);
+        ++batch_itr;
+
+        while(true){
+
+            // fetch the next batch and issue its copy
+            // before the step on the current one
+            const auto has_next = batch_itr != batch_end;
+
+            torch_tensor_t next_data;
+            torch_tensor_t next_target;
+            if(has_next){
+                next_data = to_device_(batch_itr->data.view({batch_itr->data.size(0), -1}));
+                next_target = to_device_(batch_itr->target);
+                ++batch_itr;
+            }
+
+            torch_tensor_t output;
+            torch_tensor_t loss;
+            {
+                std::optional<CPUAutocastGuard> autocast;
+                if(use_autocast){
+                    autocast.emplace();
+                }
+
+                // Forward pass
+                output = model_.forward(data);
+
+                // Calculate loss
+                loss = loss_wrapper.calculate(output, target);
+            }
+
+            // Backward pass, the gradients accumulate
+            // until the optimizer steps
+            (loss * loss_scale).backward();
+            n_accumulated += 1;
+
+            if(n_accumulated == accumulation_steps || !has_next){
+
+                if(config_.max_grad_norm > 0.0){
+                    torch::nn::utils::clip_grad_norm_(model_.parameters(), config_.max_grad_norm);
+                }
+
+                optimizer->step();
+                optimizer->zero_grad();
+                n_accumulated = 0;
+            }
+
+            // Update the running metrics
             running_loss += loss. template item<real_t>() * data.size(0);
+            num_correct += output.argmax(1).eq(target).sum(). template item<int64_t>();
+            num_samples += data.size(0);
 
-            // Calculate prediction
-            auto prediction = output.argmax(1);
+            if(!has_next){
+                break;
+            }
 
-            // Update number of correctly classified samples
-            num_correct += prediction.eq(target).sum(). template item<int64_t>();
-
-            // Backward pass and optimize
-            optimizer->zero_grad();
-            loss.backward();
-            optimizer->step();
+            data = next_data;
+            target = next_target;
         }
 
-        auto sample_mean_loss = running_loss / num_train_samples;
-        auto accuracy = static_cast<real_t>(num_correct) / num_train_samples;
+        std::chrono::duration<real_t> elapsed = std::chrono::steady_clock::now() - start;
+
+        EpochStats stats;
+        stats.epoch = epoch;
+        stats.n_samples = num_samples;
+        stats.mean_loss = running_loss / static_cast<real_t>(num_samples);
+        stats.accuracy = static_cast<real_t>(num_correct) / static_cast<real_t>(num_samples);
+        stats.samples_per_second = static_cast<real_t>(num_samples) / elapsed.count();
+        stats.total_time = elapsed;
+        epoch_stats_.push_back(stats);
 
-        std::cout<<cubeai::CubeAIConsts::info_str()<< "Epoch [" << (epoch + 1) << "/" << n_epochs << "], Trainset - Loss: "
-            << sample_mean_loss << ", Accuracy: " << accuracy << '\n';
+        if(config_.show_loss_info && config_.output_stream){
+
+            *config_.output_stream<<cubeai::CubeAIConsts::info_str()<< "Epoch [" << (epoch + 1) << "/" << n_epochs
+                                  << "], Trainset - Loss: "<<std::fixed << std::setprecision(4)<< stats.mean_loss
+                                  << ", Accuracy: " << stats.accuracy
+                                  << ", Samples/s: " << stats.samples_per_second
+                                  << " (" << num_samples << "/" << num_train_samples << " samples)\n";
+        }
     }
 }
 
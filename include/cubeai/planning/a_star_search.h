@@ -2,200 +2,608 @@
 #define A_STAR_SEARCH_H
 
 #include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
 
-//#include "cubeai/data_structs/searchable_priority_queue.h"
-//#include "kernel/utilities/map_utilities.h"
-
-#include <utility>
-#include <set>
-#include <queue>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace cubeai{
-namespace astar_impl{
 
+///
+/// \brief The graph interface the search engines in this module consume.
+/// A graph is anything with
+///
+///   uint_t n_vertices()const;
+///   template<typename Fn> void for_each_neighbor(uint_t v, Fn&& fn)const;
+///
+/// where for_each_neighbor calls fn(w, cost) for every edge v -> w. Edges
+/// whose cost is infinite are ignored, so a graph can report blocked edges
+/// instead of filtering them
+///
+template<typename GraphTp>
+concept astar_graph_concept = requires(const GraphTp& g, uint_t v){
+    { g.n_vertices() };
+    g.for_each_neighbor(v, [](uint_t, real_t){});
+};
 
+namespace astar_impl{
 
 ///
-/// \brief See Scott Meyers Effective STL Item 24
-/// for this function. If k isn't in the map
-/// efficiently add pair (k,v) otherwise efficiently update
-/// to v the value associated with k. Return an interator
-/// to the added or modified pair
+/// \brief The IndexedMinHeap class. Binary min-heap of vertex ids keyed
+/// by a cost. The position of every vertex in the heap is kept so that
+/// the key of a queued vertex can be decreased in O(log n) instead of
+/// pushing a duplicate
 ///
-template<typename MapType,
-         typename KeyArgType,
-         typename ValueArgType>
-typename MapType::iterator
-add_or_update_map(MapType& map, const KeyArgType& k, const ValueArgType& v){
+template<typename CostTp>
+class IndexedMinHeap
+{
+public:
+
+    static constexpr uint_t npos = CubeAIConsts::INVALID_SIZE_TYPE;
+
+    ///
+    /// \brief resize. The ids pushed should be in [0, n)
+    ///
+    void resize(uint_t n){pos_.assign(n, npos); heap_.clear();}
+
+    ///
+    /// \brief clear. Remove all the entries. O(size)
+    ///
+    void clear()noexcept;
+
+    bool empty()const noexcept{return heap_.empty();}
+    uint_t size()const noexcept{return heap_.size();}
+    bool contains(uint_t v)const noexcept{return pos_[v] != npos;}
+
+    ///
+    /// \brief top. The vertex with the smallest key
+    ///
+    uint_t top()const noexcept{return heap_.front().v;}
+
+    ///
+    /// \brief top_key. The smallest key
+    ///
+    CostTp top_key()const noexcept{return heap_.front().key;}
+
+    ///
+    /// \brief key. The key of a queued vertex
+    ///
+    CostTp key(uint_t v)const noexcept{return heap_[pos_[v]].key;}
+
+    ///
+    /// \brief push. The vertex should not be queued
+    ///
+    void push(uint_t v, CostTp key);
+
+    ///
+    /// \brief decrease_key. The vertex should be queued
+    /// and the new key not larger than the current
+    ///
+    void decrease_key(uint_t v, CostTp key);
+
+    ///
+    /// \brief update. Push the vertex or change its key
+    ///
+    void update(uint_t v, CostTp key);
+
+    ///
+    /// \brief pop. Remove and return the vertex with the smallest key
+    ///
+    uint_t pop();
+
+    ///
+    /// \brief erase. Remove the vertex if it is queued
+    ///
+    void erase(uint_t v);
+
+private:
+
+    struct Entry
+    {
+        CostTp key;
+        uint_t v;
+    };
+
+    std::vector<Entry> heap_;
+    std::vector<uint_t> pos_;
+
+    void sift_up_(uint_t i);
+    void sift_down_(uint_t i);
+
+    void place_(uint_t i, const Entry& e)noexcept{heap_[i] = e; pos_[e.v] = i;}
+};
+
+template<typename CostTp>
+void
+IndexedMinHeap<CostTp>::clear()noexcept{
+
+    for(const auto& e : heap_){
+        pos_[e.v] = npos;
+    }
 
-//find where k is or should be
-typename MapType::iterator lb = map.lower_bound(k);
+    heap_.clear();
+}
 
-//if lb points to a pair whose key is equivalent to k
-//update the pair's value and return the iterator
-if(lb != map.end() &&
-   !(map.key_comp()(k,lb->first))){
+template<typename CostTp>
+void
+IndexedMinHeap<CostTp>::push(uint_t v, CostTp key){
 
-         lb->second = v;
-         return lb;
- }
- else{  //add pair (k,v) to map and return an iterator
-           //to the new map element
+    heap_.push_back(Entry{key, v});
+    pos_[v] = heap_.size() - 1;
+    sift_up_(heap_.size() - 1);
+}
 
-  typedef typename MapType::value_type MVT;
-  return map.insert(lb,MVT(k,v));
+template<typename CostTp>
+void
+IndexedMinHeap<CostTp>::decrease_key(uint_t v, CostTp key){
 
- }
+    const auto i = pos_[v];
+    heap_[i].key = key;
+    sift_up_(i);
 }
 
-struct fcost_astar_node_compare
-{
-   template<typename NodeTp>
-   bool operator()(const NodeTp& n1,const NodeTp& n2)const;
-};
+template<typename CostTp>
+void
+IndexedMinHeap<CostTp>::update(uint_t v, CostTp key){
 
-template<typename NodeTp>
-bool
-fcost_astar_node_compare::operator()(const NodeTp& n1,const NodeTp& n2)const{
+    if(!contains(v)){
+        push(v, key);
+        return;
+    }
 
-   if(n1.data.f_cost > n2.data.f_cost){
-       return true;
-   }
+    const auto i = pos_[v];
+    const auto old_key = heap_[i].key;
+    heap_[i].key = key;
 
-   return false;
+    if(key < old_key){
+        sift_up_(i);
+    }
+    else{
+        sift_down_(i);
+    }
 }
 
-struct id_astar_node_compare
-{
-   template<typename NodeTp>
-   bool operator()(const NodeTp& n1,const NodeTp& n2)const;
-};
+template<typename CostTp>
+uint_t
+IndexedMinHeap<CostTp>::pop(){
 
-template<typename NodeTp>
-bool
-id_astar_node_compare::operator()(const NodeTp& n1,const NodeTp& n2)const{
+    const auto v = heap_.front().v;
+    pos_[v] = npos;
+
+    const auto last = heap_.back();
+    heap_.pop_back();
+
+    if(!heap_.empty()){
+        place_(0, last);
+        sift_down_(0);
+    }
+
+    return v;
+}
+
+template<typename CostTp>
+void
+IndexedMinHeap<CostTp>::erase(uint_t v){
+
+    if(!contains(v)){
+        return;
+    }
+
+    const auto i = pos_[v];
+    pos_[v] = npos;
+
+    const auto last = heap_.back();
+    heap_.pop_back();
+
+    if(i == heap_.size()){
+        return;
+    }
+
+    const auto old_key = heap_[i].key;
+    place_(i, last);
+
+    if(last.key < old_key){
+        sift_up_(i);
+    }
+    else{
+        sift_down_(i);
+    }
+}
+
+template<typename CostTp>
+void
+IndexedMinHeap<CostTp>::sift_up_(uint_t i){
 
-   if(n1.id > n2.id){
-       return true;
-   }
+    // move the hole up instead of swapping
+    const auto e = heap_[i];
+    while(i != 0){
+
+        const auto parent = (i - 1) / 2;
+        if(!(e.key < heap_[parent].key)){
+            break;
+        }
 
-   return false;
+        place_(i, heap_[parent]);
+        i = parent;
+    }
+
+    place_(i, e);
 }
+
+template<typename CostTp>
+void
+IndexedMinHeap<CostTp>::sift_down_(uint_t i){
+
+    const auto n = heap_.size();
+    const auto e = heap_[i];
+
+    while(true){
+
+        auto child = 2 * i + 1;
+        if(child >= n){
+            break;
+        }
+
+        if(child + 1 < n && heap_[child + 1].key < heap_[child].key){
+            child += 1;
+        }
+
+        if(!(heap_[child].key < e.key)){
+            break;
+        }
+
+        place_(i, heap_[child]);
+        i = child;
+    }
+
+    place_(i, e);
+}
+
+///
+/// \brief The BoostGraphView class. Exposes a BoostSerialGraph through the
+/// for_each_neighbor interface. The cost of an edge is cost(u, w) where u
+/// and w are the vertex objects
+///
+template<typename GraphTp, typename CostFn>
+class BoostGraphView
+{
+public:
+
+    BoostGraphView(const GraphTp& g, const CostFn& cost)
+        :
+          g_(g),
+          cost_(cost)
+    {}
+
+    uint_t n_vertices()const{return g_.n_vertices();}
+
+    template<typename Fn>
+    void for_each_neighbor(uint_t v, Fn&& fn)const{
+
+        const auto& cv = g_.get_vertex(v);
+        auto neighbors = g_.get_vertex_neighbors(v);
+        for(auto itr = neighbors.first; itr != neighbors.second; ++itr){
+
+            const auto& nv = g_.get_vertex(itr);
+            fn(nv.id, cost_(cv, nv));
+        }
+    }
+
+private:
+
+    const GraphTp& g_;
+    const CostFn& cost_;
+};
+
 } //astar_impl
 
 ///
-/// \brief Simple implementation of A* algorithm
-/// at the moment the algorithm is only usable with a
-/// boost_unidirected_serial_graph graph
+/// \brief The AStarSearch class. A* over the vertex ids of a graph that
+/// models astar_graph_concept. The state of a query lives in dense per-vertex
+/// arrays: the g cost, the parent, a visit stamp, a closed bitset and the
+/// position in an indexed binary heap that supports decrease-key. A query
+/// only touches the vertices it reaches. Instead of clearing the arrays every
+/// query increments an epoch counter and a vertex whose stamp differs from the
+/// epoch counts as unvisited, so reusing the engine costs nothing per vertex.
+/// The heuristic is called as h(v) and should estimate the cost from v to the
+/// goal. Closed vertices are reopened when a cheaper path reaches them, so
+/// admissible but inconsistent heuristics still give optimal paths
 ///
-template<typename GraphTp, typename H>
-std::multimap<uint_t, uint_t>
-a_star_search(GraphTp& g, typename GraphTp::vertex_type& start, typename GraphTp::vertex_type& end, const H& h){
+template<typename CostTp=real_t>
+class AStarSearch
+{
+public:
+
+    typedef CostTp cost_type;
+
+    static constexpr uint_t npos = CubeAIConsts::INVALID_SIZE_TYPE;
+
+    ///
+    /// \brief Constructor. The arrays grow with the first
+    /// graph that has more vertices
+    ///
+    explicit AStarSearch(uint_t n_vertices=0);
+
+    ///
+    /// \brief reserve. Allocate the arrays for graphs with n vertices
+    ///
+    void reserve(uint_t n);
+
+    ///
+    /// \brief search. Find a cheapest path from start to goal. Returns
+    /// true if the goal is reachable
+    ///
+    template<astar_graph_concept GraphTp, typename HeuristicFn>
+    bool search(const GraphTp& graph, uint_t start, uint_t goal, const HeuristicFn& h);
+
+    ///
+    /// \brief path. The vertices from start to v of the last search.
+    /// Empty if v was not reached
+    ///
+    void path(uint_t v, std::vector<uint_t>& out)const;
+
+    ///
+    /// \brief path. The vertices from start to v of the last search
+    ///
+    std::vector<uint_t> path(uint_t v)const{std::vector<uint_t> out; path(v, out); return out;}
+
+    ///
+    /// \brief reached. Whether the last search reached v
+    ///
+    bool reached(uint_t v)const noexcept{return v < stamp_.size() && stamp_[v] == epoch_;}
+
+    ///
+    /// \brief is_closed. Whether the last search expanded v
+    ///
+    bool is_closed(uint_t v)const noexcept{return reached(v) && (closed_[v >> 6] >> (v & 63)) & 1;}
+
+    ///
+    /// \brief g_cost. The cost from start to v of the last search.
+    /// Infinite if v was not reached
+    ///
+    cost_type g_cost(uint_t v)const noexcept{return reached(v) ? g_[v] : std::numeric_limits<cost_type>::infinity();}
+
+    ///
+    /// \brief parent. The predecessor of v on the path. npos if v was not reached
+    ///
+    uint_t parent(uint_t v)const noexcept{return reached(v) ? parent_[v] : npos;}
+
+    ///
+    /// \brief n_expanded. Number of vertices expanded by the last search
+    ///
+    uint_t n_expanded()const noexcept{return n_expanded_;}
+
+    ///
+    /// \brief n_touched. Number of vertices reached by the last search
+    ///
+    uint_t n_touched()const noexcept{return n_touched_;}
+
+private:
+
+    std::vector<cost_type> g_;
+    std::vector<uint_t> parent_;
+    std::vector<std::uint32_t> stamp_;
+    std::vector<std::uint64_t> closed_;
+    astar_impl::IndexedMinHeap<cost_type> open_;
+
+    std::uint32_t epoch_;
+    uint_t n_expanded_;
+    uint_t n_touched_;
+
+    ///
+    /// \brief begin_query_. Start a new epoch
+    ///
+    void begin_query_(uint_t n);
+
+    ///
+    /// \brief touch_. Mark v visited in this epoch
+    ///
+    void touch_(uint_t v, cost_type g, uint_t parent)noexcept;
+
+    void set_closed_(uint_t v)noexcept{closed_[v >> 6] |= std::uint64_t(1) << (v & 63);}
+    void clear_closed_(uint_t v)noexcept{closed_[v >> 6] &= ~(std::uint64_t(1) << (v & 63));}
+    bool closed_bit_(uint_t v)const noexcept{return (closed_[v >> 6] >> (v & 63)) & 1;}
+};
 
-   // for each node hodls where it
-   // came form
-   std::multimap<uint_t, uint_t> came_from;
+template<typename CostTp>
+AStarSearch<CostTp>::AStarSearch(uint_t n_vertices)
+    :
+      g_(),
+      parent_(),
+      stamp_(),
+      closed_(),
+      open_(),
+      epoch_(1),
+      n_expanded_(0),
+      n_touched_(0)
+{
+    reserve(n_vertices);
+}
 
-   if(start == end){
+template<typename CostTp>
+void
+AStarSearch<CostTp>::reserve(uint_t n){
 
-     //we don't have to search for anything
-     came_from.insert(start.id, start.id);
-     return came_from;
-   }
+    if(n <= stamp_.size()){
+        return;
+    }
 
-   typedef typename H::cost_type cost_t;
-   typedef typename GraphTp::vertex_type vertex_t;
-   typedef typename GraphTp::adjacency_iterator adjacency_iterator;
-   typedef typename GraphTp::vertex_type node_t;
-   typedef std::priority_queue<node_t, std::vector<node_t>, astar_impl::fcost_astar_node_compare> searchable_priority_queue;
+    g_.resize(n);
+    parent_.resize(n);
+    closed_.resize((n + 63) / 64);
 
-   std::set<node_t,astar_impl::id_astar_node_compare> explored;
-   searchable_priority_queue open;
+    // the epoch is never zero so the new vertices are unvisited
+    stamp_.resize(n, 0);
+    open_.resize(n);
+}
 
-   //the cost of the path so far leading to this
-   //node is obviously zero at the start node
-   start.data.g_cost = 0.0;
+template<typename CostTp>
+void
+AStarSearch<CostTp>::begin_query_(uint_t n){
 
-   //calculate the fCost from start node to the goal
-   //at the moment this can be done only heuristically
-   //start.data.fcost = h(start.data.position, end.data.position);
-   start.data.f_cost = h(start, end);
-   open.push(start);
+    reserve(n);
+    open_.clear();
 
-   while(!open.empty()){
+    epoch_ += 1;
+    if(epoch_ == 0){
 
-      //the vertex currently examined
-      const node_t cv = open.top();
-      open.pop();
+        // the counter wrapped, every stamp may
+        // now alias a new epoch so reset them
+        std::fill(stamp_.begin(), stamp_.end(), 0);
+        epoch_ = 1;
+    }
 
-      //check if this is the goal
-      if(cv == end){
-         break;
-      }
+    n_expanded_ = 0;
+    n_touched_ = 0;
+}
 
-      //current node is not the goal so proceed
-      //add it to the explored (or else called closed) set
-      explored.insert(cv);
+template<typename CostTp>
+void
+AStarSearch<CostTp>::touch_(uint_t v, cost_type g, uint_t parent)noexcept{
 
-      //get the adjacent neighbors
-      std::pair<adjacency_iterator,adjacency_iterator> neighbors = g.get_vertex_neighbors(cv);
-      auto itr = neighbors.first;
+    stamp_[v] = epoch_;
+    g_[v] = g;
+    parent_[v] = parent;
 
-      // loop over the neighbors
-      for(; itr != neighbors.second; itr++){
+    // the bit may be left over from an earlier query
+    clear_closed_(v);
+    n_touched_ += 1;
+}
 
-         node_t& nv = g.get_vertex(itr);
+template<typename CostTp>
+template<astar_graph_concept GraphTp, typename HeuristicFn>
+bool
+AStarSearch<CostTp>::search(const GraphTp& graph, uint_t start, uint_t goal, const HeuristicFn& h){
 
-         if(open.contains(nv)){
-             continue;
-         }
-         else{
+    const uint_t n = graph.n_vertices();
+    if(start >= n || goal >= n){
+        throw std::logic_error("Invalid start/goal vertex " + std::to_string(start) + "/" +
+                               std::to_string(goal) + " not in [0," + std::to_string(n) + ")");
+    }
 
-             // we cannot move to the neighbor
-             // so no reason checking
-             if(!nv.data.can_move()){
-                explored.insert(nv);
-                continue;
-             }
-         }
+    begin_query_(n);
 
-         // node id
-         uint_t nid = nv.id;
+    touch_(start, cost_type(0), start);
+    open_.push(start, h(start));
 
-         //search explored set by id
-         auto itr = std::find_if(explored.begin(), explored.end(),
-                                 [=](const node_t& n){return (n.id == nid);});
+    while(!open_.empty()){
 
-         //the node has been explored
-         if(itr != explored.end()){
-            continue;
-         }
+        const auto u = open_.pop();
+        if(u == goal){
+            return true;
+        }
 
-         //this actually the cost of the path from the current node
-         //to reach its neighbor
-         cost_t tg_cost = cv.data.g_cost + h(cv, nv);//h(cv.data.position, nv.data.position);
+        set_closed_(u);
+        n_expanded_ += 1;
+
+        const auto gu = g_[u];
+        graph.for_each_neighbor(u, [&](uint_t w, auto edge_cost){
+
+            const auto cost = static_cast<cost_type>(edge_cost);
+            if(cost == std::numeric_limits<cost_type>::infinity()){
+                return;
+            }
+
+            const auto tg = gu + cost;
+
+            if(stamp_[w] != epoch_){
+                touch_(w, tg, u);
+                open_.push(w, tg + h(w));
+                return;
+            }
+
+            if(!(tg < g_[w])){
+                return;
+            }
+
+            g_[w] = tg;
+            parent_[w] = u;
+
+            if(open_.contains(w)){
+                open_.decrease_key(w, tg + h(w));
+            }
+            else{
+                // reopen, only happens with inconsistent heuristics
+                clear_closed_(w);
+                open_.push(w, tg + h(w));
+            }
+        });
+    }
 
-         if (tg_cost >= nv.data.g_cost) {
-            continue; //this is not a better path
-         }
+    return false;
+}
 
-         // This path is the best until now. Record it!
-         astar_impl::add_or_update_map(came_from,nv.id,cv.id);
+template<typename CostTp>
+void
+AStarSearch<CostTp>::path(uint_t v, std::vector<uint_t>& out)const{
 
-         //came_from.put(nv.id,cv.id);
-         nv.data.g_cost = tg_cost;
+    out.clear();
+    if(!reached(v)){
+        return;
+    }
 
-         //acutally calculate f(nn) = g(nn)+h(nn)
-         nv.data.f_cost = nv.data.g_cost + h(nv, end);//h(nv.data.position, end.data.position);
+    out.push_back(v);
+    while(parent_[v] != v){
+        v = parent_[v];
+        out.push_back(v);
+    }
 
-         //if the neighbor not in open set add it
-         open.push(nv);
+    std::reverse(out.begin(), out.end());
+}
 
-      }
-   }
+///
+/// \brief A* over a BoostSerialGraph. h(v1, v2) is called with vertex objects
+/// and gives both the cost of the edge between two neighbours and the
+/// heuristic estimate to the goal. Neighbours whose data reports can_move()
+/// false are not entered. The result maps every reached vertex id, except the
+/// start, to the id of its predecessor; reconstruct_a_star_path(result, end.id)
+/// gives the path. Use AStarSearch directly to run many queries without
+/// allocating
+///
+template<typename GraphTp, typename H>
+std::multimap<uint_t, uint_t>
+a_star_search(GraphTp& g, typename GraphTp::vertex_t& start, typename GraphTp::vertex_t& end, const H& h){
+
+    typedef typename H::cost_type cost_t;
+    typedef typename GraphTp::vertex_t vertex_t;
+
+    std::multimap<uint_t, uint_t> came_from;
+    if(start == end){
+        //we don't have to search for anything
+        return came_from;
+    }
+
+    auto edge_cost = [&h](const vertex_t& cv, const vertex_t& nv){
+
+        // we cannot move to the neighbor
+        if constexpr(requires{ nv.data.can_move(); }){
+            if(!nv.data.can_move()){
+                return std::numeric_limits<cost_t>::infinity();
+            }
+        }
+
+        return static_cast<cost_t>(h(cv, nv));
+    };
+
+    astar_impl::BoostGraphView<GraphTp, decltype(edge_cost)> view(g, edge_cost);
+
+    AStarSearch<cost_t> engine(g.n_vertices());
+    engine.search(view, start.id, end.id,
+                  [&](uint_t v){return static_cast<cost_t>(h(g.get_vertex(v), end));});
+
+    for(uint_t v=0; v<g.n_vertices(); ++v){
+        if(v != start.id && engine.reached(v)){
+            came_from.emplace(v, engine.parent(v));
+        }
+    }
 
-   return came_from;
+    return came_from;
 }
 
 template<typename IdTp>
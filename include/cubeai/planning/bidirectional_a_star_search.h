@@ -0,0 +1,624 @@
+#ifndef BIDIRECTIONAL_A_STAR_SEARCH_H
+#define BIDIRECTIONAL_A_STAR_SEARCH_H
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/planning/a_star_search.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cubeai{
+
+///
+/// \brief The BidirectionalAStarSearch class. Bidirectional A* over the
+/// vertex ids of graphs that model astar_graph_concept. A forward search
+/// from the start and a backward search from the goal, over the reversed
+/// graph, run until the best path found through a vertex labelled by both
+/// can no longer be improved.
+///
+/// Both searches use the average potential p(v) = (h_goal(v) - h_start(v)) / 2,
+/// the forward one with key g(v) + p(v) and the backward one with key
+/// g(v) - p(v). h_goal estimates the cost from v to the goal and h_start the
+/// cost from the start to v. The heuristics should be consistent. Then the
+/// reduced edge costs are non-negative, no vertex is expanded twice and the
+/// search stops as soon as the sum of the two smallest keys reaches the cost
+/// of the best path found. This is the criterion of bidirectional Dijkstra on
+/// the reduced graph, so the path is optimal. The stop test is not the naive
+/// one of stopping when the searches meet, which may return a longer path.
+/// A popped vertex is not expanded when its g cost plus the heuristic of its
+/// side reaches the best cost, or when the other side already closed it.
+///
+/// In sequential mode the side with the smaller open list is expanded next.
+/// In concurrent mode the backward search runs on a second thread. The two
+/// share the best path cost and the smallest key of each open list, and read
+/// the cost of the other side through atomics, so neither waits for the
+/// other. The graphs and the heuristics are then called from both threads
+/// and should be safe to call concurrently, which holds for const calls on
+/// the graph classes of this library. The concurrent mode pays off when
+/// expanding a vertex is expensive, e.g. when the edge costs involve
+/// collision checks; on cheap graphs the synchronization costs more than the
+/// second thread saves
+///
+template<typename CostTp=real_t>
+class BidirectionalAStarSearch
+{
+public:
+
+    typedef CostTp cost_type;
+
+    static constexpr uint_t npos = CubeAIConsts::INVALID_SIZE_TYPE;
+
+    ///
+    /// \brief Constructor. The arrays grow with the first
+    /// graph that has more vertices
+    ///
+    explicit BidirectionalAStarSearch(uint_t n_vertices=0, bool concurrent=false);
+
+    ///
+    /// \brief reserve. Allocate the arrays for graphs with n vertices
+    ///
+    void reserve(uint_t n);
+
+    ///
+    /// \brief set_concurrent. Run the backward search on a second thread
+    ///
+    void set_concurrent(bool concurrent)noexcept{concurrent_ = concurrent;}
+
+    ///
+    /// \brief is_concurrent
+    ///
+    bool is_concurrent()const noexcept{return concurrent_;}
+
+    ///
+    /// \brief search. Find a cheapest path from start to goal on a graph
+    /// whose edges have the same cost in both directions, e.g. a
+    /// BoostSerialGraph or a GridGraph. Returns true if the goal is reachable
+    ///
+    template<astar_graph_concept GraphTp, typename HeuristicGoalFn, typename HeuristicStartFn>
+    bool search(const GraphTp& graph, uint_t start, uint_t goal,
+                const HeuristicGoalFn& h_goal, const HeuristicStartFn& h_start){
+        return search(graph, graph, start, goal, h_goal, h_start);
+    }
+
+    ///
+    /// \brief search. Find a cheapest path from start to goal. The reverse
+    /// graph has an edge w -> v of cost c for every edge v -> w of cost c of
+    /// the graph
+    ///
+    template<astar_graph_concept GraphTp, astar_graph_concept ReverseGraphTp,
+             typename HeuristicGoalFn, typename HeuristicStartFn>
+    bool search(const GraphTp& graph, const ReverseGraphTp& reverse_graph, uint_t start, uint_t goal,
+                const HeuristicGoalFn& h_goal, const HeuristicStartFn& h_start);
+
+    ///
+    /// \brief cost. The cost of the path found by the last search.
+    /// Infinite if the goal was not reached
+    ///
+    cost_type cost()const noexcept{return best_;}
+
+    ///
+    /// \brief meeting_vertex. The vertex where the forward and the backward
+    /// path of the last search join. npos if the goal was not reached
+    ///
+    uint_t meeting_vertex()const noexcept{return meet_;}
+
+    ///
+    /// \brief path. The vertices from start to goal of the last search.
+    /// Empty if the goal was not reached
+    ///
+    void path(std::vector<uint_t>& out)const;
+
+    ///
+    /// \brief path. The vertices from start to goal of the last search
+    ///
+    std::vector<uint_t> path()const{std::vector<uint_t> out; path(out); return out;}
+
+    ///
+    /// \brief n_expanded. Number of vertices expanded by both searches
+    ///
+    uint_t n_expanded()const noexcept{return forward_.n_expanded + backward_.n_expanded;}
+
+    ///
+    /// \brief n_expanded_forward. Number of vertices expanded by the forward search
+    ///
+    uint_t n_expanded_forward()const noexcept{return forward_.n_expanded;}
+
+    ///
+    /// \brief n_expanded_backward. Number of vertices expanded by the backward search
+    ///
+    uint_t n_expanded_backward()const noexcept{return backward_.n_expanded;}
+
+private:
+
+    ///
+    /// \brief The Side struct. The state of one of the two searches.
+    /// The g costs and the stamps are read by the other side
+    ///
+    struct Side
+    {
+        std::vector<cost_type> g;
+        std::vector<uint_t> parent;
+        std::vector<std::uint32_t> stamp;
+        std::vector<std::uint64_t> closed;
+        astar_impl::IndexedMinHeap<cost_type> open;
+        std::uint32_t epoch{1};
+        uint_t n_expanded{0};
+
+        ///
+        /// \brief The smallest key of the open list, published for the other side
+        ///
+        std::atomic<cost_type> top_key{0};
+
+        void reserve(uint_t n);
+        void begin_query(uint_t n);
+
+        bool is_closed(uint_t v)const noexcept{return (closed[v >> 6] >> (v & 63)) & 1;}
+        void set_closed(uint_t v)noexcept{closed[v >> 6] |= std::uint64_t(1) << (v & 63);}
+    };
+
+    Side forward_;
+    Side backward_;
+    bool concurrent_;
+
+    cost_type best_;
+    uint_t meet_;
+
+    ///
+    /// \brief The best cost is read by both threads in concurrent mode;
+    /// it is only changed together with the meeting vertex, under the mutex
+    ///
+    std::atomic<cost_type> shared_best_;
+    std::mutex meet_mutex_;
+    std::atomic<bool> stop_;
+
+    ///
+    /// \brief label_. Set the cost of v for the side. Called
+    /// when v is reached or reached with a lower cost
+    ///
+    template<bool concurrent>
+    void label_(Side& side, uint_t v, cost_type g, uint_t parent)noexcept;
+
+    ///
+    /// \brief cost_of_. The cost of v for the side. Infinite if not reached
+    ///
+    template<bool concurrent>
+    cost_type cost_of_(const Side& side, uint_t v)const noexcept;
+
+    ///
+    /// \brief expand_. Pop the side's open vertex with the smallest key and relax
+    /// its edges. h is the heuristic of the side, towards the root of the other
+    /// side, and h_other the heuristic of the other side
+    ///
+    template<bool concurrent, typename GraphTp, typename HeuristicFn, typename HeuristicOtherFn>
+    void expand_(Side& side, const Side& other, const GraphTp& graph,
+                 const HeuristicFn& h, const HeuristicOtherFn& h_other);
+
+    ///
+    /// \brief update_best_. Record a path through v of the given cost
+    ///
+    template<bool concurrent>
+    void update_best_(cost_type cost, uint_t v);
+
+    ///
+    /// \brief potential_. The average potential of v for the side whose heuristic is h
+    ///
+    template<typename HeuristicFn, typename HeuristicOtherFn>
+    static cost_type potential_(const HeuristicFn& h, const HeuristicOtherFn& h_other, uint_t v){
+        return (static_cast<cost_type>(h(v)) - static_cast<cost_type>(h_other(v))) / cost_type(2);
+    }
+
+    template<typename GraphTp, typename ReverseGraphTp, typename HeuristicGoalFn, typename HeuristicStartFn>
+    void run_sequential_(const GraphTp& graph, const ReverseGraphTp& reverse_graph,
+                         const HeuristicGoalFn& h_goal, const HeuristicStartFn& h_start);
+
+    template<typename GraphTp, typename ReverseGraphTp, typename HeuristicGoalFn, typename HeuristicStartFn>
+    void run_concurrent_(const GraphTp& graph, const ReverseGraphTp& reverse_graph,
+                         const HeuristicGoalFn& h_goal, const HeuristicStartFn& h_start);
+
+    ///
+    /// \brief run_side_. The loop of one side in concurrent mode
+    ///
+    template<typename GraphTp, typename HeuristicFn, typename HeuristicOtherFn>
+    void run_side_(Side& side, Side& other, const GraphTp& graph,
+                   const HeuristicFn& h, const HeuristicOtherFn& h_other);
+};
+
+template<typename CostTp>
+void
+BidirectionalAStarSearch<CostTp>::Side::reserve(uint_t n){
+
+    if(n <= stamp.size()){
+        return;
+    }
+
+    g.resize(n);
+    parent.resize(n);
+    closed.resize((n + 63) / 64);
+    stamp.resize(n, 0);
+    open.resize(n);
+}
+
+template<typename CostTp>
+void
+BidirectionalAStarSearch<CostTp>::Side::begin_query(uint_t n){
+
+    reserve(n);
+    open.clear();
+
+    epoch += 1;
+    if(epoch == 0){
+        std::fill(stamp.begin(), stamp.end(), 0);
+        epoch = 1;
+    }
+
+    n_expanded = 0;
+}
+
+template<typename CostTp>
+BidirectionalAStarSearch<CostTp>::BidirectionalAStarSearch(uint_t n_vertices, bool concurrent)
+    :
+      forward_(),
+      backward_(),
+      concurrent_(concurrent),
+      best_(std::numeric_limits<cost_type>::infinity()),
+      meet_(npos),
+      shared_best_(std::numeric_limits<cost_type>::infinity()),
+      meet_mutex_(),
+      stop_(false)
+{
+    reserve(n_vertices);
+}
+
+template<typename CostTp>
+void
+BidirectionalAStarSearch<CostTp>::reserve(uint_t n){
+
+    forward_.reserve(n);
+    backward_.reserve(n);
+}
+
+template<typename CostTp>
+template<bool concurrent>
+void
+BidirectionalAStarSearch<CostTp>::label_(Side& side, uint_t v, cost_type g, uint_t parent)noexcept{
+
+    // in concurrent mode the other side reads g and the stamp. The
+    // sequentially consistent order of the writes of one side and the
+    // reads of the other guarantees that, of the two sides labelling
+    // a vertex, at least one sees the cost the other wrote
+    constexpr auto order = concurrent ? std::memory_order_seq_cst : std::memory_order_relaxed;
+
+    side.parent[v] = parent;
+    std::atomic_ref<cost_type>(side.g[v]).store(g, order);
+
+    if(side.stamp[v] != side.epoch){
+
+        std::atomic_ref<std::uint32_t>(side.stamp[v]).store(side.epoch, order);
+
+        // the bit may be left over from an earlier query
+        side.closed[v >> 6] &= ~(std::uint64_t(1) << (v & 63));
+    }
+}
+
+template<typename CostTp>
+template<bool concurrent>
+typename BidirectionalAStarSearch<CostTp>::cost_type
+BidirectionalAStarSearch<CostTp>::cost_of_(const Side& side, uint_t v)const noexcept{
+
+    constexpr auto order = concurrent ? std::memory_order_seq_cst : std::memory_order_relaxed;
+
+    // the stamp is written after g so a matching stamp
+    // means g holds a cost of the current query
+    const auto stamp = std::atomic_ref<std::uint32_t>(const_cast<std::uint32_t&>(side.stamp[v])).load(order);
+    if(stamp != side.epoch){
+        return std::numeric_limits<cost_type>::infinity();
+    }
+
+    return std::atomic_ref<cost_type>(const_cast<cost_type&>(side.g[v])).load(order);
+}
+
+template<typename CostTp>
+template<bool concurrent>
+void
+BidirectionalAStarSearch<CostTp>::update_best_(cost_type cost, uint_t v){
+
+    if constexpr(concurrent){
+
+        std::lock_guard<std::mutex> lock(meet_mutex_);
+        if(cost < shared_best_.load(std::memory_order_relaxed)){
+            meet_ = v;
+            shared_best_.store(cost);
+        }
+    }
+    else{
+
+        if(cost < best_){
+            best_ = cost;
+            meet_ = v;
+        }
+    }
+}
+
+template<typename CostTp>
+template<bool concurrent, typename GraphTp, typename HeuristicFn, typename HeuristicOtherFn>
+void
+BidirectionalAStarSearch<CostTp>::expand_(Side& side, const Side& other, const GraphTp& graph,
+                                          const HeuristicFn& h, const HeuristicOtherFn& h_other){
+
+    const auto u = side.open.pop();
+    side.set_closed(u);
+    side.n_expanded += 1;
+
+    const auto gu = side.g[u];
+
+    // no path through u is cheaper than the best one found. In
+    // sequential mode the paths through a vertex the other side
+    // closed are known, its cost there is that of its shortest path
+    const auto best = concurrent ? shared_best_.load(std::memory_order_relaxed) : best_;
+    if(!(gu + static_cast<cost_type>(h(u)) < best)){
+        return;
+    }
+
+    if constexpr(!concurrent){
+        if(other.stamp[u] == other.epoch && other.is_closed(u)){
+            return;
+        }
+    }
+
+    graph.for_each_neighbor(u, [&](uint_t w, auto edge_cost){
+
+        const auto cost = static_cast<cost_type>(edge_cost);
+        if(cost == std::numeric_limits<cost_type>::infinity()){
+            return;
+        }
+
+        const auto tg = gu + cost;
+        if(side.stamp[w] != side.epoch){
+
+            label_<concurrent>(side, w, tg, u);
+            side.open.push(w, tg + potential_(h, h_other, w));
+        }
+        else{
+
+            // the reduced costs are non-negative, a closed
+            // vertex already has the cost of its shortest path
+            if(side.is_closed(w) || !(tg < side.g[w])){
+                return;
+            }
+
+            label_<concurrent>(side, w, tg, u);
+            side.open.decrease_key(w, tg + potential_(h, h_other, w));
+        }
+
+        const auto other_g = cost_of_<concurrent>(other, w);
+        if(other_g != std::numeric_limits<cost_type>::infinity()){
+            update_best_<concurrent>(tg + other_g, w);
+        }
+    });
+}
+
+template<typename CostTp>
+template<astar_graph_concept GraphTp, astar_graph_concept ReverseGraphTp,
+         typename HeuristicGoalFn, typename HeuristicStartFn>
+bool
+BidirectionalAStarSearch<CostTp>::search(const GraphTp& graph, const ReverseGraphTp& reverse_graph,
+                                         uint_t start, uint_t goal,
+                                         const HeuristicGoalFn& h_goal, const HeuristicStartFn& h_start){
+
+    const uint_t n = graph.n_vertices();
+    if(start >= n || goal >= n || reverse_graph.n_vertices() != n){
+        throw std::logic_error("Invalid start/goal vertex " + std::to_string(start) + "/" +
+                               std::to_string(goal) + " not in [0," + std::to_string(n) + ")"
+                               " or graphs of different size");
+    }
+
+    forward_.begin_query(n);
+    backward_.begin_query(n);
+
+    best_ = std::numeric_limits<cost_type>::infinity();
+    meet_ = npos;
+
+    label_<false>(forward_, start, cost_type(0), start);
+    forward_.open.push(start, potential_(h_goal, h_start, start));
+
+    label_<false>(backward_, goal, cost_type(0), goal);
+    backward_.open.push(goal, potential_(h_start, h_goal, goal));
+
+    if(start == goal){
+        best_ = cost_type(0);
+        meet_ = start;
+        return true;
+    }
+
+    if(concurrent_){
+        run_concurrent_(graph, reverse_graph, h_goal, h_start);
+    }
+    else{
+        run_sequential_(graph, reverse_graph, h_goal, h_start);
+    }
+
+    return meet_ != npos;
+}
+
+template<typename CostTp>
+template<typename GraphTp, typename ReverseGraphTp, typename HeuristicGoalFn, typename HeuristicStartFn>
+void
+BidirectionalAStarSearch<CostTp>::run_sequential_(const GraphTp& graph, const ReverseGraphTp& reverse_graph,
+                                                  const HeuristicGoalFn& h_goal, const HeuristicStartFn& h_start){
+
+    while(!forward_.open.empty() && !backward_.open.empty()){
+
+        // every path not found yet costs at least
+        // the sum of the two smallest keys
+        if(!(forward_.open.top_key() + backward_.open.top_key() < best_)){
+            break;
+        }
+
+        if(forward_.open.size() <= backward_.open.size()){
+            expand_<false>(forward_, backward_, graph, h_goal, h_start);
+        }
+        else{
+            expand_<false>(backward_, forward_, reverse_graph, h_start, h_goal);
+        }
+    }
+}
+
+template<typename CostTp>
+template<typename GraphTp, typename HeuristicFn, typename HeuristicOtherFn>
+void
+BidirectionalAStarSearch<CostTp>::run_side_(Side& side, Side& other, const GraphTp& graph,
+                                            const HeuristicFn& h, const HeuristicOtherFn& h_other){
+
+    while(!stop_.load(std::memory_order_relaxed)){
+
+        // the keys of a side never decrease, so the key the other side
+        // published is a lower bound of the key it has now
+        const auto top = side.open.empty() ? std::numeric_limits<cost_type>::infinity() : side.open.top_key();
+        side.top_key.store(top);
+
+        if(!(top + other.top_key.load() < shared_best_.load())){
+            stop_.store(true);
+            return;
+        }
+
+        expand_<true>(side, other, graph, h, h_other);
+    }
+}
+
+template<typename CostTp>
+template<typename GraphTp, typename ReverseGraphTp, typename HeuristicGoalFn, typename HeuristicStartFn>
+void
+BidirectionalAStarSearch<CostTp>::run_concurrent_(const GraphTp& graph, const ReverseGraphTp& reverse_graph,
+                                                  const HeuristicGoalFn& h_goal, const HeuristicStartFn& h_start){
+
+    forward_.top_key.store(forward_.open.top_key());
+    backward_.top_key.store(backward_.open.top_key());
+    shared_best_.store(std::numeric_limits<cost_type>::infinity());
+    stop_.store(false);
+
+    std::exception_ptr backward_error;
+    std::thread backward_thread([&](){
+
+        try{
+            run_side_(backward_, forward_, reverse_graph, h_start, h_goal);
+        }
+        catch(...){
+            backward_error = std::current_exception();
+            stop_.store(true);
+        }
+    });
+
+    std::exception_ptr forward_error;
+    try{
+        run_side_(forward_, backward_, graph, h_goal, h_start);
+    }
+    catch(...){
+        forward_error = std::current_exception();
+        stop_.store(true);
+    }
+
+    // a side that stops may still be finishing an expansion on
+    // the other thread, the best cost is final after the join
+    backward_thread.join();
+
+    if(forward_error){
+        std::rethrow_exception(forward_error);
+    }
+
+    if(backward_error){
+        std::rethrow_exception(backward_error);
+    }
+
+    best_ = shared_best_.load();
+}
+
+template<typename CostTp>
+void
+BidirectionalAStarSearch<CostTp>::path(std::vector<uint_t>& out)const{
+
+    out.clear();
+    if(meet_ == npos){
+        return;
+    }
+
+    // start -> meet along the forward parents
+    auto v = meet_;
+    out.push_back(v);
+    while(forward_.parent[v] != v){
+        v = forward_.parent[v];
+        out.push_back(v);
+    }
+
+    std::reverse(out.begin(), out.end());
+
+    // meet -> goal along the backward parents
+    v = meet_;
+    while(backward_.parent[v] != v){
+        v = backward_.parent[v];
+        out.push_back(v);
+    }
+}
+
+///
+/// \brief Bidirectional A* over a BoostSerialGraph. h(v1, v2) is called with
+/// vertex objects and gives both the cost of the edge between two neighbours
+/// and the heuristic estimate between two vertices, which should be
+/// consistent. Neighbours whose data reports can_move() false are not
+/// entered, as in a_star_search. Returns the vertex ids from start to end,
+/// empty if end cannot be reached
+///
+template<typename GraphTp, typename H>
+std::vector<uint_t>
+bidirectional_a_star_search(GraphTp& g, typename GraphTp::vertex_t& start, typename GraphTp::vertex_t& end,
+                            const H& h, bool concurrent=false){
+
+    typedef typename H::cost_type cost_t;
+    typedef typename GraphTp::vertex_t vertex_t;
+
+    // an edge v -> w is blocked when w cannot be entered. The reverse
+    // view walks the edges backwards, there the vertex left is checked
+    auto edge_cost = [&h](const vertex_t& cv, const vertex_t& nv){
+
+        if constexpr(requires{ nv.data.can_move(); }){
+            if(!nv.data.can_move()){
+                return std::numeric_limits<cost_t>::infinity();
+            }
+        }
+
+        return static_cast<cost_t>(h(cv, nv));
+    };
+
+    auto reverse_edge_cost = [&h](const vertex_t& cv, const vertex_t& nv){
+
+        if constexpr(requires{ cv.data.can_move(); }){
+            if(!cv.data.can_move()){
+                return std::numeric_limits<cost_t>::infinity();
+            }
+        }
+
+        return static_cast<cost_t>(h(nv, cv));
+    };
+
+    astar_impl::BoostGraphView<GraphTp, decltype(edge_cost)> view(g, edge_cost);
+    astar_impl::BoostGraphView<GraphTp, decltype(reverse_edge_cost)> reverse_view(g, reverse_edge_cost);
+
+    BidirectionalAStarSearch<cost_t> engine(g.n_vertices(), concurrent);
+    engine.search(view, reverse_view, start.id, end.id,
+                  [&](uint_t v){return static_cast<cost_t>(h(g.get_vertex(v), end));},
+                  [&](uint_t v){return static_cast<cost_t>(h(start, g.get_vertex(v)));});
+
+    return engine.path();
+}
+
+}
+
+#endif // BIDIRECTIONAL_A_STAR_SEARCH_H
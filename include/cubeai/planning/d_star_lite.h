@@ -0,0 +1,525 @@
+#ifndef D_STAR_LITE_H
+#define D_STAR_LITE_H
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/planning/a_star_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace cubeai{
+
+///
+/// \brief The DStarLite class. D* Lite (Koenig and Likhachev) over the vertex
+/// ids of a graph that models astar_graph_concept. The search runs from the
+/// goal towards the start and keeps its g and rhs values and its priority
+/// queue between plans. When edge costs change only the vertices whose
+/// shortest path changes are expanded again, so replanning after a small map
+/// edit costs a fraction of a search from scratch.
+///
+/// The graph is held by reference and edited by the caller, who reports the
+/// vertices whose outgoing edges changed with update_vertices, or, for graphs
+/// with for_each_adjacent like GridGraph, the cells that were blocked or
+/// freed with update_cells. Every edge should exist in both directions with
+/// the same cost, which GridGraph guarantees; the predecessors of a vertex are
+/// then its neighbours. h(v, w) estimates the cost between two vertices and
+/// should be consistent and satisfy the triangle inequality
+///
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp=real_t>
+class DStarLite
+{
+public:
+
+    typedef GraphTp graph_type;
+    typedef CostTp cost_type;
+
+    static constexpr uint_t npos = CubeAIConsts::INVALID_SIZE_TYPE;
+
+    ///
+    /// \brief Constructor. The graph should outlive the object
+    ///
+    DStarLite(const graph_type& graph, const HeuristicFn& h);
+
+    ///
+    /// \brief initialize. Forget the previous plans and plan from start to goal
+    /// on the next call of plan
+    ///
+    void initialize(uint_t start, uint_t goal);
+
+    ///
+    /// \brief plan. Repair the shortest path from the current start to the goal.
+    /// Returns true if the goal is reachable
+    ///
+    bool plan();
+
+    ///
+    /// \brief set_start. Move the start, e.g. to the vertex the robot reached
+    ///
+    void set_start(uint_t start);
+
+    ///
+    /// \brief update_vertices. Report a batch of vertices whose outgoing edge
+    /// costs changed. Duplicates are ignored. Call plan to replan
+    ///
+    template<typename RangeTp>
+    void update_vertices(const RangeTp& vertices);
+
+    ///
+    /// \brief update_cells. Report a batch of cells that were blocked or freed.
+    /// The cells and the cells adjacent to them are updated. The graph should
+    /// have for_each_adjacent(v, fn) like GridGraph
+    ///
+    template<typename RangeTp>
+    void update_cells(const RangeTp& cells);
+
+    ///
+    /// \brief start
+    ///
+    uint_t start()const noexcept{return start_;}
+
+    ///
+    /// \brief goal
+    ///
+    uint_t goal()const noexcept{return goal_;}
+
+    ///
+    /// \brief cost. The cost from the start to the goal after the last plan.
+    /// Infinite if the goal is not reachable
+    ///
+    cost_type cost()const noexcept{return start_ == npos ? infinity() : g_[start_];}
+
+    ///
+    /// \brief g_cost. The cost from v to the goal after the last plan,
+    /// exact for the vertices the plan needed
+    ///
+    cost_type g_cost(uint_t v)const noexcept{return g_[v];}
+
+    ///
+    /// \brief next. The neighbour of v on a cheapest path to the goal.
+    /// npos if there is none
+    ///
+    uint_t next(uint_t v)const;
+
+    ///
+    /// \brief path. The vertices from the start to the goal after the
+    /// last plan. Empty if the goal is not reachable
+    ///
+    void path(std::vector<uint_t>& out)const;
+
+    ///
+    /// \brief path. The vertices from the start to the goal
+    ///
+    std::vector<uint_t> path()const{std::vector<uint_t> out; path(out); return out;}
+
+    ///
+    /// \brief n_expanded. Number of vertices expanded by the last plan
+    ///
+    uint_t n_expanded()const noexcept{return n_expanded_;}
+
+private:
+
+    ///
+    /// \brief The Key struct. The priority (k1, k2) of a vertex and the
+    /// vertex. The queue orders the keys exactly and lexicographically with
+    /// the vertex id last, so ties are broken the same way on every run
+    ///
+    struct Key
+    {
+        cost_type k1;
+        cost_type k2;
+        uint_t v;
+
+        bool operator<(const Key& other)const noexcept{
+
+            if(k1 != other.k1){
+                return k1 < other.k1;
+            }
+
+            if(k2 != other.k2){
+                return k2 < other.k2;
+            }
+
+            return v < other.v;
+        }
+    };
+
+    const graph_type& graph_;
+    HeuristicFn h_;
+
+    std::vector<cost_type> g_;
+    std::vector<cost_type> rhs_;
+    astar_impl::IndexedMinHeap<Key> open_;
+
+    uint_t start_;
+    uint_t goal_;
+
+    ///
+    /// \brief The start when the last edge costs changed
+    ///
+    uint_t last_start_;
+
+    ///
+    /// \brief The key modifier. The sum of the heuristic distances the start
+    /// moved, so the keys in the queue stay valid after the start moves
+    ///
+    cost_type km_;
+
+    ///
+    /// \brief Marks the vertices of the batch being updated
+    ///
+    std::vector<std::uint32_t> batch_stamp_;
+    std::uint32_t batch_epoch_;
+
+    uint_t n_expanded_;
+
+    static constexpr cost_type infinity()noexcept{return std::numeric_limits<cost_type>::infinity();}
+
+    Key calculate_key_(uint_t v)const;
+
+    ///
+    /// \brief may_precede_. The stop test of plan. In exact arithmetic a
+    /// vertex on a shortest path may have the k1 of the start and a smaller
+    /// k2, and must be expanded before the start. Its computed k1 can round
+    /// above that of the start, so every vertex whose k1 is within a bound of
+    /// the accumulated rounding of the start k1 is expanded. Expanding more
+    /// vertices than needed costs time but never makes the plan wrong
+    ///
+    static bool may_precede_(const Key& top, const Key& start)noexcept;
+
+    ///
+    /// \brief min_successor_cost_. min over the edges v -> w of c(v, w) + g(w)
+    ///
+    cost_type min_successor_cost_(uint_t v)const;
+
+    ///
+    /// \brief update_vertex_. Recompute rhs(v) and fix its place in the queue
+    ///
+    void update_vertex_(uint_t v);
+
+    ///
+    /// \brief queue_vertex_. Fix the place of v in the queue after g or rhs changed
+    ///
+    void queue_vertex_(uint_t v);
+
+    ///
+    /// \brief begin_batch_. Account for the start that moved since
+    /// the last change and start a new batch of updates
+    ///
+    void begin_batch_();
+
+    ///
+    /// \brief in_batch_. Mark v in the current batch; false if it was already
+    ///
+    bool in_batch_(uint_t v)noexcept;
+
+    void check_vertex_(uint_t v)const;
+};
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+DStarLite<GraphTp, HeuristicFn, CostTp>::DStarLite(const graph_type& graph, const HeuristicFn& h)
+    :
+      graph_(graph),
+      h_(h),
+      g_(),
+      rhs_(),
+      open_(),
+      start_(npos),
+      goal_(npos),
+      last_start_(npos),
+      km_(0),
+      batch_stamp_(),
+      batch_epoch_(0),
+      n_expanded_(0)
+{}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+void
+DStarLite<GraphTp, HeuristicFn, CostTp>::check_vertex_(uint_t v)const{
+
+    if(v >= graph_.n_vertices()){
+        throw std::logic_error("Invalid vertex " + std::to_string(v) +
+                               " not in [0," + std::to_string(graph_.n_vertices()) + ")");
+    }
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+void
+DStarLite<GraphTp, HeuristicFn, CostTp>::initialize(uint_t start, uint_t goal){
+
+    check_vertex_(start);
+    check_vertex_(goal);
+
+    const uint_t n = graph_.n_vertices();
+    g_.assign(n, infinity());
+    rhs_.assign(n, infinity());
+    open_.resize(n);
+    batch_stamp_.assign(n, 0);
+    batch_epoch_ = 0;
+
+    start_ = start;
+    goal_ = goal;
+    last_start_ = start;
+    km_ = cost_type(0);
+    n_expanded_ = 0;
+
+    rhs_[goal_] = cost_type(0);
+    open_.push(goal_, calculate_key_(goal_));
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+typename DStarLite<GraphTp, HeuristicFn, CostTp>::Key
+DStarLite<GraphTp, HeuristicFn, CostTp>::calculate_key_(uint_t v)const{
+
+    const auto k2 = std::min(g_[v], rhs_[v]);
+    return Key{k2 + static_cast<cost_type>(h_(start_, v)) + km_, k2, v};
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+bool
+DStarLite<GraphTp, HeuristicFn, CostTp>::may_precede_(const Key& top, const Key& start)noexcept{
+
+    if constexpr(std::is_floating_point_v<cost_type>){
+        if(std::isfinite(start.k1)){
+
+            // the relative rounding of a sum of n terms is about
+            // n * epsilon, this covers paths of 1e8 edges
+            const auto bound = std::sqrt(std::numeric_limits<cost_type>::epsilon()) * (1 + std::abs(start.k1));
+            return top.k1 <= start.k1 + bound;
+        }
+    }
+
+    return top.k1 < start.k1 || (top.k1 == start.k1 && top.k2 < start.k2);
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+typename DStarLite<GraphTp, HeuristicFn, CostTp>::cost_type
+DStarLite<GraphTp, HeuristicFn, CostTp>::min_successor_cost_(uint_t v)const{
+
+    auto best = infinity();
+    graph_.for_each_neighbor(v, [&](uint_t w, auto edge_cost){
+        best = std::min(best, static_cast<cost_type>(edge_cost) + g_[w]);
+    });
+
+    return best;
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+void
+DStarLite<GraphTp, HeuristicFn, CostTp>::queue_vertex_(uint_t v){
+
+    if(g_[v] != rhs_[v]){
+        open_.update(v, calculate_key_(v));
+    }
+    else{
+        open_.erase(v);
+    }
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+void
+DStarLite<GraphTp, HeuristicFn, CostTp>::update_vertex_(uint_t v){
+
+    if(v != goal_){
+        rhs_[v] = min_successor_cost_(v);
+    }
+
+    queue_vertex_(v);
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+bool
+DStarLite<GraphTp, HeuristicFn, CostTp>::plan(){
+
+    if(start_ == npos){
+        throw std::logic_error("DStarLite::initialize should be called before plan");
+    }
+
+    n_expanded_ = 0;
+
+    // the start is expanded too, so its g is the cost of the path
+    while(!open_.empty() &&
+          (may_precede_(open_.top_key(), calculate_key_(start_)) || rhs_[start_] != g_[start_])){
+
+        const auto u = open_.top();
+        const auto k_old = open_.top_key();
+        const auto k_new = calculate_key_(u);
+
+        if(k_old.k1 < k_new.k1 || (k_old.k1 == k_new.k1 && k_old.k2 < k_new.k2)){
+
+            // the key is stale, the start moved since it was computed
+            open_.update(u, k_new);
+            continue;
+        }
+
+        n_expanded_ += 1;
+
+        if(g_[u] > rhs_[u]){
+
+            // overconsistent, u gets its cost and its
+            // predecessors may now go through it
+            g_[u] = rhs_[u];
+            open_.erase(u);
+
+            const auto gu = g_[u];
+            graph_.for_each_neighbor(u, [&](uint_t s, auto edge_cost){
+
+                const auto through_u = static_cast<cost_type>(edge_cost) + gu;
+                if(s != goal_ && through_u < rhs_[s]){
+                    rhs_[s] = through_u;
+                    queue_vertex_(s);
+                }
+            });
+        }
+        else{
+
+            // underconsistent, the predecessors that
+            // went through u look for another successor
+            const auto g_old = g_[u];
+            g_[u] = infinity();
+
+            graph_.for_each_neighbor(u, [&](uint_t s, auto edge_cost){
+                if(s != goal_ && rhs_[s] == static_cast<cost_type>(edge_cost) + g_old){
+                    update_vertex_(s);
+                }
+            });
+
+            update_vertex_(u);
+        }
+    }
+
+    return g_[start_] != infinity();
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+void
+DStarLite<GraphTp, HeuristicFn, CostTp>::set_start(uint_t start){
+
+    check_vertex_(start);
+    start_ = start;
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+void
+DStarLite<GraphTp, HeuristicFn, CostTp>::begin_batch_(){
+
+    if(start_ == npos){
+        throw std::logic_error("DStarLite::initialize should be called before updating vertices");
+    }
+
+    km_ += static_cast<cost_type>(h_(last_start_, start_));
+    last_start_ = start_;
+
+    batch_epoch_ += 1;
+    if(batch_epoch_ == 0){
+        std::fill(batch_stamp_.begin(), batch_stamp_.end(), 0);
+        batch_epoch_ = 1;
+    }
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+bool
+DStarLite<GraphTp, HeuristicFn, CostTp>::in_batch_(uint_t v)noexcept{
+
+    if(batch_stamp_[v] == batch_epoch_){
+        return false;
+    }
+
+    batch_stamp_[v] = batch_epoch_;
+    return true;
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+template<typename RangeTp>
+void
+DStarLite<GraphTp, HeuristicFn, CostTp>::update_vertices(const RangeTp& vertices){
+
+    begin_batch_();
+    for(auto v : vertices){
+
+        check_vertex_(v);
+        if(in_batch_(v)){
+            update_vertex_(v);
+        }
+    }
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+template<typename RangeTp>
+void
+DStarLite<GraphTp, HeuristicFn, CostTp>::update_cells(const RangeTp& cells){
+
+    begin_batch_();
+    for(auto c : cells){
+
+        check_vertex_(c);
+        if(in_batch_(c)){
+            update_vertex_(c);
+        }
+
+        graph_.for_each_adjacent(c, [this](uint_t w){
+            if(in_batch_(w)){
+                update_vertex_(w);
+            }
+        });
+    }
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+uint_t
+DStarLite<GraphTp, HeuristicFn, CostTp>::next(uint_t v)const{
+
+    auto best = infinity();
+    auto best_w = npos;
+    graph_.for_each_neighbor(v, [&](uint_t w, auto edge_cost){
+
+        const auto cost = static_cast<cost_type>(edge_cost) + g_[w];
+        if(cost < best){
+            best = cost;
+            best_w = w;
+        }
+    });
+
+    return best_w;
+}
+
+template<astar_graph_concept GraphTp, typename HeuristicFn, typename CostTp>
+void
+DStarLite<GraphTp, HeuristicFn, CostTp>::path(std::vector<uint_t>& out)const{
+
+    out.clear();
+    if(cost() == infinity()){
+        return;
+    }
+
+    auto v = start_;
+    out.push_back(v);
+
+    // the g values decrease along the path, the
+    // bound only guards against a graph edited
+    // without telling the planner
+    while(v != goal_ && out.size() <= g_.size()){
+
+        v = next(v);
+        if(v == npos){
+            out.clear();
+            return;
+        }
+
+        out.push_back(v);
+    }
+
+    if(v != goal_){
+        out.clear();
+    }
+}
+
+}
+
+#endif // D_STAR_LITE_H
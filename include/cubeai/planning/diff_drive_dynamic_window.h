@@ -1,26 +1,17 @@
 #ifndef DIFF_DRIVE_DYNAMIC_WINDOW_H
 #define DIFF_DRIVE_DYNAMIC_WINDOW_H
-#include "cubic_engine/base/config.h"
 
-#ifdef USE_PLANNING
-
-#include "cubic_engine/base/cubic_engine_types.h"
-#include "kernel/dynamics/diff_drive_dynamics.h"
-#include "kernel/geometry/bounding_box_type.h"
-#include "kernel/dynamics/system_state.h"
-#include "kernel/geometry/geom_point.h"
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/geom_primitives/geom_point.h"
+#include "cubeai/planning/obstacle_distance_map.h"
 
 #include <vector>
 #include <array>
 #include <limits>
 #include <cmath>
 
-#ifdef USE_WARNINGS_FOR_MISSING_IMPLEMENTATION
-#include <iostream>
-#include "kernel/base/kernel_consts.h"
-#endif
-
-namespace cengine{
+namespace cubeai{
 namespace planning {
 
 ///
@@ -47,9 +38,19 @@ struct DiffDriveDWConfig
       real_t to_goal_cost_gain;
       real_t obstacle_cost_gain;
       real_t robot_stuck_flag_cons;
-      kernel::dynamics::DiffDriveDynamics::DynamicVersion dynamics_version;
-      kernel::geom::BBType bbtype;
       bool show_warnigs{true};
+
+      ///
+      /// \brief parallel_rollout. If true the blocks of
+      /// candidates are rolled out and scored in parallel
+      ///
+      bool parallel_rollout{false};
+
+      ///
+      /// \brief rollout_block_size. The number of candidates
+      /// rolled out together. A block is the unit of parallel work
+      ///
+      uint_t rollout_block_size{128};
 };
 
 ///
@@ -67,31 +68,46 @@ struct DiffDriveWindowProperties
 /// \brief DiffDriveDW class. Dynamic window approach for
 /// differential drive systems. This class is an implementation
 /// from: https://github.com/onlytailei/CppRobotics/blob/master/src/dynamic_window_approach.cpp
+/// Every (v, w) pair of the window is a candidate. A candidate keeps v and
+/// w constant so its trajectory is an arc of the unicycle which is written
+/// in closed form; the headings of the steps follow from one rotation per
+/// candidate so the rollout has no trigonometric calls per step. The
+/// candidates are rolled out in blocks over arrays with one entry per
+/// candidate and every step is scored against every obstacle as one pass
+/// over the block. Only the index of the best candidate is kept, its
+/// trajectory is recomputed on request
 ///
 class DiffDriveDW
 {
 public:
 
     ///
-    /// \brief state_t. The type of the state used by the window
+    /// \brief state_t. The type of the state used by the window.
+    /// The entries are indexed by X, Y, THETA, V and W
     ///
-    typedef kernel::dynamics::SysState<5> state_t;
+    typedef std::array<real_t, 5> state_t;
+
+    static constexpr uint_t X = 0;
+    static constexpr uint_t Y = 1;
+    static constexpr uint_t THETA = 2;
+    static constexpr uint_t V = 3;
+    static constexpr uint_t W = 4;
 
     ///
     /// \brief goal_t. The type of the goal
     ///
-    typedef kernel::GeomPoint<2> goal_t;
+    typedef geom_primitives::GeomPoint<2> goal_t;
 
     ///
     /// \brief control_t The type of the control input calculated by the
-    /// the application of the window
+    /// the application of the window, the speed and the yaw rate
     ///
-    typedef std::vector<real_t> control_t;
+    typedef std::array<real_t, 2> control_t;
 
     ///
     /// \brief trajectory_t Helper type used to form trajectories
     ///
-    typedef std::vector<std::array<real_t, 5>> trajectory_t;
+    typedef std::vector<state_t> trajectory_t;
 
     ///
     /// \brief config_t. Congiguration type used by the window
@@ -103,6 +119,11 @@ public:
     ///
     typedef DiffDriveWindowProperties window_properties_t;
 
+    ///
+    /// \brief npos The index returned when no candidate is collision free
+    ///
+    static constexpr uint_t npos = CubeAIConsts::INVALID_SIZE_TYPE;
+
     ///
     /// \brief DiffDriveDW. Constructor
     ///
@@ -120,10 +141,20 @@ public:
     window_properties_t& calculate_window();
 
     ///
-    /// \brief Given the obstacle type calculate the appropriate control
+    /// \brief Given the obstacles calculate the appropriate control and
+    /// return the index of the best candidate or npos if every candidate
+    /// collides. obstacle[i][0] and obstacle[i][1] are the coordinates
+    /// of the i-th obstacle point
     ///
     template<typename ObstacleTp>
-    trajectory_t dwa_control(const ObstacleTp& obstacle);
+    uint_t dwa_control(const ObstacleTp& obstacle);
+
+    ///
+    /// \brief Given the distance map of the obstacles calculate the
+    /// appropriate control. The distance of a trajectory point to the
+    /// obstacles is a lookup in the map
+    ///
+    uint_t dwa_control(const ObstacleDistanceMap& map);
 
     ///
     /// \brief update_dynamics_state. Update the state of
@@ -131,6 +162,43 @@ public:
     ///
     void update_state(const state_t& state){state_ = state;}
 
+    ///
+    /// \brief set_goal. Change the goal of the robot
+    ///
+    void set_goal(const goal_t& goal){goal_ = goal;}
+
+    ///
+    /// \brief n_candidates. The number of candidates of the last control cycle
+    ///
+    uint_t n_candidates()const noexcept{return v_.size();}
+
+    ///
+    /// \brief best_index. The index of the best candidate of the last control cycle
+    ///
+    uint_t best_index()const noexcept{return best_;}
+
+    ///
+    /// \brief candidate_control. The (v, w) of the i-th candidate
+    ///
+    control_t candidate_control(uint_t i)const{return {v_[i], w_[i]};}
+
+    ///
+    /// \brief candidate_cost. The cost of the i-th candidate,
+    /// infinite if the candidate collides
+    ///
+    real_t candidate_cost(uint_t i)const{return cost_[i];}
+
+    ///
+    /// \brief trajectory. The trajectory of the i-th candidate
+    ///
+    void trajectory(uint_t i, trajectory_t& out)const;
+
+    ///
+    /// \brief best_trajectory. The trajectory of the best
+    /// candidate, empty if every candidate collides
+    ///
+    trajectory_t best_trajectory()const;
+
 protected:
 
     ///
@@ -147,7 +215,7 @@ protected:
     /// \brief state_. The state descrbing the
     /// robot that the algorithm uses internally
     ///
-    kernel::dynamics::SysState<5> state_;
+    state_t state_;
 
     ///
     /// \brief config_. The congiration of thw window
@@ -162,136 +230,93 @@ protected:
     window_properties_t w_properties_;
 
     ///
-    /// \brief calculate_control_input_ Calculate the control inputs
+    /// \brief n_steps_ The number of integration steps over predict_time
     ///
-    template<typename ObstacleTp>
-    trajectory_t calculate_control_input_(const ObstacleTp& obstacle);
+    uint_t n_steps_;
 
     ///
-    /// \brief calc_trajectory_
+    /// \brief best_ The index of the best candidate
     ///
-    trajectory_t predict_trajectory_(real_t v, real_t w);
+    uint_t best_;
 
     ///
-    /// \brief calc_to_goal_cost_ Claculate the cost to the goal with the
-    /// given trajectory
+    /// \brief The candidates, one entry per (v, w) pair
     ///
-    real_t calc_to_goal_cost_(const trajectory_t& trajectory);
+    std::vector<real_t> v_;
+    std::vector<real_t> w_;
+    std::vector<real_t> cost_;
 
     ///
-    /// \brief calc_obstacle_cost_ Calculate the cost to obstacle
-    /// on the given trajectory. The cost is infinite if
-    /// collision occurs and 0 if not.
+    /// \brief The rollout state of the candidates. The heading
+    /// is rotated by (cos_dw_, sin_dw_) every step, the position
+    /// is arc_ * (sin - sin0, cos0 - cos) on a turn and
+    /// line_ * step * (cos0, sin0) on a straight line
     ///
-    template<typename ObstacleTp>
-    real_t calc_obstacle_cost_(const trajectory_t& trajectory, const ObstacleTp& obstacle);
-};
+    std::vector<real_t> arc_;
+    std::vector<real_t> line_;
+    std::vector<real_t> cos_dw_;
+    std::vector<real_t> sin_dw_;
+    std::vector<real_t> cos_;
+    std::vector<real_t> sin_;
+    std::vector<real_t> x_;
+    std::vector<real_t> y_;
+    std::vector<real_t> min_d2_;
 
-template<typename ObstacleTp>
-typename DiffDriveDW::trajectory_t
-DiffDriveDW::dwa_control(const ObstacleTp& obstacle){
-
-    // calculate the window
-    auto& window = calculate_window();
-
-    // calculate the control values based on the
-    // updated window properties
-    return calculate_control_input_(obstacle);
-}
-
-template<typename ObstacleTp>
-real_t
-DiffDriveDW::calc_obstacle_cost_(const trajectory_t& trajectory, const ObstacleTp& obstacle){
-
-    // calc obstacle cost max (inf): collistion, 0:free
-    auto minr = std::numeric_limits<real_t>::max();
-
-    for (auto ii=0; ii<trajectory.size(); ii += this->config_.skip_n){
-      for (auto i=0; i< obstacle.size(); i++){
+    ///
+    /// \brief The obstacle coordinates of the control cycle
+    ///
+    std::vector<real_t> ox_;
+    std::vector<real_t> oy_;
 
-        auto ox = obstacle[i][0];
-        auto oy = obstacle[i][1];
-        auto dx = trajectory[ii][0] - ox;
-        auto dy = trajectory[ii][1] - oy;
+    ///
+    /// \brief blocks_ The first candidate of every block
+    ///
+    std::vector<uint_t> blocks_;
 
-        float r = std::sqrt(dx*dx + dy*dy);
+    ///
+    /// \brief calculate_control_input_ Calculate the control inputs
+    /// for the obstacles in the map or in ox_ and oy_ if there is no map
+    ///
+    void calculate_control_input_(const ObstacleDistanceMap* map);
 
-        if (r <= this->config_.robot_radius){
-            return std::numeric_limits<real_t>::max();
-        }
+    ///
+    /// \brief build_candidates_. The (v, w) grid of the window
+    ///
+    void build_candidates_();
 
-        if (minr >= r){
-            minr = r;
-        }
-      }
-    }
+    ///
+    /// \brief rollout_ Roll out and score the candidates in [begin, end)
+    ///
+    void rollout_(uint_t begin, uint_t end, real_t min_d2_start, const ObstacleDistanceMap* map);
 
-    return 1.0 / minr;
-}
+    ///
+    /// \brief calc_to_goal_cost_ Claculate the cost to the goal
+    /// of a trajectory that ends at (x, y, theta)
+    ///
+    real_t calc_to_goal_cost_(real_t x, real_t y, real_t theta)const;
+};
 
+template<typename ObstacleTp>
+uint_t
+DiffDriveDW::dwa_control(const ObstacleTp& obstacle){
 
+    // calculate the window
+    calculate_window();
 
-template<typename ObstacleTp>
-DiffDriveDW::trajectory_t
-DiffDriveDW::calculate_control_input_(const ObstacleTp& obstacle){
-
-    auto min_cost = std::numeric_limits<real_t>::max(); //this->config_.min_cost;
-    auto min_u = control_;
-    min_u[0] = 0.0;
-    min_u[1] = 0.0;
-
-    auto v_min = w_properties_.v_min;
-    auto v_max = w_properties_.v_max;
-    auto w_min = w_properties_.w_min;
-    auto w_max = w_properties_.w_max;
-
-    // the best trajectory
-    trajectory_t best_traj;
-
-    // evalucate all trajectory with sampled input in dynamic window
-    for (auto v=v_min; v <= v_max; v += this->config_.v_reso){
-       for (auto w=w_min; w <= w_max; w += this->config_.yawrate_reso){
-
-
-
-            trajectory_t traj = predict_trajectory_(v, w);
-
-            // what's the cost reaching goal on this
-            // trajectory
-            auto to_goal_cost = this->config_.to_goal_cost_gain*calc_to_goal_cost_(traj);
-            auto speed_cost = this->config_.speed_cost_gain * (this->config_.max_speed - traj.back()[3]);
-            auto ob_cost = this->config_.obstacle_cost_gain*calc_obstacle_cost_(traj, obstacle);
-
-            // final cost
-            auto final_cost = to_goal_cost + speed_cost + ob_cost;
-
-            // we want minimum cost trajectory
-            if (min_cost >= final_cost){
-                  min_cost = final_cost;
-                  min_u[0] = v;
-                  min_u[1] = w; //control_t{{v, w}};
-                  best_traj = traj;
-
-                  if(std::fabs(min_u[0]) < config_.robot_stuck_flag_cons &&
-                     std::fabs(state_["v"]) < config_.robot_stuck_flag_cons){
-                       // to ensure the robot do not get stuck in
-                       // best v=0 m/s (in front of an obstacle) and
-                       // best omega=0 rad/s (heading to the goal with
-                       // angle difference of 0)
-                       min_u[1] = -config_.max_delta_yaw_rate;
-                  }
-            }
-        }
+    ox_.resize(obstacle.size());
+    oy_.resize(obstacle.size());
+    for(uint_t i=0; i<obstacle.size(); ++i){
+        ox_[i] = obstacle[i][0];
+        oy_[i] = obstacle[i][1];
     }
 
-    // update the control and return the best
-    // trajectory
-    control_ = min_u;
-    return best_traj;
+    // calculate the control values based on the
+    // updated window properties
+    calculate_control_input_(nullptr);
+    return best_;
 }
 
-
 }
 }
-#endif
+
 #endif // DIFF_DRIVE_DYNAMIC_WINDOW_H
@@ -0,0 +1,341 @@
+#ifndef JUMP_POINT_SEARCH_H
+#define JUMP_POINT_SEARCH_H
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/data_structs/grid_graph.h"
+#include "cubeai/planning/a_star_search.h"
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+namespace cubeai{
+
+///
+/// \brief The JumpPointSearch class. Jump Point Search (Harabor and Grastien)
+/// on a uniform cost 2D GridGraph with FULL connectivity. It is A* over jump
+/// points: the successors of a cell are found by scanning from it in the
+/// directions that remain after pruning the ones with a symmetric path that
+/// does not go through the cell, and stopping at the first cell with a forced
+/// neighbour. The rules are those of the variant that never cuts corners, in
+/// line with the moves of GridGraph, so the paths have the same cost as the
+/// paths of A* on the grid while far fewer vertices reach the open list. The
+/// search over the jump points is an AStarSearch, so the engine is reused
+/// across queries like AStarSearch is
+///
+class JumpPointSearch
+{
+public:
+
+    typedef GridGraph<2> grid_type;
+
+    ///
+    /// \brief Constructor. The grid should outlive the object
+    ///
+    explicit JumpPointSearch(const grid_type& grid);
+
+    ///
+    /// \brief search. Find a cheapest path from start to goal
+    ///
+    bool search(uint_t start, uint_t goal);
+
+    ///
+    /// \brief jump_points. The jump points from start to v of the last search
+    ///
+    void jump_points(uint_t v, std::vector<uint_t>& out)const{engine_.path(v, out);}
+
+    ///
+    /// \brief path. Every cell from start to v of the last search
+    ///
+    void path(uint_t v, std::vector<uint_t>& out)const;
+
+    ///
+    /// \brief cost. The cost from start to v of the last search
+    ///
+    real_t cost(uint_t v)const noexcept{return engine_.g_cost(v);}
+
+    ///
+    /// \brief n_expanded. Number of jump points expanded by the last search
+    ///
+    uint_t n_expanded()const noexcept{return engine_.n_expanded();}
+
+    ///
+    /// \brief n_scanned. Number of cells the jumps of the last search visited
+    ///
+    uint_t n_scanned()const noexcept{return n_scanned_;}
+
+private:
+
+    ///
+    /// \brief The SuccessorGraph class. The jump points as a graph. The
+    /// successors of a cell depend on the direction it was reached from,
+    /// which is read from the parent the engine recorded
+    ///
+    class SuccessorGraph
+    {
+    public:
+
+        explicit SuccessorGraph(JumpPointSearch& jps)
+            :
+              jps_(jps)
+        {}
+
+        uint_t n_vertices()const{return jps_.grid_.n_vertices();}
+
+        template<typename Fn>
+        void for_each_neighbor(uint_t v, Fn&& fn)const{jps_.successors_(v, fn);}
+
+    private:
+
+        JumpPointSearch& jps_;
+    };
+
+    const grid_type& grid_;
+    AStarSearch<real_t> engine_;
+    uint_t goal_;
+    long nx_;
+    uint_t n_scanned_;
+
+    bool walkable_(long x, long y)const noexcept{
+        return x >= 0 && y >= 0 && x < nx_ && y < static_cast<long>(grid_.sizes()[1]) &&
+               grid_.is_free(static_cast<uint_t>(x + nx_ * y));
+    }
+
+    uint_t id_(long x, long y)const noexcept{return static_cast<uint_t>(x + nx_ * y);}
+
+    ///
+    /// \brief jump_. Scan from (x, y) along (dx, dy) and return the first
+    /// jump point or npos. (x, y) is the cell the scan starts at
+    ///
+    uint_t jump_(long x, long y, long dx, long dy);
+
+    ///
+    /// \brief jump_straight_. jump_ for a horizontal or vertical direction
+    ///
+    uint_t jump_straight_(long x, long y, long dx, long dy);
+
+    ///
+    /// \brief successors_. Call fn(w, cost) for the jump points reachable from v
+    ///
+    template<typename Fn>
+    void successors_(uint_t v, Fn& fn);
+
+    ///
+    /// \brief octile_. The cost of the straight or diagonal segment between two cells
+    ///
+    real_t octile_(uint_t v, uint_t w)const noexcept{return grid_.heuristic(v, w);}
+};
+
+inline
+JumpPointSearch::JumpPointSearch(const grid_type& grid)
+    :
+      grid_(grid),
+      engine_(grid.n_vertices()),
+      goal_(CubeAIConsts::INVALID_SIZE_TYPE),
+      nx_(static_cast<long>(grid.sizes()[0])),
+      n_scanned_(0)
+{
+    if(grid_.connectivity() != GridConnectivity::FULL){
+        throw std::logic_error("JumpPointSearch needs a grid with FULL connectivity");
+    }
+}
+
+inline
+bool
+JumpPointSearch::search(uint_t start, uint_t goal){
+
+    goal_ = goal;
+    n_scanned_ = 0;
+
+    SuccessorGraph graph(*this);
+    return engine_.search(graph, start, goal, [this](uint_t v){return grid_.heuristic(v, goal_);});
+}
+
+inline
+uint_t
+JumpPointSearch::jump_straight_(long x, long y, long dx, long dy){
+
+    while(true){
+
+        if(!walkable_(x, y)){
+            return CubeAIConsts::INVALID_SIZE_TYPE;
+        }
+
+        n_scanned_ += 1;
+        const auto v = id_(x, y);
+        if(v == goal_){
+            return v;
+        }
+
+        // a blocked cell behind a free side cell forces a turn
+        if(dx != 0){
+            if((walkable_(x, y - 1) && !walkable_(x - dx, y - 1)) ||
+               (walkable_(x, y + 1) && !walkable_(x - dx, y + 1))){
+                return v;
+            }
+        }
+        else{
+            if((walkable_(x - 1, y) && !walkable_(x - 1, y - dy)) ||
+               (walkable_(x + 1, y) && !walkable_(x + 1, y - dy))){
+                return v;
+            }
+        }
+
+        x += dx;
+        y += dy;
+    }
+}
+
+inline
+uint_t
+JumpPointSearch::jump_(long x, long y, long dx, long dy){
+
+    if(dx == 0 || dy == 0){
+        return jump_straight_(x, y, dx, dy);
+    }
+
+    while(true){
+
+        if(!walkable_(x, y)){
+            return CubeAIConsts::INVALID_SIZE_TYPE;
+        }
+
+        n_scanned_ += 1;
+        const auto v = id_(x, y);
+        if(v == goal_){
+            return v;
+        }
+
+        // a diagonal cell is a jump point if one
+        // of its straight scans finds a jump point
+        if(jump_straight_(x + dx, y, dx, 0) != CubeAIConsts::INVALID_SIZE_TYPE ||
+           jump_straight_(x, y + dy, 0, dy) != CubeAIConsts::INVALID_SIZE_TYPE){
+            return v;
+        }
+
+        // no corner cutting
+        if(!walkable_(x + dx, y) || !walkable_(x, y + dy)){
+            return CubeAIConsts::INVALID_SIZE_TYPE;
+        }
+
+        x += dx;
+        y += dy;
+    }
+}
+
+template<typename Fn>
+void
+JumpPointSearch::successors_(uint_t v, Fn& fn){
+
+    const auto x = static_cast<long>(v % static_cast<uint_t>(nx_));
+    const auto y = static_cast<long>(v / static_cast<uint_t>(nx_));
+
+    // the directions to scan
+    std::array<std::array<long, 2>, 8> dirs;
+    uint_t n_dirs = 0;
+
+    const auto parent = engine_.parent(v);
+    if(parent == v){
+
+        // the start cell, every move of the grid
+        grid_.for_each_neighbor(v, [&](uint_t w, real_t){
+            dirs[n_dirs++] = {static_cast<long>(w % static_cast<uint_t>(nx_)) - x,
+                              static_cast<long>(w / static_cast<uint_t>(nx_)) - y};
+        });
+    }
+    else{
+
+        const auto px = static_cast<long>(parent % static_cast<uint_t>(nx_));
+        const auto py = static_cast<long>(parent / static_cast<uint_t>(nx_));
+        const long dx = (x > px) - (x < px);
+        const long dy = (y > py) - (y < py);
+
+        if(dx != 0 && dy != 0){
+
+            const auto walk_x = walkable_(x + dx, y);
+            const auto walk_y = walkable_(x, y + dy);
+            if(walk_y){ dirs[n_dirs++] = {0, dy}; }
+            if(walk_x){ dirs[n_dirs++] = {dx, 0}; }
+            if(walk_x && walk_y){ dirs[n_dirs++] = {dx, dy}; }
+        }
+        else if(dx != 0){
+
+            // a side cell is a forced neighbour only when the cell
+            // behind it is blocked, otherwise a path of the same cost
+            // reaches it without going through (x, y)
+            const auto next = walkable_(x + dx, y);
+            const auto up = walkable_(x, y + 1) && !walkable_(x - dx, y + 1);
+            const auto down = walkable_(x, y - 1) && !walkable_(x - dx, y - 1);
+            if(next){ dirs[n_dirs++] = {dx, 0}; }
+            if(up){
+                dirs[n_dirs++] = {0, 1};
+                if(next){ dirs[n_dirs++] = {dx, 1}; }
+            }
+            if(down){
+                dirs[n_dirs++] = {0, -1};
+                if(next){ dirs[n_dirs++] = {dx, -1}; }
+            }
+        }
+        else{
+
+            const auto next = walkable_(x, y + dy);
+            const auto right = walkable_(x + 1, y) && !walkable_(x + 1, y - dy);
+            const auto left = walkable_(x - 1, y) && !walkable_(x - 1, y - dy);
+            if(next){ dirs[n_dirs++] = {0, dy}; }
+            if(right){
+                dirs[n_dirs++] = {1, 0};
+                if(next){ dirs[n_dirs++] = {1, dy}; }
+            }
+            if(left){
+                dirs[n_dirs++] = {-1, 0};
+                if(next){ dirs[n_dirs++] = {-1, dy}; }
+            }
+        }
+    }
+
+    for(uint_t d=0; d<n_dirs; ++d){
+
+        const auto w = jump_(x + dirs[d][0], y + dirs[d][1], dirs[d][0], dirs[d][1]);
+        if(w != CubeAIConsts::INVALID_SIZE_TYPE){
+            fn(w, octile_(v, w));
+        }
+    }
+}
+
+inline
+void
+JumpPointSearch::path(uint_t v, std::vector<uint_t>& out)const{
+
+    std::vector<uint_t> points;
+    engine_.path(v, points);
+
+    out.clear();
+    if(points.empty()){
+        return;
+    }
+
+    out.push_back(points.front());
+    for(uint_t p=1; p<points.size(); ++p){
+
+        // consecutive jump points lie on a straight or a diagonal line
+        auto x = static_cast<long>(points[p - 1] % static_cast<uint_t>(nx_));
+        auto y = static_cast<long>(points[p - 1] / static_cast<uint_t>(nx_));
+        const auto tx = static_cast<long>(points[p] % static_cast<uint_t>(nx_));
+        const auto ty = static_cast<long>(points[p] / static_cast<uint_t>(nx_));
+        const long dx = (tx > x) - (tx < x);
+        const long dy = (ty > y) - (ty < y);
+
+        while(x != tx || y != ty){
+            x += dx;
+            y += dy;
+            out.push_back(id_(x, y));
+        }
+    }
+}
+
+}
+
+#endif // JUMP_POINT_SEARCH_H
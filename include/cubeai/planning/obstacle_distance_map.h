@@ -0,0 +1,260 @@
+#ifndef OBSTACLE_DISTANCE_MAP_H
+#define OBSTACLE_DISTANCE_MAP_H
+
+#include "cubeai/base/cubeai_types.h"
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+namespace cubeai{
+namespace planning {
+
+///
+/// \brief The ObstacleDistanceMap class. Occupancy grid with the
+/// Euclidean distance of every cell to the closest occupied cell.
+/// Distances are truncated at max_distance so a change of a cell only
+/// affects the cells closer than max_distance to it. Changes are
+/// collected and applied by update() which recomputes the distance
+/// transform over the changed region only. Querying the distance of a
+/// point is a cell lookup. Distances are measured between cell centers
+///
+/// The map trades accuracy for the lookup. A point is moved to the center
+/// of its cell, so the distance of a point is off by up to a cell diagonal,
+/// and every distance at or beyond max_distance reads max_distance. A cost
+/// computed from the map is therefore close to, but not the same as, one
+/// computed from the points, and max_distance should cover the range over
+/// which the cost still changes.
+///
+/// The points are counted per cell. A cell stays occupied until every
+/// point added to it is removed, so removing the previous scan does not
+/// free a cell a point of the current scan still falls in. set_occupied
+/// overrides the count
+///
+class ObstacleDistanceMap
+{
+public:
+
+    ///
+    /// \brief ObstacleDistanceMap. The map covers
+    /// [x_min, x_min + nx*resolution) x [y_min, y_min + ny*resolution).
+    /// All the cells are free
+    ///
+    ObstacleDistanceMap(real_t x_min, real_t y_min, uint_t nx, uint_t ny,
+                        real_t resolution, real_t max_distance);
+
+    ///
+    /// \brief nx. Number of cells along x
+    ///
+    uint_t nx()const noexcept{return nx_;}
+
+    ///
+    /// \brief ny. Number of cells along y
+    ///
+    uint_t ny()const noexcept{return ny_;}
+
+    ///
+    /// \brief resolution. The side of a cell
+    ///
+    real_t resolution()const noexcept{return resolution_;}
+
+    ///
+    /// \brief max_distance. The distance of the cells with no
+    /// occupied cell closer than max_distance
+    ///
+    real_t max_distance()const noexcept{return max_distance_;}
+
+    ///
+    /// \brief is_inside. Returns true if the point is on the map
+    ///
+    bool is_inside(real_t x, real_t y)const noexcept;
+
+    ///
+    /// \brief cell_x. The column of the x coordinate. The point should be on the map
+    ///
+    uint_t cell_x(real_t x)const noexcept{return std::min(static_cast<uint_t>((x - x_min_) * inv_resolution_), nx_ - 1);}
+
+    ///
+    /// \brief cell_y. The row of the y coordinate. The point should be on the map
+    ///
+    uint_t cell_y(real_t y)const noexcept{return std::min(static_cast<uint_t>((y - y_min_) * inv_resolution_), ny_ - 1);}
+
+    ///
+    /// \brief is_occupied
+    ///
+    bool is_occupied(uint_t ix, uint_t iy)const{return n_points_[iy * nx_ + ix] != 0;}
+
+    ///
+    /// \brief n_points. The number of points in the cell
+    ///
+    uint_t n_points(uint_t ix, uint_t iy)const{return n_points_[iy * nx_ + ix];}
+
+    ///
+    /// \brief set_occupied. Mark the cell occupied, as one point, or
+    /// free whatever the points in it. The distances change after
+    /// the next call to update()
+    ///
+    void set_occupied(uint_t ix, uint_t iy, bool occupied=true);
+
+    ///
+    /// \brief add_point. Count the point in its cell. Points outside
+    /// the map are ignored. Returns true if the point is on the map
+    ///
+    bool add_point(real_t x, real_t y);
+
+    ///
+    /// \brief add_points. Mark the cells of the points occupied.
+    /// points[i][0] and points[i][1] are the coordinates of the i-th point
+    ///
+    template<typename PointsTp>
+    void add_points(const PointsTp& points);
+
+    ///
+    /// \brief remove_point. Remove the point from its cell. The cell
+    /// becomes free with its last point. Points outside the map and
+    /// cells without points are ignored. Returns true if the point is on the map
+    ///
+    bool remove_point(real_t x, real_t y);
+
+    ///
+    /// \brief remove_points. Remove the points, for
+    /// example the points of the previous scan
+    ///
+    template<typename PointsTp>
+    void remove_points(const PointsTp& points);
+
+    ///
+    /// \brief clear. Mark every cell free
+    ///
+    void clear();
+
+    ///
+    /// \brief update. Recompute the distances of the cells
+    /// affected by the changes since the last update
+    ///
+    void update();
+
+    ///
+    /// \brief rebuild. Recompute the distances of every cell
+    ///
+    void rebuild();
+
+    ///
+    /// \brief cell_distance. The distance of the cell to the closest
+    /// occupied cell as of the last update
+    ///
+    real_t cell_distance(uint_t ix, uint_t iy)const{return distance_[iy * nx_ + ix];}
+
+    ///
+    /// \brief distance. The distance of the cell of the point to the
+    /// closest occupied cell. max_distance for points outside the map
+    ///
+    real_t distance(real_t x, real_t y)const noexcept;
+
+    ///
+    /// \brief has_changes. True if there are changes not yet applied by update()
+    ///
+    bool has_changes()const noexcept{return dirty_x_min_ <= dirty_x_max_;}
+
+private:
+
+    real_t x_min_;
+    real_t y_min_;
+    uint_t nx_;
+    uint_t ny_;
+    real_t resolution_;
+    real_t inv_resolution_;
+    real_t max_distance_;
+
+    ///
+    /// \brief max_cells_ The number of cells the
+    /// effect of a change reaches along an axis
+    ///
+    uint_t max_cells_;
+
+    ///
+    /// \brief n_points_ The number of points of every cell
+    ///
+    std::vector<std::uint32_t> n_points_;
+    std::vector<real_t> distance_;
+
+    ///
+    /// \brief The box of the cells changed since the last update
+    ///
+    uint_t dirty_x_min_;
+    uint_t dirty_x_max_;
+    uint_t dirty_y_min_;
+    uint_t dirty_y_max_;
+
+    ///
+    /// \brief Scratch buffers of the distance transform
+    ///
+    std::vector<real_t> d2_;
+    std::vector<real_t> f_;
+    std::vector<real_t> d_;
+    std::vector<real_t> z_;
+    std::vector<uint_t> v_;
+
+    void reset_changes_()noexcept;
+
+    ///
+    /// \brief mark_changed_ Grow the box of changed cells
+    ///
+    void mark_changed_(uint_t ix, uint_t iy)noexcept;
+
+    ///
+    /// \brief transform_ Compute the distances of the cells in
+    /// [x0, x1] x [y0, y1] from the occupied cells that are
+    /// at most max_cells_ away from the box
+    ///
+    void transform_(uint_t x0, uint_t x1, uint_t y0, uint_t y1);
+
+    ///
+    /// \brief transform_1d_ The squared distance transform of the n samples of f_ into d_
+    ///
+    void transform_1d_(uint_t n);
+};
+
+inline
+bool
+ObstacleDistanceMap::is_inside(real_t x, real_t y)const noexcept{
+
+    return x >= x_min_ && y >= y_min_ &&
+           x < x_min_ + static_cast<real_t>(nx_) * resolution_ &&
+           y < y_min_ + static_cast<real_t>(ny_) * resolution_;
+}
+
+inline
+real_t
+ObstacleDistanceMap::distance(real_t x, real_t y)const noexcept{
+
+    if(!is_inside(x, y)){
+        return max_distance_;
+    }
+
+    return distance_[cell_y(y) * nx_ + cell_x(x)];
+}
+
+template<typename PointsTp>
+void
+ObstacleDistanceMap::add_points(const PointsTp& points){
+
+    for(const auto& p : points){
+        add_point(p[0], p[1]);
+    }
+}
+
+template<typename PointsTp>
+void
+ObstacleDistanceMap::remove_points(const PointsTp& points){
+
+    for(const auto& p : points){
+        remove_point(p[0], p[1]);
+    }
+}
+
+}
+}
+
+#endif // OBSTACLE_DISTANCE_MAP_H
@@ -1,17 +1,19 @@
 #ifndef RAPIDLY_EXPLORING_RANDOM_TREE_H
 #define RAPIDLY_EXPLORING_RANDOM_TREE_H
 
-#include "cubic_engine/base/cubic_engine_types.h"
-#include "kernel/data_structs/boost_serial_graph.h"
-#include "kernel/base/kernel_consts.h"
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/data_structs/boost_serial_graph.h"
+#include "cubeai/data_structs/dynamic_kd_tree.h"
 
 #include"boost/noncopyable.hpp"
 #include <chrono>
 #include <iostream>
+#include <stdexcept>
+#include <tuple>
 
 
-namespace cengine {
-namespace search {
+namespace cubeai {
 
 ///
 /// \brief The RRT class models a Rapidly-Exploring Random Tree
@@ -21,9 +23,14 @@ namespace search {
 /// of \f$x_{rand}\f$ and \f$x_{new}\f$ from the paper cited above.
 /// The EdgeData type corresponds to the type of \f$u\f$ in the paper.
 /// It is the input that should subsequently be applied to reach from
-/// one state to another and this is what the applications most often will use
+/// one state to another and this is what the applications most often will use.
+/// The vertices are indexed by a DynamicKDTree over their first dim
+/// coordinates, data[0], ..., data[dim - 1], so the NodeData should provide
+/// operator[]. The metrics passed to the tree should be bounded below by the
+/// absolute difference of each of these coordinates, e.g. the Euclidean
+/// distance of the positions, so that the index can skip whole subtrees
 ///
-template<typename NodeData, typename EdgeData>
+template<typename NodeData, typename EdgeData, uint_t dim=2>
 class RRT: private boost::noncopyable
 {
 public:
@@ -41,26 +48,31 @@ public:
     ///
     /// \brief vertex_t the vertex type
     ///
-    typedef typename kernel::BoostSerialGraph<vertex_data_t,
-                                              edge_data_t>::vertex_t vertex_t;
+    typedef typename BoostSerialGraph<vertex_data_t,
+                                      edge_data_t>::vertex_t vertex_t;
 
     ///
     /// \brief edge_t The edge type
     ///
-    typedef typename kernel::BoostSerialGraph<vertex_data_t,
-                                              edge_data_t>::edge_t edge_t;
+    typedef typename BoostSerialGraph<vertex_data_t,
+                                      edge_data_t>::edge_t edge_t;
 
     ///
     /// \brief edge_iterator Edge iterator
     ///
-    typedef typename kernel::BoostSerialGraph<vertex_data_t,
-                                              edge_data_t>::edge_iterator edge_iterator;
+    typedef typename BoostSerialGraph<vertex_data_t,
+                                      edge_data_t>::edge_iterator edge_iterator;
 
     ///
     /// \brief adjacency_iterator Adjacency iterator
     ///
-    typedef typename kernel::BoostSerialGraph<vertex_data_t,
-                                              edge_data_t>::adjacency_iterator adjacency_iterator;
+    typedef typename BoostSerialGraph<vertex_data_t,
+                                      edge_data_t>::adjacency_iterator adjacency_iterator;
+
+    ///
+    /// \brief index_t The type of the spatial index of the vertices
+    ///
+    typedef containers::DynamicKDTree<dim, real_t> index_t;
 
     ///
     /// \brief RRT Default constructor. Creates an empty tree
@@ -109,7 +121,7 @@ public:
     /// \brief add_vertex Add a new vertex to the tree
     /// \param node The new vertex to add
     ///
-    vertex_t& add_vertex(const vertex_t& node){ return tree_.add_vertex(node.data);}
+    vertex_t& add_vertex(const vertex_t& node){ return add_vertex(node.data);}
 
     ///
     /// \brief Add a new vertex in the tree that has the given data
@@ -171,7 +183,18 @@ public:
     ///
     /// \brief clear Clear the underlying tree
     ///
-    void clear(){tree_.clear();}
+    void clear(){tree_.clear(); index_.clear();}
+
+    ///
+    /// \brief reserve Reserve space in the spatial index for the given number of vertices
+    ///
+    void reserve(uint_t n){index_.reserve(n);}
+
+    ///
+    /// \brief index The spatial index of the vertices. The id of
+    /// a point in the index is the id of the vertex
+    ///
+    const index_t& index()const noexcept{return index_;}
 
     ///
     /// \brief n_vertices. Returns the number of vertices of the tree
@@ -218,7 +241,12 @@ private:
     ///
     /// \brief tree_ The underlying tree data structure
     ///
-    kernel::BoostSerialGraph<vertex_data_t, edge_data_t> tree_;
+    BoostSerialGraph<vertex_data_t, edge_data_t> tree_;
+
+    ///
+    /// \brief index_ The spatial index of the vertices
+    ///
+    index_t index_;
 
     ///
     /// \brief show_iterations_ Flag indicating if information
@@ -226,25 +254,45 @@ private:
     ///
     bool show_iterations_;
 
+    ///
+    /// \brief position_ The coordinates of the data the index uses
+    ///
+    static typename index_t::point_type position_(const vertex_data_t& data);
+
 };
 
-template<typename NodeData, typename EdgeData>
-RRT<NodeData, EdgeData>::RRT()
+template<typename NodeData, typename EdgeData, uint_t dim>
+RRT<NodeData, EdgeData, dim>::RRT()
     :
       tree_(),
+      index_(),
       show_iterations_(false)
 {}
 
-template<typename NodeData, typename EdgeData>
-typename RRT<NodeData, EdgeData>::vertex_t&
-RRT<NodeData, EdgeData>::add_vertex(const vertex_data_t& data){
-    return tree_.add_vertex(data);
+template<typename NodeData, typename EdgeData, uint_t dim>
+typename RRT<NodeData, EdgeData, dim>::vertex_t&
+RRT<NodeData, EdgeData, dim>::add_vertex(const vertex_data_t& data){
+
+    auto& v = tree_.add_vertex(data);
+    index_.insert(position_(data));
+    return v;
+}
+
+template<typename NodeData, typename EdgeData, uint_t dim>
+typename RRT<NodeData, EdgeData, dim>::index_t::point_type
+RRT<NodeData, EdgeData, dim>::position_(const vertex_data_t& data){
+
+    typename index_t::point_type p;
+    for(uint_t i=0; i<dim; ++i){
+        p[i] = static_cast<real_t>(data[i]);
+    }
+    return p;
 }
 
-template<typename NodeTp, typename EdgeTp>
+template<typename NodeData, typename EdgeData, uint_t dim>
 template<typename StateSelector, typename MetricTp, typename DynamicsTp>
 void
-RRT<NodeTp, EdgeTp>::build(uint_t nitrs, const vertex_t& xinit,
+RRT<NodeData, EdgeData, dim>::build(uint_t nitrs, const vertex_t& xinit,
                            const  StateSelector& state_selector,
                            const MetricTp& metric,
                            DynamicsTp& dynamics){
@@ -256,7 +304,7 @@ RRT<NodeTp, EdgeTp>::build(uint_t nitrs, const vertex_t& xinit,
     clear();
 
     // initialize the tree. This is the root node
-    tree_.add_vertex(xinit.data);
+    add_vertex(xinit.data);
 
     // loop over the states and create
     // the tree
@@ -283,7 +331,7 @@ RRT<NodeTp, EdgeTp>::build(uint_t nitrs, const vertex_t& xinit,
         auto& new_v = add_vertex(xnew);
 
         // add a new edge
-        auto new_e = add_edge(xnear.id, new_v.id);
+        auto& new_e = add_edge(xnear.id, new_v.id);
         new_e.set_data(u);
     }
 
@@ -295,10 +343,10 @@ RRT<NodeTp, EdgeTp>::build(uint_t nitrs, const vertex_t& xinit,
     }
 }
 
-template<typename NodeData, typename EdgeData>
+template<typename NodeData, typename EdgeData, uint_t dim>
 template<typename StateSelector, typename MetricTp, typename DynamicsTp>
 std::tuple<bool, uint_t, uint_t>
-RRT<NodeData, EdgeData>::build(uint_t nitrs, const vertex_t& xinit,
+RRT<NodeData, EdgeData, dim>::build(uint_t nitrs, const vertex_t& xinit,
                                const vertex_t& goal, const  StateSelector& state_selector,
                                const MetricTp& metric, DynamicsTp& dynamics, real_t goal_radius){
 
@@ -316,13 +364,13 @@ RRT<NodeData, EdgeData>::build(uint_t nitrs, const vertex_t& xinit,
     }
 
     // initialize the tree. This is the root node
-    auto& root = tree_.add_vertex(xinit.data);
+    auto& root = add_vertex(xinit.data);
 
     // flag indicating that the goal is found
     bool goal_found = false;
 
     // the uid of the last vertex
-    uint_t last_v_id = kernel::KernelConsts::invalid_size_type();
+    uint_t last_v_id = CubeAIConsts::invalid_size_type();
 
     // loop over the states and create
     // the tree
@@ -349,7 +397,7 @@ RRT<NodeData, EdgeData>::build(uint_t nitrs, const vertex_t& xinit,
         auto& new_v = add_vertex(xnew);
 
         // add a new edge
-        auto new_e = add_edge(xnear.id, new_v.id);
+        auto& new_e = add_edge(xnear.id, new_v.id);
         new_e.set_data(u);
 
         // if this new node is the goal then
@@ -363,67 +411,41 @@ RRT<NodeData, EdgeData>::build(uint_t nitrs, const vertex_t& xinit,
 
     end = std::chrono::system_clock::now();
 
-    //if(show_iterations_){
+    if(show_iterations_){
         std::chrono::duration<real_t> dur = end - start;
         std::cout<<"Total build time: "<<dur.count()<<std::endl;
-    //}
+    }
 
     return std::make_tuple(goal_found, root.id, last_v_id);
 }
 
-template<typename NodeData, typename EdgeData>
+template<typename NodeData, typename EdgeData, uint_t dim>
 template<typename MetricTp>
-const typename RRT<NodeData, EdgeData>::vertex_t&
-RRT<NodeData, EdgeData>::find_nearest_neighbor(const vertex_t& other,
-                                               const MetricTp& metric)const{
-
-    auto dist = metric(tree_.get_vertex(0), other);
-    auto result = 0;
-
-    for(uint_t v=1; v< tree_.n_vertices(); ++v){
-        auto vertex_data = tree_.get_vertex(v);
-
-        auto new_dist = metric(vertex_data, other);
+const typename RRT<NodeData, EdgeData, dim>::vertex_t&
+RRT<NodeData, EdgeData, dim>::find_nearest_neighbor(const vertex_t& other,
+                                                    const MetricTp& metric)const{
 
-        if(new_dist < dist){
-            dist = new_dist;
-            result = v;
-        }
+    if(index_.empty()){
+        throw std::logic_error("Cannot find the nearest neighbor in an empty tree");
     }
 
+    auto result = index_.nearest(position_(other.data),
+                                 [&](uint_t v){return metric(tree_.get_vertex(v), other);});
+
     return tree_.get_vertex(result);
 }
 
-template<typename NodeData, typename EdgeData>
+template<typename NodeData, typename EdgeData, uint_t dim>
 template<typename MetricTp>
-const typename RRT<NodeData, EdgeData>::vertex_t&
-RRT<NodeData, EdgeData>::find_nearest_neighbor(const vertex_data_t& other,
-                                               const MetricTp& metric)const{
+const typename RRT<NodeData, EdgeData, dim>::vertex_t&
+RRT<NodeData, EdgeData, dim>::find_nearest_neighbor(const vertex_data_t& other,
+                                                    const MetricTp& metric)const{
 
-    typedef typename RRT<NodeData, EdgeData>::vertex_t vertex_t;
+    typedef typename RRT<NodeData, EdgeData, dim>::vertex_t vertex_t;
     vertex_t dummy;
     dummy.data = other;
 
-    auto dist = metric(tree_.get_vertex(0), dummy);
-    auto result = 0;
-
-    for(uint_t v=1; v< tree_.n_vertices(); ++v){
-        auto vertex_data = tree_.get_vertex(v);
-
-        auto new_dist = metric(vertex_data, dummy);
-
-        if(new_dist < dist){
-            dist = new_dist;
-            result = v;
-        }
-    }
-
-    return tree_.get_vertex(result);
-
-}
-
-
-
+    return find_nearest_neighbor(dummy, metric);
 }
 
 }
@@ -0,0 +1,811 @@
+#ifndef RRT_STAR_H
+#define RRT_STAR_H
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/base/math_constants.h"
+#include "cubeai/data_structs/dynamic_kd_tree.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cubeai{
+
+///
+/// \brief The collision_checker_concept. A checker tells whether a state
+/// and the straight segment between two states are free. When samples are
+/// generated on worker threads is_free is called concurrently from them
+/// while the main thread calls is_segment_free, so const calls should be
+/// safe to make from several threads. A checker may also provide
+/// are_segments_free(x, ys, out) that sets out[i] to one if the segment
+/// from ys[i] to x is free; the planner then checks the segments of a
+/// rewiring step with one call, e.g. to vectorize over the segments
+///
+template<typename T, typename StateTp>
+concept collision_checker_concept = requires(const T& checker, const StateTp& x){
+
+    {checker.is_free(x)} -> std::convertible_to<bool>;
+    {checker.is_segment_free(x, x)} -> std::convertible_to<bool>;
+};
+
+///
+/// \brief The RRTStarConfig struct
+///
+struct RRTStarConfig
+{
+    ///
+    /// \brief n_iterations. Number of free samples the tree is extended towards
+    ///
+    uint_t n_iterations{10000};
+
+    ///
+    /// \brief max_step. The longest edge steering adds to the tree
+    ///
+    real_t max_step{1.0};
+
+    ///
+    /// \brief gamma. The constant of the rewiring radius
+    /// gamma * (log(n) / n)^(1/dim). The radius never exceeds max_step.
+    /// Zero selects the bound of Karaman and Frazzoli for the sampling box
+    ///
+    real_t gamma{0.0};
+
+    ///
+    /// \brief goal_radius. Vertices this close to the goal reach it
+    ///
+    real_t goal_radius{0.5};
+
+    ///
+    /// \brief n_sampling_threads. If not zero the samples are generated and
+    /// checked with is_free on this many worker threads while the main
+    /// thread inserts them into the tree
+    ///
+    uint_t n_sampling_threads{0};
+
+    ///
+    /// \brief sample_batch_size. The number of free samples a
+    /// worker hands over to the main thread at a time
+    ///
+    uint_t sample_batch_size{256};
+
+    uint_t seed{42};
+};
+
+///
+/// \brief The RRTStar class. RRT* (Karaman and Frazzoli) in a box of R^dim
+/// with straight line steering and the Euclidean length of the path as the
+/// cost. The vertices are indexed by a DynamicKDTree which answers both the
+/// nearest vertex and the near set queries. The near vertices are tried as
+/// the parent of a new vertex in the order of the cost through them, so
+/// the segment checks stop at the first free one. The near vertices the
+/// new vertex would improve are then checked together and rewired; the
+/// cost change of a rewired vertex is pushed down to its subtree so every
+/// vertex always holds its cost from the start. With n_sampling_threads
+/// workers draw the samples and reject those that are not free while the
+/// main thread extends the tree, so only the main thread touches the tree
+///
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+class RRTStar
+{
+public:
+
+    ///
+    /// \brief index_type The type of the spatial index of the vertices
+    ///
+    typedef containers::DynamicKDTree<dim, real_t> index_type;
+
+    ///
+    /// \brief state_type The type of a state
+    ///
+    typedef typename index_type::point_type state_type;
+
+    ///
+    /// \brief checker_type The type of the collision checker
+    ///
+    typedef CheckerTp checker_type;
+
+    ///
+    /// \brief npos The parent of the root and the goal vertex when the goal is not reached
+    ///
+    static constexpr uint_t npos = CubeAIConsts::INVALID_SIZE_TYPE;
+
+    ///
+    /// \brief Constructor. The samples are drawn uniformly from the box
+    /// [lower, upper]. The checker should outlive the object
+    ///
+    RRTStar(const RRTStarConfig& config, const state_type& lower,
+            const state_type& upper, const CheckerTp& checker);
+
+    ///
+    /// \brief Destructor. Stops the sampling threads if needed
+    ///
+    ~RRTStar();
+
+    RRTStar(const RRTStar&)=delete;
+    RRTStar& operator=(const RRTStar&)=delete;
+
+    ///
+    /// \brief plan. Grow a tree from start and return true if a vertex
+    /// within goal_radius of the goal is reached. Throws std::logic_error
+    /// if the start is not free
+    ///
+    bool plan(const state_type& start, const state_type& goal);
+
+    ///
+    /// \brief cost. The cost from the start of the goal vertex
+    ///
+    real_t cost()const noexcept{
+        return goal_vertex_ == npos ? std::numeric_limits<real_t>::infinity() : cost_[goal_vertex_];
+    }
+
+    ///
+    /// \brief goal_vertex. The cheapest vertex within goal_radius of the goal or npos
+    ///
+    uint_t goal_vertex()const noexcept{return goal_vertex_;}
+
+    ///
+    /// \brief path. The states from the start to the goal vertex.
+    /// out is empty if the goal is not reached
+    ///
+    void path(std::vector<state_type>& out)const;
+
+    ///
+    /// \brief path. The states from the start to the goal vertex
+    ///
+    std::vector<state_type> path()const{std::vector<state_type> out; path(out); return out;}
+
+    ///
+    /// \brief n_vertices. The number of vertices of the tree
+    ///
+    uint_t n_vertices()const noexcept{return parent_.size();}
+
+    ///
+    /// \brief state. The state of vertex v
+    ///
+    const state_type& state(uint_t v)const{return index_.point(v);}
+
+    ///
+    /// \brief parent. The parent of vertex v, npos for the root
+    ///
+    uint_t parent(uint_t v)const{return parent_[v];}
+
+    ///
+    /// \brief cost_to_come. The cost from the start of vertex v
+    ///
+    real_t cost_to_come(uint_t v)const{return cost_[v];}
+
+    ///
+    /// \brief n_collision_checks. Number of segments checked by the last plan
+    ///
+    uint_t n_collision_checks()const noexcept{return n_collision_checks_;}
+
+    ///
+    /// \brief n_rewires. Number of vertices that changed parent in the last plan
+    ///
+    uint_t n_rewires()const noexcept{return n_rewires_;}
+
+    ///
+    /// \brief index. The spatial index of the vertices
+    ///
+    const index_type& index()const noexcept{return index_;}
+
+private:
+
+    RRTStarConfig config_;
+    state_type lower_;
+    state_type upper_;
+    const CheckerTp& checker_;
+    real_t gamma_;
+
+    state_type goal_;
+    uint_t goal_vertex_;
+    std::vector<uint_t> goal_vertices_;
+
+    ///
+    /// \brief The tree. The children of a vertex form a doubly
+    /// linked list so a vertex is moved to a new parent in O(1)
+    ///
+    index_type index_;
+    std::vector<uint_t> parent_;
+    std::vector<real_t> cost_;
+    std::vector<uint_t> first_child_;
+    std::vector<uint_t> next_sibling_;
+    std::vector<uint_t> prev_sibling_;
+
+    uint_t n_collision_checks_;
+    uint_t n_rewires_;
+
+    ///
+    /// \brief Scratch space of an extension
+    ///
+    std::vector<uint_t> near_;
+    std::vector<real_t> near_distance_;
+    std::vector<uint_t> order_;
+    std::vector<std::uint8_t> checked_;
+    std::vector<uint_t> batch_ids_;
+    std::vector<state_type> batch_states_;
+    std::vector<std::uint8_t> batch_free_;
+    std::vector<uint_t> stack_;
+
+    ///
+    /// \brief The samples. batch_ holds the free samples the
+    /// main thread is consuming, sampling_queue_ the batches
+    /// the workers have produced
+    ///
+    std::mt19937_64 gen_;
+    std::vector<state_type> batch_;
+    uint_t batch_pos_;
+
+    ///
+    /// \brief Synchronization with the sampling threads
+    ///
+    std::mutex mutex_;
+    std::condition_variable ready_cv_;
+    std::condition_variable space_cv_;
+    std::deque<std::vector<state_type>> sampling_queue_;
+    std::vector<std::thread> workers_;
+    bool stop_;
+    std::exception_ptr error_;
+
+    ///
+    /// \brief extend_. Extend the tree towards x_rand
+    ///
+    void extend_(const state_type& x_rand);
+
+    ///
+    /// \brief add_vertex_. Add a vertex and return its id
+    ///
+    uint_t add_vertex_(const state_type& x, uint_t parent, real_t cost);
+
+    ///
+    /// \brief reparent_. Make v a child of p and subtract
+    /// delta from the cost of v and of its subtree
+    ///
+    void reparent_(uint_t v, uint_t p, real_t delta);
+
+    ///
+    /// \brief check_batch_. Check the segments from the states
+    /// of batch_ids_ to x and write the outcome in batch_free_
+    ///
+    void check_batch_(const state_type& x);
+
+    ///
+    /// \brief radius_. The radius of the near set of a tree with n vertices
+    ///
+    real_t radius_(uint_t n)const;
+
+    ///
+    /// \brief sample_batch_. Fill out with free samples
+    ///
+    void sample_batch_(std::mt19937_64& gen, std::vector<state_type>& out)const;
+
+    ///
+    /// \brief next_sample_. The next free sample
+    ///
+    const state_type& next_sample_();
+
+    ///
+    /// \brief sampling_loop_. The body of a sampling thread
+    ///
+    void sampling_loop_(uint_t worker);
+
+    void start_sampling_threads_();
+    void stop_sampling_threads_();
+
+    static real_t distance_(const state_type& a, const state_type& b)noexcept;
+};
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+RRTStar<dim, CheckerTp>::RRTStar(const RRTStarConfig& config, const state_type& lower,
+                                 const state_type& upper, const CheckerTp& checker)
+    :
+      config_(config),
+      lower_(lower),
+      upper_(upper),
+      checker_(checker),
+      gamma_(config.gamma),
+      goal_(),
+      goal_vertex_(npos),
+      goal_vertices_(),
+      index_(),
+      parent_(),
+      cost_(),
+      first_child_(),
+      next_sibling_(),
+      prev_sibling_(),
+      n_collision_checks_(0),
+      n_rewires_(0),
+      near_(),
+      near_distance_(),
+      order_(),
+      checked_(),
+      batch_ids_(),
+      batch_states_(),
+      batch_free_(),
+      stack_(),
+      gen_(config.seed),
+      batch_(),
+      batch_pos_(0),
+      mutex_(),
+      ready_cv_(),
+      space_cv_(),
+      sampling_queue_(),
+      workers_(),
+      stop_(false),
+      error_()
+{
+    real_t volume = 1.0;
+    for(uint_t i=0; i<dim; ++i){
+
+        if(!(upper_[i] > lower_[i])){
+            throw std::logic_error("The sampling box of RRTStar is empty");
+        }
+
+        volume *= upper_[i] - lower_[i];
+    }
+
+    if(config_.max_step <= 0.0 || config_.sample_batch_size == 0){
+        throw std::logic_error("RRTStar needs a positive max_step and sample_batch_size");
+    }
+
+    // gamma > 2 (1 + 1/d)^(1/d) (mu(X_free) / zeta_d)^(1/d), the
+    // volume of the box bounds the volume of the free space
+    if(gamma_ <= 0.0){
+        const auto d = static_cast<real_t>(dim);
+        const auto unit_ball = std::pow(MathConsts::PI, 0.5 * d) / std::tgamma(0.5 * d + 1.0);
+        gamma_ = 2.0 * std::pow((1.0 + 1.0 / d) * volume / unit_ball, 1.0 / d);
+    }
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+RRTStar<dim, CheckerTp>::~RRTStar(){
+    stop_sampling_threads_();
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+real_t
+RRTStar<dim, CheckerTp>::distance_(const state_type& a, const state_type& b)noexcept{
+
+    real_t d = 0.0;
+    for(uint_t i=0; i<dim; ++i){
+        d += (a[i] - b[i]) * (a[i] - b[i]);
+    }
+    return std::sqrt(d);
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+real_t
+RRTStar<dim, CheckerTp>::radius_(uint_t n)const{
+
+    const auto nr = static_cast<real_t>(n);
+    const auto r = gamma_ * std::pow(std::log(nr) / nr, 1.0 / static_cast<real_t>(dim));
+    return std::min(r, config_.max_step);
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+bool
+RRTStar<dim, CheckerTp>::plan(const state_type& start, const state_type& goal){
+
+    if(!checker_.is_free(start)){
+        throw std::logic_error("The start state of RRTStar is not free");
+    }
+
+    index_.clear();
+    parent_.clear();
+    cost_.clear();
+    first_child_.clear();
+    next_sibling_.clear();
+    prev_sibling_.clear();
+    goal_vertices_.clear();
+    goal_vertex_ = npos;
+    goal_ = goal;
+    n_collision_checks_ = 0;
+    n_rewires_ = 0;
+
+    const auto capacity = config_.n_iterations + 1;
+    index_.reserve(capacity);
+    parent_.reserve(capacity);
+    cost_.reserve(capacity);
+    first_child_.reserve(capacity);
+    next_sibling_.reserve(capacity);
+    prev_sibling_.reserve(capacity);
+
+    add_vertex_(start, npos, 0.0);
+    if(distance_(start, goal_) <= config_.goal_radius){
+        goal_vertices_.push_back(0);
+    }
+
+    gen_.seed(config_.seed);
+    batch_.clear();
+    batch_pos_ = 0;
+
+    // the threads are stopped whichever way the loop ends
+    struct SamplingGuard
+    {
+        RRTStar& planner;
+        ~SamplingGuard(){planner.stop_sampling_threads_();}
+    };
+
+    {
+        start_sampling_threads_();
+        SamplingGuard guard{*this};
+
+        for(uint_t itr=0; itr<config_.n_iterations; ++itr){
+            extend_(next_sample_());
+        }
+    }
+
+    for(auto v : goal_vertices_){
+        if(goal_vertex_ == npos || cost_[v] < cost_[goal_vertex_]){
+            goal_vertex_ = v;
+        }
+    }
+
+    return goal_vertex_ != npos;
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+uint_t
+RRTStar<dim, CheckerTp>::add_vertex_(const state_type& x, uint_t parent, real_t cost){
+
+    const auto v = index_.insert(x);
+    parent_.push_back(parent);
+    cost_.push_back(cost);
+    first_child_.push_back(npos);
+    prev_sibling_.push_back(npos);
+    next_sibling_.push_back(npos);
+
+    if(parent != npos){
+
+        const auto first = first_child_[parent];
+        next_sibling_[v] = first;
+        if(first != npos){
+            prev_sibling_[first] = v;
+        }
+        first_child_[parent] = v;
+    }
+
+    return v;
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+void
+RRTStar<dim, CheckerTp>::reparent_(uint_t v, uint_t p, real_t delta){
+
+    // unlink v from the children of its parent
+    const auto old = parent_[v];
+    const auto prev = prev_sibling_[v];
+    const auto next = next_sibling_[v];
+
+    if(prev != npos){
+        next_sibling_[prev] = next;
+    }
+    else{
+        first_child_[old] = next;
+    }
+
+    if(next != npos){
+        prev_sibling_[next] = prev;
+    }
+
+    // and link it to p
+    parent_[v] = p;
+    prev_sibling_[v] = npos;
+    next_sibling_[v] = first_child_[p];
+    if(first_child_[p] != npos){
+        prev_sibling_[first_child_[p]] = v;
+    }
+    first_child_[p] = v;
+
+    // the whole subtree gets cheaper by delta
+    stack_.clear();
+    stack_.push_back(v);
+    while(!stack_.empty()){
+
+        const auto w = stack_.back();
+        stack_.pop_back();
+        cost_[w] -= delta;
+
+        for(auto c = first_child_[w]; c != npos; c = next_sibling_[c]){
+            stack_.push_back(c);
+        }
+    }
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+void
+RRTStar<dim, CheckerTp>::check_batch_(const state_type& x){
+
+    n_collision_checks_ += batch_ids_.size();
+    batch_free_.resize(batch_ids_.size());
+
+    if constexpr(requires(const CheckerTp& c, std::vector<std::uint8_t>& out){
+                     c.are_segments_free(x, batch_states_, out);}){
+
+        batch_states_.clear();
+        for(auto v : batch_ids_){
+            batch_states_.push_back(index_.point(v));
+        }
+
+        checker_.are_segments_free(x, batch_states_, batch_free_);
+    }
+    else{
+
+        for(uint_t i=0; i<batch_ids_.size(); ++i){
+            batch_free_[i] = checker_.is_segment_free(index_.point(batch_ids_[i]), x);
+        }
+    }
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+void
+RRTStar<dim, CheckerTp>::extend_(const state_type& x_rand){
+
+    // steer from the nearest vertex
+    const auto nearest = index_.nearest(x_rand);
+    const auto x_nearest = index_.point(nearest);
+    const auto d = distance_(x_nearest, x_rand);
+    if(d == 0.0){
+        return;
+    }
+
+    auto x_new = x_rand;
+    if(d > config_.max_step){
+        for(uint_t i=0; i<dim; ++i){
+            x_new[i] = x_nearest[i] + (x_rand[i] - x_nearest[i]) * config_.max_step / d;
+        }
+    }
+
+    // the near set always has the nearest vertex
+    index_.radius_search(x_new, radius_(n_vertices() + 1), near_);
+    if(std::find(near_.begin(), near_.end(), nearest) == near_.end()){
+        near_.push_back(nearest);
+    }
+
+    near_distance_.resize(near_.size());
+    order_.resize(near_.size());
+    checked_.assign(near_.size(), 0);
+    for(uint_t i=0; i<near_.size(); ++i){
+        near_distance_[i] = distance_(index_.point(near_[i]), x_new);
+        order_[i] = i;
+    }
+
+    // the parent is the first free one in the order of the cost through it
+    std::sort(order_.begin(), order_.end(), [this](uint_t i, uint_t j){
+        return cost_[near_[i]] + near_distance_[i] < cost_[near_[j]] + near_distance_[j];
+    });
+
+    auto parent = npos;
+    real_t cost = 0.0;
+    for(auto i : order_){
+
+        checked_[i] = 1;
+        n_collision_checks_ += 1;
+        if(checker_.is_segment_free(index_.point(near_[i]), x_new)){
+            parent = near_[i];
+            cost = cost_[parent] + near_distance_[i];
+            break;
+        }
+    }
+
+    if(parent == npos){
+        return;
+    }
+
+    const auto v = add_vertex_(x_new, parent, cost);
+    if(distance_(x_new, goal_) <= config_.goal_radius){
+        goal_vertices_.push_back(v);
+    }
+
+    // the near vertices the new vertex would improve are checked in one batch.
+    // A vertex that failed as a parent has a blocked segment
+    batch_ids_.clear();
+    for(uint_t i=0; i<near_.size(); ++i){
+        if(!checked_[i] && cost + near_distance_[i] < cost_[near_[i]]){
+            batch_ids_.push_back(near_[i]);
+        }
+    }
+
+    if(batch_ids_.empty()){
+        return;
+    }
+
+    check_batch_(x_new);
+    for(uint_t i=0; i<batch_ids_.size(); ++i){
+
+        if(!batch_free_[i]){
+            continue;
+        }
+
+        // the cost of a vertex may have dropped
+        // when an ancestor of it was rewired
+        const auto w = batch_ids_[i];
+        const auto c = cost + distance_(index_.point(w), x_new);
+        if(c < cost_[w]){
+            reparent_(w, v, cost_[w] - c);
+            n_rewires_ += 1;
+        }
+    }
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+void
+RRTStar<dim, CheckerTp>::path(std::vector<state_type>& out)const{
+
+    out.clear();
+    if(goal_vertex_ == npos){
+        return;
+    }
+
+    for(auto v = goal_vertex_; v != npos; v = parent_[v]){
+        out.push_back(index_.point(v));
+    }
+
+    std::reverse(out.begin(), out.end());
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+void
+RRTStar<dim, CheckerTp>::sample_batch_(std::mt19937_64& gen, std::vector<state_type>& out)const{
+
+    out.clear();
+
+    std::uniform_real_distribution<real_t> unit(0.0, 1.0);
+    const auto max_attempts = 1000 * config_.sample_batch_size;
+    for(uint_t attempt=0; attempt<max_attempts && out.size()<config_.sample_batch_size; ++attempt){
+
+        state_type x;
+        for(uint_t i=0; i<dim; ++i){
+            x[i] = lower_[i] + unit(gen) * (upper_[i] - lower_[i]);
+        }
+
+        if(checker_.is_free(x)){
+            out.push_back(x);
+        }
+    }
+
+    if(out.empty()){
+        throw std::logic_error("RRTStar could not draw a free sample");
+    }
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+const typename RRTStar<dim, CheckerTp>::state_type&
+RRTStar<dim, CheckerTp>::next_sample_(){
+
+    if(batch_pos_ == batch_.size()){
+
+        if(workers_.empty()){
+            sample_batch_(gen_, batch_);
+        }
+        else{
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_cv_.wait(lock, [this](){return !sampling_queue_.empty() || error_;});
+
+            if(sampling_queue_.empty()){
+                std::rethrow_exception(error_);
+            }
+
+            batch_ = std::move(sampling_queue_.front());
+            sampling_queue_.pop_front();
+            space_cv_.notify_one();
+        }
+
+        batch_pos_ = 0;
+    }
+
+    return batch_[batch_pos_++];
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+void
+RRTStar<dim, CheckerTp>::sampling_loop_(uint_t worker){
+
+    std::mt19937_64 gen(config_.seed + 1 + worker);
+    std::vector<state_type> batch;
+
+    try{
+
+        while(true){
+
+            sample_batch_(gen, batch);
+
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            // at most two batches per worker wait for the main thread
+            space_cv_.wait(lock, [this](){return stop_ || sampling_queue_.size() < 2 * config_.n_sampling_threads;});
+            if(stop_){
+                return;
+            }
+
+            sampling_queue_.push_back(std::move(batch));
+            batch = std::vector<state_type>();
+            ready_cv_.notify_one();
+        }
+    }
+    catch(...){
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(!error_){
+            error_ = std::current_exception();
+        }
+        stop_ = true;
+        ready_cv_.notify_all();
+        space_cv_.notify_all();
+    }
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+void
+RRTStar<dim, CheckerTp>::start_sampling_threads_(){
+
+    if(config_.n_sampling_threads == 0){
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = false;
+    error_ = nullptr;
+    sampling_queue_.clear();
+
+    workers_.reserve(config_.n_sampling_threads);
+    for(uint_t w=0; w<config_.n_sampling_threads; ++w){
+        workers_.emplace_back(&RRTStar<dim, CheckerTp>::sampling_loop_, this, w);
+    }
+}
+
+template<uint_t dim, typename CheckerTp>
+requires collision_checker_concept<CheckerTp, std::array<real_t, dim>>
+void
+RRTStar<dim, CheckerTp>::stop_sampling_threads_(){
+
+    if(workers_.empty()){
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+
+    space_cv_.notify_all();
+    for(auto& worker : workers_){
+        worker.join();
+    }
+
+    workers_.clear();
+    sampling_queue_.clear();
+}
+
+}
+
+#endif // RRT_STAR_H
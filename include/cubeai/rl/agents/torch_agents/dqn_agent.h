@@ -1,76 +1,654 @@
 #ifndef DQN_AGENT_H
 #define DQN_AGENT_H
 
+/**
+  * Implements the deep Q-network, DQN, agent and its Double DQN
+  * variant. The agent keeps a replay memory in an ExperienceBuffer,
+  * a target network that is synchronized either softly or periodically
+  * and computes the TD targets of a whole minibatch with one forward pass
+  * per network. The implementation assumes that PyTorch is used to model
+  * the Q-network
+  *
+  */
+
 #include "cubeai/base/cubeai_config.h"
 
 #ifdef USE_PYTORCH
 
-#include "cubeai/rl/torch_agents/torch_agent_base.h"
-#include "cubeai/rl/episode_result_info.h"
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/agents/torch_agents/torch_agent_base.h"
+#include "cubeai/rl/episode_info.h"
+#include "cubeai/rl/worlds/observation_utils.h"
+#include "cubeai/data_structs/experience_buffer.h"
+#include "cubeai/io/binary_checkpoint.h"
+#include "cubeai/io/torch_checkpoint.h"
+#include "cubeai/maths/optimization/pytorch_optimizer_factory.h"
+#include "cubeai/utils/instrumentation.h"
+#include "cubeai/utils/torch_adaptor.h"
+
+#include <torch/torch.h>
 
-namespace cubeai{
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace cubeai {
 namespace rl{
 namespace pytorch{
 
-template<typename EnvType, typename ActionSelector>
+///
+/// \brief The DQNAgentConfig struct. Configuration for the DQNAgent.
+/// n_itrs_per_episode is the maximum number of steps of an episode,
+/// zero means run until the environment signals done
+///
+struct DQNAgentConfig: public TorchAgentConfig
+{
+    ///
+    /// \brief buffer_size. Capacity of the replay memory
+    ///
+    uint_t buffer_size{10000};
+
+    ///
+    /// \brief batch_size. Transitions per update
+    ///
+    uint_t batch_size{64};
+
+    ///
+    /// \brief warmup_steps. Number of stored transitions
+    /// before the first update
+    ///
+    uint_t warmup_steps{1000};
+
+    ///
+    /// \brief train_frequency. Perform an update every
+    /// train_frequency environment steps. Should be positive
+    ///
+    uint_t train_frequency{1};
+
+    ///
+    /// \brief Discount factor
+    ///
+    real_t gamma{0.99};
+
+    ///
+    /// \brief double_dqn. Select the next actions with the online
+    /// network and evaluate them with the target network
+    ///
+    bool double_dqn{true};
+
+    ///
+    /// \brief tau. If positive the target network is updated softly
+    /// after every update as target = tau * online + (1 - tau) * target
+    ///
+    real_t tau{0.0};
+
+    ///
+    /// \brief target_update_frequency. When tau is not positive the
+    /// target network is copied from the online one every
+    /// target_update_frequency updates. It should then be positive
+    ///
+    uint_t target_update_frequency{500};
+
+    ///
+    /// \brief max_grad_norm. Non positive values disable clipping
+    ///
+    real_t max_grad_norm{10.0};
+
+    ///
+    /// \brief Linear epsilon-greedy exploration schedule
+    ///
+    real_t eps_start{1.0};
+    real_t eps_end{0.05};
+    uint_t eps_decay_steps{10000};
+
+    ///
+    /// \brief use_inference_mode. Act under torch::InferenceMode
+    /// instead of torch::NoGradGuard
+    ///
+    bool use_inference_mode{true};
+
+    ///
+    /// \brief seed. Used for exploration and for sampling the replay memory
+    ///
+    uint_t seed{42};
+};
+
+///
+/// \brief The DQNTransition struct. The transitions stored
+/// in the replay memory of the DQNAgent
+///
+struct DQNTransition
+{
+    std::vector<float> state;
+    std::vector<float> next_state;
+    uint_t action;
+    real_t reward;
+    bool done;
+};
+
+/**
+ * @brief DQN agent. ModelType should be a torch::nn::ModuleHolder whose
+ * forward maps a [batch, observation_size] tensor to [batch, n_actions]
+ * Q-values. The agent is given two instances of the model, the online
+ * and the target network. The target network is initialized from the
+ * online one and is never trained directly. The replay memory stores the
+ * observations as float vectors, once it is full the new transitions are
+ * copy-assigned over the oldest so their storage is reused. The minibatches
+ * are gathered into tensors allocated once
+ */
+template<typename EnvType, typename ModelType>
 class DQNAgent: public TorchAgentBase<EnvType>
 {
 public:
 
     typedef typename TorchAgentBase<EnvType>::env_type env_type;
     typedef typename TorchAgentBase<EnvType>::time_step_type time_step_type;
-    typedef ActionSelector action_selector_type;
+    typedef ModelType model_type;
+    typedef uint_t action_type;
 
     ///
     /// \brief DQNAgent
-    /// \param config
     ///
-    DQNAgent(const TorchAgentConfig& config);
+    DQNAgent(const DQNAgentConfig& config, model_type& online, model_type& target);
+
+    ///
+    /// \brief actions_before_training_begins. Allocates the
+    /// minibatch tensors and synchronizes the target network
+    ///
+    virtual void actions_before_training_begins(env_type& env)override;
 
     ///
-    /// \brief on_training_episode
-    /// \param env
-    /// \param episode_idx
-    /// \return
+    /// \brief actions_before_episode_begins. Resets the environment
     ///
-    virtual EpisodeResultInfo on_training_episode(env_type& env, uint_t episode_idx);
+    virtual void actions_before_episode_begins(env_type& env, uint_t)override;
+
+    ///
+    /// \brief on_training_episode. Play one episode storing the transitions
+    /// and updating the online network every train_frequency steps
+    ///
+    virtual EpisodeInfo on_training_episode(env_type& env, uint_t episode_idx)override;
+
+    ///
+    /// \brief actions_after_episode_ends
+    ///
+    virtual void actions_after_episode_ends(env_type&, uint_t, const EpisodeInfo&)override{}
+
+    ///
+    /// \brief actions_after_training_ends
+    ///
+    virtual void actions_after_training_ends(env_type&)override{}
+
+    ///
+    /// \brief act. Greedy action for the given observation. Runs under
+    /// torch::InferenceMode or torch::NoGradGuard depending on the configuration
+    ///
+    template<typename ObsType>
+    action_type act(const ObsType& observation);
+
+    ///
+    /// \brief epsilon. The current exploration rate
+    ///
+    real_t epsilon()const noexcept;
+
+    ///
+    /// \brief n_updates. Number of gradient updates so far
+    ///
+    uint_t n_updates()const noexcept{return n_updates_;}
+
+    ///
+    /// \brief n_total_steps. Number of environment steps so far
+    ///
+    uint_t n_total_steps()const noexcept{return total_steps_;}
+
+    ///
+    /// \brief last_loss. The loss of the last update
+    ///
+    real_t last_loss()const noexcept{return last_loss_;}
+
+    ///
+    /// \brief sync_target_network. Copy the online parameters
+    /// and buffers into the target network
+    ///
+    void sync_target_network();
+
+    ///
+    /// \brief save_checkpoint. Add both networks, the optimizer state, the
+    /// counters and the random engines to the checkpoint. The replay memory
+    /// is not saved, it is refilled after a resume
+    ///
+    void save_checkpoint(io::Checkpoint& checkpoint)const;
+
+    ///
+    /// \brief load_checkpoint. Restore what save_checkpoint added. The next
+    /// training continues from the restored state instead of starting over
+    ///
+    void load_checkpoint(const io::MappedCheckpoint& checkpoint);
 
 protected:
 
+    DQNAgentConfig config_;
+    model_type& online_;
+    model_type& target_;
+
+    std::unique_ptr<torch::optim::Optimizer> optimizer_;
+
+    ///
+    /// \brief memory_. The replay memory
+    ///
+    containers::ExperienceBuffer<DQNTransition> memory_;
+
     ///
-    /// \brief config_
+    /// \brief The observation of the current and of the next step
     ///
-    TorchAgentConfig config_;
+    std::vector<float> current_obs_;
+    DQNTransition transition_;
 
     ///
-    /// \brief current_time_step_
+    /// \brief Preallocated tensors. act_state_ is a [1, D] staging tensor,
+    /// pinned when the model lives on a GPU. batch_states_ is [2B, D] with
+    /// the states in the first B rows and the next states in the last B so
+    /// that Double DQN needs one online forward per update
     ///
+    torch_utils::TorchStagingTensor act_state_;
+    torch_tensor_t batch_states_;
+    torch_tensor_t batch_actions_;
+    torch_tensor_t batch_rewards_;
+    torch_tensor_t batch_dones_;
+    std::vector<uint_t> batch_indices_;
+
     time_step_type current_time_step_;
 
+    uint_t observation_size_;
+    uint_t n_actions_;
+    uint_t total_steps_;
+    uint_t n_updates_;
+    real_t last_loss_;
+
+    std::mt19937 generator_;
+
+    ///
+    /// \brief resume_. Whether the state was restored from a checkpoint
+    ///
+    bool resume_;
+
+    ///
+    /// \brief select_action_. Epsilon-greedy on the current observation
+    ///
+    action_type select_action_();
+
+    ///
+    /// \brief greedy_action_. Argmax of the online Q-values on act_state_
+    ///
+    action_type greedy_action_();
+
     ///
-    /// \brief action_selector_
+    /// \brief update_. One minibatch update of the online network
     ///
-    action_selector_type action_selector_;
+    void update_();
 
+    ///
+    /// \brief soft_update_target_.
+    ///
+    void soft_update_target_();
 };
 
-template<typename EnvType, typename ActionSelector>
-EpisodeResultInfo
-DQNAgent<EnvType, ActionSelector>::on_training_episode(env_type& env, uint_t episode_idx){
+template<typename EnvType, typename ModelType>
+DQNAgent<EnvType, ModelType>::DQNAgent(const DQNAgentConfig& config, model_type& online, model_type& target)
+    :
+      TorchAgentBase<EnvType>(*online),
+      config_(config),
+      online_(online),
+      target_(target),
+      optimizer_(),
+      memory_(config.buffer_size),
+      current_obs_(),
+      transition_(),
+      act_state_(),
+      batch_states_(),
+      batch_actions_(),
+      batch_rewards_(),
+      batch_dones_(),
+      batch_indices_(),
+      current_time_step_(),
+      observation_size_(0),
+      n_actions_(0),
+      total_steps_(0),
+      n_updates_(0),
+      last_loss_(0.0),
+      generator_(config.seed),
+      resume_(false)
+{
+    if(config_.batch_size == 0){
+        throw std::logic_error("DQNAgent batch_size should be positive");
+    }
+
+    if(config_.train_frequency == 0){
+        throw std::logic_error("DQNAgent train_frequency should be positive");
+    }
+
+    if(config_.tau <= 0.0 && config_.target_update_frequency == 0){
+        throw std::logic_error("DQNAgent target_update_frequency should be positive when tau is not");
+    }
+
+    auto options = config_.optim_options;
+    if(options.find("lr") == options.end()){
+        options["lr"] = static_cast<real_t>(1.0e-3);
+    }
+
+    auto torch_options = maths::optim::pytorch::build_pytorch_optimizer_options(config_.optim_type, options);
+    optimizer_ = maths::optim::pytorch::build_pytorch_optimizer(config_.optim_type, *online_, *torch_options);
+}
+
+template<typename EnvType, typename ModelType>
+void
+DQNAgent<EnvType, ModelType>::actions_before_training_begins(env_type& env){
+
+    auto time_step = env.reset();
+    observation_size_ = envs::observation_size(time_step.observation());
+
+    const auto B = static_cast<int64_t>(config_.batch_size);
+    const auto D = static_cast<int64_t>(observation_size_);
+    const auto float_opts = torch::TensorOptions().dtype(torch::kFloat32);
+
+    act_state_.allocate({1, D}, config_.device);
+    batch_states_ = torch::zeros({2 * B, D}, float_opts);
+    batch_actions_ = torch::zeros({B}, torch::TensorOptions().dtype(torch::kInt64));
+    batch_rewards_ = torch::zeros({B}, float_opts);
+    batch_dones_ = torch::zeros({B}, float_opts);
+    batch_indices_.reserve(config_.batch_size);
+
+    current_obs_.resize(observation_size_);
+    transition_.state.resize(observation_size_);
+    transition_.next_state.resize(observation_size_);
+
+    online_ -> to(config_.device);
+    target_ -> to(config_.device);
+    online_ -> train();
+    target_ -> eval();
+
+    // a resumed agent keeps its restored target network and counters
+    const auto resume = resume_;
+    resume_ = false;
+
+    if(!resume){
+        sync_target_network();
+    }
+
+    // query the number of actions once from the online network
+    envs::copy_observation(time_step.observation(), act_state_.tensor().data_ptr<float>());
+    {
+        torch::NoGradGuard no_grad;
+        n_actions_ = static_cast<uint_t>(online_ -> forward(act_state_.to_device()).size(1));
+    }
+
+    if(!resume){
+        total_steps_ = 0;
+        n_updates_ = 0;
+    }
+}
+
+template<typename EnvType, typename ModelType>
+void
+DQNAgent<EnvType, ModelType>::actions_before_episode_begins(env_type& env, uint_t){
+
+    current_time_step_ = env.reset();
+    envs::copy_observation(current_time_step_.observation(), current_obs_.data());
+}
+
+template<typename EnvType, typename ModelType>
+EpisodeInfo
+DQNAgent<EnvType, ModelType>::on_training_episode(env_type& env, uint_t episode_idx){
+
+    auto start = std::chrono::steady_clock::now();
+
+    real_t episode_reward = 0.0;
+    uint_t itr = 0;
+    for(; config_.n_itrs_per_episode == 0 || itr < config_.n_itrs_per_episode; ++itr){
+
+        action_type action;
+        {
+            utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::ACTION_SELECTION);
+            action = select_action_();
+        }
+
+        {
+            utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::ENV_STEP);
+            current_time_step_ = env.step(action);
+        }
+
+        utils::Instrumentation::increment(utils::InstrumentationCounter::STEPS);
+
+        // build the transition in place. Once the memory is full
+        // appending copy-assigns over the oldest transition
+        std::copy(current_obs_.begin(), current_obs_.end(), transition_.state.begin());
+        envs::copy_observation(current_time_step_.observation(), transition_.next_state.data());
+        transition_.action = action;
+        transition_.reward = current_time_step_.reward();
+        transition_.done = current_time_step_.done();
+        memory_.append(transition_);
+
+        std::swap(current_obs_, transition_.next_state);
+        episode_reward += transition_.reward;
+        total_steps_ += 1;
+
+        if(memory_.size() >= std::max(config_.warmup_steps, config_.batch_size) &&
+           total_steps_ % config_.train_frequency == 0){
+            update_();
+        }
+
+        if(transition_.done){
+            itr += 1;
+            break;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<real_t> elapsed_seconds = end - start;
+
+    EpisodeInfo info;
+    info.episode_index = episode_idx;
+    info.episode_reward = episode_reward;
+    info.episode_iterations = itr;
+    info.total_time = elapsed_seconds;
+    return info;
+}
+
+template<typename EnvType, typename ModelType>
+template<typename ObsType>
+typename DQNAgent<EnvType, ModelType>::action_type
+DQNAgent<EnvType, ModelType>::act(const ObsType& observation){
+
+    envs::copy_observation(observation, act_state_.tensor().data_ptr<float>());
+    return greedy_action_();
+}
+
+template<typename EnvType, typename ModelType>
+real_t
+DQNAgent<EnvType, ModelType>::epsilon()const noexcept{
+
+    if(total_steps_ >= config_.eps_decay_steps){
+        return config_.eps_end;
+    }
+
+    const auto fraction = static_cast<real_t>(total_steps_) / static_cast<real_t>(config_.eps_decay_steps);
+    return config_.eps_start + fraction * (config_.eps_end - config_.eps_start);
+}
+
+template<typename EnvType, typename ModelType>
+void
+DQNAgent<EnvType, ModelType>::sync_target_network(){
+
+    torch::NoGradGuard no_grad;
+
+    auto target_params = target_ -> parameters();
+    auto online_params = online_ -> parameters();
+    for(uint_t i=0; i<target_params.size(); ++i){
+        target_params[i].copy_(online_params[i]);
+    }
+
+    auto target_buffers = target_ -> buffers();
+    auto online_buffers = online_ -> buffers();
+    for(uint_t i=0; i<target_buffers.size(); ++i){
+        target_buffers[i].copy_(online_buffers[i]);
+    }
+}
+
+template<typename EnvType, typename ModelType>
+typename DQNAgent<EnvType, ModelType>::action_type
+DQNAgent<EnvType, ModelType>::select_action_(){
+
+    std::uniform_real_distribution<real_t> real_dist(0.0, 1.0);
+    if(real_dist(generator_) < epsilon()){
+        std::uniform_int_distribution<uint_t> action_dist(0, n_actions_ - 1);
+        return action_dist(generator_);
+    }
+
+    act_state_.copy_from(current_obs_.data());
+    return greedy_action_();
+}
+
+template<typename EnvType, typename ModelType>
+typename DQNAgent<EnvType, ModelType>::action_type
+DQNAgent<EnvType, ModelType>::greedy_action_(){
+
+    if(config_.use_inference_mode){
+        c10::InferenceMode guard;
+        return torch_utils::TorchAdaptor::to_scalar<action_type>(online_ -> forward(act_state_.to_device()).argmax(1));
+    }
+
+    torch::NoGradGuard no_grad;
+    return torch_utils::TorchAdaptor::to_scalar<action_type>(online_ -> forward(act_state_.to_device()).argmax(1));
+}
+
+template<typename EnvType, typename ModelType>
+void
+DQNAgent<EnvType, ModelType>::update_(){
+
+    const auto B = static_cast<int64_t>(config_.batch_size);
+
+    torch_tensor_t loss;
+    {
+        utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::LOSS);
+
+        // gather the minibatch into the preallocated tensors
+        memory_.sample_indices(config_.batch_size, batch_indices_, generator_);
 
-    for(uint_t itr=0; itr < config_.n_itrs_per_episode; ++itr){
+        auto* states = batch_states_.data_ptr<float>();
+        auto* next_states = states + config_.batch_size * observation_size_;
+        auto* actions = batch_actions_.data_ptr<int64_t>();
+        auto* rewards = batch_rewards_.data_ptr<float>();
+        auto* dones = batch_dones_.data_ptr<float>();
 
-        // get the model predictions
-        auto model_vals = this->model_.forward(current_time_step_.observation());
+        for(uint_t i=0; i<config_.batch_size; ++i){
 
-        // choose an action. The action selector
-        // is able to resolve the action type
-        auto action = action_selector_.choose_action(model_vals);
+            const auto& transition = memory_[batch_indices_[i]];
+            std::copy(transition.state.begin(), transition.state.end(), states + i * observation_size_);
+            std::copy(transition.next_state.begin(), transition.next_state.end(), next_states + i * observation_size_);
+            actions[i] = static_cast<int64_t>(transition.action);
+            rewards[i] = static_cast<float>(transition.reward);
+            dones[i] = transition.done ? 1.0f : 0.0f;
+        }
 
+        auto all_states = batch_states_.to(config_.device);
+        auto batch_actions = batch_actions_.to(config_.device).unsqueeze(1);
+        auto batch_rewards = batch_rewards_.to(config_.device);
+        auto batch_dones = batch_dones_.to(config_.device);
 
+        torch_tensor_t q_values;
+        torch_tensor_t next_actions;
+        if(config_.double_dqn){
+
+            // one online forward over the states and the next states
+            auto all_q_values = online_ -> forward(all_states);
+            q_values = all_q_values.narrow(0, 0, B);
+            next_actions = all_q_values.narrow(0, B, B).detach().argmax(1, true);
+        }
+        else{
+            q_values = online_ -> forward(all_states.narrow(0, 0, B));
+        }
+
+        auto state_action_values = q_values.gather(1, batch_actions).squeeze(1);
+
+        torch_tensor_t targets;
+        {
+            torch::NoGradGuard no_grad;
+
+            auto next_q_values = target_ -> forward(all_states.narrow(0, B, B));
+            auto next_values = config_.double_dqn ? next_q_values.gather(1, next_actions).squeeze(1)
+                                                  : std::get<0>(next_q_values.max(1));
+
+            targets = batch_rewards + config_.gamma * (1.0 - batch_dones) * next_values;
+        }
+
+        loss = torch::smooth_l1_loss(state_action_values, targets);
+    }
+
+    {
+        utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::UPDATE);
+
+        optimizer_ -> zero_grad();
+        loss.backward();
+
+        if(config_.max_grad_norm > 0.0){
+            torch::nn::utils::clip_grad_norm_(online_ -> parameters(), config_.max_grad_norm);
+        }
+
+        optimizer_ -> step();
+    }
+
+    last_loss_ = loss.template item<real_t>();
+    n_updates_ += 1;
+    utils::Instrumentation::increment(utils::InstrumentationCounter::UPDATES);
+
+    if(config_.tau > 0.0){
+        soft_update_target_();
+    }
+    else if(n_updates_ % config_.target_update_frequency == 0){
+        sync_target_network();
     }
+}
+
+template<typename EnvType, typename ModelType>
+void
+DQNAgent<EnvType, ModelType>::save_checkpoint(io::Checkpoint& checkpoint)const{
+
+    io::add_module(checkpoint, "dqn.online", online_);
+    io::add_module(checkpoint, "dqn.target", target_);
+    io::add_optimizer(checkpoint, "dqn.optimizer", *optimizer_);
+    checkpoint.add_scalar("dqn.total_steps", total_steps_);
+    checkpoint.add_scalar("dqn.n_updates", n_updates_);
+    checkpoint.add_rng("dqn.generator", generator_);
+    io::add_torch_rng(checkpoint, "torch.generator");
+}
+
+template<typename EnvType, typename ModelType>
+void
+DQNAgent<EnvType, ModelType>::load_checkpoint(const io::MappedCheckpoint& checkpoint){
+
+    io::load_module(checkpoint, "dqn.online", online_, config_.device);
+    io::load_module(checkpoint, "dqn.target", target_, config_.device);
+    io::load_optimizer(checkpoint, "dqn.optimizer", *optimizer_, config_.device);
+    total_steps_ = checkpoint.scalar<uint_t>("dqn.total_steps");
+    n_updates_ = checkpoint.scalar<uint_t>("dqn.n_updates");
+    checkpoint.load_rng("dqn.generator", generator_);
+    io::load_torch_rng(checkpoint, "torch.generator");
+    resume_ = true;
+}
+
+template<typename EnvType, typename ModelType>
+void
+DQNAgent<EnvType, ModelType>::soft_update_target_(){
 
+    torch::NoGradGuard no_grad;
 
+    auto target_params = target_ -> parameters();
+    auto online_params = online_ -> parameters();
+    for(uint_t i=0; i<target_params.size(); ++i){
+        target_params[i].mul_(1.0 - config_.tau).add_(online_params[i], config_.tau);
+    }
 }
 
 }
@@ -6,8 +6,8 @@
 #ifdef USE_PYTORCH
 
 #include "cubeai/base/cubeai_types.h"
-//#include "cubeai/rl/episode_result_info.h"
-#include "cubeai/optimization/optimizer_type.h"
+#include "cubeai/rl/episode_info.h"
+#include "cubeai/maths/optimization/optimizer_type.h"
 
 #include <torch/torch.h>
 #include <boost/noncopyable.hpp>
@@ -17,10 +17,6 @@
 
 namespace cubeai {
 namespace rl{
-
-/// Forward declaration
-struct EpisodeResultInfo;
-
 namespace pytorch{
 
 ///
@@ -36,12 +32,12 @@ struct TorchAgentConfig
     ///
     /// \brief device
     ///
-    torch::Device device;
+    torch::Device device{torch::kCPU};
 
     ///
     /// \brief optim_type
     ///
-    cubeai::optim::OptimzerType optim_type;
+    maths::optim::OptimzerType optim_type{maths::optim::OptimzerType::ADAM};
 
     ///
     /// \brief optim_options
@@ -84,13 +80,13 @@ public:
     /// \param episode_idx
     /// \return
     ///
-    virtual EpisodeResultInfo on_training_episode(env_type& env, uint_t episode_idx)=0;
+    virtual EpisodeInfo on_training_episode(env_type& env, uint_t episode_idx)=0;
 
     ///
     /// \brief  actions_after_episode_ends. Execute any actions the algorithm needs after
     /// ending the episode
     ///
-    virtual void actions_after_episode_ends(env_type&, uint_t)=0;
+    virtual void actions_after_episode_ends(env_type&, uint_t, const EpisodeInfo&)=0;
 
     ///
     /// \brief actions_after_training_ends. Execute any actions the algorithm needs after
@@ -2,9 +2,9 @@
 #define A2C_H
 
 /**
-  * Implements synchronous shared-weights advantage-actor critic, A2C, algorithm
-  * Currently the implementation of this class assumes that
-  * PyTorch is used to model the deep networks
+  * Implements synchronous advantage-actor critic, A2C, algorithm
+  * over a number of parallel environments. Currently the implementation
+  * of this class assumes that PyTorch is used to model the deep networks
   *
   */
 
@@ -13,58 +13,32 @@
 #ifdef USE_PYTORCH
 
 #include "cubeai/base/cubeai_types.h"
-#include "cubeai/utils/torch_adaptor.h"
 #include "cubeai/rl/algorithms/rl_algorithm_base.h"
 #include "cubeai/rl/algorithms/utils.h"
 #include "cubeai/rl/episode_info.h"
-#include "cubeai/utils/cubeai_concepts.h"
+#include "cubeai/maths/statistics/distributions/torch_categorical.h"
+#include "cubeai/utils/instrumentation.h"
 #include "cubeai/utils/torch_adaptor.h"
-#include "cubeai/data_structs/experience_buffer.h"
+
+#include <torch/torch.h>
 
 #ifdef CUBEAI_DEBUG
 #include <cassert>
 #endif
 
-#include <string>
+#include <algorithm>
 #include <chrono>
-#include <map>
-#include <any>
 #include <memory>
-#include <tuple>
+#include <numeric>
+#include <random>
 #include <string>
+#include <vector>
 
 namespace cubeai{
 namespace rl{
 namespace algos {
 namespace ac {
 
-namespace  {
-
-
-// utility functio to stack the values under prop_name
-// in the given buffer as PyTorch tensor.
-// TODO: maybe we need to guard against the prop_name
-template<typename ExperienceType>
-torch_tensor_t
-stack_values(const cubeai::containers::ExperienceBuffer<ExperienceType>& buffer,
-             const std::string& prop_name ){
-
-    std::vector<torch_tensor_t> vals;
-    vals.reserve(buffer.size());
-
-    for(const auto& item: buffer){
-        auto& info = std::get<4>(item);
-
-        auto value_itr = info.find(prop_name);
-        auto values = std::any_cast<torch_tensor_t>(value_itr -> second);
-        vals.push_back(values);
-    }
-
-    return torch::cat(vals);
-}
-
-}
-
 ///
 /// \brief The A2CConfig struct. Configuration for A2C class
 ///
@@ -77,9 +51,10 @@ struct A2CConfig
     real_t gamma{0.99};
 
     ///
-    /// \brief GAE lambda
+    /// \brief GAE lambda. With lambda = 1 the advantages
+    /// are formed from the n-step bootstrapped returns
     ///
-    real_t lambda{0.1};
+    real_t lambda{0.95};
 
     ///
     /// \brief Coefficient for accounting for entropy contribution
@@ -93,51 +68,85 @@ struct A2CConfig
     real_t policy_loss_weight{ 1.0};
 
     ///
-    ///
+    /// \brief value_loss_weight. How much weight to give
+    /// on the critic loss when forming the global loss
     ///
     real_t value_loss_weight{1.0};
 
     ///
-    ///
+    /// \brief max_grad_norm. The gradients of each network are
+    /// clipped to this norm. Non positive values disable clipping
     ///
     real_t max_grad_norm{1.0};
 
     ///
-    ///
+    /// \brief n_iterations_per_episode. Number of steps every
+    /// environment copy performs per rollout
     ///
     uint_t n_iterations_per_episode{100};
 
     ///
+    /// \brief batch_size. Size of the minibatches the rollout is split
+    /// into for the update. Zero uses the whole rollout as one batch
     ///
-    ///
-    uint_t buffer_size{100};
+    uint_t batch_size{0};
 
     ///
+    /// \brief normalize_advantages. Normalize the advantages
+    /// of every minibatch to zero mean and unit variance
     ///
-    ///
-    uint_t batch_size{1};
+    bool normalize_advantages{true};
 
     ///
+    /// \brief device. Where the networks live. The rollout
+    /// is always collected on the CPU
     ///
-    ///
-    bool normalize_advantages{true};
+    std::string device{"cpu"};
 
     ///
+    /// \brief use_inference_mode. Run the acting forward passes of the
+    /// rollout and of act under torch::InferenceMode instead of
+    /// torch::NoGradGuard. The update always records the graph
     ///
-    ///
-    std::string device{"cpu"};
+    bool use_inference_mode{true};
 
     ///
     ///
     ///
     std::string save_model_path{""};
+
+    ///
+    /// \brief seed. Used to shuffle the minibatches
+    ///
+    uint_t seed{42};
+};
+
+///
+/// \brief The A2CLosses struct. The loss terms of the last update
+///
+struct A2CLosses
+{
+    real_t policy_loss{0.0};
+    real_t value_loss{0.0};
+    real_t entropy{0.0};
 };
 
 /**
  * @brief A2C solver assuming separate networks for the actor and
- * the critic. In additio the implementation assumes that the
- * given environment handles any multiplicity of the environments
+ * the critic. The environment runs n_copies() environments in lockstep,
+ * see envs::SerialVectorEnv, and should expose
+ *
+ * - uint_t n_copies()
+ * - void reset(std::vector<float>& observations)
+ * - void step(const uint_t* actions, float* observations, float* rewards, float* dones)
  *
+ * Every episode of the solver collects a rollout of n_iterations_per_episode
+ * steps from all the copies into preallocated tensors. The acting forward passes
+ * run without autograd, under torch::InferenceMode by default. GAE(lambda) advantages and returns are then computed in a
+ * single backward pass over the rollout and the networks are updated by re-evaluating
+ * them over shuffled minibatches of the rollout. The policy forward should return
+ * the unnormalized action logits of shape [batch, n_actions], not probabilities,
+ * and the critic forward the values of shape [batch, 1]
  */
 template<typename EnvType, typename PolicyType, typename CriticType>
 class A2CSolver final: public RLSolverBase<EnvType>
@@ -170,8 +179,8 @@ public:
               std::unique_ptr<torch::optim::Optimizer>& critic_optimizer);
 
     ///
-    /// \brief actions_before_training_begins. Execute any actions the
-    /// algorithm needs before starting the iterations
+    /// \brief actions_before_training_begins. Resets the environments
+    /// and allocates the rollout storage
     ///
     virtual void actions_before_training_begins(env_type&);
 
@@ -189,10 +198,12 @@ public:
     ///
     /// \brief actions_after_training_episode
     ///
-    virtual void actions_after_episode_ends(env_type&, uint_t /*episode_idx*/, const EpisodeInfo& info);
+    virtual void actions_after_episode_ends(env_type&, uint_t /*episode_idx*/, const EpisodeInfo& /*info*/){}
 
     ///
-    /// \brief on_episode Do one on_episode of the algorithm
+    /// \brief on_episode Collect one rollout and update the networks.
+    /// The reported reward is the mean return of the episodes that
+    /// finished during the rollout
     ///
     virtual EpisodeInfo on_training_episode(env_type&, uint_t /*episode_idx*/);
 
@@ -206,16 +217,26 @@ public:
     ///
     void set_evaluation_mode()noexcept;
 
-private:
+    ///
+    /// \brief act. The actions of the policy for n_copies() observations laid
+    /// out contiguously, greedy or sampled. The forward pass runs on staging
+    /// tensors allocated in actions_before_training_begins and the guard is
+    /// chosen by use_inference_mode. The mode of the networks is not changed
+    ///
+    void act(const float* observations, uint_t* actions, bool greedy=true);
 
-    // helper class
-    struct action_result
-    {
-        torch_tensor_t log_probs;
-        torch_tensor_t values;
-        torch_tensor_t actions;
-        torch_tensor_t entropies;
-    };
+    ///
+    /// \brief last_losses. The loss terms of the last minibatch
+    ///
+    const A2CLosses& last_losses()const noexcept{return last_losses_;}
+
+    ///
+    /// \brief n_finished_episodes. Number of environment episodes
+    /// completed since training started
+    ///
+    uint_t n_finished_episodes()const noexcept{return n_finished_episodes_;}
+
+private:
 
     ///
     /// \brief config_
@@ -243,26 +264,75 @@ private:
     std::unique_ptr<torch::optim::Optimizer> critic_optimizer_;
 
     ///
+    /// \brief device_
+    ///
+    torch::Device device_;
+
+    ///
+    /// \brief Rollout storage. Float tensors on the CPU of shape
+    /// observations_ [T + 1, N, D], values_ [T + 1, N] and [T, N]
+    /// for the rest. Allocated once in actions_before_training_begins
     ///
+    torch_tensor_t observations_;
+    torch_tensor_t actions_;
+    torch_tensor_t rewards_;
+    torch_tensor_t dones_;
+    torch_tensor_t values_;
+    torch_tensor_t advantages_;
+    torch_tensor_t returns_;
+
+    ///
+    /// \brief indices_. Permutation of the rollout used for the minibatches
+    ///
+    torch_tensor_t indices_;
+
+    ///
+    /// \brief Acting tensors. act_input_ is a [N, D] staging tensor used when
+    /// the networks are not on the CPU or by act, act_output_ the [N] actions
+    /// of act on the device
+    ///
+    torch_utils::TorchStagingTensor act_input_;
+    torch_tensor_t act_output_;
+
+    ///
+    /// \brief action_buffer_. The actions handed to the environment
     ///
-    EpisodeInfo do_train_on_episode_(env_type&, uint_t /*episode_idx*/);
+    std::vector<uint_t> action_buffer_;
 
     ///
-    /// \brief act_on_episode_iteration_ For every episode iteration
-    /// this function computes the result for the critic and actor networks
-    /// \param state
+    /// \brief running_returns_. Return so far of the current episode of every copy
     ///
-    action_result act_on_episode_iteration_(torch_tensor_t& state);
+    std::vector<real_t> running_returns_;
+
+    uint_t n_envs_;
+    uint_t observation_size_;
+    uint_t n_finished_episodes_;
+
+    ///
+    /// \brief generator_. Shuffles the minibatches
+    ///
+    std::mt19937 generator_;
 
     ///
-    /// \brief optimize_model_
-    /// \param logprobs
-    /// \param entropies
-    /// \param values
-    /// \param rewards
+    /// \brief last_losses_
     ///
-    //torch_tensor_t compute_loss_(torch_tensor_t logprobs, torch_tensor_t entropies,
-    //                             torch_tensor_t values, torch_tensor_t rewards);
+    A2CLosses last_losses_;
+
+    ///
+    /// \brief collect_rollout_. Fill the rollout storage. Returns the
+    /// sum and the number of the episode returns that finished
+    ///
+    std::pair<real_t, uint_t> collect_rollout_(env_type& env);
+
+    ///
+    /// \brief compute_advantages_. GAE over the rollout
+    ///
+    void compute_advantages_();
+
+    ///
+    /// \brief update_. Update both networks over the rollout
+    ///
+    void update_();
 
 };
 
@@ -276,7 +346,25 @@ A2CSolver<EnvType, PolicyType, CriticType>::A2CSolver(const A2CConfig config,
       policy_(policy),
       critic_(critic),
       policy_optimizer_(std::move(policy_optimizer)),
-      critic_optimizer_(std::move(critic_optimizer))
+      critic_optimizer_(std::move(critic_optimizer)),
+      device_(config.device),
+      observations_(),
+      actions_(),
+      rewards_(),
+      dones_(),
+      values_(),
+      advantages_(),
+      returns_(),
+      indices_(),
+      act_input_(),
+      act_output_(),
+      action_buffer_(),
+      running_returns_(),
+      n_envs_(0),
+      observation_size_(0),
+      n_finished_episodes_(0),
+      generator_(config.seed),
+      last_losses_()
 {}
 
 template<typename EnvType, typename PolicyType, typename CriticType>
@@ -297,216 +385,287 @@ A2CSolver<EnvType, PolicyType, CriticType>::set_evaluation_mode()noexcept{
 
 template<typename EnvType, typename PolicyType, typename CriticType>
 void
-A2CSolver<EnvType, PolicyType, CriticType>::actions_before_training_begins(env_type& env){
-    set_train_mode();
-}
+A2CSolver<EnvType, PolicyType, CriticType>::act(const float* observations, uint_t* actions, bool greedy){
 
-template<typename EnvType, typename PolicyType, typename CriticType>
-EpisodeInfo
-A2CSolver<EnvType, PolicyType, CriticType>::on_training_episode(env_type& env, uint_t episode_idx){
-
-    auto start = std::chrono::steady_clock::now();
-
-    uint_t itrs = 0;
-    auto R = 0.0;
+    act_input_.copy_from(observations);
+    torch_utils::run_without_autograd(config_.use_inference_mode, [&](){
 
-    auto eps_info = do_train_on_episode_(env, episode_idx);
-
-    auto end = std::chrono::steady_clock::now();
-    std::chrono::duration<real_t> elapsed_seconds = end - start;
+        auto logits = policy_ -> forward(act_input_.to_device());
+        if(greedy){
+            torch::argmax_out(act_output_, logits, 1);
+        }
+        else{
+            act_output_.copy_(maths::stats::TorchCategorical(logits, true).sample());
+        }
+    });
 
-    EpisodeInfo info;
-    info.episode_index = episode_idx;
-    info.episode_reward = R;
-    info.episode_iterations = eps_info.episode_iterations;
-    info.total_time = elapsed_seconds;
-    return info;
+    const auto result = act_output_.cpu();
+    const auto* data = result.data_ptr<int64_t>();
+    for(uint_t e=0; e<n_envs_; ++e){
+        actions[e] = static_cast<uint_t>(data[e]);
+    }
 }
 
 template<typename EnvType, typename PolicyType, typename CriticType>
-EpisodeInfo
-A2CSolver<EnvType, PolicyType, CriticType>::do_train_on_episode_(env_type& env, uint_t episode_idx){
-
-    auto episode_score = 0.0;
-
-    typedef torch_utils::TorchAdaptor::state_type state_type;
-    typedef torch_utils::TorchAdaptor::value_type value_type;
-    typedef typename EnvType::time_step_type time_step_type;
+void
+A2CSolver<EnvType, PolicyType, CriticType>::actions_before_training_begins(env_type& env){
 
-    typedef std::tuple<state_type,
-                       state_type,
-                       real_t,
-                       time_step_type,
-                       std::map<std::string, std::any>> experience_type;
+    set_train_mode();
 
-    // create a buffer for experience accummulation
-    cubeai::containers::ExperienceBuffer<experience_type> buffer(config_.buffer_size);
-    auto time_step = env.reset();
-    auto state = time_step.observation();
+    std::vector<float> initial_observations;
+    env.reset(initial_observations);
 
-    // helper class to convert from std::vector to torch_tensor_t
-    // and vice versa
-    torch_utils::TorchAdaptor torch_adaptor;
+    n_envs_ = env.n_copies();
+    observation_size_ = initial_observations.size() / n_envs_;
 
-    // loop over the iterations
-    uint_t itrs = 0;
-    for(; itrs < config_.n_iterations_per_episode; ++ itrs){
+    const auto n_steps = static_cast<int64_t>(config_.n_iterations_per_episode);
+    const auto n_envs = static_cast<int64_t>(n_envs_);
+    const auto float_opts = torch::TensorOptions().dtype(torch::kFloat32);
 
-        auto torch_state = torch_adaptor(state);
-        auto action_result = act_on_episode_iteration_(torch_state);
+    observations_ = torch::zeros({n_steps + 1, n_envs, static_cast<int64_t>(observation_size_)}, float_opts);
+    actions_ = torch::zeros({n_steps, n_envs}, torch::TensorOptions().dtype(torch::kInt64));
+    rewards_ = torch::zeros({n_steps, n_envs}, float_opts);
+    dones_ = torch::zeros({n_steps, n_envs}, float_opts);
+    values_ = torch::zeros({n_steps + 1, n_envs}, float_opts);
+    advantages_ = torch::zeros({n_steps, n_envs}, float_opts);
+    returns_ = torch::zeros({n_steps, n_envs}, float_opts);
+    indices_ = torch::arange(n_steps * n_envs, torch::TensorOptions().dtype(torch::kInt64));
 
-        auto action = torch_utils::TorchAdaptor::to_vector<uint_t>(action_result.actions)[0];
-        auto next_time_step = env.step(action);
+    act_input_.allocate({n_envs, static_cast<int64_t>(observation_size_)}, device_);
+    act_output_ = torch::zeros({n_envs}, torch::TensorOptions().dtype(torch::kInt64).device(device_));
 
-        auto next_state = next_time_step.observation();
-        auto reward = next_time_step.reward();
+    std::copy(initial_observations.begin(), initial_observations.end(), observations_.data_ptr<float>());
 
-        std::map<std::string, std::any> info;
-        info["log_probs"] = action_result.log_probs;
-        info["values"] = action_result.values;
+    action_buffer_.assign(n_envs_, 0);
+    running_returns_.assign(n_envs_, 0.0);
+    n_finished_episodes_ = 0;
+}
 
-        // how do we handle the fact that the environment exited?
-        // do not append anything in the buffer exit the loop
+template<typename EnvType, typename PolicyType, typename CriticType>
+EpisodeInfo
+A2CSolver<EnvType, PolicyType, CriticType>::on_training_episode(env_type& env, uint_t episode_idx){
 
-        auto torch_next_state = torch_adaptor(next_state);
-        buffer.append(std::make_tuple(torch_state,
-                                      torch_next_state,
-                                      reward,
-                                      next_time_step,
-                                      info));
+    auto start = std::chrono::steady_clock::now();
 
-        state = next_state;
+    auto [finished_returns, n_finished] = collect_rollout_(env);
+    compute_advantages_();
+    update_();
 
-        if(buffer.size() < config_.buffer_size){
-            continue;
-        }
-    }
+    // the next rollout starts where this one stopped
+    observations_[0].copy_(observations_[config_.n_iterations_per_episode]);
 
-    // optimize the model check the actions_after_episode_ends
-    // function for this
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<real_t> elapsed_seconds = end - start;
 
     EpisodeInfo info;
     info.episode_index = episode_idx;
-    info.episode_reward = episode_score;
-    info.episode_iterations = itrs;
-    info.info["log_probs"] = stack_values(buffer, "log_probs"); //stack_log_probs(buffer);
-    info.info["values"] = stack_values(buffer, "values");
-    info.info["rewards"] = stack_values(buffer, "rewards"); //stack_rewards(buffer);
+    info.episode_iterations = config_.n_iterations_per_episode;
+    info.total_time = elapsed_seconds;
+
+    if(n_finished != 0){
+        info.episode_reward = finished_returns / static_cast<real_t>(n_finished);
+    }
+    else{
+        // no episode finished, report how far the
+        // current ones have got on average
+        info.episode_reward = std::accumulate(running_returns_.begin(), running_returns_.end(), 0.0) /
+                              static_cast<real_t>(n_envs_);
+    }
+
     return info;
 }
 
 template<typename EnvType, typename PolicyType, typename CriticType>
-typename A2CSolver<EnvType, PolicyType, CriticType>::action_result
-A2CSolver<EnvType, PolicyType, CriticType>::act_on_episode_iteration_(torch_tensor_t& state){
+std::pair<real_t, uint_t>
+A2CSolver<EnvType, PolicyType, CriticType>::collect_rollout_(env_type& env){
 
-    // get the probabilities and the values
-    auto probs = policy_ -> forward(state);
-    auto values = critic_ -> forward(state);
+    real_t finished_returns = 0.0;
+    uint_t n_finished = 0;
 
-    // sample the actions
-    auto actions = policy_ -> sample();
-    auto logprobs = policy_ -> log_probabilities(actions);
+    const auto n_steps = config_.n_iterations_per_episode;
+    for(uint_t t=0; t<n_steps; ++t){
 
-    typedef typename A2CSolver<EnvType, PolicyType, CriticType>::action_result action_result;
+        {
+            utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::ACTION_SELECTION);
 
-    action_result result;
-    result.actions = actions;
-    result.log_probs = logprobs;
-    result.values = values;
-    return result;
-}
+            // the rollout tensors are written in place so they
+            // stay usable by the update after InferenceMode
+            torch_utils::run_without_autograd(config_.use_inference_mode, [&](){
 
-template<typename EnvType,typename PolicyType, typename CriticType>
-void
-A2CSolver<EnvType, PolicyType, CriticType>::actions_after_episode_ends(env_type&, uint_t /*episode_idx*/,
-                                                                       const EpisodeInfo& info){
+                auto state = observations_[t];
+                if(!device_.is_cpu()){
+                    act_input_.copy_from(state.data_ptr<float>());
+                    state = act_input_.to_device();
+                }
 
-        auto logprobs_itr = info.info.find("log_probs");
-        auto values_itr = info.info.find("values");
-        auto rewards_itr = info.info.find("rewards");
+                auto logits = policy_ -> forward(state);
+                auto values = critic_ -> forward(state);
 
-        if(logprobs_itr == info.info.end() || values_itr == info.info.end() ||
-            rewards_itr == info.info.end()){
-            throw std::logic_error("Couldn't find needed item");
+                values_[t].copy_(values.reshape({-1}));
+                actions_[t].copy_(maths::stats::TorchCategorical(logits, true).sample());
+            });
+
+            const auto* actions = actions_[t].data_ptr<int64_t>();
+            for(uint_t e=0; e<n_envs_; ++e){
+                action_buffer_[e] = static_cast<uint_t>(actions[e]);
+            }
         }
 
-        auto logprobs = std::any_cast<torch_tensor_t>(logprobs_itr -> second);
-        auto values = std::any_cast<torch_tensor_t>(values_itr -> second);
-        auto rewards = std::any_cast<torch_tensor_t>(rewards_itr -> second);
+        {
+            utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::ENV_STEP);
+            env.step(action_buffer_.data(), observations_[t + 1].data_ptr<float>(),
+                     rewards_[t].data_ptr<float>(), dones_[t].data_ptr<float>());
+        }
 
-        auto advantage = rewards - values;
+        utils::Instrumentation::increment(utils::InstrumentationCounter::STEPS, n_envs_);
 
-        auto policy_loss = -(logprobs * advantage.detach()).mean();
-        auto critic_loss = advantage.pow(2).mean();
+        const auto* rewards = rewards_[t].data_ptr<float>();
+        const auto* dones = dones_[t].data_ptr<float>();
+        for(uint_t e=0; e<n_envs_; ++e){
 
-        // compute the loss we have two networks so two losses
-        // auto loss = compute_loss_(std::any_cast<torch_tensor_t>(logprobs->second), torch_tensor_t(),
-        //                          std::any_cast<torch_tensor_t>(values->second),
-        //                          std::any_cast<torch_tensor_t>(rewards->second));
+            running_returns_[e] += rewards[e];
 
-        // Backward pass and optimize
-        policy_optimizer_->zero_grad();
-        critic_optimizer_ -> zero_grad();
+            if(dones[e] != 0.0f){
+                finished_returns += running_returns_[e];
+                n_finished += 1;
+                running_returns_[e] = 0.0;
+            }
+        }
+    }
 
-        policy_loss.backward();
-        critic_loss.backward();
+    // values of the last observations to bootstrap from
+    {
+        utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::ACTION_SELECTION);
+        torch_utils::run_without_autograd(config_.use_inference_mode, [&](){
 
-        policy_optimizer_ -> step();
-        critic_optimizer_ -> step();
+            auto state = observations_[n_steps];
+            if(!device_.is_cpu()){
+                act_input_.copy_from(state.data_ptr<float>());
+                state = act_input_.to_device();
+            }
 
+            values_[n_steps].copy_(critic_ -> forward(state).reshape({-1}));
+        });
+    }
 
+    n_finished_episodes_ += n_finished;
+    return {finished_returns, n_finished};
 }
 
-
-/*
 template<typename EnvType, typename PolicyType, typename CriticType>
-torch_tensor_t
-A2CSolver<EnvType, PolicyType, CriticType>::compute_loss_(torch_tensor_t logprobs, torch_tensor_t entropies,
-                                                          torch_tensor_t values, torch_tensor_t rewards){
+void
+A2CSolver<EnvType, PolicyType, CriticType>::compute_advantages_(){
 
+    utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::LOSS);
 
-        // create the discounts
-        auto discounts = create_discounts_array(config_.gamma, rewards.size(0));
+    const auto n_steps = config_.n_iterations_per_episode;
+    const auto* values = values_.data_ptr<float>();
 
-        auto vec_rewards = torch_utils::TorchAdaptor::to_vector<real_t>(rewards);
-        auto vec_values = torch_utils::TorchAdaptor::to_vector<real_t>(values.detach());
+    generalized_advantage_estimate(rewards_.data_ptr<float>(), values, dones_.data_ptr<float>(),
+                                   values + n_steps * n_envs_, n_steps, n_envs_,
+                                   config_.gamma, config_.lambda,
+                                   advantages_.data_ptr<float>(), returns_.data_ptr<float>());
+}
 
-        // calculate the discounted returns
-        auto discounted_returns = calculate_discounted_returns(vec_rewards, discounts, config_.n_workers);
+template<typename EnvType, typename PolicyType, typename CriticType>
+void
+A2CSolver<EnvType, PolicyType, CriticType>::update_(){
 
-        // compute the advanatges
-        auto advantages = compute_advantages_(vec_rewards, vec_values);
+    const auto n_steps = static_cast<int64_t>(config_.n_iterations_per_episode);
+    const auto n_samples = n_steps * static_cast<int64_t>(n_envs_);
 
-        // form the loss function
+    auto batch_size = static_cast<int64_t>(config_.batch_size);
+    if(batch_size == 0 || batch_size > n_samples){
+        batch_size = n_samples;
+    }
 
-        // clip the grad if needed
-        torch::nn::utils::clip_grad_norm_(parameters(), config_.max_grad_norm);
+    // flat views over the rollout, no copies
+    auto observations = observations_.narrow(0, 0, n_steps).reshape({n_samples, static_cast<int64_t>(observation_size_)});
+    auto actions = actions_.reshape({n_samples});
+    auto advantages = advantages_.reshape({n_samples});
+    auto returns = returns_.reshape({n_samples});
 
-        # get the discounted returns
-        discounted_returns: np.array = calculate_discounted_returns(rewards.numpy(),
-                                                                    discounts,
-                                                                    n_workers=self.config.n_workers)
+    if(batch_size < n_samples){
+        auto* indices = indices_.data_ptr<int64_t>();
+        std::shuffle(indices, indices + n_samples, generator_);
+    }
 
-        advantages: np.array = self._compute_advantages(rewards=rewards.numpy(),
-                                                        values=values.detach().numpy())
+    for(int64_t begin=0; begin < n_samples; begin += batch_size){
+
+        const auto size = std::min(batch_size, n_samples - begin);
+
+        torch_tensor_t loss;
+        {
+            utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::LOSS);
+
+            torch_tensor_t mb_observations;
+            torch_tensor_t mb_actions;
+            torch_tensor_t mb_advantages;
+            torch_tensor_t mb_returns;
+
+            if(size == n_samples){
+                mb_observations = observations;
+                mb_actions = actions;
+                mb_advantages = advantages;
+                mb_returns = returns;
+            }
+            else{
+                auto idx = indices_.narrow(0, begin, size);
+                mb_observations = observations.index_select(0, idx);
+                mb_actions = actions.index_select(0, idx);
+                mb_advantages = advantages.index_select(0, idx);
+                mb_returns = returns.index_select(0, idx);
+            }
+
+            mb_observations = mb_observations.to(device_);
+            mb_actions = mb_actions.to(device_);
+            mb_advantages = mb_advantages.to(device_);
+            mb_returns = mb_returns.to(device_);
+
+            if(config_.normalize_advantages && size > 1){
+                mb_advantages = (mb_advantages - mb_advantages.mean()) / (mb_advantages.std() + 1.0e-8);
+            }
+
+            auto logits = policy_ -> forward(mb_observations);
+            auto values = critic_ -> forward(mb_observations).reshape({-1});
+
+            maths::stats::TorchCategorical distribution(logits, true);
+            auto log_probs = distribution.log_prob(mb_actions);
+            auto entropy = distribution.entropy().mean();
+
+            auto policy_loss = -(log_probs * mb_advantages).mean();
+            auto value_loss = (mb_returns - values).pow(2).mean();
+
+            loss = config_.policy_loss_weight * policy_loss +
+                   config_.value_loss_weight * value_loss -
+                   config_.beta * entropy;
+
+            last_losses_.policy_loss = policy_loss.template item<real_t>();
+            last_losses_.value_loss = value_loss.template item<real_t>();
+            last_losses_.entropy = entropy.template item<real_t>();
+        }
 
-        loss: torch.Tensor = self._compute_loss_function(advantages=torch.from_numpy(advantages), values=values,
-                                                         entropies=entropies,
-                                                         returns=torch.from_numpy(discounted_returns),
-                                                         logprobs=logprobs[:-1])
+        {
+            utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::UPDATE);
 
+            policy_optimizer_ -> zero_grad();
+            critic_optimizer_ -> zero_grad();
 
-        loss.backward()
+            loss.backward();
 
-        # clip the grad if needed
-        torch.nn.utils.clip_grad_norm_(self.parameters(),
-                                       self.config.max_grad_norm)
+            if(config_.max_grad_norm > 0.0){
+                torch::nn::utils::clip_grad_norm_(policy_ -> parameters(), config_.max_grad_norm);
+                torch::nn::utils::clip_grad_norm_(critic_ -> parameters(), config_.max_grad_norm);
+            }
 
+            policy_optimizer_ -> step();
+            critic_optimizer_ -> step();
+        }
 
+        utils::Instrumentation::increment(utils::InstrumentationCounter::UPDATES);
+    }
 }
 
-*/
-
 }
 
 }
@@ -0,0 +1,498 @@
+#ifndef PPO_H
+#define PPO_H
+
+/**
+  * Implements the proximal policy optimization, PPO, algorithm
+  * with the clipped surrogate objective over a number of parallel
+  * environments. The implementation assumes that PyTorch is used
+  * to model the deep networks
+  *
+  */
+
+#include "cubeai/base/cubeai_config.h"
+
+#ifdef USE_PYTORCH
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/algorithms/rl_algorithm_base.h"
+#include "cubeai/rl/algorithms/actor_critic/rollout_buffer.h"
+#include "cubeai/rl/episode_info.h"
+#include "cubeai/maths/statistics/distributions/torch_categorical.h"
+#include "cubeai/maths/optimization/optimizer_type.h"
+#include "cubeai/maths/optimization/pytorch_optimizer_factory.h"
+#include "cubeai/utils/instrumentation.h"
+
+#include <torch/torch.h>
+
+#include <algorithm>
+#include <any>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace cubeai{
+namespace rl{
+namespace algos {
+namespace ac {
+
+///
+/// \brief The PPOConfig struct. Configuration for the PPOSolver class
+///
+struct PPOConfig
+{
+    ///
+    /// \brief Discount factor
+    ///
+    real_t gamma{0.99};
+
+    ///
+    /// \brief GAE lambda
+    ///
+    real_t lambda{0.95};
+
+    ///
+    /// \brief clip_epsilon. The probability ratio is clipped
+    /// to [1 - clip_epsilon, 1 + clip_epsilon]
+    ///
+    real_t clip_epsilon{0.2};
+
+    ///
+    /// \brief value_clip_epsilon. The new value predictions are kept within
+    /// value_clip_epsilon of the rollout ones. Non positive values disable it
+    ///
+    real_t value_clip_epsilon{0.2};
+
+    ///
+    /// \brief Coefficient of the entropy bonus
+    ///
+    real_t beta{0.01};
+
+    ///
+    /// \brief policy_loss_weight
+    ///
+    real_t policy_loss_weight{1.0};
+
+    ///
+    /// \brief value_loss_weight
+    ///
+    real_t value_loss_weight{0.5};
+
+    ///
+    /// \brief max_grad_norm. Non positive values disable clipping
+    ///
+    real_t max_grad_norm{0.5};
+
+    ///
+    /// \brief n_iterations_per_episode. Number of steps every
+    /// environment copy performs per rollout
+    ///
+    uint_t n_iterations_per_episode{128};
+
+    ///
+    /// \brief n_epochs. Passes over the rollout per update
+    ///
+    uint_t n_epochs{4};
+
+    ///
+    /// \brief batch_size. Minibatch size
+    ///
+    uint_t batch_size{64};
+
+    ///
+    /// \brief normalize_advantages. Per minibatch
+    ///
+    bool normalize_advantages{true};
+
+    ///
+    /// \brief The optimizer used for both networks
+    ///
+    maths::optim::OptimzerType optimizer_type{maths::optim::OptimzerType::ADAM};
+
+    ///
+    /// \brief learning_rate
+    ///
+    real_t learning_rate{3.0e-4};
+
+    ///
+    /// \brief device. Where the networks live. The rollout
+    /// is always collected on the CPU
+    ///
+    std::string device{"cpu"};
+
+    ///
+    /// \brief seed. Used to shuffle the minibatches
+    ///
+    uint_t seed{42};
+};
+
+///
+/// \brief The PPOStats struct. Diagnostics of the last update
+///
+struct PPOStats
+{
+    real_t policy_loss{0.0};
+    real_t value_loss{0.0};
+    real_t entropy{0.0};
+
+    ///
+    /// \brief approx_kl. Mean of old_log_prob - new_log_prob
+    ///
+    real_t approx_kl{0.0};
+
+    ///
+    /// \brief clip_fraction. Fraction of samples whose ratio was clipped
+    ///
+    real_t clip_fraction{0.0};
+};
+
+/**
+ * @brief PPO solver with separate actor and critic networks. The
+ * environment contract is the same as for A2CSolver: it runs n_copies()
+ * environments in lockstep, see envs::SerialVectorEnv. Every episode of
+ * the solver collects a rollout of n_iterations_per_episode steps into a
+ * RolloutBuffer, computes the GAE advantages and then performs n_epochs
+ * passes of shuffled minibatch updates. As for A2CSolver the policy forward
+ * returns the action logits. The optimizers are built with
+ * build_pytorch_optimizer from the configuration
+ */
+template<typename EnvType, typename PolicyType, typename CriticType>
+class PPOSolver final: public RLSolverBase<EnvType>
+{
+public:
+
+    typedef EnvType env_type;
+    typedef PolicyType policy_type;
+    typedef CriticType critic_type;
+
+    ///
+    /// \brief Constructor
+    ///
+    PPOSolver(const PPOConfig config, policy_type& policy, critic_type& critic);
+
+    ///
+    /// \brief actions_before_training_begins. Resets the environments
+    /// and allocates the rollout buffer
+    ///
+    virtual void actions_before_training_begins(env_type&);
+
+    ///
+    /// \brief actions_after_training_ends
+    ///
+    virtual void actions_after_training_ends(env_type&){}
+
+    ///
+    /// \brief on_training_episode. Collect one rollout and update
+    /// the networks. The reported reward is the mean return of the
+    /// episodes that finished during the rollout
+    ///
+    virtual EpisodeInfo on_training_episode(env_type&, uint_t episode_idx);
+
+    ///
+    /// \brief set_train_mode for both the Actor and the Critic
+    ///
+    void set_train_mode()noexcept{policy_ -> train(); critic_ -> train();}
+
+    ///
+    /// \brief set_evaluation_mode for both the Actor and the Critic
+    ///
+    void set_evaluation_mode()noexcept{policy_ -> eval(); critic_ -> eval();}
+
+    ///
+    /// \brief last_stats
+    ///
+    const PPOStats& last_stats()const noexcept{return last_stats_;}
+
+    ///
+    /// \brief n_finished_episodes. Number of environment episodes
+    /// completed since training started
+    ///
+    uint_t n_finished_episodes()const noexcept{return n_finished_episodes_;}
+
+private:
+
+    PPOConfig config_;
+    policy_type& policy_;
+    critic_type& critic_;
+
+    std::unique_ptr<torch::optim::Optimizer> policy_optimizer_;
+    std::unique_ptr<torch::optim::Optimizer> critic_optimizer_;
+
+    torch::Device device_;
+
+    ///
+    /// \brief buffer_. The rollout storage
+    ///
+    RolloutBuffer buffer_;
+
+    std::vector<uint_t> action_buffer_;
+    std::vector<real_t> running_returns_;
+    uint_t n_envs_;
+    uint_t n_finished_episodes_;
+
+    std::mt19937 generator_;
+    PPOStats last_stats_;
+
+    ///
+    /// \brief collect_rollout_. Returns the sum and the number
+    /// of the episode returns that finished
+    ///
+    std::pair<real_t, uint_t> collect_rollout_(env_type& env);
+
+    ///
+    /// \brief update_. n_epochs of minibatch updates
+    ///
+    void update_();
+};
+
+template<typename EnvType, typename PolicyType, typename CriticType>
+PPOSolver<EnvType, PolicyType, CriticType>::PPOSolver(const PPOConfig config,
+                                                      policy_type& policy, critic_type& critic)
+    :
+      config_(config),
+      policy_(policy),
+      critic_(critic),
+      policy_optimizer_(),
+      critic_optimizer_(),
+      device_(config.device),
+      buffer_(),
+      action_buffer_(),
+      running_returns_(),
+      n_envs_(0),
+      n_finished_episodes_(0),
+      generator_(config.seed),
+      last_stats_()
+{
+    std::map<std::string, std::any> options;
+    options["lr"] = config_.learning_rate;
+
+    auto torch_options = maths::optim::pytorch::build_pytorch_optimizer_options(config_.optimizer_type, options);
+    policy_optimizer_ = maths::optim::pytorch::build_pytorch_optimizer(config_.optimizer_type, *policy_, *torch_options);
+    critic_optimizer_ = maths::optim::pytorch::build_pytorch_optimizer(config_.optimizer_type, *critic_, *torch_options);
+}
+
+template<typename EnvType, typename PolicyType, typename CriticType>
+void
+PPOSolver<EnvType, PolicyType, CriticType>::actions_before_training_begins(env_type& env){
+
+    set_train_mode();
+
+    std::vector<float> initial_observations;
+    env.reset(initial_observations);
+
+    n_envs_ = env.n_copies();
+    buffer_.allocate(config_.n_iterations_per_episode, n_envs_,
+                     initial_observations.size() / n_envs_, config_.batch_size);
+
+    std::copy(initial_observations.begin(), initial_observations.end(),
+              buffer_.observations(0).data_ptr<float>());
+
+    action_buffer_.assign(n_envs_, 0);
+    running_returns_.assign(n_envs_, 0.0);
+    n_finished_episodes_ = 0;
+}
+
+template<typename EnvType, typename PolicyType, typename CriticType>
+EpisodeInfo
+PPOSolver<EnvType, PolicyType, CriticType>::on_training_episode(env_type& env, uint_t episode_idx){
+
+    auto start = std::chrono::steady_clock::now();
+
+    auto [finished_returns, n_finished] = collect_rollout_(env);
+
+    {
+        utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::LOSS);
+        buffer_.compute_advantages(config_.gamma, config_.lambda);
+    }
+
+    update_();
+    buffer_.start_next_rollout();
+
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<real_t> elapsed_seconds = end - start;
+
+    EpisodeInfo info;
+    info.episode_index = episode_idx;
+    info.episode_iterations = config_.n_iterations_per_episode;
+    info.total_time = elapsed_seconds;
+
+    if(n_finished != 0){
+        info.episode_reward = finished_returns / static_cast<real_t>(n_finished);
+    }
+    else{
+        info.episode_reward = std::accumulate(running_returns_.begin(), running_returns_.end(), 0.0) /
+                              static_cast<real_t>(n_envs_);
+    }
+
+    return info;
+}
+
+template<typename EnvType, typename PolicyType, typename CriticType>
+std::pair<real_t, uint_t>
+PPOSolver<EnvType, PolicyType, CriticType>::collect_rollout_(env_type& env){
+
+    torch::NoGradGuard no_grad;
+
+    real_t finished_returns = 0.0;
+    uint_t n_finished = 0;
+
+    const auto n_steps = buffer_.n_steps();
+    for(uint_t t=0; t<n_steps; ++t){
+
+        {
+            utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::ACTION_SELECTION);
+
+            auto state = buffer_.observations(t).to(device_);
+            auto logits = policy_ -> forward(state);
+            auto values = critic_ -> forward(state);
+
+            maths::stats::TorchCategorical distribution(logits, true);
+            auto actions = distribution.sample();
+
+            buffer_.values(t).copy_(values.reshape({-1}));
+            buffer_.actions(t).copy_(actions);
+            buffer_.log_probs(t).copy_(distribution.log_prob(actions));
+
+            const auto* sampled = buffer_.actions(t).data_ptr<int64_t>();
+            for(uint_t e=0; e<n_envs_; ++e){
+                action_buffer_[e] = static_cast<uint_t>(sampled[e]);
+            }
+        }
+
+        {
+            utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::ENV_STEP);
+            env.step(action_buffer_.data(), buffer_.observations(t + 1).data_ptr<float>(),
+                     buffer_.rewards(t).data_ptr<float>(), buffer_.dones(t).data_ptr<float>());
+        }
+
+        utils::Instrumentation::increment(utils::InstrumentationCounter::STEPS, n_envs_);
+
+        const auto* rewards = buffer_.rewards(t).data_ptr<float>();
+        const auto* dones = buffer_.dones(t).data_ptr<float>();
+        for(uint_t e=0; e<n_envs_; ++e){
+
+            running_returns_[e] += rewards[e];
+
+            if(dones[e] != 0.0f){
+                finished_returns += running_returns_[e];
+                n_finished += 1;
+                running_returns_[e] = 0.0;
+            }
+        }
+    }
+
+    {
+        utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::ACTION_SELECTION);
+        buffer_.values(n_steps).copy_(critic_ -> forward(buffer_.observations(n_steps).to(device_)).reshape({-1}));
+    }
+
+    n_finished_episodes_ += n_finished;
+    return {finished_returns, n_finished};
+}
+
+template<typename EnvType, typename PolicyType, typename CriticType>
+void
+PPOSolver<EnvType, PolicyType, CriticType>::update_(){
+
+    const auto n_samples = buffer_.n_samples();
+    const auto batch_size = std::min(config_.batch_size == 0 ? n_samples : config_.batch_size, n_samples);
+
+    const auto clip_low = 1.0 - config_.clip_epsilon;
+    const auto clip_high = 1.0 + config_.clip_epsilon;
+
+    for(uint_t epoch=0; epoch<config_.n_epochs; ++epoch){
+
+        buffer_.shuffle(generator_);
+
+        for(uint_t begin=0; begin < n_samples; begin += batch_size){
+
+            const auto size = std::min(batch_size, n_samples - begin);
+
+            torch_tensor_t loss;
+            {
+                utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::LOSS);
+
+                auto mb = buffer_.get_minibatch(begin, size);
+
+                auto observations = mb.observations.to(device_);
+                auto actions = mb.actions.to(device_);
+                auto old_log_probs = mb.log_probs.to(device_);
+                auto old_values = mb.values.to(device_);
+                auto advantages = mb.advantages.to(device_);
+                auto returns = mb.returns.to(device_);
+
+                if(config_.normalize_advantages && size > 1){
+                    advantages = (advantages - advantages.mean()) / (advantages.std() + 1.0e-8);
+                }
+
+                auto logits = policy_ -> forward(observations);
+                auto values = critic_ -> forward(observations).reshape({-1});
+
+                maths::stats::TorchCategorical distribution(logits, true);
+                auto log_probs = distribution.log_prob(actions);
+                auto entropy = distribution.entropy().mean();
+
+                // clipped surrogate objective
+                auto log_ratio = log_probs - old_log_probs;
+                auto ratio = torch::exp(log_ratio);
+                auto surrogate = ratio * advantages;
+                auto clipped_surrogate = torch::clamp(ratio, clip_low, clip_high) * advantages;
+                auto policy_loss = -torch::min(surrogate, clipped_surrogate).mean();
+
+                // value loss with optional clipping around the rollout values
+                torch_tensor_t value_loss;
+                if(config_.value_clip_epsilon > 0.0){
+
+                    auto clipped_values = old_values + torch::clamp(values - old_values,
+                                                                    -config_.value_clip_epsilon,
+                                                                    config_.value_clip_epsilon);
+                    value_loss = torch::max((values - returns).pow(2), (clipped_values - returns).pow(2)).mean();
+                }
+                else{
+                    value_loss = (values - returns).pow(2).mean();
+                }
+
+                loss = config_.policy_loss_weight * policy_loss +
+                       config_.value_loss_weight * value_loss -
+                       config_.beta * entropy;
+
+                torch::NoGradGuard no_grad;
+                last_stats_.policy_loss = policy_loss.template item<real_t>();
+                last_stats_.value_loss = value_loss.template item<real_t>();
+                last_stats_.entropy = entropy.template item<real_t>();
+                last_stats_.approx_kl = (-log_ratio).mean().template item<real_t>();
+                last_stats_.clip_fraction = ((ratio - 1.0).abs() > config_.clip_epsilon).to(torch::kFloat32).mean().template item<real_t>();
+            }
+
+            {
+                utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::UPDATE);
+
+                policy_optimizer_ -> zero_grad();
+                critic_optimizer_ -> zero_grad();
+
+                loss.backward();
+
+                if(config_.max_grad_norm > 0.0){
+                    torch::nn::utils::clip_grad_norm_(policy_ -> parameters(), config_.max_grad_norm);
+                    torch::nn::utils::clip_grad_norm_(critic_ -> parameters(), config_.max_grad_norm);
+                }
+
+                policy_optimizer_ -> step();
+                critic_optimizer_ -> step();
+            }
+
+            utils::Instrumentation::increment(utils::InstrumentationCounter::UPDATES);
+        }
+    }
+}
+
+}
+}
+}
+}
+
+#endif
+#endif // PPO_H
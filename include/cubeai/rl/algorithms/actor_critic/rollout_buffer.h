@@ -0,0 +1,230 @@
+#ifndef ROLLOUT_BUFFER_H
+#define ROLLOUT_BUFFER_H
+
+#include "cubeai/base/cubeai_config.h"
+
+#ifdef USE_PYTORCH
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/algorithms/utils.h"
+
+#include <torch/torch.h>
+
+#include <algorithm>
+#include <random>
+
+namespace cubeai{
+namespace rl{
+namespace algos {
+namespace ac {
+
+///
+/// \brief The RolloutBuffer class. Fixed size, tensor backed storage for
+/// on-policy rollouts of n_steps over n_envs environments. All the tensors
+/// live on the CPU and are allocated once by allocate(). The minibatches are
+/// gathered into tensors that are also allocated once, so after the first
+/// rollout filling the buffer and iterating over it allocates nothing
+///
+class RolloutBuffer
+{
+public:
+
+    ///
+    /// \brief The minibatch struct. Views over the
+    /// preallocated minibatch tensors
+    ///
+    struct minibatch
+    {
+        torch_tensor_t observations;
+        torch_tensor_t actions;
+        torch_tensor_t log_probs;
+        torch_tensor_t values;
+        torch_tensor_t advantages;
+        torch_tensor_t returns;
+    };
+
+    ///
+    /// \brief allocate. Allocate the storage. The minibatch tensors
+    /// hold up to batch_size samples, zero means the whole rollout
+    ///
+    void allocate(uint_t n_steps, uint_t n_envs, uint_t observation_size, uint_t batch_size);
+
+    ///
+    /// \brief n_steps
+    ///
+    uint_t n_steps()const noexcept{return n_steps_;}
+
+    ///
+    /// \brief n_envs
+    ///
+    uint_t n_envs()const noexcept{return n_envs_;}
+
+    ///
+    /// \brief n_samples. n_steps * n_envs
+    ///
+    uint_t n_samples()const noexcept{return n_steps_ * n_envs_;}
+
+    ///
+    /// \brief observations. Observations of step t, [n_envs, observation_size].
+    /// Step n_steps holds the observations to bootstrap from
+    ///
+    torch_tensor_t observations(uint_t t){return observations_[t];}
+
+    ///
+    /// \brief Per step views of shape [n_envs]
+    ///
+    torch_tensor_t actions(uint_t t){return actions_[t];}
+    torch_tensor_t log_probs(uint_t t){return log_probs_[t];}
+    torch_tensor_t values(uint_t t){return values_[t];}
+    torch_tensor_t rewards(uint_t t){return rewards_[t];}
+    torch_tensor_t dones(uint_t t){return dones_[t];}
+
+    ///
+    /// \brief compute_advantages. GAE(lambda) advantages and returns
+    /// in one backward pass. values(n_steps) should hold the bootstrap values
+    ///
+    void compute_advantages(real_t gamma, real_t lambda);
+
+    ///
+    /// \brief shuffle. Draw a new order for the minibatches
+    ///
+    template<typename GeneratorType>
+    void shuffle(GeneratorType& generator);
+
+    ///
+    /// \brief get_minibatch. Gather the samples [begin, begin + size)
+    /// of the current order. size should not exceed the batch_size
+    /// given to allocate
+    ///
+    minibatch get_minibatch(uint_t begin, uint_t size);
+
+    ///
+    /// \brief start_next_rollout. Carry the last observations
+    /// over as the first of the next rollout
+    ///
+    void start_next_rollout(){observations_[0].copy_(observations_[n_steps_]);}
+
+private:
+
+    uint_t n_steps_{0};
+    uint_t n_envs_{0};
+    uint_t observation_size_{0};
+
+    torch_tensor_t observations_;
+    torch_tensor_t actions_;
+    torch_tensor_t log_probs_;
+    torch_tensor_t values_;
+    torch_tensor_t rewards_;
+    torch_tensor_t dones_;
+    torch_tensor_t advantages_;
+    torch_tensor_t returns_;
+    torch_tensor_t indices_;
+
+    ///
+    /// \brief Flat views [n_samples, ...] over the storage
+    ///
+    torch_tensor_t flat_observations_;
+    torch_tensor_t flat_actions_;
+    torch_tensor_t flat_log_probs_;
+    torch_tensor_t flat_values_;
+    torch_tensor_t flat_advantages_;
+    torch_tensor_t flat_returns_;
+
+    ///
+    /// \brief mb_. The minibatch storage
+    ///
+    minibatch mb_;
+};
+
+inline
+void
+RolloutBuffer::allocate(uint_t n_steps, uint_t n_envs, uint_t observation_size, uint_t batch_size){
+
+    n_steps_ = n_steps;
+    n_envs_ = n_envs;
+    observation_size_ = observation_size;
+
+    const auto T = static_cast<int64_t>(n_steps);
+    const auto N = static_cast<int64_t>(n_envs);
+    const auto D = static_cast<int64_t>(observation_size);
+    const auto B = static_cast<int64_t>(batch_size == 0 ? n_steps * n_envs : std::min(batch_size, n_steps * n_envs));
+
+    const auto float_opts = torch::TensorOptions().dtype(torch::kFloat32);
+    const auto long_opts = torch::TensorOptions().dtype(torch::kInt64);
+
+    observations_ = torch::zeros({T + 1, N, D}, float_opts);
+    actions_ = torch::zeros({T, N}, long_opts);
+    log_probs_ = torch::zeros({T, N}, float_opts);
+    values_ = torch::zeros({T + 1, N}, float_opts);
+    rewards_ = torch::zeros({T, N}, float_opts);
+    dones_ = torch::zeros({T, N}, float_opts);
+    advantages_ = torch::zeros({T, N}, float_opts);
+    returns_ = torch::zeros({T, N}, float_opts);
+    indices_ = torch::arange(T * N, long_opts);
+
+    flat_observations_ = observations_.narrow(0, 0, T).view({T * N, D});
+    flat_actions_ = actions_.view({T * N});
+    flat_log_probs_ = log_probs_.view({T * N});
+    flat_values_ = values_.narrow(0, 0, T).view({T * N});
+    flat_advantages_ = advantages_.view({T * N});
+    flat_returns_ = returns_.view({T * N});
+
+    mb_.observations = torch::zeros({B, D}, float_opts);
+    mb_.actions = torch::zeros({B}, long_opts);
+    mb_.log_probs = torch::zeros({B}, float_opts);
+    mb_.values = torch::zeros({B}, float_opts);
+    mb_.advantages = torch::zeros({B}, float_opts);
+    mb_.returns = torch::zeros({B}, float_opts);
+}
+
+inline
+void
+RolloutBuffer::compute_advantages(real_t gamma, real_t lambda){
+
+    const auto* values = values_.data_ptr<float>();
+    generalized_advantage_estimate(rewards_.data_ptr<float>(), values, dones_.data_ptr<float>(),
+                                   values + n_steps_ * n_envs_, n_steps_, n_envs_,
+                                   gamma, lambda,
+                                   advantages_.data_ptr<float>(), returns_.data_ptr<float>());
+}
+
+template<typename GeneratorType>
+void
+RolloutBuffer::shuffle(GeneratorType& generator){
+
+    auto* indices = indices_.data_ptr<int64_t>();
+    std::shuffle(indices, indices + n_samples(), generator);
+}
+
+inline
+RolloutBuffer::minibatch
+RolloutBuffer::get_minibatch(uint_t begin, uint_t size){
+
+    const auto n = static_cast<int64_t>(size);
+    auto idx = indices_.narrow(0, static_cast<int64_t>(begin), n);
+
+    minibatch result;
+    result.observations = mb_.observations.narrow(0, 0, n);
+    result.actions = mb_.actions.narrow(0, 0, n);
+    result.log_probs = mb_.log_probs.narrow(0, 0, n);
+    result.values = mb_.values.narrow(0, 0, n);
+    result.advantages = mb_.advantages.narrow(0, 0, n);
+    result.returns = mb_.returns.narrow(0, 0, n);
+
+    torch::index_select_out(result.observations, flat_observations_, 0, idx);
+    torch::index_select_out(result.actions, flat_actions_, 0, idx);
+    torch::index_select_out(result.log_probs, flat_log_probs_, 0, idx);
+    torch::index_select_out(result.values, flat_values_, 0, idx);
+    torch::index_select_out(result.advantages, flat_advantages_, 0, idx);
+    torch::index_select_out(result.returns, flat_returns_, 0, idx);
+
+    return result;
+}
+
+}
+}
+}
+}
+
+#endif
+#endif // ROLLOUT_BUFFER_H
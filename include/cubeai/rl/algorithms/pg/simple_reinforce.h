@@ -7,17 +7,22 @@
 
 #include "cubeai/base/cubeai_types.h"
 #include "cubeai/rl/algorithms/rl_algorithm_base.h"
+#include "cubeai/rl/algorithms/utils.h"
 #include "cubeai/rl/episode_info.h"
-#include "cubeai/maths/vector_math.h"
+#include "cubeai/maths/statistics/distributions/torch_categorical.h"
+#include "cubeai/utils/instrumentation.h"
+#include "cubeai/utils/torch_adaptor.h"
 
 #include <torch/torch.h>
 
+#include <algorithm>
 #include <vector>
-#include <deque>
 #include <numeric>
 #include <iostream>
 #include <chrono>
+#include <cmath>
 #include <memory>
+#include <tuple>
 
 namespace cubeai {
 namespace rl {
@@ -26,18 +31,52 @@ namespace pg {
 
 
 ///
-/// \brief The ReinforceOpts struct. Holds various
+/// \brief The ReinforceConfig struct. Holds various
 /// configuration options for the Reinforce algorithm
 ///
 struct ReinforceConfig
 {
-    uint_t max_num_of_episodes;
-    uint_t max_itrs_per_episode;
-    uint_t print_frequency;
-    uint_t scores_queue_max_size;
-    real_t gamma;
-    real_t tolerance;
-    real_t exit_score_level;
+    ///
+    /// \brief max_itrs_per_episode. Maximum number of steps
+    /// of a rollout. Episodes still running when it is reached
+    /// are cut there. There is no value function to bootstrap
+    /// from so their return to go ends at the cut
+    ///
+    uint_t max_itrs_per_episode{500};
+
+    ///
+    /// \brief n_episodes_per_update. Number of episodes a rollout
+    /// starts over all the environments. Zero means one episode
+    /// per environment copy
+    ///
+    uint_t n_episodes_per_update{0};
+
+    ///
+    /// \brief Discount factor
+    ///
+    real_t gamma{0.99};
+
+    ///
+    /// \brief use_baseline. Subtract the mean return of the batch
+    ///
+    bool use_baseline{true};
+
+    ///
+    /// \brief normalize_returns. Divide the returns by their standard deviation
+    ///
+    bool normalize_returns{true};
+
+    ///
+    /// \brief max_grad_norm. Non positive values disable clipping
+    ///
+    real_t max_grad_norm{0.0};
+
+    ///
+    /// \brief use_inference_mode. Run act under torch::InferenceMode instead
+    /// of torch::NoGradGuard. The rollout keeps the graph of the
+    /// log-probabilities and runs under neither
+    ///
+    bool use_inference_mode{true};
 
     ///
     /// \brief print
@@ -55,7 +94,19 @@ std::ostream& operator<<(std::ostream& out, ReinforceConfig opts){
 /**
   * @brief The ReinforceSolver class. The ReinforceSolver
   * trains a policy represented by the PolicyTp template parameter
-  * on the environment represented by the EnvType parameter
+  * on the environment represented by the EnvType parameter.
+  * The environment runs n_copies() environments in lockstep,
+  * see envs::SerialVectorEnv, and the policy maps a [n_envs, observation_size]
+  * tensor to the action logits. Every episode of the solver starts
+  * n_episodes_per_update episodes from reset environments and plays them
+  * to their end, computes the returns to go in one reverse scan and
+  * performs one gradient step. An environment whose episode ends once
+  * enough episodes have been started keeps stepping in lockstep with the
+  * others but its steps are not used. Every episode of a rollout is thus
+  * used whole whatever its length, and the environments are reset before
+  * the next rollout. The only bias left is the cut of the episodes still
+  * running after max_itrs_per_episode steps. The log-probabilities stay in
+  * the autograd graph and are stacked once per update
   *
   */
 template<typename EnvType, typename PolicyType>
@@ -73,8 +124,8 @@ public:
                     std::unique_ptr<torch::optim::Optimizer>& policy_optimizer);
 
     ///
-    /// \brief actions_before_training_begins. Execute any actions the
-    /// algorithm needs before starting the iterations
+    /// \brief actions_before_training_begins. Resets the environments
+    /// and reserves the rollout storage
     ///
     virtual void actions_before_training_begins(env_type&);
 
@@ -93,10 +144,12 @@ public:
     /// \brief actions_after_training_episode
     ///
     virtual void actions_after_episode_ends(env_type&, uint_t /*episode_idx*/,
-                                            const EpisodeInfo& /*einfo*/);
+                                            const EpisodeInfo& /*einfo*/){}
 
     ///
-    /// \brief on_episode Do one on_episode of the algorithm
+    /// \brief on_episode Collect the episodes and update the policy.
+    /// The reported reward is the mean undiscounted return of the
+    /// episodes that finished during the rollout
     ///
     virtual EpisodeInfo on_training_episode(env_type&, uint_t /*episode_idx*/);
 
@@ -105,13 +158,24 @@ public:
     ///
     std::vector<torch::Tensor> parameters(bool recurse = true) const{return policy_ptr_ -> parameters(recurse);}
 
+    ///
+    /// \brief act. The actions of the policy for n_copies() observations laid
+    /// out contiguously, greedy or sampled. The forward pass runs on staging
+    /// tensors allocated in actions_before_training_begins and the guard is
+    /// chosen by use_inference_mode. The mode of the policy is not changed
+    ///
+    void act(const float* observations, uint_t* actions, bool greedy=true);
 
     ///
-    /// \brief compute_loss
-    /// \return
+    /// \brief last_loss. The policy loss of the last update
     ///
-    torch_tensor_t compute_loss(){return policy_ptr_->compute_loss();}
+    real_t last_loss()const noexcept{return last_loss_;}
 
+    ///
+    /// \brief n_finished_episodes. Number of environment episodes
+    /// completed since training started
+    ///
+    uint_t n_finished_episodes()const noexcept{return n_finished_episodes_;}
 
 private:
 
@@ -132,35 +196,54 @@ private:
     std::unique_ptr<torch::optim::Optimizer> policy_optimizer_;
 
     ///
-    /// \brief exit_score_level_
+    /// \brief Rollout storage. The observations live in a
+    /// [max_itrs_per_episode + 1, n_envs, observation_size] tensor that the
+    /// environments write into, so the inputs the autograd graph keeps are
+    /// never overwritten during a rollout. The log-probabilities are kept as
+    /// one [n_envs] tensor per step. The rewards, dones, active flags, returns
+    /// and mask are laid out as [step * n_envs + env] and only grow on the first
+    /// rollouts. A step is active if it belongs to an episode the rollout started
     ///
-    real_t exit_score_level_;
-
-
-    std::vector<real_t> scores_;
-    std::deque<real_t> scores_deque_;
-    std::vector<real_t> saved_log_probs_;
-    std::vector<real_t> rewards_;
+    torch_tensor_t observations_;
+    std::vector<torch_tensor_t> saved_log_probs_;
+    std::vector<float> rewards_;
+    std::vector<float> dones_;
+    std::vector<float> active_;
+    std::vector<float> returns_;
+    std::vector<float> mask_;
+    std::vector<uint_t> action_buffer_;
+    std::vector<real_t> running_returns_;
+    std::vector<float> reset_observations_;
+    std::vector<bool> env_active_;
 
     ///
-    /// \brief reset_internal_structs_
+    /// \brief Acting tensors of act. The [n_envs, observation_size]
+    /// input and the [n_envs] actions
     ///
-    void reset_internal_structs_()noexcept;
+    torch_utils::TorchStagingTensor act_input_;
+    torch_tensor_t act_output_;
+
+    uint_t n_envs_{0};
+    uint_t observation_size_{0};
+    uint_t n_finished_episodes_{0};
+    real_t last_loss_{0.0};
 
     ///
-    /// \brief compute_discounts
+    /// \brief do_step_. Play the environments and return the number of
+    /// steps, the number of finished episodes and the sum of their returns.
+    /// The rollout is cut if episodes are still running after the last step
     ///
-    void compute_discounts_(std::vector<real_t>& data)const noexcept;
+    std::tuple<uint_t, uint_t, real_t> do_step_(env_type& env);
 
     ///
-    /// \brief comoute_rewards_
+    /// \brief reset_envs_. Start every environment from a new episode
     ///
-    real_t compute_total_reward_(const std::vector<real_t>& discounts)const;
+    void reset_envs_(env_type& env);
 
     ///
-    /// \brief do_step_
+    /// \brief update_. One gradient step on the collected rollout
     ///
-    uint_t do_step_(env_type& env);
+    void update_(uint_t n_steps, bool truncate);
 
 };
 
@@ -177,132 +260,238 @@ ReinforceSolver<EnvType, PolicyType>::ReinforceSolver(ReinforceConfig config,
 
 template<typename EnvType, typename PolicyType>
 void
-ReinforceSolver<EnvType, PolicyType>::actions_before_training_begins(env_type& /*env*/){
+ReinforceSolver<EnvType, PolicyType>::actions_before_training_begins(env_type& env){
 
-    scores_.clear();
-    reset_internal_structs_();
     policy_ptr_ -> train();
 
+    env.reset(reset_observations_);
+    n_envs_ = env.n_copies();
+    observation_size_ = reset_observations_.size() / n_envs_;
+
+    observations_ = torch::zeros({static_cast<int64_t>(config_.max_itrs_per_episode + 1),
+                                  static_cast<int64_t>(n_envs_),
+                                  static_cast<int64_t>(observation_size_)}, torch::kFloat32);
+
+    const auto capacity = config_.max_itrs_per_episode * n_envs_;
+    saved_log_probs_.reserve(config_.max_itrs_per_episode);
+    rewards_.reserve(capacity);
+    dones_.reserve(capacity);
+    active_.reserve(capacity);
+    returns_.reserve(capacity);
+    mask_.reserve(capacity);
+
+    act_input_.allocate({static_cast<int64_t>(n_envs_), static_cast<int64_t>(observation_size_)}, torch::kCPU);
+    act_output_ = torch::zeros({static_cast<int64_t>(n_envs_)}, torch::TensorOptions().dtype(torch::kInt64));
+
+    action_buffer_.assign(n_envs_, 0);
+    running_returns_.assign(n_envs_, 0.0);
+    env_active_.assign(n_envs_, false);
+    n_finished_episodes_ = 0;
 }
 
 template<typename EnvType, typename PolicyType>
 void
-ReinforceSolver<EnvType, PolicyType>::reset_internal_structs_()noexcept{
-
-    std::vector<real_t> empty;
-    std::swap(saved_log_probs_, empty);
-    empty.clear();
-    std::swap(rewards_, empty);
-
-    std::deque<real_t> empty_deque;
-    std::swap(scores_deque_, empty_deque);
-
+ReinforceSolver<EnvType, PolicyType>::act(const float* observations, uint_t* actions, bool greedy){
+
+    act_input_.copy_from(observations);
+    torch_utils::run_without_autograd(config_.use_inference_mode, [&](){
+
+        auto logits = policy_ptr_ -> forward(act_input_.to_device());
+        if(greedy){
+            torch::argmax_out(act_output_, logits, 1);
+        }
+        else{
+            act_output_.copy_(maths::stats::TorchCategorical(logits, true).sample());
+        }
+    });
+
+    const auto* data = act_output_.data_ptr<int64_t>();
+    for(uint_t e=0; e<n_envs_; ++e){
+        actions[e] = static_cast<uint_t>(data[e]);
+    }
 }
 
-/*template<typename WorldTp, typename PolicyTp, typename OptimizerTp>
+template<typename EnvType, typename PolicyType>
 void
-Reinforce<WorldTp, PolicyTp, OptimizerTp>::compute_discounts_(std::vector<real_t>& data)const noexcept{
+ReinforceSolver<EnvType, PolicyType>::reset_envs_(env_type& env){
 
-    for(uint_t i=0; i < rewards_.size() + 1; ++i ){
-        data.push_back(std::pow(gamma_, i));
-    }
-}*/
+    env.reset(reset_observations_);
+    std::copy(reset_observations_.begin(), reset_observations_.end(),
+              observations_[0].data_ptr<float>());
+    std::fill(running_returns_.begin(), running_returns_.end(), 0.0);
+}
 
 template<typename EnvType, typename PolicyType>
-real_t
-ReinforceSolver<EnvType, PolicyType>::compute_total_reward_(const std::vector<real_t>& discounts)const{
+std::tuple<uint_t, uint_t, real_t>
+ReinforceSolver<EnvType, PolicyType>::do_step_(env_type& env){
+
+    saved_log_probs_.clear();
+    rewards_.clear();
+    dones_.clear();
+    active_.clear();
 
-    real_t reward = 0.0;
+    reset_envs_(env);
 
-    for(uint_t i = 0; i<rewards_.size(); ++i){
-        reward += discounts[i]*rewards_[i];
+    // every environment starts one of the episodes while there are
+    // any left, the others idle until the rollout ends
+    const auto n_episodes = config_.n_episodes_per_update == 0 ? n_envs_ : config_.n_episodes_per_update;
+    uint_t n_started = 0;
+    for(uint_t e=0; e<n_envs_; ++e){
+        env_active_[e] = n_started < n_episodes;
+        n_started += env_active_[e] ? 1 : 0;
     }
 
-    return reward;
-}
+    auto n_running = n_started;
+    uint_t n_finished = 0;
+    real_t finished_returns = 0.0;
 
-template<typename EnvType, typename PolicyType>
-uint_t
-ReinforceSolver<EnvType, PolicyType>::do_step_(env_type& env){
+    uint_t itr = 0;
+    while(itr < config_.max_itrs_per_episode && n_running != 0){
 
-    //  for every episode reset the environment
-    auto state = env.reset().observation();
+        {
+            utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::ACTION_SELECTION);
 
-    uint_t itr = 0;
-    for(; itr < config_.max_itrs_per_episode; ++itr){
+            auto logits = policy_ptr_ -> forward(observations_[itr]);
+            maths::stats::TorchCategorical distribution(logits, true);
+
+            torch_tensor_t actions;
+            {
+                torch::NoGradGuard no_grad;
+                actions = distribution.sample();
+            }
+
+            saved_log_probs_.push_back(distribution.log_prob(actions));
 
-            // from the policy get the action to do based
-            // on the seen state
-            auto [action, log_prob] = policy_ptr_ -> act(state);
+            const auto* sampled = actions.data_ptr<int64_t>();
+            for(uint_t e=0; e<n_envs_; ++e){
+                action_buffer_[e] = static_cast<uint_t>(sampled[e]);
+            }
+        }
 
-            saved_log_probs_.push_back(log_prob);
+        rewards_.resize(rewards_.size() + n_envs_);
+        dones_.resize(dones_.size() + n_envs_);
+        active_.resize(active_.size() + n_envs_);
 
-            // execute the selected action on the environment
-            auto time_step = env.step(action);
+        auto* rewards = rewards_.data() + itr * n_envs_;
+        auto* dones = dones_.data() + itr * n_envs_;
+        auto* active = active_.data() + itr * n_envs_;
+        {
+            utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::ENV_STEP);
+            env.step(action_buffer_.data(), observations_[itr + 1].data_ptr<float>(), rewards, dones);
+        }
 
-            // update state
-            state = time_step.observation();
+        utils::Instrumentation::increment(utils::InstrumentationCounter::STEPS, n_envs_);
 
-            rewards_.push_back(time_step.reward());
+        for(uint_t e=0; e<n_envs_; ++e){
 
-            if (time_step.done()){
-                break;
+            active[e] = env_active_[e] ? 1.0f : 0.0f;
+            if(!env_active_[e]){
+                continue;
             }
-    }
 
-    return itr;
+            running_returns_[e] += rewards[e];
+
+            if(dones[e] != 0.0f){
+
+                finished_returns += running_returns_[e];
+                n_finished += 1;
+                running_returns_[e] = 0.0;
+
+                // the environment has already started its next
+                // episode, it is used only if one is left
+                if(n_started < n_episodes){
+                    n_started += 1;
+                }
+                else{
+                    env_active_[e] = false;
+                    n_running -= 1;
+                }
+            }
+        }
+
+        itr += 1;
+    }
 
+    n_finished_episodes_ += n_finished;
+    return {itr, n_finished, finished_returns};
 }
 
 template<typename EnvType, typename PolicyType>
-EpisodeInfo
-ReinforceSolver<EnvType, PolicyType>::on_training_episode(env_type& env, uint_t episode_idx){
+void
+ReinforceSolver<EnvType, PolicyType>::update_(uint_t n_steps, bool truncate){
 
+    torch_tensor_t loss;
+    {
+        utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::LOSS);
 
-    auto start = std::chrono::steady_clock::now();
+        returns_.resize(n_steps * n_envs_);
+        mask_.resize(n_steps * n_envs_);
 
-    //  for every episode reset the environment
-    //auto state = world_ptr_ ->reset().observation();
-    reset_internal_structs_();
+        auto n_valid = monte_carlo_returns(rewards_.data(), dones_.data(), n_steps, n_envs_,
+                                           config_.gamma, truncate, returns_.data(), mask_.data(),
+                                           active_.data());
 
-    auto itrs = do_step_(env);
-    auto rewards_sum = std::accumulate(rewards_.begin(), rewards_.end(), 0.0);
+        if(n_valid == 0){
+            return;
+        }
 
-    scores_deque_.push_back(rewards_sum);
-    scores_.push_back(rewards_sum);
+        const auto T = static_cast<int64_t>(n_steps);
+        const auto N = static_cast<int64_t>(n_envs_);
 
-    std::vector<real_t> discounts;
-    discounts.reserve(rewards_.size() + 1);
+        auto returns = torch::from_blob(returns_.data(), {T, N}, torch::kFloat32);
+        auto mask = torch::from_blob(mask_.data(), {T, N}, torch::kFloat32);
 
-    //discounts = [self.gamma ** i for i in range(len(self.rewards) + 1)]
-    cubeai::maths::exponentiate(discounts);
+        if(config_.use_baseline || config_.normalize_returns){
 
-    // R = sum([a * b for a, b in zip(discounts, self.rewards)])
-    auto R = compute_total_reward_(discounts);
+            const auto count = static_cast<real_t>(n_valid);
+            const auto mean = (returns * mask).sum().template item<real_t>() / count;
 
-    std::vector<real_t> policy_loss_values;
-    policy_loss_values.reserve(saved_log_probs_.size());
+            if(config_.use_baseline){
+                returns = (returns - mean) * mask;
+            }
+
+            if(config_.normalize_returns && n_valid > 1){
+                const auto centered = config_.use_baseline ? returns : (returns - mean) * mask;
+                const auto stddev = std::sqrt(centered.pow(2).sum().template item<real_t>() / (count - 1.0));
+                returns = returns / (stddev + 1.0e-8);
+            }
+        }
 
-    for(auto& log_prob: saved_log_probs_){
-        policy_loss_values.push_back(-log_prob * R);
+        // one stack of the log-probabilities per update
+        auto log_probs = torch::stack(saved_log_probs_);
+        loss = -(log_probs * returns * mask).sum() / static_cast<real_t>(n_valid);
     }
 
+    {
+        utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::UPDATE);
 
-    policy_ptr_ -> update_policy_loss(policy_loss_values);
-    //opt_ptr_ -> zero_grad();
+        policy_optimizer_ -> zero_grad();
+        loss.backward();
 
-    // backward propagate policy loss i.e. policy_loss.backward();
-    //policy_ptr_ -> step_backward_policy_loss();
-    //opt_ptr_ -> step();
+        if(config_.max_grad_norm > 0.0){
+            torch::nn::utils::clip_grad_norm_(policy_ptr_ -> parameters(), config_.max_grad_norm);
+        }
 
-    //auto scores_mean = std::accumulate(scores_deque_.begin(), scores_deque_.end(), 0.0);
-    //scores_mean /= std::distance(scores_deque_.begin(), scores_deque_.end());
+        policy_optimizer_ -> step();
+    }
+
+    last_loss_ = loss.template item<real_t>();
+    utils::Instrumentation::increment(utils::InstrumentationCounter::UPDATES);
+}
+
+template<typename EnvType, typename PolicyType>
+EpisodeInfo
+ReinforceSolver<EnvType, PolicyType>::on_training_episode(env_type& env, uint_t episode_idx){
+
+
+    auto start = std::chrono::steady_clock::now();
 
-    /*if(scores_mean > exit_score_level_){
-        std::cout<<"Environment solved in "<<this->current_episode_idx()<<". Average score: "<<scores_mean<<std::endl;
-        auto res = this->iter_controller_().get_residual();
-        this->iter_controller_().update_residual(res * 1.0e-2);
-    }*/
+    auto [itrs, n_finished, finished_returns] = do_step_(env);
+
+    // if episodes are still running the rollout hit
+    // the step limit and they are cut there
+    const auto truncate = std::find(env_active_.begin(), env_active_.end(), true) != env_active_.end();
+    update_(itrs, truncate);
 
     auto end = std::chrono::steady_clock::now();
     std::chrono::duration<real_t> elapsed_seconds = end - start;
@@ -310,26 +499,21 @@ ReinforceSolver<EnvType, PolicyType>::on_training_episode(env_type& env, uint_t
     // the info class to return for the episode
     EpisodeInfo info;
     info.episode_index = episode_idx;
-    info.episode_reward = R;
     info.episode_iterations = itrs;
     info.total_time = elapsed_seconds;
-    return info;
-}
 
-template<typename EnvType, typename PolicyType>
-void
-ReinforceSolver<EnvType, PolicyType>::actions_after_episode_ends(env_type&, uint_t /*episode_idx*/,
-                                                               const EpisodeInfo& /*einfo*/){
-
-    // compute the loss
-    // auto loss = compute_loss();
-    // loss.backward();
-     policy_optimizer_ -> zero_grad();
-     auto loss = policy_ptr_->compute_loss();
-     loss.backward();
-     policy_optimizer_ -> step();
+    if(n_finished != 0){
+        info.episode_reward = finished_returns / static_cast<real_t>(n_finished);
+    }
+    else{
 
+        // every episode was cut, the idle environments have no return
+        const auto n_cut = std::count(env_active_.begin(), env_active_.end(), true);
+        info.episode_reward = std::accumulate(running_returns_.begin(), running_returns_.end(), 0.0) /
+                              static_cast<real_t>(n_cut);
+    }
 
+    return info;
 }
 
 }
@@ -337,4 +521,4 @@ ReinforceSolver<EnvType, PolicyType>::actions_after_episode_ends(env_type&, uint
 }
 }
 #endif
-#endif // VANILLA_REINFORCE_H
+#endif // SIMPLE_REINFORCE_H
@@ -12,11 +12,14 @@
 #include "cubeai/rl/rl_mixins.h"
 #include "cubeai/rl/worlds/envs_concepts.h"
 #include "cubeai/rl/episode_info.h"
-#include "cubeai/io/csv_file_writer.h"
+#include "cubeai/io/binary_checkpoint.h"
 #include "cubeai/maths/matrix_utilities.h"
 
 #include <chrono>
+#include <numeric>
 #include <random>
+#include <string>
+#include <vector>
 
 namespace cubeai{
 namespace rl{
@@ -102,10 +105,29 @@ public:
     virtual EpisodeInfo on_training_episode(env_type&, uint_t episode_idx);
 
     ///
-    ///
+    /// \brief save. Write both Q-tables and the state of the
+    /// action selector to a binary checkpoint file
     ///
     void save(std::string filename)const;
 
+    ///
+    /// \brief load. Restore the state written by save. The next
+    /// training resumes from it instead of zero Q-tables
+    ///
+    void load(const std::string& filename);
+
+    ///
+    /// \brief save_checkpoint. Add both Q-tables, the engine that picks
+    /// the table to update and, if the action selector supports it, its
+    /// state to the checkpoint
+    ///
+    void save_checkpoint(io::Checkpoint& checkpoint)const;
+
+    ///
+    /// \brief load_checkpoint. Restore what save_checkpoint added
+    ///
+    void load_checkpoint(const io::MappedCheckpoint& checkpoint);
+
 private:
 
     DoubleQLearningConfig config_;
@@ -116,6 +138,16 @@ private:
     ///
     action_selector_type action_selector_;
 
+    ///
+    /// \brief generator_. Picks the table every update goes to
+    ///
+    std::mt19937 generator_;
+
+    ///
+    /// \brief resume_. Whether the Q-tables were restored from a checkpoint
+    ///
+    bool resume_;
+
     ///
     /// \brief update_q_table_
     /// \param action
@@ -131,14 +163,42 @@ DoubleQLearning<EnvTp, ActionSelector>::DoubleQLearning(const DoubleQLearningCon
      TDAlgoBase<EnvTp>(),
      with_double_q_table_mixin<DynMat<real_t>>(),
      config_(config),
-     action_selector_(selector)
+     action_selector_(selector),
+     generator_(config.seed),
+     resume_(false)
 {}
 
 
 template<envs::discrete_world_concept EnvTp, typename ActionSelector>
 void
 DoubleQLearning<EnvTp, ActionSelector>::actions_before_training_begins(env_type& env){
-    this->with_double_q_table_mixin<DynMat<real_t>>::initialize(env.n_states(), env.n_actions(), 0.0);
+
+    const auto resume = resume_;
+    resume_ = false;
+
+    if(resume){
+
+        const auto& q_table_1 = this->with_double_q_table_mixin<DynMat<real_t>>::q_table_1;
+        if(static_cast<uint_t>(q_table_1.rows()) != env.n_states() ||
+           static_cast<uint_t>(q_table_1.cols()) != env.n_actions()){
+            throw std::logic_error("The restored Q-tables do not match the environment");
+        }
+
+        return;
+    }
+
+    std::vector<uint_t> states(env.n_states());
+    std::iota(states.begin(), states.end(), 0);
+    this->with_double_q_table_mixin<DynMat<real_t>>::initialize(states, env.n_actions(), 0.0);
+}
+
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+DoubleQLearning<EnvTp, ActionSelector>::actions_after_training_ends(env_type&){
+
+    if(config_.path != ""){
+        save(config_.path);
+    }
 }
 
 template<envs::discrete_world_concept EnvTp, typename ActionSelector>
@@ -197,21 +257,19 @@ DoubleQLearning<EnvTp, ActionSelector>::update_q_table_(const action_type& actio
 
     // flip a coin 50% of the time we update Q1
     // whilst 50% of the time Q2
-    std::mt19937 gen(config_.seed); //rd());
-
     // generate a number in [0, 1]
     std::uniform_real_distribution<> real_dist_(0.0, 1.0);
 
     // update Q1
-    if(real_dist_(gen) <= 0.5){
+    if(real_dist_(generator_) <= 0.5){
 
         // the current qvalue
         auto q_current = this->with_double_q_table_mixin<DynMat<real_t>>::template get<1>(cstate, action);
         auto Qsa_next = 0.0;
 
         //if(this->env_ref_().is_valid_state(next_state)){
-            auto max_act = this->with_double_q_table_max_action_mixin::max_action(this->with_double_q_table_mixin<DynMat<real_t>>::q_table_1,
-                                                                                  next_state, this->env_ref_().n_actions());
+            const auto& q_table_1 = this->with_double_q_table_mixin<DynMat<real_t>>::q_table_1;
+            auto max_act = rl::max_action(q_table_1, next_state, q_table_1.cols());
 
             // value of next state
             Qsa_next = this->with_double_q_table_mixin<DynMat<real_t>>::template get<2>(next_state, max_act);
@@ -231,8 +289,8 @@ DoubleQLearning<EnvTp, ActionSelector>::update_q_table_(const action_type& actio
         auto Qsa_next = 0.0;
 
 
-        auto max_act = this->with_double_q_table_max_action_mixin::max_action(this->with_double_q_table_mixin<DynMat<real_t>>::q_table_2,
-                                                                                  next_state, this->env_ref_().n_actions());
+        const auto& q_table_2 = this->with_double_q_table_mixin<DynMat<real_t>>::q_table_2;
+        auto max_act = rl::max_action(q_table_2, next_state, q_table_2.cols());
 
             // value of next state
         Qsa_next = this->with_double_q_table_mixin<DynMat<real_t>>::template get<1>(next_state, max_act);
@@ -251,26 +309,47 @@ template <envs::discrete_world_concept EnvTp, typename ActionSelector>
 void
 DoubleQLearning<EnvTp, ActionSelector>::save(std::string filename)const{
 
-    CSVWriter file_writer(filename, ',', true);
-    std::vector<std::string> col_names(1 + this->with_double_q_table_mixin<DynMat<real_t>>::q_table_1.columns());
-    col_names[0] = "state_index";
+    io::Checkpoint checkpoint;
+    save_checkpoint(checkpoint);
+    io::write_checkpoint(checkpoint, filename);
+}
 
-    for(uint_t i = 0; i< this->with_double_q_table_mixin<DynMat<real_t>>::q_table_1.columns(); ++i){
-        col_names[i + 1] = "action_" + std::to_string(i);
-    }
+template <envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+DoubleQLearning<EnvTp, ActionSelector>::load(const std::string& filename){
 
-    file_writer.write_column_names(col_names);
+    io::MappedCheckpoint checkpoint(filename);
+    load_checkpoint(checkpoint);
+}
 
-    for(uint_t s=0; s < this->with_double_q_table_mixin<DynMat<real_t>>::q_table_1.rows(); ++s){
+template <envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+DoubleQLearning<EnvTp, ActionSelector>::save_checkpoint(io::Checkpoint& checkpoint)const{
 
-        auto actions = maths::get_row(this->with_double_q_table_mixin<DynMat<real_t>>::q_table_1, s);
-        file_writer.write_row(std::make_tuple(s, actions));
+    checkpoint.add("q_table_1", this->with_double_q_table_mixin<DynMat<real_t>>::q_table_1);
+    checkpoint.add("q_table_2", this->with_double_q_table_mixin<DynMat<real_t>>::q_table_2);
+    checkpoint.add_rng("generator", generator_);
 
-        actions = maths::get_row(this->with_double_q_table_mixin<DynMat<real_t>>::q_table_2, s);
-        file_writer.write_row(std::make_tuple(s, actions));
+    if constexpr(requires(const action_selector_type& s){ s.save_checkpoint(checkpoint, std::string()); }){
+        action_selector_.save_checkpoint(checkpoint, "action_selector.");
     }
 }
 
+template <envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+DoubleQLearning<EnvTp, ActionSelector>::load_checkpoint(const io::MappedCheckpoint& checkpoint){
+
+    this->with_double_q_table_mixin<DynMat<real_t>>::q_table_1 = checkpoint.matrix("q_table_1");
+    this->with_double_q_table_mixin<DynMat<real_t>>::q_table_2 = checkpoint.matrix("q_table_2");
+    checkpoint.load_rng("generator", generator_);
+
+    if constexpr(requires(action_selector_type& s){ s.load_checkpoint(checkpoint, std::string()); }){
+        action_selector_.load_checkpoint(checkpoint, "action_selector.");
+    }
+
+    resume_ = true;
+}
+
 }
 }
 }
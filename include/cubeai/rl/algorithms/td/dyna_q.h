@@ -0,0 +1,405 @@
+#ifndef DYNA_Q_H
+#define DYNA_Q_H
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/base/cubeai_config.h"
+#include "cubeai/rl/algorithms/td/td_algo_base.h"
+#include "cubeai/rl/algorithms/td/tabular_transition_model.h"
+#include "cubeai/rl/worlds/envs_concepts.h"
+#include "cubeai/rl/episode_info.h"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace cubeai {
+namespace rl{
+namespace algos {
+namespace td {
+
+///
+/// \brief The DynaQConfig struct
+///
+struct DynaQConfig
+{
+    uint_t n_episodes;
+    real_t tolerance;
+    real_t gamma;
+    real_t eta;
+    uint_t max_num_iterations_per_episode;
+
+    ///
+    /// \brief n_planning_steps. Number of simulated
+    /// backups per real environment step
+    ///
+    uint_t n_planning_steps{10};
+
+    ///
+    /// \brief model_type. How the model stores the outcomes
+    ///
+    TransitionModelType model_type{TransitionModelType::DETERMINISTIC};
+
+    ///
+    /// \brief background_planning. If true the planning backups run on
+    /// a worker thread so that they overlap with env.step
+    ///
+    bool background_planning{false};
+
+    uint_t seed{42};
+    std::string path{""};
+};
+
+
+///
+/// \brief The DynaQ class. Tabular Dyna-Q. Every real transition
+/// updates the Q-table as in QLearning and is recorded in a
+/// TabularTransitionModel. The model is then used to perform
+/// n_planning_steps simulated Q-learning backups. With background_planning
+/// the simulated backups are credited to a worker thread which performs them
+/// while the main thread steps the environment. The Q-table and the model
+/// are shared under a mutex that is not held during env.step
+///
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+class DynaQ final: public TDAlgoBase<EnvTp>
+{
+
+public:
+
+    ///
+    /// \brief env_t
+    ///
+    typedef typename TDAlgoBase<EnvTp>::env_type env_type;
+
+    ///
+    /// \brief action_t
+    ///
+    typedef typename TDAlgoBase<EnvTp>::action_type action_type;
+
+    ///
+    /// \brief state_t
+    ///
+    typedef typename TDAlgoBase<EnvTp>::state_type state_type;
+
+    ///
+    /// \brief action_selector_t
+    ///
+    typedef ActionSelector action_selector_type;
+
+    ///
+    /// \brief Constructor
+    ///
+    DynaQ(const DynaQConfig config, const ActionSelector& selector);
+
+    ///
+    /// \brief Destructor. Stops the planning thread if needed
+    ///
+    virtual ~DynaQ();
+
+    ///
+    /// \brief actions_before_training_begins. Execute any actions the
+    /// algorithm needs before starting the iterations
+    ///
+    virtual void actions_before_training_begins(env_type&);
+
+    ///
+    /// \brief actions_after_training_ends. Actions to execute after
+    /// the training iterations have finisehd
+    ///
+    virtual void actions_after_training_ends(env_type&);
+
+    ///
+    /// \brief actions_before_training_episode
+    ///
+    virtual void actions_before_episode_begins(env_type&, uint_t /*episode_idx*/){}
+
+    ///
+    /// \brief actions_after_training_episode
+    ///
+    virtual void actions_after_episode_ends(env_type&, uint_t episode_idx,
+                                            const EpisodeInfo& /*einfo*/);
+
+    ///
+    /// \brief on_episode Do one on_episode of the algorithm
+    ///
+    virtual EpisodeInfo on_training_episode(env_type&, uint_t episode_idx);
+
+    ///
+    /// \brief q_table. Read access to the learnt Q-function. Should
+    /// not be called whilst training with background_planning
+    ///
+    const DynMat<real_t>& q_table()const noexcept{return q_table_;}
+
+    ///
+    /// \brief model. Read access to the learnt model
+    ///
+    const TabularTransitionModel& model()const noexcept{return model_;}
+
+    ///
+    /// \brief n_planning_backups. Returns the number of simulated
+    /// backups performed so far. Safe to call whilst the planning
+    /// thread runs
+    ///
+    uint_t n_planning_backups()const noexcept{return n_planning_backups_.load(std::memory_order_relaxed);}
+
+private:
+
+    ///
+    /// \brief config_
+    ///
+    DynaQConfig config_;
+
+    ///
+    /// \brief action_selector_
+    ///
+    action_selector_type action_selector_;
+
+    ///
+    /// \brief q_table_. The tabular representation of the Q-function
+    ///
+    DynMat<real_t> q_table_;
+
+    ///
+    /// \brief model_. The learnt model
+    ///
+    TabularTransitionModel model_;
+
+    ///
+    /// \brief generator_. Used to sample the model
+    ///
+    std::mt19937 generator_;
+
+    ///
+    /// \brief Synchronization with the planning thread
+    ///
+    std::mutex mutex_;
+    std::condition_variable planning_cv_;
+    std::thread planning_thread_;
+    uint_t pending_backups_;
+    std::atomic<uint_t> n_planning_backups_;
+    bool stop_planning_;
+
+    ///
+    /// \brief update_q_table_. One step Q-learning backup
+    ///
+    void update_q_table_(uint_t state, uint_t action, uint_t next_state, real_t reward, bool done);
+
+    ///
+    /// \brief plan_. Perform n simulated backups. The mutex should be held
+    ///
+    void plan_(uint_t n);
+
+    ///
+    /// \brief planning_loop_. The body of the planning thread
+    ///
+    void planning_loop_();
+
+    ///
+    /// \brief stop_planning_thread_. The thread performs the
+    /// backups still queued before it exits
+    ///
+    void stop_planning_thread_();
+};
+
+template <envs::discrete_world_concept EnvTp, typename ActionSelector>
+DynaQ<EnvTp, ActionSelector>::DynaQ(const DynaQConfig config, const ActionSelector& selector)
+    :
+      TDAlgoBase<EnvTp>(),
+      config_(config),
+      action_selector_(selector),
+      q_table_(),
+      model_(config.model_type),
+      generator_(config.seed),
+      mutex_(),
+      planning_cv_(),
+      planning_thread_(),
+      pending_backups_(0),
+      n_planning_backups_(0),
+      stop_planning_(false)
+{}
+
+template <envs::discrete_world_concept EnvTp, typename ActionSelector>
+DynaQ<EnvTp, ActionSelector>::~DynaQ(){
+    stop_planning_thread_();
+}
+
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+DynaQ<EnvTp, ActionSelector>::actions_before_training_begins(env_type& env){
+
+    stop_planning_thread_();
+
+    q_table_ = DynMat<real_t>::Zero(env.n_states(), env.n_actions());
+    model_.initialize(env.n_actions());
+    pending_backups_ = 0;
+    n_planning_backups_ = 0;
+    stop_planning_ = false;
+
+    if(config_.background_planning){
+        planning_thread_ = std::thread(&DynaQ<EnvTp, ActionSelector>::planning_loop_, this);
+    }
+}
+
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+DynaQ<EnvTp, ActionSelector>::actions_after_training_ends(env_type&){
+    stop_planning_thread_();
+}
+
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+DynaQ<EnvTp, ActionSelector>::actions_after_episode_ends(env_type&, uint_t episode_idx,
+                                                        const EpisodeInfo& /*einfo*/){
+    std::lock_guard<std::mutex> lock(mutex_);
+    action_selector_.on_episode(episode_idx);
+}
+
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+EpisodeInfo
+DynaQ<EnvTp, ActionSelector>::on_training_episode(env_type& env, uint_t episode_idx){
+
+    auto start = std::chrono::steady_clock::now();
+    EpisodeInfo info;
+
+    // total score for the episode
+    auto episode_score = 0.0;
+    auto state = env.reset().observation();
+
+    uint_t itr=0;
+    for(;  itr < config_.max_num_iterations_per_episode; ++itr){
+
+        action_type action;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            action = action_selector_(q_table_, state);
+        }
+
+        // the planning thread may run whilst we step
+        auto step_type_result = env.step(action);
+
+        auto next_state = step_type_result.observation();
+        auto reward = step_type_result.reward();
+        auto done = step_type_result.done();
+
+        // accumulate score
+        episode_score += reward;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            update_q_table_(state, action, next_state, reward, done);
+            model_.update(state, action, next_state, reward, done);
+
+            if(!config_.background_planning){
+                plan_(config_.n_planning_steps);
+            }
+            else{
+                pending_backups_ += config_.n_planning_steps;
+            }
+        }
+
+        if(config_.background_planning){
+            planning_cv_.notify_one();
+        }
+
+        state = next_state;
+
+        if(done){
+            break;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<real_t> elapsed_seconds = end-start;
+
+    info.episode_index = episode_idx;
+    info.episode_reward = episode_score;
+    info.episode_iterations = itr;
+    info.total_time = elapsed_seconds;
+    return info;
+}
+
+template <envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+DynaQ<EnvTp, ActionSelector>::update_q_table_(uint_t state, uint_t action, uint_t next_state, real_t reward, bool done){
+
+    auto q_current = q_table_(state, action);
+    auto q_next = done ? 0.0 : q_table_.row(next_state).maxCoeff();
+    auto td_target = reward + config_.gamma * q_next;
+    q_table_(state, action) = q_current + (config_.eta * (td_target - q_current));
+}
+
+template <envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+DynaQ<EnvTp, ActionSelector>::plan_(uint_t n){
+
+    if(model_.empty()){
+        return;
+    }
+
+    uint_t state = 0;
+    uint_t action = 0;
+    for(uint_t i=0; i<n; ++i){
+        const auto& outcome = model_.sample(generator_, state, action);
+        update_q_table_(state, action, outcome.next_state, outcome.reward, outcome.done);
+    }
+
+    n_planning_backups_.fetch_add(n, std::memory_order_relaxed);
+}
+
+template <envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+DynaQ<EnvTp, ActionSelector>::planning_loop_(){
+
+    // backups are done in small batches so that the
+    // main thread is not locked out for long
+    const uint_t batch_size = 16;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(true){
+
+        planning_cv_.wait(lock, [this](){return stop_planning_ || pending_backups_ > 0;});
+
+        // the queued backups are done before stopping so that
+        // every real step gets its n_planning_steps backups
+        if(pending_backups_ == 0){
+            return;
+        }
+
+        auto n = pending_backups_ < batch_size ? pending_backups_ : batch_size;
+        pending_backups_ -= n;
+        plan_(n);
+
+        // give the main thread the chance to acquire the lock
+        lock.unlock();
+        std::this_thread::yield();
+        lock.lock();
+    }
+}
+
+template <envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+DynaQ<EnvTp, ActionSelector>::stop_planning_thread_(){
+
+    if(!planning_thread_.joinable()){
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_planning_ = true;
+    }
+
+    planning_cv_.notify_one();
+    planning_thread_.join();
+}
+
+}
+}
+}
+}
+
+#endif // DYNA_Q_H
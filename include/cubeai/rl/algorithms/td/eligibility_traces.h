@@ -0,0 +1,249 @@
+#ifndef ELIGIBILITY_TRACES_H
+#define ELIGIBILITY_TRACES_H
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/base/cubeai_config.h"
+
+#ifdef CUBEAI_DEBUG
+#include <cassert>
+#endif
+
+#include <vector>
+
+namespace cubeai {
+namespace rl {
+namespace algos {
+namespace td {
+
+///
+/// \brief The EligibilityTraceType enum. Enumerate
+/// the supported trace update rules
+///
+enum class EligibilityTraceType{ACCUMULATING, REPLACING};
+
+///
+/// \brief The SparseEligibilityTraces class. Keeps only the
+/// state-action pairs with a non-negligible trace in a flat list.
+/// Traces that decay below the given cutoff are dropped from the list
+/// so that the cost of an update is proportional to the number of
+/// recently visited pairs and not to n_states * n_actions.
+///
+class SparseEligibilityTraces
+{
+public:
+
+    ///
+    /// \brief The trace_entry struct. A single active trace
+    ///
+    struct trace_entry
+    {
+        uint_t state;
+        uint_t action;
+        real_t value;
+    };
+
+    ///
+    /// \brief Constructor
+    ///
+    SparseEligibilityTraces(EligibilityTraceType type=EligibilityTraceType::REPLACING,
+                            real_t cutoff=1.0e-4);
+
+    ///
+    /// \brief initialize. Allocate the position index for
+    /// the given number of states and actions. This is the only
+    /// operation that is proportional to n_states * n_actions
+    ///
+    void initialize(uint_t n_states, uint_t n_actions);
+
+    ///
+    /// \brief visit. Bump the trace of the given state-action pair
+    ///
+    void visit(uint_t state, uint_t action);
+
+    ///
+    /// \brief update. Apply q(s, a) += step * e(s, a) for every active
+    /// trace and then decay the traces by the given factor. Traces that fall
+    /// below the cutoff are removed. With a positive cutoff passing
+    /// decay_factor = 0 clears the list
+    ///
+    template<typename TableTp>
+    void update(TableTp& q_table, real_t step, real_t decay_factor);
+
+    ///
+    /// \brief clear. Drop all the active traces. Only
+    /// touches the active entries
+    ///
+    void clear()noexcept;
+
+    ///
+    /// \brief value. Returns the trace of the given pair
+    ///
+    real_t value(uint_t state, uint_t action)const noexcept;
+
+    ///
+    /// \brief size. Returns the number of active traces
+    ///
+    uint_t size()const noexcept{return entries_.size();}
+
+    ///
+    /// \brief empty. Returns true if there are no active traces
+    ///
+    bool empty()const noexcept{return entries_.empty();}
+
+    ///
+    /// \brief cutoff. Returns the cutoff threshold
+    ///
+    real_t cutoff()const noexcept{return cutoff_;}
+
+    ///
+    /// \brief trace_type
+    ///
+    EligibilityTraceType trace_type()const noexcept{return type_;}
+
+    ///
+    /// \brief entries. Read access to the active traces
+    ///
+    const std::vector<trace_entry>& entries()const noexcept{return entries_;}
+
+private:
+
+    ///
+    /// \brief type_
+    ///
+    EligibilityTraceType type_;
+
+    ///
+    /// \brief cutoff_. Traces below this value are dropped
+    ///
+    real_t cutoff_;
+
+    ///
+    /// \brief n_actions_
+    ///
+    uint_t n_actions_;
+
+    ///
+    /// \brief entries_. The active traces
+    ///
+    std::vector<trace_entry> entries_;
+
+    ///
+    /// \brief position_. Maps state * n_actions + action to the
+    /// position of the pair in entries_ or INVALID_SIZE_TYPE
+    ///
+    std::vector<uint_t> position_;
+
+    ///
+    /// \brief remove_. Swap-remove the i-th entry
+    ///
+    void remove_(uint_t i)noexcept;
+};
+
+inline
+SparseEligibilityTraces::SparseEligibilityTraces(EligibilityTraceType type, real_t cutoff)
+    :
+      type_(type),
+      cutoff_(cutoff),
+      n_actions_(0),
+      entries_(),
+      position_()
+{}
+
+inline
+void
+SparseEligibilityTraces::initialize(uint_t n_states, uint_t n_actions){
+
+    n_actions_ = n_actions;
+    entries_.clear();
+    entries_.reserve(256);
+    position_.assign(n_states * n_actions, CubeAIConsts::INVALID_SIZE_TYPE);
+}
+
+inline
+void
+SparseEligibilityTraces::visit(uint_t state, uint_t action){
+
+#ifdef CUBEAI_DEBUG
+    assert(state * n_actions_ + action < position_.size() && "Invalid state-action pair");
+#endif
+
+    auto& pos = position_[state * n_actions_ + action];
+
+    if(pos == CubeAIConsts::INVALID_SIZE_TYPE){
+        pos = entries_.size();
+        entries_.push_back({state, action, 1.0});
+        return;
+    }
+
+    if(type_ == EligibilityTraceType::ACCUMULATING){
+        entries_[pos].value += 1.0;
+    }
+    else{
+        entries_[pos].value = 1.0;
+    }
+}
+
+template<typename TableTp>
+void
+SparseEligibilityTraces::update(TableTp& q_table, real_t step, real_t decay_factor){
+
+    uint_t i = 0;
+    while(i < entries_.size()){
+
+        auto& entry = entries_[i];
+        q_table(entry.state, entry.action) += step * entry.value;
+        entry.value *= decay_factor;
+
+        if(entry.value < cutoff_){
+            // the last entry is moved into position i
+            // so do not advance
+            remove_(i);
+            continue;
+        }
+
+        ++i;
+    }
+}
+
+inline
+void
+SparseEligibilityTraces::clear()noexcept{
+
+    for(const auto& entry : entries_){
+        position_[entry.state * n_actions_ + entry.action] = CubeAIConsts::INVALID_SIZE_TYPE;
+    }
+
+    entries_.clear();
+}
+
+inline
+real_t
+SparseEligibilityTraces::value(uint_t state, uint_t action)const noexcept{
+
+    auto pos = position_[state * n_actions_ + action];
+    return pos == CubeAIConsts::INVALID_SIZE_TYPE ? 0.0 : entries_[pos].value;
+}
+
+inline
+void
+SparseEligibilityTraces::remove_(uint_t i)noexcept{
+
+    const auto& entry = entries_[i];
+    position_[entry.state * n_actions_ + entry.action] = CubeAIConsts::INVALID_SIZE_TYPE;
+
+    const auto last = entries_.size() - 1;
+    if(i != last){
+        entries_[i] = entries_[last];
+        position_[entries_[i].state * n_actions_ + entries_[i].action] = i;
+    }
+
+    entries_.pop_back();
+}
+
+}
+}
+}
+}
+
+#endif // ELIGIBILITY_TRACES_H
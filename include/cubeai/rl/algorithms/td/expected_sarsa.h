@@ -6,25 +6,42 @@
 #include "cubeai/base/cubeai_types.h"
 #include "cubeai/rl/algorithms/td/td_algo_base.h"
 #include "cubeai/rl/worlds/envs_concepts.h"
-
-
+#include "cubeai/rl/episode_info.h"
 
 #ifdef CUBEAI_DEBUG
 #include <cassert>
 #endif
 
+#include <chrono>
+#include <string>
+
 namespace cubeai {
 namespace rl{
 namespace algos {
 namespace td {
 
+///
+/// \brief The ExpectedSARSAConfig struct
+///
+struct ExpectedSARSAConfig
+{
+    uint_t n_episodes;
+    real_t tolerance;
+    real_t gamma;
+    real_t eta;
+    uint_t max_num_iterations_per_episode;
+    std::string path{""};
+};
 
 ///
 /// \brief The  ExpectedSARSA class. Simple implementation
-/// of the expected SARSA algorithm
+/// of the expected SARSA algorithm. The ActionSelector is assumed
+/// to be epsilon-greedy and should expose eps_value(). The expectation
+/// of Q(s', .) under the epsilon-greedy policy is computed in closed form
+/// as (1 - eps) * max_a Q(s', a) + eps * mean_a Q(s', a)
 ///
 template<envs::discrete_world_concept EnvTp, typename ActionSelector>
-class ExpectedSARSA: public  TDAlgoBase<EnvTp>
+class ExpectedSARSA final: public  TDAlgoBase<EnvTp>
 {
 public:
 
@@ -51,161 +68,160 @@ public:
     ///
     /// \brief Constructor
     ///
-    ExpectedSARSA(uint_t n_episodes, real_t tolerance,
-                  real_t gamma, real_t eta, uint_t plot_f,
-                  env_type& env, uint_t max_num_iterations_per_episode,
-                  const ActionSelector& selector);
+    ExpectedSARSA(const ExpectedSARSAConfig config, const ActionSelector& selector);
 
     ///
-    /// \brief Constructor
+    /// \brief actions_before_training_begins. Execute any actions the
+    /// algorithm needs before starting the iterations
+    ///
+    virtual void actions_before_training_begins(env_type&);
+
+    ///
+    /// \brief actions_after_training_ends. Actions to execute after
+    /// the training iterations have finisehd
     ///
-    ExpectedSARSA(TDAlgoConfig config,
-                  env_type& env,  const ActionSelector& selector);
+    virtual void actions_after_training_ends(env_type&){}
 
     ///
-    /// \brief on_episode. Performs the iterations for
-    /// one training episode
+    /// \brief actions_before_training_episode
     ///
-    virtual void on_episode()override final;
+    virtual void actions_before_episode_begins(env_type&, uint_t /*episode_idx*/){}
+
+    ///
+    /// \brief actions_after_training_episode
+    ///
+    virtual void actions_after_episode_ends(env_type&, uint_t episode_idx,
+                                            const EpisodeInfo& /*einfo*/){
+        action_selector_.on_episode(episode_idx);
+    }
+
+    ///
+    /// \brief on_episode Do one on_episode of the algorithm
+    ///
+    virtual EpisodeInfo on_training_episode(env_type&, uint_t episode_idx);
+
+    ///
+    /// \brief q_table. Read access to the learnt Q-function
+    ///
+    const DynMat<real_t>& q_table()const noexcept{return q_table_;}
 
 private:
 
+    ///
+    /// \brief config_
+    ///
+    ExpectedSARSAConfig config_;
+
     ///
     /// \brief action_selector_
     ///
     action_selector_type action_selector_;
 
     ///
-    /// \brief current_score_counter_
+    /// \brief q_table_. The tabular representation of the Q-function
     ///
-    uint_t current_score_counter_;
+    DynMat<real_t> q_table_;
 
     ///
     /// \brief update_q_table_
     /// \param action
     ///
     void update_q_table_(const action_type& action, const state_type& cstate,
-                         const state_type& next_state, const  action_type& next_action, real_t reward);
+                         const state_type& next_state, real_t reward);
 
 };
 
 template <envs::discrete_world_concept EnvTp, typename ActionSelector>
-ExpectedSARSA<EnvTp, ActionSelector>::ExpectedSARSA(uint_t n_episodes, real_t tolerance, real_t gamma,
-                                         real_t eta, uint_t plot_f,
-                                         env_type& env, uint_t max_num_iterations_per_episode, const ActionSelector& selector)
+ExpectedSARSA<EnvTp, ActionSelector>::ExpectedSARSA(const ExpectedSARSAConfig config, const ActionSelector& selector)
     :
-      TDAlgoBase<EnvTp>(n_episodes, tolerance, gamma, eta, plot_f, max_num_iterations_per_episode, env),
+      TDAlgoBase<EnvTp>(),
+      config_(config),
       action_selector_(selector),
-      current_score_counter_(0)
+      q_table_()
 {}
 
-template <envs::discrete_world_concept EnvTp, typename ActionSelector>
-ExpectedSARSA<EnvTp, ActionSelector>::ExpectedSARSA(TDAlgoConfig config, env_type& env, const ActionSelector& selector)
-    :
-      TDAlgoBase<EnvTp>(config, env),
-      action_selector_(selector),
-      current_score_counter_(0)
-{}
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+ExpectedSARSA<EnvTp, ActionSelector>::actions_before_training_begins(env_type& env){
+    q_table_ = DynMat<real_t>::Zero(env.n_states(), env.n_actions());
+}
 
 template <envs::discrete_world_concept EnvTp, typename ActionSelector>
-void
-ExpectedSARSA<EnvTp, ActionSelector>::on_episode(){
+EpisodeInfo
+ExpectedSARSA<EnvTp, ActionSelector>::on_training_episode(env_type& env, uint_t episode_idx){
 
-    // total score for the episode
-    auto score = 0.0;
-    auto state = this->env_ref_().reset().observation();
+    auto start = std::chrono::steady_clock::now();
+    EpisodeInfo info;
 
-    // select an action
-    auto action = action_selector_(this->q_table(), state);
+    // total score for the episode
+    auto episode_score = 0.0;
+    auto state = env.reset().observation();
 
     uint_t itr=0;
-    for(;  itr < this->n_iterations_per_episode(); ++itr){
+    for(;  itr < config_.max_num_iterations_per_episode; ++itr){
 
         // select an action
-        auto action = action_selector_(this->q_table(), state);
-        if(this->is_verbose()){
-            std::cout<<"Episode iteration="<<itr<<" of="<<this->n_iterations_per_episode()<<std::endl;
-            std::cout<<"State="<<state<<std::endl;
-            std::cout<<"Action="<<action<<std::endl;
-        }
+        auto action = action_selector_(q_table_, state);
 
         // Take a on_episode
-        auto step_type_result = this->env_ref_().step(action);
+        auto step_type_result = env.step(action);
 
         auto next_state = step_type_result.observation();
         auto reward = step_type_result.reward();
         auto done = step_type_result.done();
 
         // accumulate score
-        score += reward;
+        episode_score += reward;
 
         if(!done){
-            auto next_action = action_selector_(this->q_table(), state);
-            update_q_table_(action, state, next_state, next_action, reward);
+            update_q_table_(action, state, next_state, reward);
             state = next_state;
-            action = next_action;
         }
         else{
 
-            update_q_table_(action, state, CubeAIConsts::invalid_size_type(),
-                            CubeAIConsts::invalid_size_type(), reward);
-
-            this->tmp_scores()[current_score_counter_++] = score;
-
-            if(current_score_counter_ >= this->render_env_frequency_){
-                current_score_counter_ = 0;
-            }
-
-            if(this->is_verbose()){
-                std::cout<<"============================================="<<std::endl;
-                std::cout<<"Break out from episode="<<this->current_episode_idx()<<std::endl;
-                std::cout<<"============================================="<<std::endl;
-            }
-
+            update_q_table_(action, state, CubeAIConsts::invalid_size_type(), reward);
             break;
         }
     }
 
-    // make any adjustments to the way
-    // actions are selected given the experience collected
-    // in the episode
-    action_selector_.adjust_on_episode(this->current_episode_idx());
-    if(current_score_counter_ >= this->render_env_frequency_){
-        current_score_counter_ = 0;
-    }
-
-    std::cout<<"Finished on_episode="<<this->current_episode_idx()<<std::endl;
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<real_t> elapsed_seconds = end-start;
 
+    info.episode_index = episode_idx;
+    info.episode_reward = episode_score;
+    info.episode_iterations = itr;
+    info.total_time = elapsed_seconds;
+    return info;
 }
 
 template<envs::discrete_world_concept EnvTp, typename ActionSelector>
 void
 ExpectedSARSA<EnvTp, ActionSelector>::update_q_table_(const action_type& action, const state_type& cstate,
-                                                           const state_type& next_state, const  action_type& next_action, real_t reward){
+                                                      const state_type& next_state, real_t reward){
 
 #ifdef CUBEAI_DEBUG
-    assert(action < this->env_ref_().n_actions() && "Inavlid action idx");
-    assert(cstate < this->env_ref_().n_states() && "Inavlid state idx");
+    assert(action < static_cast<action_type>(q_table_.cols()) && "Inavlid action idx");
+    assert(cstate < static_cast<state_type>(q_table_.rows()) && "Inavlid state idx");
 
     if(next_state != CubeAIConsts::invalid_size_type())
-        assert(next_state < this->env_ref_().n_states() && "Inavlid next_state idx");
-
-    if(next_action != CubeAIConsts::invalid_size_type())
-        assert(next_action < this->env_ref_().n_actions() && "Inavlid next_action idx");
+        assert(next_state < static_cast<state_type>(q_table_.rows()) && "Inavlid next_state idx");
 #endif
 
-    const auto eps = action_selector_.eps_value();
-    auto q_current = this->q_table()[cstate][action];
-    auto policy_s = DynVec<real_t>(this->env_ref_().n_actions(), 1.0);
-    policy_s *= eps / this->env_ref_().n_actions();
+    auto q_next = 0.0;
 
-    auto state_action_values = this->q_table()[next_state];
-    auto argmax = blaze::argmax(state_action_values);
-    policy_s[argmax] = 1 - eps + (eps / this->env_ref_().n_actions());
+    if(next_state != CubeAIConsts::invalid_size_type()){
+
+        // the greedy action has probability 1 - eps + eps/n and every
+        // action eps/n so the expectation reduces to a max and a mean
+        // over the row. No policy vector is needed
+        const auto eps = action_selector_.eps_value();
+        const auto row = q_table_.row(next_state);
+        q_next = (1.0 - eps) * row.maxCoeff() + eps * row.mean();
+    }
 
-    auto q_next = state_action_values * policy_s;
-    auto td_target = reward + this->gamma() * q_next;
-    //this->q_table()[cstate][action] = q_current + (this->eta() * (td_target - q_current));
+    auto q_current = q_table_(cstate, action);
+    auto td_target = reward + config_.gamma * q_next;
+    q_table_(cstate, action) = q_current + (config_.eta * (td_target - q_current));
 }
 
 }
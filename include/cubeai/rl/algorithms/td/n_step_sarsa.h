@@ -0,0 +1,283 @@
+#ifndef N_STEP_SARSA_H
+#define N_STEP_SARSA_H
+
+#include "cubeai/rl/algorithms/td/td_algo_base.h"
+#include "cubeai/rl/worlds/envs_concepts.h"
+#include "cubeai/rl/episode_info.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/base/cubeai_config.h"
+
+#ifdef CUBEAI_DEBUG
+#include <cassert>
+#endif
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace cubeai{
+namespace rl {
+namespace algos {
+namespace td {
+
+///
+/// \brief The NStepSarsaConfig struct
+///
+struct NStepSarsaConfig
+{
+    uint_t n_episodes;
+    real_t tolerance;
+    real_t gamma;
+    real_t eta;
+    uint_t n;
+    uint_t max_num_iterations_per_episode;
+    std::string path{""};
+};
+
+///
+/// \brief The NStepSarsa class. Tabular n-step SARSA. The last n + 1
+/// states, actions and rewards are kept in preallocated ring buffers
+/// so an update touches only the pair that leaves the window
+///
+template<envs::discrete_world_concept EnvType, typename ActionSelector>
+class NStepSarsa final: public TDAlgoBase<EnvType>
+{
+public:
+
+    ///
+    /// \brief env_t
+    ///
+    typedef typename TDAlgoBase<EnvType>::env_type env_type;
+
+    ///
+    /// \brief action_t
+    ///
+    typedef typename TDAlgoBase<EnvType>::action_type action_type;
+
+    ///
+    /// \brief state_t
+    ///
+    typedef typename TDAlgoBase<EnvType>::state_type state_type;
+
+    ///
+    /// \brief action_selector_t
+    ///
+    typedef ActionSelector action_selector_type;
+
+    ///
+    /// \brief NStepSarsa
+    ///
+    NStepSarsa(NStepSarsaConfig config, const ActionSelector& selector);
+
+    ///
+    /// \brief actions_before_training_begins. Execute any actions the
+    /// algorithm needs before starting the iterations
+    ///
+    virtual void actions_before_training_begins(env_type&);
+
+    ///
+    /// \brief actions_after_training_ends. Actions to execute after
+    /// the training iterations have finisehd
+    ///
+    virtual void actions_after_training_ends(env_type&){}
+
+    ///
+    /// \brief actions_before_training_episode
+    ///
+    virtual void actions_before_episode_begins(env_type&, uint_t /*episode_idx*/){}
+
+    ///
+    /// \brief actions_after_training_episode
+    ///
+    virtual void actions_after_episode_ends(env_type&, uint_t episode_idx, const EpisodeInfo& /*einfo*/){
+        action_selector_.on_episode(episode_idx);
+    }
+
+    ///
+    /// \brief on_episode Do one on_episode of the algorithm
+    ///
+    virtual EpisodeInfo on_training_episode(env_type&, uint_t episode_idx);
+
+    ///
+    /// \brief q_table. Read access to the learnt Q-function
+    ///
+    const DynMat<real_t>& q_table()const noexcept{return q_table_;}
+
+private:
+
+    ///
+    /// \brief config_
+    ///
+    NStepSarsaConfig config_;
+
+    ///
+    /// \brief action_selector_
+    ///
+    action_selector_type action_selector_;
+
+    ///
+    /// \brief q_table_. The tabular representation of the Q-function
+    ///
+    DynMat<real_t> q_table_;
+
+    ///
+    /// \brief Ring buffers of size n + 1
+    ///
+    std::vector<state_type> states_;
+    std::vector<action_type> actions_;
+    std::vector<real_t> rewards_;
+
+    ///
+    /// \brief gamma_powers_. gamma^0,...,gamma^n
+    ///
+    std::vector<real_t> gamma_powers_;
+
+    ///
+    /// \brief update_q_table_. Update the pair at time tau
+    /// using the rewards up to min(tau + n, T) and bootstrap
+    /// from that time if required
+    ///
+    void update_q_table_(uint_t tau, uint_t horizon, bool bootstrap);
+};
+
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+NStepSarsa<EnvTp, ActionSelector>::NStepSarsa(NStepSarsaConfig config, const ActionSelector& selector)
+    :
+      TDAlgoBase<EnvTp>(),
+      config_(config),
+      action_selector_(selector),
+      q_table_(),
+      states_(),
+      actions_(),
+      rewards_(),
+      gamma_powers_()
+{}
+
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+NStepSarsa<EnvTp, ActionSelector>::actions_before_training_begins(env_type& env){
+
+#ifdef CUBEAI_DEBUG
+    assert(config_.n > 0 && "The number of steps n should be positive");
+#endif
+
+    q_table_ = DynMat<real_t>::Zero(env.n_states(), env.n_actions());
+
+    states_.assign(config_.n + 1, state_type());
+    actions_.assign(config_.n + 1, action_type());
+    rewards_.assign(config_.n + 1, 0.0);
+
+    gamma_powers_.resize(config_.n + 1);
+    gamma_powers_[0] = 1.0;
+    for(uint_t i=1; i <= config_.n; ++i){
+        gamma_powers_[i] = gamma_powers_[i - 1] * config_.gamma;
+    }
+}
+
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+EpisodeInfo
+NStepSarsa<EnvTp, ActionSelector>::on_training_episode(env_type& env, uint_t episode_idx){
+
+    auto start = std::chrono::steady_clock::now();
+    EpisodeInfo info;
+
+    const auto n = config_.n;
+    const auto window = n + 1;
+
+    // total score for the episode
+    auto episode_score = 0.0;
+    states_[0] = env.reset().observation();
+    actions_[0] = action_selector_(q_table_, states_[0]);
+
+    // T in the usual notation. Becomes finite once the
+    // episode terminates or is truncated
+    auto horizon = CubeAIConsts::INVALID_SIZE_TYPE;
+    auto truncated = false;
+
+    uint_t t = 0;
+    for(;; ++t){
+
+        if(t < horizon){
+
+            auto step_type_result = env.step(actions_[t % window]);
+
+            auto next_state = step_type_result.observation();
+            auto reward = step_type_result.reward();
+            auto done = step_type_result.done();
+
+            episode_score += reward;
+            states_[(t + 1) % window] = next_state;
+            rewards_[(t + 1) % window] = reward;
+
+            if(done){
+                horizon = t + 1;
+            }
+            else{
+                actions_[(t + 1) % window] = action_selector_(q_table_, next_state);
+
+                // we ran out of iterations. Keep bootstrapping
+                // from the last pair for the remaining updates
+                if(t + 1 >= config_.max_num_iterations_per_episode){
+                    horizon = t + 1;
+                    truncated = true;
+                }
+            }
+        }
+
+        // the time whose estimate is being updated
+        if(t + 1 >= n){
+
+            auto tau = t + 1 - n;
+            update_q_table_(tau, horizon, truncated || tau + n < horizon);
+
+            if(tau + 1 == horizon){
+                break;
+            }
+        }
+        else if(t + 1 == horizon){
+
+            // the episode ended before the window was filled
+            for(uint_t tau = 0; tau < horizon; ++tau){
+                update_q_table_(tau, horizon, truncated);
+            }
+            break;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<real_t> elapsed_seconds = end-start;
+
+    info.episode_index = episode_idx;
+    info.episode_reward = episode_score;
+    info.episode_iterations = horizon;
+    info.total_time = elapsed_seconds;
+    return info;
+}
+
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+NStepSarsa<EnvTp, ActionSelector>::update_q_table_(uint_t tau, uint_t horizon, bool bootstrap){
+
+    const auto window = config_.n + 1;
+    const auto last = std::min(tau + config_.n, horizon);
+
+    auto G = 0.0;
+    for(uint_t i = tau + 1; i <= last; ++i){
+        G += gamma_powers_[i - tau - 1] * rewards_[i % window];
+    }
+
+    if(bootstrap){
+        G += gamma_powers_[last - tau] * q_table_(states_[last % window], actions_[last % window]);
+    }
+
+    auto& q_current = q_table_(states_[tau % window], actions_[tau % window]);
+    q_current += config_.eta * (G - q_current);
+}
+
+}
+}
+}
+}
+
+#endif // N_STEP_SARSA_H
@@ -6,7 +6,8 @@
 #include "cubeai/rl/worlds/envs_concepts.h"
 #include "cubeai/rl/episode_info.h"
 #include "cubeai/maths/matrix_utilities.h"
-#include "cubeai/io/csv_file_writer.h"
+#include "cubeai/io/binary_checkpoint.h"
+#include "cubeai/utils/instrumentation.h"
 
 #include "cubeai/base/cubeai_consts.h"
 #include "cubeai/base/cubeai_config.h"
@@ -16,6 +17,7 @@
 #endif
 
 #include <chrono>
+#include <string>
 
 namespace cubeai {
 namespace rl{
@@ -102,10 +104,33 @@ public:
     virtual EpisodeInfo on_training_episode(env_type&, uint_t episode_idx);
 
     ///
-    ///
+    /// \brief save. Write the Q-table and the state of the
+    /// action selector to a binary checkpoint file
     ///
     void save(std::string filename)const;
 
+    ///
+    /// \brief load. Restore the state written by save. The next
+    /// training resumes from it instead of a zero Q-table
+    ///
+    void load(const std::string& filename);
+
+    ///
+    /// \brief save_checkpoint. Add the Q-table and, if the action
+    /// selector supports it, its state to the checkpoint
+    ///
+    void save_checkpoint(io::Checkpoint& checkpoint)const;
+
+    ///
+    /// \brief load_checkpoint. Restore what save_checkpoint added
+    ///
+    void load_checkpoint(const io::MappedCheckpoint& checkpoint);
+
+    ///
+    /// \brief q_function
+    ///
+    const DynMat<real_t>& q_function()const noexcept{return q_table_;}
+
 private:
 
     ///
@@ -123,6 +148,11 @@ private:
     ///
     DynMat<real_t> q_table_;
 
+    ///
+    /// \brief resume_. Whether q_table_ was restored from a checkpoint
+    ///
+    bool resume_;
+
     ///
     /// \brief update_q_table_
     /// \param action
@@ -138,12 +168,27 @@ QLearning<EnvTp, ActionSelector>::QLearning(const QLearningConfig config, const
       TDAlgoBase<EnvTp>(),
       config_(config),
       action_selector_(selector),
-      q_table_()
+      q_table_(),
+      resume_(false)
 {}
 
 template<envs::discrete_world_concept EnvTp, typename ActionSelector>
 void
 QLearning<EnvTp, ActionSelector>::actions_before_training_begins(env_type& env){
+
+    const auto resume = resume_;
+    resume_ = false;
+
+    if(resume){
+
+        if(static_cast<uint_t>(q_table_.rows()) != env.n_states() ||
+           static_cast<uint_t>(q_table_.cols()) != env.n_actions()){
+            throw std::logic_error("The restored Q-table does not match the environment");
+        }
+
+        return;
+    }
+
     q_table_ = DynMat<real_t>(env.n_states(), env.n_actions());
 
     for(uint_t i=0; i < env.n_states(); ++i)
@@ -180,7 +225,12 @@ QLearning<EnvTp, ActionSelector>::on_training_episode(env_type& env, uint_t epis
     for(;  itr < config_.max_num_iterations_per_episode; ++itr){
 
         // Take a on_episode
-        auto step_type_result = env.step(action);
+        auto step_type_result = [&](){
+            utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::ENV_STEP);
+            return env.step(action);
+        }();
+
+        utils::Instrumentation::increment(utils::InstrumentationCounter::STEPS);
 
         auto next_state = step_type_result.observation();
         auto reward = step_type_result.reward();
@@ -190,17 +240,30 @@ QLearning<EnvTp, ActionSelector>::on_training_episode(env_type& env, uint_t epis
         episode_score += reward;
 
         if(!done){
-            auto next_action = action_selector_(q_table_, state);
-            update_q_table_(action, state, next_state, next_action, reward);
+
+            auto next_action = [&](){
+                utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::ACTION_SELECTION);
+                return action_selector_(q_table_, next_state);
+            }();
+
+            {
+                utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::UPDATE);
+                update_q_table_(action, state, next_state, next_action, reward);
+            }
+
+            utils::Instrumentation::increment(utils::InstrumentationCounter::UPDATES);
             state = next_state;
             action = next_action;
         }
         else{
 
-            update_q_table_(action, state, CubeAIConsts::invalid_size_type(),
-                            CubeAIConsts::invalid_size_type(), reward);
-
+            {
+                utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::UPDATE);
+                update_q_table_(action, state, CubeAIConsts::invalid_size_type(),
+                                CubeAIConsts::invalid_size_type(), reward);
+            }
 
+            utils::Instrumentation::increment(utils::InstrumentationCounter::UPDATES);
             break;
         }
     }
@@ -226,22 +289,41 @@ template<envs::discrete_world_concept EnvTp, typename ActionSelector>
 void
 QLearning<EnvTp, ActionSelector>::save(std::string filename)const{
 
-    /*CSVWriter file_writer(filename, ',', true);
-    std::vector<std::string> col_names(1 + q_table_.columns());
-    col_names[0] = "state_index";
+    io::Checkpoint checkpoint;
+    save_checkpoint(checkpoint);
+    io::write_checkpoint(checkpoint, filename);
+}
 
-    for(uint_t i = 0; i< q_table_.columns(); ++i){
-        col_names[i + 1] = "action_" + std::to_string(i);
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+QLearning<EnvTp, ActionSelector>::load(const std::string& filename){
+
+    io::MappedCheckpoint checkpoint(filename);
+    load_checkpoint(checkpoint);
+}
+
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+QLearning<EnvTp, ActionSelector>::save_checkpoint(io::Checkpoint& checkpoint)const{
+
+    checkpoint.add("q_table", q_table_);
+
+    if constexpr(requires(const action_selector_type& s){ s.save_checkpoint(checkpoint, std::string()); }){
+        action_selector_.save_checkpoint(checkpoint, "action_selector.");
     }
+}
 
-    file_writer.write_column_names(col_names);
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+QLearning<EnvTp, ActionSelector>::load_checkpoint(const io::MappedCheckpoint& checkpoint){
 
-    for(uint_t s=0; s < q_table_.rows(); ++s){
-        auto actions = maths::get_row(q_table_, s);
-        auto row = std::make_tuple(s, actions);
-        file_writer.write_row(row);
-    }*/
+    q_table_ = checkpoint.matrix("q_table");
+
+    if constexpr(requires(action_selector_type& s){ s.load_checkpoint(checkpoint, std::string()); }){
+        action_selector_.load_checkpoint(checkpoint, "action_selector.");
+    }
 
+    resume_ = true;
 }
 
 template <envs::discrete_world_concept EnvTp, typename ActionSelector>
@@ -0,0 +1,213 @@
+#ifndef SARSA_LAMBDA_H
+#define SARSA_LAMBDA_H
+
+#include "cubeai/rl/algorithms/td/td_algo_base.h"
+#include "cubeai/rl/algorithms/td/eligibility_traces.h"
+#include "cubeai/rl/worlds/envs_concepts.h"
+#include "cubeai/rl/episode_info.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/base/cubeai_config.h"
+
+#ifdef CUBEAI_DEBUG
+#include <cassert>
+#endif
+
+#include <chrono>
+#include <string>
+
+namespace cubeai{
+namespace rl {
+namespace algos {
+namespace td {
+
+///
+/// \brief The SarsaLambdaConfig struct
+///
+struct SarsaLambdaConfig
+{
+    uint_t n_episodes;
+    real_t tolerance;
+    real_t gamma;
+    real_t eta;
+    real_t lambda;
+    uint_t max_num_iterations_per_episode;
+    real_t trace_cutoff{1.0e-4};
+    EligibilityTraceType trace_type{EligibilityTraceType::REPLACING};
+    std::string path{""};
+};
+
+///
+/// \brief The SarsaLambdaSolver class. Tabular SARSA(lambda).
+/// The eligibility traces are kept in a SparseEligibilityTraces
+/// instance so that every step only touches the recently visited
+/// state-action pairs
+///
+template<envs::discrete_world_concept EnvType, typename ActionSelector>
+class SarsaLambdaSolver final: public TDAlgoBase<EnvType>
+{
+public:
+
+    ///
+    /// \brief env_t
+    ///
+    typedef typename TDAlgoBase<EnvType>::env_type env_type;
+
+    ///
+    /// \brief action_t
+    ///
+    typedef typename TDAlgoBase<EnvType>::action_type action_type;
+
+    ///
+    /// \brief state_t
+    ///
+    typedef typename TDAlgoBase<EnvType>::state_type state_type;
+
+    ///
+    /// \brief action_selector_t
+    ///
+    typedef ActionSelector action_selector_type;
+
+    ///
+    /// \brief SarsaLambdaSolver
+    ///
+    SarsaLambdaSolver(SarsaLambdaConfig config, const ActionSelector& selector);
+
+    ///
+    /// \brief actions_before_training_begins. Execute any actions the
+    /// algorithm needs before starting the iterations
+    ///
+    virtual void actions_before_training_begins(env_type&);
+
+    ///
+    /// \brief actions_after_training_ends. Actions to execute after
+    /// the training iterations have finisehd
+    ///
+    virtual void actions_after_training_ends(env_type&){}
+
+    ///
+    /// \brief actions_before_training_episode
+    ///
+    virtual void actions_before_episode_begins(env_type&, uint_t /*episode_idx*/){traces_.clear();}
+
+    ///
+    /// \brief actions_after_training_episode
+    ///
+    virtual void actions_after_episode_ends(env_type&, uint_t episode_idx, const EpisodeInfo& /*einfo*/){
+        action_selector_.on_episode(episode_idx);
+    }
+
+    ///
+    /// \brief on_episode Do one on_episode of the algorithm
+    ///
+    virtual EpisodeInfo on_training_episode(env_type&, uint_t episode_idx);
+
+    ///
+    /// \brief q_table. Read access to the learnt Q-function
+    ///
+    const DynMat<real_t>& q_table()const noexcept{return q_table_;}
+
+    ///
+    /// \brief traces. Read access to the eligibility traces
+    ///
+    const SparseEligibilityTraces& traces()const noexcept{return traces_;}
+
+private:
+
+    ///
+    /// \brief config_
+    ///
+    SarsaLambdaConfig config_;
+
+    ///
+    /// \brief action_selector_
+    ///
+    action_selector_type action_selector_;
+
+    ///
+    /// \brief q_table_. The tabular representation of the Q-function
+    ///
+    DynMat<real_t> q_table_;
+
+    ///
+    /// \brief traces_. The active eligibility traces
+    ///
+    SparseEligibilityTraces traces_;
+};
+
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+SarsaLambdaSolver<EnvTp, ActionSelector>::SarsaLambdaSolver(SarsaLambdaConfig config, const ActionSelector& selector)
+    :
+      TDAlgoBase<EnvTp>(),
+      config_(config),
+      action_selector_(selector),
+      q_table_(),
+      traces_(config.trace_type, config.trace_cutoff)
+{}
+
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+void
+SarsaLambdaSolver<EnvTp, ActionSelector>::actions_before_training_begins(env_type& env){
+
+    q_table_ = DynMat<real_t>::Zero(env.n_states(), env.n_actions());
+    traces_.initialize(env.n_states(), env.n_actions());
+}
+
+template<envs::discrete_world_concept EnvTp, typename ActionSelector>
+EpisodeInfo
+SarsaLambdaSolver<EnvTp, ActionSelector>::on_training_episode(env_type& env, uint_t episode_idx){
+
+    auto start = std::chrono::steady_clock::now();
+    EpisodeInfo info;
+
+    // total score for the episode
+    auto episode_score = 0.0;
+    auto state = env.reset().observation();
+    auto action = action_selector_(q_table_, state);
+
+    const auto trace_decay = config_.gamma * config_.lambda;
+
+    uint_t itr=0;
+    for(;  itr < config_.max_num_iterations_per_episode; ++itr){
+
+        auto step_type_result = env.step(action);
+
+        auto next_state = step_type_result.observation();
+        auto reward = step_type_result.reward();
+        auto done = step_type_result.done();
+
+        // accumulate score
+        episode_score += reward;
+        traces_.visit(state, action);
+
+        if(!done){
+
+            auto next_action = action_selector_(q_table_, next_state);
+            auto td_error = reward + config_.gamma * q_table_(next_state, next_action) - q_table_(state, action);
+            traces_.update(q_table_, config_.eta * td_error, trace_decay);
+            state = next_state;
+            action = next_action;
+        }
+        else{
+
+            auto td_error = reward - q_table_(state, action);
+            traces_.update(q_table_, config_.eta * td_error, trace_decay);
+            break;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<real_t> elapsed_seconds = end-start;
+
+    info.episode_index = episode_idx;
+    info.episode_reward = episode_score;
+    info.episode_iterations = itr;
+    info.total_time = elapsed_seconds;
+    return info;
+}
+
+}
+}
+}
+}
+
+#endif // SARSA_LAMBDA_H
@@ -0,0 +1,360 @@
+#ifndef TABULAR_TRANSITION_MODEL_H
+#define TABULAR_TRANSITION_MODEL_H
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/base/cubeai_config.h"
+
+#ifdef CUBEAI_DEBUG
+#include <cassert>
+#endif
+
+#include <vector>
+#include <random>
+#include <cstdint>
+
+namespace cubeai {
+namespace rl {
+namespace algos {
+namespace td {
+
+///
+/// \brief The TransitionModelType enum
+///
+enum class TransitionModelType{DETERMINISTIC, STOCHASTIC};
+
+///
+/// \brief The TabularTransitionModel class. Learned model of
+/// a discrete environment. Only the observed state-action pairs are
+/// stored. They are located via an open addressing hash table over
+/// the key state * n_actions + action so that the memory is proportional
+/// to the number of observed pairs and not to n_states * n_actions.
+/// In STOCHASTIC mode every pair keeps the list of observed outcomes
+/// with their counts and sampling follows the empirical distribution.
+/// In DETERMINISTIC mode the last observed outcome is kept.
+///
+class TabularTransitionModel
+{
+public:
+
+    ///
+    /// \brief The transition_outcome struct
+    ///
+    struct transition_outcome
+    {
+        uint_t next_state;
+        real_t reward;
+        uint_t count;
+        bool done;
+
+        ///
+        /// \brief next. Index of the next outcome of the
+        /// same pair or INVALID_SIZE_TYPE
+        ///
+        uint_t next;
+    };
+
+    ///
+    /// \brief The model_entry struct. An observed state-action pair
+    ///
+    struct model_entry
+    {
+        uint_t state;
+        uint_t action;
+        uint_t first_outcome;
+        uint_t total_count;
+    };
+
+    ///
+    /// \brief Constructor
+    ///
+    explicit TabularTransitionModel(TransitionModelType type=TransitionModelType::DETERMINISTIC);
+
+    ///
+    /// \brief initialize. Clear the model and set the number of
+    /// actions used to form the keys
+    ///
+    void initialize(uint_t n_actions, uint_t expected_n_pairs=1024);
+
+    ///
+    /// \brief update. Record the observed transition
+    ///
+    void update(uint_t state, uint_t action, uint_t next_state, real_t reward, bool done);
+
+    ///
+    /// \brief sample. Sample an observed state-action pair uniformly
+    /// and an outcome for it. The model should not be empty
+    ///
+    template<typename RandomEngineTp>
+    const transition_outcome& sample(RandomEngineTp& engine, uint_t& state, uint_t& action)const;
+
+    ///
+    /// \brief find. Returns the index of the entry for the given
+    /// pair or INVALID_SIZE_TYPE if the pair has not been observed
+    ///
+    uint_t find(uint_t state, uint_t action)const noexcept;
+
+    ///
+    /// \brief size. Returns the number of observed pairs
+    ///
+    uint_t size()const noexcept{return entries_.size();}
+
+    ///
+    /// \brief empty
+    ///
+    bool empty()const noexcept{return entries_.empty();}
+
+    ///
+    /// \brief n_outcomes. Returns the total number of stored outcomes
+    ///
+    uint_t n_outcomes()const noexcept{return outcomes_.size();}
+
+    ///
+    /// \brief model_type
+    ///
+    TransitionModelType model_type()const noexcept{return type_;}
+
+    ///
+    /// \brief entry. Access the i-th observed pair
+    ///
+    const model_entry& entry(uint_t i)const{return entries_[i];}
+
+    ///
+    /// \brief outcome. Access the i-th outcome
+    ///
+    const transition_outcome& outcome(uint_t i)const{return outcomes_[i];}
+
+private:
+
+    ///
+    /// \brief EMPTY_SLOT
+    ///
+    static constexpr uint_t EMPTY_SLOT = CubeAIConsts::INVALID_SIZE_TYPE;
+
+    ///
+    /// \brief type_
+    ///
+    TransitionModelType type_;
+
+    ///
+    /// \brief n_actions_
+    ///
+    uint_t n_actions_;
+
+    ///
+    /// \brief slots_. Open addressing table of indices into entries_.
+    /// Its size is always a power of two
+    ///
+    std::vector<uint_t> slots_;
+
+    ///
+    /// \brief entries_
+    ///
+    std::vector<model_entry> entries_;
+
+    ///
+    /// \brief outcomes_. Pool with the outcomes of all the entries
+    ///
+    std::vector<transition_outcome> outcomes_;
+
+    ///
+    /// \brief hash_
+    ///
+    uint_t hash_(uint_t key)const noexcept;
+
+    ///
+    /// \brief probe_. Returns the slot holding the key or the empty
+    /// slot where it should be inserted
+    ///
+    uint_t probe_(uint_t key)const noexcept;
+
+    ///
+    /// \brief grow_. Double the slots and rehash
+    ///
+    void grow_();
+};
+
+inline
+TabularTransitionModel::TabularTransitionModel(TransitionModelType type)
+    :
+      type_(type),
+      n_actions_(0),
+      slots_(),
+      entries_(),
+      outcomes_()
+{}
+
+inline
+void
+TabularTransitionModel::initialize(uint_t n_actions, uint_t expected_n_pairs){
+
+    n_actions_ = n_actions;
+
+    uint_t capacity = 16;
+    while(capacity < 2 * expected_n_pairs){
+        capacity *= 2;
+    }
+
+    slots_.assign(capacity, EMPTY_SLOT);
+    entries_.clear();
+    entries_.reserve(expected_n_pairs);
+    outcomes_.clear();
+    outcomes_.reserve(expected_n_pairs);
+}
+
+inline
+uint_t
+TabularTransitionModel::hash_(uint_t key)const noexcept{
+
+    // 64-bit finalizer from MurmurHash3
+    std::uint64_t h = key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<uint_t>(h);
+}
+
+inline
+uint_t
+TabularTransitionModel::probe_(uint_t key)const noexcept{
+
+    const auto mask = slots_.size() - 1;
+    auto slot = hash_(key) & mask;
+
+    while(slots_[slot] != EMPTY_SLOT){
+
+        const auto& entry = entries_[slots_[slot]];
+        if(entry.state * n_actions_ + entry.action == key){
+            return slot;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+inline
+uint_t
+TabularTransitionModel::find(uint_t state, uint_t action)const noexcept{
+
+    if(slots_.empty()){
+        return CubeAIConsts::INVALID_SIZE_TYPE;
+    }
+
+    return slots_[probe_(state * n_actions_ + action)];
+}
+
+inline
+void
+TabularTransitionModel::grow_(){
+
+    std::vector<uint_t> old(slots_.size() * 2, EMPTY_SLOT);
+    slots_.swap(old);
+
+    const auto mask = slots_.size() - 1;
+    for(uint_t e=0; e<entries_.size(); ++e){
+
+        auto slot = hash_(entries_[e].state * n_actions_ + entries_[e].action) & mask;
+        while(slots_[slot] != EMPTY_SLOT){
+            slot = (slot + 1) & mask;
+        }
+
+        slots_[slot] = e;
+    }
+}
+
+inline
+void
+TabularTransitionModel::update(uint_t state, uint_t action, uint_t next_state, real_t reward, bool done){
+
+#ifdef CUBEAI_DEBUG
+    assert(!slots_.empty() && "Model has not been initialized");
+    assert(action < n_actions_ && "Invalid action index");
+#endif
+
+    // keep the load factor below 1/2
+    if(2 * (entries_.size() + 1) > slots_.size()){
+        grow_();
+    }
+
+    const auto slot = probe_(state * n_actions_ + action);
+
+    if(slots_[slot] == EMPTY_SLOT){
+
+        slots_[slot] = entries_.size();
+        entries_.push_back({state, action, outcomes_.size(), 1});
+        outcomes_.push_back({next_state, reward, 1, done, CubeAIConsts::INVALID_SIZE_TYPE});
+        return;
+    }
+
+    auto& entry = entries_[slots_[slot]];
+
+    if(type_ == TransitionModelType::DETERMINISTIC){
+        outcomes_[entry.first_outcome] = {next_state, reward, 1, done, CubeAIConsts::INVALID_SIZE_TYPE};
+        return;
+    }
+
+    entry.total_count += 1;
+
+    auto idx = entry.first_outcome;
+    while(true){
+
+        auto& outcome = outcomes_[idx];
+        if(outcome.next_state == next_state && outcome.done == done){
+
+            // running mean of the reward
+            outcome.count += 1;
+            outcome.reward += (reward - outcome.reward) / static_cast<real_t>(outcome.count);
+            return;
+        }
+
+        if(outcome.next == CubeAIConsts::INVALID_SIZE_TYPE){
+            outcome.next = outcomes_.size();
+            break;
+        }
+
+        idx = outcome.next;
+    }
+
+    outcomes_.push_back({next_state, reward, 1, done, CubeAIConsts::INVALID_SIZE_TYPE});
+}
+
+template<typename RandomEngineTp>
+const TabularTransitionModel::transition_outcome&
+TabularTransitionModel::sample(RandomEngineTp& engine, uint_t& state, uint_t& action)const{
+
+#ifdef CUBEAI_DEBUG
+    assert(!entries_.empty() && "Cannot sample from an empty model");
+#endif
+
+    std::uniform_int_distribution<uint_t> entry_dist(0, entries_.size() - 1);
+    const auto& entry = entries_[entry_dist(engine)];
+
+    state = entry.state;
+    action = entry.action;
+
+    auto idx = entry.first_outcome;
+    if(type_ == TransitionModelType::DETERMINISTIC || outcomes_[idx].next == CubeAIConsts::INVALID_SIZE_TYPE){
+        return outcomes_[idx];
+    }
+
+    std::uniform_int_distribution<uint_t> count_dist(1, entry.total_count);
+    auto target = count_dist(engine);
+
+    while(outcomes_[idx].next != CubeAIConsts::INVALID_SIZE_TYPE && target > outcomes_[idx].count){
+        target -= outcomes_[idx].count;
+        idx = outcomes_[idx].next;
+    }
+
+    return outcomes_[idx];
+}
+
+}
+}
+}
+}
+
+#endif // TABULAR_TRANSITION_MODEL_H
@@ -82,17 +82,82 @@ real_t calculate_discounted_return(const std::vector<TimeStepType>& rewards, rea
 
 }
 
-#ifdef USE_PYTORCH
 ///
-/// \brief calculate_discounted_returns
-/// \param reward
-/// \param discounts
-/// \param n_workers
-/// \return
+/// \brief generalized_advantage_estimate. Computes the GAE(lambda) advantages
+/// and the corresponding returns of a rollout of n_steps over n_envs parallel
+/// environments in a single backward pass. All arrays are laid out as
+/// [step * n_envs + env]. dones[t] is non zero if the episode of the environment
+/// ended at step t, in which case the bootstrap from step t + 1 is cut.
+/// last_values holds V(s_T) for every environment. With lambda = 1 the returns
+/// are the n-step bootstrapped returns
+///
+template<typename T>
+void
+generalized_advantage_estimate(const T* rewards, const T* values, const T* dones,
+                               const T* last_values, uint_t n_steps, uint_t n_envs,
+                               real_t gamma, real_t lambda, T* advantages, T* returns){
+
+    for(uint_t e=0; e<n_envs; ++e){
+
+        T gae = 0;
+        T next_value = last_values[e];
+
+        for(uint_t t=n_steps; t-- > 0;){
+
+            const auto idx = t * n_envs + e;
+            const T not_done = dones[idx] != T(0) ? T(0) : T(1);
+            const T delta = rewards[idx] + static_cast<T>(gamma) * next_value * not_done - values[idx];
+
+            gae = delta + static_cast<T>(gamma * lambda) * not_done * gae;
+            advantages[idx] = gae;
+            returns[idx] = gae + values[idx];
+            next_value = values[idx];
+        }
+    }
+}
+
+///
+/// \brief monte_carlo_returns. Computes the discounted returns to go of a
+/// rollout of n_steps over n_envs parallel environments in one reverse scan.
+/// The arrays are laid out as [step * n_envs + env] and dones[t] is non zero
+/// if the episode ended at step t. The steps that belong to an episode that
+/// did not finish within the rollout have no return; their mask entry is set
+/// to zero unless truncate is true, in which case the rollout end is treated
+/// as the episode end. If active is given the steps where it is zero are
+/// masked as well; their rewards still enter the returns of the earlier
+/// steps of the same episode. Returns the number of steps with a return
 ///
-std::vector<real_t>
-calculate_discounted_returns(torch_tensor_t reward, torch_tensor_t discounts, uint_t n_workers);
-#endif
+template<typename T>
+uint_t
+monte_carlo_returns(const T* rewards, const T* dones, uint_t n_steps, uint_t n_envs,
+                    real_t gamma, bool truncate, T* returns, T* mask, const T* active=nullptr){
+
+    uint_t n_valid = 0;
+    for(uint_t e=0; e<n_envs; ++e){
+
+        T ret = 0;
+        bool finished = truncate;
+
+        for(uint_t t=n_steps; t-- > 0;){
+
+            const auto idx = t * n_envs + e;
+            if(dones[idx] != T(0)){
+                ret = 0;
+                finished = true;
+            }
+
+            ret = rewards[idx] + static_cast<T>(gamma) * ret;
+
+            const auto valid = finished && (active == nullptr || active[idx] != T(0));
+            returns[idx] = valid ? ret : T(0);
+            mask[idx] = valid ? T(1) : T(0);
+            n_valid += valid ? 1 : 0;
+        }
+    }
+
+    return n_valid;
+}
+
 }
 }
 }
@@ -4,16 +4,16 @@
 #include "cubeai/base/cubeai_types.h"
 #include "cubeai/base/cubeai_consts.h"
 #include <chrono>
-#include <string>
-#include <map>
-#include <any>
 #include <ostream>
 
 namespace cubeai {
 namespace rl {
 
 ///
-/// \brief The EpisodeInfo struct
+/// \brief The EpisodeInfo struct. Plain summary of a training
+/// episode. Algorithms that need to carry extra data from
+/// on_training_episode to actions_after_episode_ends keep it
+/// in a typed member of their own
 ///
 struct EpisodeInfo
 {
@@ -32,11 +32,6 @@ struct EpisodeInfo
     ///
     std::chrono::duration<real_t> total_time;
 
-    ///
-    /// \brief info
-    ///
-    std::map<std::string, std::any> info;
-
     ///
     /// \brief print
     /// \param out
@@ -0,0 +1,216 @@
+#ifndef EPISODE_LOG_SINK_H
+#define EPISODE_LOG_SINK_H
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/episode_info.h"
+
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cubeai {
+namespace rl {
+
+///
+/// \brief The LogOverflowPolicy enum. What push does when the ring is
+/// full. BLOCK waits for the writer to make room, DROP discards the
+/// record and counts it
+///
+enum class LogOverflowPolicy{BLOCK, DROP};
+
+///
+/// \brief The AsyncEpisodeLogSink class. Moves the formatting and the
+/// writing of the episode messages off the training thread. The trainer
+/// copies the EpisodeInfo into a single-producer/single-consumer ring
+/// buffer. A background thread wakes up every flush_interval, or as soon as
+/// the ring is half full, prints all the pending episodes with
+/// EpisodeInfo::print and flushes the stream once per batch. Pushing never allocates and takes the mutex only
+/// when it fills half the ring. When the ring is full the overflow policy
+/// decides whether push waits or drops the record. Dropped records are
+/// reported on the stream when the sink stops
+///
+class AsyncEpisodeLogSink: private boost::noncopyable
+{
+public:
+
+    ///
+    /// \brief Constructor. The capacity is rounded up to a power of two
+    ///
+    explicit AsyncEpisodeLogSink(std::ostream& out, uint_t capacity=1024,
+                                 std::chrono::milliseconds flush_interval=std::chrono::milliseconds(100),
+                                 LogOverflowPolicy overflow=LogOverflowPolicy::BLOCK);
+
+    ///
+    /// \brief Destructor. Stops the writer thread and drains the ring
+    ///
+    ~AsyncEpisodeLogSink();
+
+    ///
+    /// \brief start. Start the writer thread. Does nothing if already running
+    ///
+    void start();
+
+    ///
+    /// \brief stop. Stop the writer thread after it has written every
+    /// pending record. The records dropped since the last stop are
+    /// reported on the stream
+    ///
+    void stop();
+
+    ///
+    /// \brief is_running
+    ///
+    bool is_running()const noexcept{return writer_thread_.joinable();}
+
+    ///
+    /// \brief push. Copy the episode info into the ring. Returns false
+    /// if the ring was full and the info was dropped. With
+    /// LogOverflowPolicy::BLOCK a full ring is drained by the writer thread,
+    /// or on the calling thread if the writer is not running, so push always
+    /// succeeds. Should only be called from one thread
+    ///
+    bool push(const EpisodeInfo& info)noexcept;
+
+    ///
+    /// \brief capacity
+    ///
+    uint_t capacity()const noexcept{return ring_.size();}
+
+    ///
+    /// \brief overflow_policy
+    ///
+    LogOverflowPolicy overflow_policy()const noexcept{return overflow_;}
+
+    ///
+    /// \brief n_dropped. Number of records dropped because the ring was full
+    ///
+    uint_t n_dropped()const noexcept{return n_dropped_.load(std::memory_order_relaxed);}
+
+    ///
+    /// \brief n_written. Number of records written to the stream
+    ///
+    uint_t n_written()const noexcept{return n_written_.load(std::memory_order_relaxed);}
+
+private:
+
+    ///
+    /// \brief out_ The stream to write to
+    ///
+    std::ostream& out_;
+
+    ///
+    /// \brief flush_interval_
+    ///
+    std::chrono::milliseconds flush_interval_;
+
+    ///
+    /// \brief overflow_
+    ///
+    LogOverflowPolicy overflow_;
+
+    ///
+    /// \brief ring_ The storage of the ring buffer
+    ///
+    std::vector<EpisodeInfo> ring_;
+
+    ///
+    /// \brief mask_. capacity - 1
+    ///
+    uint_t mask_;
+
+    ///
+    /// \brief head_. Next slot to write. Only the producer modifies it.
+    /// Kept on its own cache line so that producer and consumer do not
+    /// share a line
+    ///
+    alignas(64) std::atomic<uint_t> head_;
+
+    ///
+    /// \brief tail_. Next slot to read. Only the consumer modifies it
+    ///
+    alignas(64) std::atomic<uint_t> tail_;
+
+    std::atomic<uint_t> n_dropped_;
+    std::atomic<uint_t> n_written_;
+
+    ///
+    /// \brief n_reported_dropped_. Dropped records already reported
+    ///
+    uint_t n_reported_dropped_;
+
+    ///
+    /// \brief Synchronization with the writer thread. push takes
+    /// the mutex only to wake the writer or to wait for room
+    ///
+    std::mutex mutex_;
+    std::condition_variable writer_cv_;
+    std::condition_variable room_cv_;
+    std::thread writer_thread_;
+    bool stop_writer_;
+    bool wake_writer_;
+
+    ///
+    /// \brief request_drain_. Ask the writer to drain the ring now
+    ///
+    void request_drain_();
+
+    ///
+    /// \brief wait_for_room_. Block until the ring has a free slot
+    ///
+    void wait_for_room_(uint_t head)noexcept;
+
+    ///
+    /// \brief writer_loop_. The body of the writer thread
+    ///
+    void writer_loop_();
+
+    ///
+    /// \brief drain_. Write all pending records and flush once
+    ///
+    void drain_();
+};
+
+inline
+bool
+AsyncEpisodeLogSink::push(const EpisodeInfo& info)noexcept{
+
+    // the slot is filled with a plain copy, nothing
+    // is formatted or allocated on the training thread
+    static_assert(std::is_trivially_copyable_v<EpisodeInfo>);
+
+    const auto head = head_.load(std::memory_order_relaxed);
+    auto tail = tail_.load(std::memory_order_acquire);
+
+    if(head - tail >= ring_.size()){
+
+        if(overflow_ == LogOverflowPolicy::DROP){
+            n_dropped_.store(n_dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        wait_for_room_(head);
+        tail = tail_.load(std::memory_order_acquire);
+    }
+
+    ring_[head & mask_] = info;
+    head_.store(head + 1, std::memory_order_release);
+
+    // the pending count grows by one per push so it hits half
+    // the capacity exactly once every time it fills up
+    if(head + 1 - tail == ring_.size() / 2){
+        request_drain_();
+    }
+
+    return true;
+}
+
+}
+}
+
+#endif // EPISODE_LOG_SINK_H
@@ -7,6 +7,7 @@
 
 #include <random>
 #include <cmath>
+#include <string>
 
 namespace cubeai {
 namespace rl {
@@ -85,6 +86,18 @@ public:
      * */
     EpsilonDecayOption decay_option()const noexcept{return decay_op_;}
 
+    /**
+     * @brief Add the current epsilon and the state of the
+     * random engines to the checkpoint. The names of the
+     * entries start with prefix
+     * */
+    void save_checkpoint(io::Checkpoint& checkpoint, const std::string& prefix)const;
+
+    /**
+     * @brief Restore what save_checkpoint added
+     * */
+    void load_checkpoint(const io::MappedCheckpoint& checkpoint, const std::string& prefix);
+
 
 private:
 
@@ -8,8 +8,16 @@
 #include "cubeai/base/cubeai_consts.h"
 
 #include <random>
+#include <string>
 
 namespace cubeai {
+
+namespace io{
+// forward declare
+class Checkpoint;
+class MappedCheckpoint;
+}
+
 namespace rl {
 namespace policies {
 
@@ -57,6 +65,16 @@ public:
      * */
     void reset()noexcept{}
 
+    /**
+     * @brief Add the state of the random engine to the checkpoint
+     */
+    void save_checkpoint(io::Checkpoint& checkpoint, const std::string& prefix)const;
+
+    /**
+     * @brief Restore the state of the random engine from the checkpoint
+     */
+    void load_checkpoint(const io::MappedCheckpoint& checkpoint, const std::string& prefix);
+
 private:
 
     /**
@@ -0,0 +1,287 @@
+#ifndef POLICY_SERVER_H
+#define POLICY_SERVER_H
+
+/**
+  * Utilities to deploy a trained policy without the training stack.
+  * export_policy writes the parameters of a policy module to a file and
+  * PolicyServer reloads them and serves actions with torch::InferenceMode
+  * and tensors allocated once. PolicyServer also serves TorchScript modules,
+  * e.g. policies scripted or traced from Python, loaded with torch::jit::load
+  *
+  */
+
+#include "cubeai/base/cubeai_config.h"
+
+#ifdef USE_PYTORCH
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/worlds/observation_utils.h"
+#include "cubeai/maths/statistics/distributions/torch_categorical.h"
+#include "cubeai/utils/torch_adaptor.h"
+
+#include <torch/torch.h>
+#include <torch/script.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace cubeai {
+namespace rl {
+
+///
+/// \brief export_policy. Save the parameters and the buffers of the
+/// policy module so that a PolicyServer over the same module type can
+/// reload them
+///
+template<typename ModuleType>
+void
+export_policy(ModuleType& policy, const std::string& filename){
+
+    torch::serialize::OutputArchive archive;
+    policy -> save(archive);
+    archive.save_to(filename);
+}
+
+///
+/// \brief The PolicyServerConfig struct. Configuration for the PolicyServer
+///
+struct PolicyServerConfig
+{
+    ///
+    /// \brief observation_size. Number of scalars of one observation
+    ///
+    uint_t observation_size{0};
+
+    ///
+    /// \brief max_batch_size. Largest number of observations
+    /// served in one call of act_batch
+    ///
+    uint_t max_batch_size{1};
+
+    ///
+    /// \brief greedy. Serve the most probable action. Otherwise
+    /// the action is sampled from the policy output
+    ///
+    bool greedy{true};
+
+    ///
+    /// \brief outputs_logits. Whether the policy outputs logits or
+    /// probabilities. Only matters when greedy is false
+    ///
+    bool outputs_logits{false};
+
+    ///
+    /// \brief device. Where the policy runs
+    ///
+    std::string device{"cpu"};
+};
+
+/**
+ * @brief The PolicyServer class. Serves the actions of a policy that maps
+ * a [batch, observation_size] tensor to [batch, n_actions] probabilities or
+ * logits. ModuleType is either a torch::nn::ModuleHolder, whose parameters are
+ * loaded from a file written by export_policy, or torch::jit::script::Module
+ * loaded from a TorchScript file. Every forward runs under torch::InferenceMode
+ * on a staging tensor allocated once and the greedy actions are written into a
+ * preallocated output tensor, so serving an action allocates only what the
+ * module itself allocates
+ */
+template<typename ModuleType>
+class PolicyServer
+{
+public:
+
+    typedef ModuleType module_type;
+    typedef uint_t action_type;
+
+    ///
+    /// \brief Constructor. For a ModuleHolder the server keeps a copy
+    /// of the holder, i.e. it shares the module with the caller
+    ///
+    PolicyServer(const PolicyServerConfig& config, module_type policy);
+
+    ///
+    /// \brief Constructor. Only for TorchScript modules. Load the module from the file
+    ///
+    PolicyServer(const PolicyServerConfig& config, const std::string& filename);
+
+    ///
+    /// \brief load. Load the parameters written by export_policy
+    ///
+    void load(const std::string& filename);
+
+    ///
+    /// \brief act. The action for a single observation
+    ///
+    template<typename ObsType>
+    action_type act(const ObsType& observation);
+
+    ///
+    /// \brief act_batch. The actions for n observations laid out
+    /// contiguously in observations. n should not exceed max_batch_size
+    ///
+    void act_batch(const float* observations, uint_t n, action_type* actions);
+
+    ///
+    /// \brief policy
+    ///
+    module_type& policy()noexcept{return policy_;}
+
+private:
+
+    static constexpr bool is_script_module = std::is_same_v<module_type, torch::jit::script::Module>;
+
+    PolicyServerConfig config_;
+    module_type policy_;
+    torch::Device device_;
+
+    ///
+    /// \brief input_. Staging tensor [max_batch_size, observation_size]
+    ///
+    torch_utils::TorchStagingTensor input_;
+
+    ///
+    /// \brief output_. The actions [max_batch_size]
+    ///
+    torch_tensor_t output_;
+
+    ///
+    /// \brief allocate_
+    ///
+    void allocate_();
+
+    ///
+    /// \brief forward_. Compute the actions of the first n rows of the input
+    ///
+    torch_tensor_t forward_(uint_t n);
+};
+
+template<typename ModuleType>
+PolicyServer<ModuleType>::PolicyServer(const PolicyServerConfig& config, module_type policy)
+    :
+      config_(config),
+      policy_(std::move(policy)),
+      device_(config.device),
+      input_(),
+      output_()
+{
+    allocate_();
+}
+
+template<typename ModuleType>
+PolicyServer<ModuleType>::PolicyServer(const PolicyServerConfig& config, const std::string& filename)
+    :
+      config_(config),
+      policy_(),
+      device_(config.device),
+      input_(),
+      output_()
+{
+    static_assert(is_script_module, "Only TorchScript modules can be constructed from a file");
+
+    policy_ = torch::jit::load(filename, device_);
+    allocate_();
+}
+
+template<typename ModuleType>
+void
+PolicyServer<ModuleType>::allocate_(){
+
+    if(config_.observation_size == 0 || config_.max_batch_size == 0){
+        throw std::logic_error("PolicyServer needs a positive observation_size and max_batch_size");
+    }
+
+    if constexpr(is_script_module){
+        policy_.to(device_);
+        policy_.eval();
+    }
+    else{
+        policy_ -> to(device_);
+        policy_ -> eval();
+    }
+
+    input_.allocate({static_cast<int64_t>(config_.max_batch_size),
+                     static_cast<int64_t>(config_.observation_size)}, device_);
+    output_ = torch::zeros({static_cast<int64_t>(config_.max_batch_size)},
+                           torch::TensorOptions().dtype(torch::kInt64).device(device_));
+}
+
+template<typename ModuleType>
+void
+PolicyServer<ModuleType>::load(const std::string& filename){
+
+    if constexpr(is_script_module){
+        policy_ = torch::jit::load(filename, device_);
+        policy_.eval();
+    }
+    else{
+        torch::serialize::InputArchive archive;
+        archive.load_from(filename, device_);
+        policy_ -> load(archive);
+        policy_ -> eval();
+    }
+}
+
+template<typename ModuleType>
+template<typename ObsType>
+typename PolicyServer<ModuleType>::action_type
+PolicyServer<ModuleType>::act(const ObsType& observation){
+
+    envs::copy_observation(observation, input_.tensor().template data_ptr<float>());
+    return torch_utils::TorchAdaptor::to_scalar<action_type>(forward_(1));
+}
+
+template<typename ModuleType>
+void
+PolicyServer<ModuleType>::act_batch(const float* observations, uint_t n, action_type* actions){
+
+    if(n > config_.max_batch_size){
+        throw std::logic_error("PolicyServer::act_batch called with more observations than max_batch_size");
+    }
+
+    std::copy(observations, observations + n * config_.observation_size,
+              input_.tensor().template data_ptr<float>());
+
+    auto result = forward_(n).cpu();
+    const auto* data = result.template data_ptr<int64_t>();
+    for(uint_t i=0; i<n; ++i){
+        actions[i] = static_cast<action_type>(data[i]);
+    }
+}
+
+template<typename ModuleType>
+torch_tensor_t
+PolicyServer<ModuleType>::forward_(uint_t n){
+
+    c10::InferenceMode guard;
+
+    const auto rows = static_cast<int64_t>(n);
+    auto input = input_.to_device().narrow(0, 0, rows);
+
+    torch_tensor_t output;
+    if constexpr(is_script_module){
+        output = policy_.forward({input}).toTensor();
+    }
+    else{
+        output = policy_ -> forward(input);
+    }
+
+    auto actions = output_.narrow(0, 0, rows);
+    if(config_.greedy){
+        torch::argmax_out(actions, output, 1);
+    }
+    else{
+        actions.copy_(maths::stats::TorchCategorical(output, config_.outputs_logits).sample());
+    }
+
+    return actions;
+}
+
+}
+}
+
+#endif
+#endif // POLICY_SERVER_H
@@ -177,24 +177,28 @@ struct with_double_q_table_mixin< DynMat<real_t> >
 };
 
 template<>
+inline
 with_double_q_table_mixin< DynMat<real_t>>::value_type
 with_double_q_table_mixin< DynMat<real_t>>::get<1>(const state_type& state, const action_type action)const{
     return q_table_1(state, action);
 }
 
 template<>
+inline
 with_double_q_table_mixin< DynMat<real_t>>::value_type
 with_double_q_table_mixin< DynMat<real_t>>::get<2>(const state_type& state, const action_type action)const{
     return q_table_2(state, action);
 }
 
 template<>
+inline
 void
 with_double_q_table_mixin< DynMat<real_t>>::set<1>(const state_type& state, const action_type action, const value_type value){
     q_table_1(state, action) = value;
 }
 
 template<>
+inline
 void
 with_double_q_table_mixin< DynMat<real_t>>::set<2>(const state_type& state, const action_type action, const value_type value){
     q_table_2(state, action) = value;
@@ -3,6 +3,7 @@
 
 #include "cubeai/base/cubeai_consts.h"
 #include "cubeai/base/iterative_algorithm_controller.h"
+#include "cubeai/rl/episode_log_sink.h"
 
 #include <boost/noncopyable.hpp>
 
@@ -116,6 +117,12 @@ protected:
     ///
     ///
     uint_t output_msg_frequency_{CubeAIConsts::INVALID_SIZE_TYPE};
+
+    ///
+    /// \brief log_sink_ Writes the episode messages to std::cout
+    /// off the training thread
+    ///
+    AsyncEpisodeLogSink log_sink_;
 };
 
 template<typename EnvType, typename AgentType>
@@ -124,7 +131,8 @@ IterativeRLTrainerBase<EnvType, AgentType>::IterativeRLTrainerBase(uint_t max_ep
     :
       itr_ctrl_(max_episodes, tolerance),
       agent_(agent),
-      output_msg_frequency_(out_msg_frequency)
+      output_msg_frequency_(out_msg_frequency),
+      log_sink_(std::cout)
 {}
 
 template<typename EnvType, typename AgentType>
@@ -136,16 +144,20 @@ IterativeRLTrainerBase<EnvType, AgentType>::train(env_type& env){
 
     this->actions_before_training_begins(env);
 
+    const auto log_episodes = output_msg_frequency_ != CubeAIConsts::INVALID_SIZE_TYPE;
+    if(log_episodes){
+        log_sink_.start();
+    }
+
+    auto stopped = false;
     uint_t episode_counter = 0;
     while(itr_ctrl_.continue_iterations()){
 
         this->actions_before_episode_begins(env, episode_counter);
         auto episode_info = agent_.on_training_episode(env, episode_counter);
 
-        if(output_msg_frequency_ != CubeAIConsts::INVALID_SIZE_TYPE &&
-                episode_counter % output_msg_frequency_  == 0){
-
-            std::cout<<episode_info<<std::endl;
+        if(log_episodes && episode_counter % output_msg_frequency_  == 0){
+            log_sink_.push(episode_info);
         }
 
         total_reward_per_episode_.push_back(episode_info.episode_reward);
@@ -153,12 +165,18 @@ IterativeRLTrainerBase<EnvType, AgentType>::train(env_type& env){
         this->actions_after_episode_ends(env, episode_counter, episode_info);
 
         if(episode_info.stop_training){
-            std::cout<<CubeAIConsts::info_str()<<" Stopping training at index="<<episode_counter<<std::endl;
+            stopped = true;
             break;
         }
         episode_counter += 1;
     }
 
+    log_sink_.stop();
+
+    if(stopped){
+        std::cout<<CubeAIConsts::info_str()<<" Stopping training at index="<<episode_counter<<std::endl;
+    }
+
     this->actions_after_training_ends(env);
     auto end = std::chrono::steady_clock::now();
     std::chrono::duration<real_t> elapsed_seconds = end-start;
@@ -5,11 +5,17 @@
 #include "cubeai/base/cubeai_consts.h"
 #include "cubeai/base/iterative_algorithm_result.h"
 #include "cubeai/base/iterative_algorithm_controller.h"
+#include "cubeai/utils/instrumentation.h"
+#include "cubeai/rl/episode_log_sink.h"
+#include "cubeai/io/binary_checkpoint.h"
 
 #include <boost/noncopyable.hpp>
 #include <vector>
 #include <chrono>
 #include <iostream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
 
 namespace cubeai {
 namespace rl {
@@ -26,6 +32,44 @@ struct RLSerialTrainerConfig
     uint_t output_msg_frequency{CubeAIConsts::INVALID_SIZE_TYPE};
     uint_t n_episodes{0};
     real_t tolerance{CubeAIConsts::tolerance()};
+
+    ///
+    /// \brief output_stream. Where the episode messages are written.
+    /// Writing happens on a background thread
+    ///
+    std::ostream* output_stream{&std::cout};
+
+    ///
+    /// \brief log_buffer_capacity. Number of episode messages that
+    /// can be pending before the overflow policy applies
+    ///
+    uint_t log_buffer_capacity{1024};
+
+    ///
+    /// \brief log_overflow. Whether the training thread waits for the
+    /// writer or drops the message when the pending messages fill the buffer
+    ///
+    LogOverflowPolicy log_overflow{LogOverflowPolicy::BLOCK};
+
+    ///
+    /// \brief log_flush_interval. How often the pending
+    /// episode messages are written
+    ///
+    std::chrono::milliseconds log_flush_interval{100};
+
+    ///
+    /// \brief checkpoint_frequency. Take a checkpoint of the agent every
+    /// that many episodes. Zero disables checkpointing. Only agents with a
+    /// save_checkpoint(io::Checkpoint&) member are checkpointed
+    ///
+    uint_t checkpoint_frequency{0};
+
+    ///
+    /// \brief checkpoint_path. The file the checkpoints are written to.
+    /// Every checkpoint replaces the previous one. Training stops with
+    /// an exception if a checkpoint cannot be written
+    ///
+    std::string checkpoint_path{""};
 };
 
 
@@ -54,6 +98,14 @@ public:
     ///
     virtual IterativeAlgorithmResult train(env_type& env);
 
+    ///
+    /// \brief resume. Restore the agent and the episode index from a
+    /// checkpoint taken by the trainer. The next train() continues with the
+    /// episode after the checkpointed one, so the schedules that depend on
+    /// the episode index carry on, and stops after n_episodes in total
+    ///
+    void resume(const std::string& filename);
+
     ///
     /// \brief actions_before_training_begins.  Execute any actions
     /// the algorithm needs before starting the episode
@@ -90,6 +142,22 @@ public:
     ///
     const std::vector<uint_t>& n_itrs_per_episode()const{return n_itrs_per_episode_;}
 
+    ///
+    /// \brief instrumentation. Per episode phase timers and counters.
+    /// Records are only collected when utils::Instrumentation is enabled
+    ///
+    const utils::EpisodeInstrumentationRecorder& instrumentation()const noexcept{return instrumentation_;}
+
+    ///
+    /// \brief log_sink. The sink the episode messages are pushed to
+    ///
+    const AsyncEpisodeLogSink& log_sink()const noexcept{return log_sink_;}
+
+    ///
+    /// \brief checkpoint_writer. The writer of the checkpoints
+    ///
+    const io::AsyncCheckpointWriter& checkpoint_writer()const noexcept{return checkpoint_writer_;}
+
 protected:
 
     ///
@@ -97,6 +165,17 @@ protected:
     ///
     uint_t output_msg_frequency_;
 
+    ///
+    /// \brief n_episodes_. The total number of training episodes
+    ///
+    uint_t n_episodes_;
+
+    ///
+    /// \brief start_episode_. The index of the first episode
+    /// of the next train(). Set by resume
+    ///
+    uint_t start_episode_;
+
     ///
     /// \brief itr_ctrl_ Handles the iteration over the
     /// episodes
@@ -119,16 +198,64 @@ protected:
     ///
     std::vector<uint_t> n_itrs_per_episode_;
 
+    ///
+    /// \brief instrumentation_ The per episode instrumentation records
+    ///
+    utils::EpisodeInstrumentationRecorder instrumentation_;
+
+    ///
+    /// \brief log_sink_ Formats and writes the episode
+    /// messages off the training thread
+    ///
+    AsyncEpisodeLogSink log_sink_;
+
+    ///
+    /// \brief checkpoint_frequency_
+    ///
+    uint_t checkpoint_frequency_;
+
+    ///
+    /// \brief checkpoint_path_
+    ///
+    std::string checkpoint_path_;
+
+    ///
+    /// \brief checkpoint_. The snapshot the agent state is copied into.
+    /// It is swapped with the buffer of the writer so its memory is reused
+    ///
+    io::Checkpoint checkpoint_;
+
+    ///
+    /// \brief checkpoint_writer_ Writes the checkpoints
+    /// off the training thread
+    ///
+    io::AsyncCheckpointWriter checkpoint_writer_;
+
+    ///
+    /// \brief take_checkpoint_. Snapshot the agent and hand
+    /// the snapshot to the writer
+    ///
+    void take_checkpoint_(uint_t episode_idx);
+
 };
 
 template<typename EnvType, typename AgentType>
 RLSerialAgentTrainer<EnvType, AgentType>::RLSerialAgentTrainer(const RLSerialTrainerConfig& config, agent_type& agent)
     :
     output_msg_frequency_(config.output_msg_frequency),
+    n_episodes_(config.n_episodes),
+    start_episode_(0),
     itr_ctrl_(config.n_episodes, config.tolerance),
     agent_(agent),
     total_reward_per_episode_(),
-    n_itrs_per_episode_()
+    n_itrs_per_episode_(),
+    instrumentation_(),
+    log_sink_(*config.output_stream, config.log_buffer_capacity,
+              config.log_flush_interval, config.log_overflow),
+    checkpoint_frequency_(config.checkpoint_frequency),
+    checkpoint_path_(config.checkpoint_path),
+    checkpoint_(),
+    checkpoint_writer_()
 {}
 
 template<typename EnvType, typename AgentType>
@@ -141,6 +268,10 @@ RLSerialAgentTrainer<EnvType, AgentType>::actions_before_training_begins(env_typ
 
     total_reward_per_episode_.reserve(itr_ctrl_.get_max_iterations());
     n_itrs_per_episode_.reserve(itr_ctrl_.get_max_iterations());
+
+    if(utils::Instrumentation::is_enabled()){
+        instrumentation_.start();
+    }
 }
 
 template<typename EnvType, typename AgentType>
@@ -161,6 +292,43 @@ RLSerialAgentTrainer<EnvType, AgentType>::actions_after_training_ends(env_type&
     agent_.actions_after_training_ends(env);
 }
 
+template<typename EnvType, typename AgentType>
+void
+RLSerialAgentTrainer<EnvType, AgentType>::take_checkpoint_(uint_t episode_idx){
+
+    if constexpr(requires(const agent_type& a, io::Checkpoint& c){ a.save_checkpoint(c); }){
+
+        // a write that failed since the last checkpoint
+        // stops the training before more work is lost
+        const auto error = checkpoint_writer_.last_error();
+        if(!error.empty()){
+            throw std::runtime_error("Checkpoint could not be written: " + error);
+        }
+
+        // the copy of the state is all the training
+        // thread pays, the file is written by the writer
+        checkpoint_.clear();
+        agent_.save_checkpoint(checkpoint_);
+        checkpoint_.add_scalar("trainer.episode_index", episode_idx);
+        checkpoint_writer_.submit(checkpoint_, checkpoint_path_);
+    }
+}
+
+template<typename EnvType, typename AgentType>
+void
+RLSerialAgentTrainer<EnvType, AgentType>::resume(const std::string& filename){
+
+    if constexpr(requires(agent_type& a, const io::MappedCheckpoint& c){ a.load_checkpoint(c); }){
+
+        io::MappedCheckpoint checkpoint(filename);
+        agent_.load_checkpoint(checkpoint);
+        start_episode_ = checkpoint.scalar<uint_t>("trainer.episode_index") + 1;
+    }
+    else{
+        throw std::logic_error("The agent does not support loading checkpoints");
+    }
+}
+
 template<typename EnvType, typename AgentType>
 IterativeAlgorithmResult
 RLSerialAgentTrainer<EnvType, AgentType>::train(env_type& env){
@@ -168,31 +336,70 @@ RLSerialAgentTrainer<EnvType, AgentType>::train(env_type& env){
     // start timing the training
     auto start = std::chrono::steady_clock::now();
 
+    // a resumed run only plays the remaining episodes
+    const auto first_episode = start_episode_;
+    start_episode_ = 0;
+    itr_ctrl_.set_max_itrs(n_episodes_ > first_episode ? n_episodes_ - first_episode : 0);
+
     this->actions_before_training_begins(env);
 
-    uint_t episode_counter = 0;
+    const auto log_episodes = output_msg_frequency_ != CubeAIConsts::INVALID_SIZE_TYPE;
+    if(log_episodes){
+        log_sink_.start();
+    }
+
+    const auto checkpoint_episodes = checkpoint_frequency_ != 0 && !checkpoint_path_.empty();
+
+    auto stopped = false;
+    uint_t episode_counter = first_episode;
     while(itr_ctrl_.continue_iterations()){
 
         this->actions_before_episode_begins(env, episode_counter);
         auto episode_info = agent_.on_training_episode(env, episode_counter);
 
-        if(output_msg_frequency_ != CubeAIConsts::INVALID_SIZE_TYPE &&
-                episode_counter % output_msg_frequency_  == 0){
+        if(log_episodes && episode_counter % output_msg_frequency_  == 0){
 
-            std::cout<<episode_info<<std::endl;
+            utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::LOGGING);
+            log_sink_.push(episode_info);
+        }
+
+        if(utils::Instrumentation::is_enabled()){
+            instrumentation_.on_episode_end(episode_counter, episode_info.total_time.count());
         }
 
         total_reward_per_episode_.push_back(episode_info.episode_reward);
         n_itrs_per_episode_.push_back(episode_info.episode_iterations);
         this->actions_after_episode_ends(env, episode_counter, episode_info);
 
+        if(checkpoint_episodes && (episode_counter + 1) % checkpoint_frequency_ == 0){
+
+            utils::ScopedPhaseTimer timer(utils::InstrumentationPhase::CHECKPOINT);
+            take_checkpoint_(episode_counter);
+        }
+
         if(episode_info.stop_training){
-            std::cout<<CubeAIConsts::info_str()<<" Stopping training at index="<<episode_counter<<std::endl;
+            stopped = true;
             break;
         }
         episode_counter += 1;
     }
 
+    // write whatever is still pending before
+    // any other message goes to the stream
+    log_sink_.stop();
+
+    // the last checkpoint is on disk when train returns
+    checkpoint_writer_.wait();
+
+    const auto checkpoint_error = checkpoint_writer_.last_error();
+    if(!checkpoint_error.empty()){
+        throw std::runtime_error("Checkpoint could not be written: " + checkpoint_error);
+    }
+
+    if(stopped){
+        std::cout<<CubeAIConsts::info_str()<<" Stopping training at index="<<episode_counter<<std::endl;
+    }
+
     this->actions_after_training_ends(env);
     auto end = std::chrono::steady_clock::now();
     std::chrono::duration<real_t> elapsed_seconds = end-start;
@@ -0,0 +1,134 @@
+#ifndef GRID_WORLD_H
+#define GRID_WORLD_H
+
+#include "cubeai/base/cubeai_types.h"
+
+namespace cubeai {
+namespace rl {
+namespace envs {
+
+///
+/// \brief The GridWorldTimeStep class. The time step
+/// returned by GridWorld
+///
+class GridWorldTimeStep
+{
+public:
+
+    ///
+    /// \brief Constructor
+    ///
+    GridWorldTimeStep(uint_t obs, real_t reward, bool done)
+        :
+          obs_(obs),
+          reward_(reward),
+          done_(done)
+    {}
+
+    ///
+    /// \brief observation
+    ///
+    uint_t observation()const noexcept{return obs_;}
+
+    ///
+    /// \brief reward
+    ///
+    real_t reward()const noexcept{return reward_;}
+
+    ///
+    /// \brief done
+    ///
+    bool done()const noexcept{return done_;}
+
+private:
+
+    uint_t obs_;
+    real_t reward_;
+    bool done_;
+};
+
+///
+/// \brief The GridWorld class. In-process size x size gridworld
+/// used for testing and benchmarking the tabular algorithms without
+/// an environment server. The agent starts at the lower left corner
+/// and receives -1 per step until it reaches the upper right corner.
+/// Actions are 0=up, 1=down, 2=left, 3=right
+///
+class GridWorld
+{
+public:
+
+    typedef uint_t state_type;
+    typedef uint_t action_type;
+    typedef GridWorldTimeStep time_step_type;
+
+    ///
+    /// \brief Constructor
+    ///
+    explicit GridWorld(uint_t size)
+        :
+          size_(size),
+          current_(0),
+          n_steps_(0)
+    {}
+
+    ///
+    /// \brief n_states
+    ///
+    uint_t n_states()const noexcept{return size_ * size_;}
+
+    ///
+    /// \brief n_actions
+    ///
+    uint_t n_actions()const noexcept{return 4;}
+
+    ///
+    /// \brief n_steps. Total number of steps performed
+    /// since construction
+    ///
+    uint_t n_steps()const noexcept{return n_steps_;}
+
+    ///
+    /// \brief reset
+    ///
+    time_step_type reset()noexcept{
+        current_ = 0;
+        return time_step_type(current_, 0.0, false);
+    }
+
+    ///
+    /// \brief step
+    ///
+    time_step_type step(action_type action)noexcept;
+
+private:
+
+    uint_t size_;
+    uint_t current_;
+    uint_t n_steps_;
+};
+
+inline
+GridWorld::time_step_type
+GridWorld::step(action_type action)noexcept{
+
+    auto x = current_ % size_;
+    auto y = current_ / size_;
+
+    switch(action){
+        case 0: y = y + 1 < size_ ? y + 1 : y; break;
+        case 1: y = y > 0 ? y - 1 : y; break;
+        case 2: x = x > 0 ? x - 1 : x; break;
+        default: x = x + 1 < size_ ? x + 1 : x; break;
+    }
+
+    current_ = y * size_ + x;
+    n_steps_ += 1;
+    return time_step_type(current_, -1.0, current_ == n_states() - 1);
+}
+
+}
+}
+}
+
+#endif // GRID_WORLD_H
@@ -0,0 +1,50 @@
+#ifndef OBSERVATION_UTILS_H
+#define OBSERVATION_UTILS_H
+
+#include "cubeai/base/cubeai_types.h"
+
+#include <iterator>
+#include <type_traits>
+
+namespace cubeai {
+namespace rl {
+namespace envs {
+
+///
+/// \brief observation_size. Number of scalars in the observation.
+/// Observations can be scalars or containers of scalars
+///
+template<typename ObsType>
+uint_t
+observation_size(const ObsType& obs){
+
+    if constexpr(std::is_arithmetic_v<ObsType>){
+        return 1;
+    }
+    else{
+        return static_cast<uint_t>(std::size(obs));
+    }
+}
+
+///
+/// \brief copy_observation. Write the scalars of the observation into out
+///
+template<typename ObsType, typename T>
+void
+copy_observation(const ObsType& obs, T* out){
+
+    if constexpr(std::is_arithmetic_v<ObsType>){
+        *out = static_cast<T>(obs);
+    }
+    else{
+        for(const auto& val : obs){
+            *out++ = static_cast<T>(val);
+        }
+    }
+}
+
+}
+}
+}
+
+#endif // OBSERVATION_UTILS_H
@@ -0,0 +1,137 @@
+#ifndef SERIAL_VECTOR_ENV_H
+#define SERIAL_VECTOR_ENV_H
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/worlds/observation_utils.h"
+
+#include <boost/noncopyable.hpp>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace cubeai {
+namespace rl {
+namespace envs {
+
+///
+/// \brief The SerialVectorEnv class. Steps n copies of an environment
+/// one after the other and writes the observations, rewards and done
+/// flags straight into caller owned arrays laid out as [env * size + i].
+/// An environment whose episode ends is reset immediately and the
+/// observation written for it is the first of the new episode, so the
+/// caller sees an uninterrupted stream of transitions. Observations
+/// can be scalars or containers of scalars of fixed size
+///
+template<typename EnvType>
+class SerialVectorEnv: private boost::noncopyable
+{
+public:
+
+    typedef EnvType env_type;
+    typedef uint_t action_type;
+
+    ///
+    /// \brief Constructor. The factory is called n_copies times
+    /// and should return a std::unique_ptr<env_type> of an environment
+    /// ready to be reset
+    ///
+    template<typename FactoryType>
+    SerialVectorEnv(uint_t n_copies, FactoryType factory);
+
+    ///
+    /// \brief n_copies
+    ///
+    uint_t n_copies()const noexcept{return envs_.size();}
+
+    ///
+    /// \brief observation_size. Known after the first reset
+    ///
+    uint_t observation_size()const noexcept{return observation_size_;}
+
+    ///
+    /// \brief env. Access the i-th copy
+    ///
+    env_type& env(uint_t i){return *envs_[i];}
+
+    ///
+    /// \brief reset. Reset all the copies and write their observations
+    /// in observations which is resized to n_copies * observation_size
+    ///
+    template<typename T>
+    void reset(std::vector<T>& observations);
+
+    ///
+    /// \brief step. Step every copy with its action
+    ///
+    template<typename T>
+    void step(const action_type* actions, T* observations, T* rewards, T* dones);
+
+private:
+
+    std::vector<std::unique_ptr<env_type>> envs_;
+    uint_t observation_size_;
+};
+
+template<typename EnvType>
+template<typename FactoryType>
+SerialVectorEnv<EnvType>::SerialVectorEnv(uint_t n_copies, FactoryType factory)
+    :
+      envs_(),
+      observation_size_(0)
+{
+    if(n_copies == 0){
+        throw std::logic_error("SerialVectorEnv needs at least one environment copy");
+    }
+
+    envs_.reserve(n_copies);
+    for(uint_t i=0; i<n_copies; ++i){
+        envs_.push_back(factory());
+    }
+}
+
+template<typename EnvType>
+template<typename T>
+void
+SerialVectorEnv<EnvType>::reset(std::vector<T>& observations){
+
+    for(uint_t i=0; i<envs_.size(); ++i){
+
+        auto time_step = envs_[i]->reset();
+        const auto& obs = time_step.observation();
+
+        if(i == 0){
+            observation_size_ = envs::observation_size(obs);
+            observations.resize(envs_.size() * observation_size_);
+        }
+
+        copy_observation(obs, observations.data() + i * observation_size_);
+    }
+}
+
+template<typename EnvType>
+template<typename T>
+void
+SerialVectorEnv<EnvType>::step(const action_type* actions, T* observations, T* rewards, T* dones){
+
+    for(uint_t i=0; i<envs_.size(); ++i){
+
+        auto time_step = envs_[i]->step(actions[i]);
+
+        rewards[i] = static_cast<T>(time_step.reward());
+        dones[i] = time_step.done() ? T(1) : T(0);
+
+        if(time_step.done()){
+            auto reset_step = envs_[i]->reset();
+            copy_observation(reset_step.observation(), observations + i * observation_size_);
+        }
+        else{
+            copy_observation(time_step.observation(), observations + i * observation_size_);
+        }
+    }
+}
+
+}
+}
+}
+
+#endif // SERIAL_VECTOR_ENV_H
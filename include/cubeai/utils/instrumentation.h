@@ -0,0 +1,338 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_config.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cubeai {
+
+// forward declare
+namespace io{
+class TensorboardServer;
+}
+
+namespace utils {
+
+///
+/// \brief The InstrumentationPhase enum. The phases of a
+/// training loop that can be timed. LOSS covers forming the
+/// loss of a function approximator, UPDATE applying it and
+/// CHECKPOINT taking the snapshot of the agent
+///
+enum class InstrumentationPhase: uint_t {ENV_STEP=0, ACTION_SELECTION, LOSS, UPDATE, LOGGING, CHECKPOINT, N_PHASES};
+
+///
+/// \brief The InstrumentationCounter enum. The events
+/// that can be counted. ALLOCATIONS counts the calls of the
+/// global operator new and stays zero unless the executable
+/// links the cubeai_allocation_hook objects
+///
+enum class InstrumentationCounter: uint_t {STEPS=0, UPDATES, ALLOCATIONS, N_COUNTERS};
+
+///
+/// \brief Number of phases and counters
+///
+inline constexpr uint_t N_INSTRUMENTATION_PHASES = static_cast<uint_t>(InstrumentationPhase::N_PHASES);
+inline constexpr uint_t N_INSTRUMENTATION_COUNTERS = static_cast<uint_t>(InstrumentationCounter::N_COUNTERS);
+
+///
+/// \brief to_string. Returns the string representation of the phase
+///
+std::string to_string(InstrumentationPhase phase);
+
+///
+/// \brief to_string. Returns the string representation of the counter
+///
+std::string to_string(InstrumentationCounter counter);
+
+///
+/// \brief The InstrumentationSnapshot struct. The totals of
+/// all threads at the time the snapshot was taken
+///
+struct InstrumentationSnapshot
+{
+    std::array<std::uint64_t, N_INSTRUMENTATION_PHASES> phase_time_ns{};
+    std::array<std::uint64_t, N_INSTRUMENTATION_PHASES> phase_calls{};
+    std::array<std::uint64_t, N_INSTRUMENTATION_COUNTERS> counters{};
+
+    ///
+    /// \brief phase_time. Returns the time spent in the phase in seconds
+    ///
+    real_t phase_time(InstrumentationPhase phase)const noexcept{
+        return static_cast<real_t>(phase_time_ns[static_cast<uint_t>(phase)]) * 1.0e-9;
+    }
+
+    ///
+    /// \brief calls. Returns how many times the phase was timed
+    ///
+    uint_t calls(InstrumentationPhase phase)const noexcept{return phase_calls[static_cast<uint_t>(phase)];}
+
+    ///
+    /// \brief count. Returns the value of the counter
+    ///
+    uint_t count(InstrumentationCounter counter)const noexcept{return counters[static_cast<uint_t>(counter)];}
+
+    ///
+    /// \brief operator-. The difference between two snapshots
+    ///
+    InstrumentationSnapshot operator-(const InstrumentationSnapshot& other)const noexcept;
+};
+
+namespace detail{
+
+///
+/// \brief The instrumentation_block struct. Per thread storage.
+/// Only the owning thread writes into it, readers aggregate with
+/// relaxed loads, so no locks or read-modify-write operations are
+/// needed on the hot path
+///
+struct instrumentation_block
+{
+    std::array<std::atomic<std::uint64_t>, N_INSTRUMENTATION_PHASES> phase_time_ns{};
+    std::array<std::atomic<std::uint64_t>, N_INSTRUMENTATION_PHASES> phase_calls{};
+    std::array<std::atomic<std::uint64_t>, N_INSTRUMENTATION_COUNTERS> counters{};
+};
+
+///
+/// \brief local_instrumentation_block. Returns the block of the calling
+/// thread. The block is registered the first time a thread asks for it
+///
+instrumentation_block& local_instrumentation_block();
+
+///
+/// \brief single_writer_add. Add to a counter owned by the calling thread
+///
+inline
+void single_writer_add(std::atomic<std::uint64_t>& value, std::uint64_t n)noexcept{
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+}
+
+///
+/// \brief The Instrumentation class. Global switch and accumulation
+/// point for the phase timers and counters. Disabled by default.
+/// When disabled every call reduces to a relaxed load of a flag.
+/// When the library is configured without USE_INSTRUMENTATION the
+/// ScopedPhaseTimer compiles to nothing
+///
+class Instrumentation
+{
+public:
+
+    ///
+    /// \brief enable
+    ///
+    static void enable()noexcept{enabled_.store(true, std::memory_order_relaxed);}
+
+    ///
+    /// \brief disable
+    ///
+    static void disable()noexcept{enabled_.store(false, std::memory_order_relaxed);}
+
+    ///
+    /// \brief is_enabled
+    ///
+    static bool is_enabled()noexcept{return enabled_.load(std::memory_order_relaxed);}
+
+    ///
+    /// \brief add_phase_time. Add the given nanoseconds to the phase
+    ///
+    static void add_phase_time(InstrumentationPhase phase, std::uint64_t ns)noexcept;
+
+    ///
+    /// \brief increment. Increment the counter by n
+    ///
+    static void increment(InstrumentationCounter counter, uint_t n=1)noexcept;
+
+    ///
+    /// \brief snapshot. Aggregate the values of all threads
+    ///
+    static InstrumentationSnapshot snapshot();
+
+    ///
+    /// \brief reset. Zero the values of all threads. Should
+    /// not be called whilst other threads are recording
+    ///
+    static void reset();
+
+    ///
+    /// \brief Constructor
+    ///
+    Instrumentation()=delete;
+
+private:
+
+    ///
+    /// \brief enabled_
+    ///
+    static std::atomic<bool> enabled_;
+};
+
+inline
+void
+Instrumentation::add_phase_time(InstrumentationPhase phase, std::uint64_t ns)noexcept{
+
+    if(!is_enabled()){
+        return;
+    }
+
+    auto& block = detail::local_instrumentation_block();
+    detail::single_writer_add(block.phase_time_ns[static_cast<uint_t>(phase)], ns);
+    detail::single_writer_add(block.phase_calls[static_cast<uint_t>(phase)], 1);
+}
+
+inline
+void
+Instrumentation::increment(InstrumentationCounter counter, uint_t n)noexcept{
+
+    if(!is_enabled()){
+        return;
+    }
+
+    detail::single_writer_add(detail::local_instrumentation_block().counters[static_cast<uint_t>(counter)], n);
+}
+
+
+#ifdef USE_INSTRUMENTATION
+
+///
+/// \brief The ScopedPhaseTimer class. Times the enclosing
+/// scope and adds the elapsed time to the given phase
+///
+class ScopedPhaseTimer
+{
+public:
+
+    ///
+    /// \brief Constructor
+    ///
+    explicit ScopedPhaseTimer(InstrumentationPhase phase)noexcept
+        :
+          phase_(phase),
+          active_(Instrumentation::is_enabled())
+    {
+        if(active_){
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ///
+    /// \brief Destructor
+    ///
+    ~ScopedPhaseTimer(){
+
+        if(active_){
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            Instrumentation::add_phase_time(phase_,
+                                            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+
+    ScopedPhaseTimer(const ScopedPhaseTimer&)=delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&)=delete;
+
+private:
+
+    InstrumentationPhase phase_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#else
+
+///
+/// \brief The ScopedPhaseTimer class. No-op version used
+/// when USE_INSTRUMENTATION is not defined
+///
+class ScopedPhaseTimer
+{
+public:
+
+    explicit ScopedPhaseTimer(InstrumentationPhase)noexcept{}
+    ScopedPhaseTimer(const ScopedPhaseTimer&)=delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&)=delete;
+};
+
+#endif
+
+
+///
+/// \brief The EpisodeInstrumentationRecorder class. Keeps the
+/// per episode difference of the instrumentation snapshots and
+/// exports them to CSV or to a tensorboard server
+///
+class EpisodeInstrumentationRecorder
+{
+public:
+
+    ///
+    /// \brief The episode_record struct
+    ///
+    struct episode_record
+    {
+        uint_t episode_index;
+        real_t episode_time;
+        InstrumentationSnapshot values;
+
+        ///
+        /// \brief rate. Events of the counter per second of episode time
+        ///
+        real_t rate(InstrumentationCounter counter)const noexcept{
+            return episode_time > 0.0 ? static_cast<real_t>(values.count(counter)) / episode_time : 0.0;
+        }
+    };
+
+    ///
+    /// \brief start. Take the baseline snapshot and
+    /// clear any previous records
+    ///
+    void start();
+
+    ///
+    /// \brief on_episode_end. Record the values accumulated
+    /// since the previous call
+    ///
+    void on_episode_end(uint_t episode_index, real_t episode_time);
+
+    ///
+    /// \brief records
+    ///
+    const std::vector<episode_record>& records()const noexcept{return records_;}
+
+    ///
+    /// \brief write_csv. Write one row per episode
+    ///
+    void write_csv(const std::string& filename)const;
+
+    ///
+    /// \brief log_to_tensorboard. Send the phase times and rates
+    /// of every recorded episode to the given server
+    ///
+    void log_to_tensorboard(const io::TensorboardServer& server,
+                            const std::string& main_tag="instrumentation")const;
+
+private:
+
+    ///
+    /// \brief last_. The snapshot at the end of the previous episode
+    ///
+    InstrumentationSnapshot last_;
+
+    ///
+    /// \brief records_
+    ///
+    std::vector<episode_record> records_;
+};
+
+}
+}
+
+#endif // INSTRUMENTATION_H
@@ -8,6 +8,7 @@
 #include "cubeai/base/cubeai_types.h"
 
 #include <torch/torch.h>
+#include <algorithm>
 #include <vector>
 
 namespace cubeai{
@@ -15,7 +16,11 @@ namespace torch_utils {
 
 
 ///
-/// \brief The TorchStateAdaptor struct
+/// \brief The TorchStateAdaptor struct. The call operators copy the
+/// data into a new tensor. The view functions wrap the memory of the
+/// container with torch::from_blob and copy nothing; the returned tensor
+/// does not own the memory and is only valid while the container is alive
+/// and not resized
 ///
 struct TorchAdaptor{
 
@@ -31,10 +36,112 @@ struct TorchAdaptor{
 
     template<typename T>
     static std::vector<T> to_vector(torch_tensor_t tensor);
+
+    ///
+    /// \brief to_vector. Copy the tensor into out which is resized to numel().
+    /// Does not allocate once out has the capacity
+    ///
+    template<typename T>
+    static void to_vector(const torch_tensor_t& tensor, std::vector<T>& out);
+
+    ///
+    /// \brief to_scalar. Read back a single element tensor, e.g. the
+    /// sampled action of one environment, without going through a vector
+    ///
+    template<typename T>
+    static T to_scalar(const torch_tensor_t& tensor){return static_cast<T>(tensor.template item<int64_t>());}
+
+    ///
+    /// \brief view. 1D view of shape [size] over the vector
+    ///
+    template<typename T>
+    static torch_tensor_t view(std::vector<T>& data);
+
+    ///
+    /// \brief view. View of the given shape over the vector.
+    /// The shape should not have more elements than the vector
+    ///
+    template<typename T>
+    static torch_tensor_t view(std::vector<T>& data, torch::IntArrayRef shape);
+
+    ///
+    /// \brief view. 1D view of shape [size] over the row vector
+    ///
+    template<typename T>
+    static torch_tensor_t view(DynVec<T>& data);
+
+    ///
+    /// \brief view. View of shape [rows, cols] over the matrix. Eigen stores
+    /// the matrix column major so the view has strides [1, rows]. Call
+    /// contiguous() on it if a row major copy is needed
+    ///
+    template<typename T>
+    static torch_tensor_t view(DynMat<T>& data);
 };
 
+///
+/// \brief The TorchStagingTensor class. A tensor allocated once and reused to
+/// move observations from the CPU to the device the model lives on. When the
+/// device is a CUDA device the staging memory is pinned so that the transfer
+/// can be asynchronous. On the CPU to_device() returns the staging tensor itself
+///
+class TorchStagingTensor
+{
+public:
+
+    ///
+    /// \brief allocate. Allocate the staging memory
+    ///
+    void allocate(torch::IntArrayRef shape, torch::Device device,
+                  torch::ScalarType dtype=torch::kFloat32);
+
+    ///
+    /// \brief tensor. The CPU staging tensor
+    ///
+    torch_tensor_t& tensor()noexcept{return staging_;}
+
+    ///
+    /// \brief copy_from. Copy numel() elements from data into the staging tensor
+    ///
+    template<typename T>
+    void copy_from(const T* data);
+
+    ///
+    /// \brief to_device. The staging tensor on the device. For CUDA devices
+    /// the copy goes into a device tensor that is also allocated once
+    ///
+    torch_tensor_t to_device();
+
+private:
+
+    torch::Device device_{torch::kCPU};
+    torch_tensor_t staging_;
+    torch_tensor_t device_tensor_;
+};
+
+///
+/// \brief run_without_autograd. Call fn under torch::InferenceMode or, if
+/// inference_mode is false, under torch::NoGradGuard. The tensors fn creates
+/// under InferenceMode cannot be used later in autograd, writing into
+/// tensors allocated outside of it is allowed
+///
+template<typename Fn>
+void
+run_without_autograd(bool inference_mode, Fn&& fn){
+
+    if(inference_mode){
+        c10::InferenceMode guard;
+        fn();
+        return;
+    }
+
+    torch::NoGradGuard no_grad;
+    fn();
+}
+
 
 template<>
+inline
 std::vector<int>
 TorchAdaptor::to_vector(torch_tensor_t tensor){
 
@@ -44,6 +151,7 @@ TorchAdaptor::to_vector(torch_tensor_t tensor){
 }
 
 template<>
+inline
 std::vector<uint_t>
 TorchAdaptor::to_vector(torch_tensor_t tensor){
 
@@ -54,6 +162,7 @@ TorchAdaptor::to_vector(torch_tensor_t tensor){
 
 #ifdef CUBEAI_REAL_TYPE_FLOAT
 template<>
+inline
 std::vector<float>
 TorchAdaptor::to_vector(torch_tensor_t tensor){
 
@@ -64,6 +173,7 @@ TorchAdaptor::to_vector(torch_tensor_t tensor){
 
 #else
 template<>
+inline
 std::vector<float>
 TorchAdaptor::to_vector(torch_tensor_t tensor){
 
@@ -73,6 +183,7 @@ TorchAdaptor::to_vector(torch_tensor_t tensor){
 }
 
 template<>
+inline
 std::vector<real_t>
 TorchAdaptor::to_vector(torch_tensor_t tensor){
 
@@ -82,6 +193,60 @@ TorchAdaptor::to_vector(torch_tensor_t tensor){
 }
 #endif
 
+template<typename T>
+void
+TorchAdaptor::to_vector(const torch_tensor_t& tensor, std::vector<T>& out){
+
+    out.resize(tensor.numel());
+
+    // wrap out and let torch do the conversion of
+    // the dtype and of the layout in one copy
+    view(out).view(tensor.sizes()).copy_(tensor);
+}
+
+template<typename T>
+torch_tensor_t
+TorchAdaptor::view(std::vector<T>& data){
+    return torch::from_blob(data.data(), {static_cast<int64_t>(data.size())},
+                            torch::CppTypeToScalarType<T>::value);
+}
+
+template<typename T>
+torch_tensor_t
+TorchAdaptor::view(std::vector<T>& data, torch::IntArrayRef shape){
+    return torch::from_blob(data.data(), shape, torch::CppTypeToScalarType<T>::value);
+}
+
+template<typename T>
+torch_tensor_t
+TorchAdaptor::view(DynVec<T>& data){
+    return torch::from_blob(data.data(), {static_cast<int64_t>(data.size())},
+                            torch::CppTypeToScalarType<T>::value);
+}
+
+template<typename T>
+torch_tensor_t
+TorchAdaptor::view(DynMat<T>& data){
+
+    const auto rows = static_cast<int64_t>(data.rows());
+    const auto cols = static_cast<int64_t>(data.cols());
+    return torch::from_blob(data.data(), {rows, cols}, {1, rows},
+                            torch::CppTypeToScalarType<T>::value);
+}
+
+template<typename T>
+void
+TorchStagingTensor::copy_from(const T* data){
+
+    if(staging_.scalar_type() == torch::CppTypeToScalarType<T>::value){
+        std::copy(data, data + staging_.numel(), staging_.data_ptr<T>());
+        return;
+    }
+
+    staging_.copy_(torch::from_blob(const_cast<T*>(data), staging_.sizes(),
+                                    torch::CppTypeToScalarType<T>::value));
+}
+
 }
 }
 
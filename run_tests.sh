@@ -16,3 +16,7 @@ cd test_random_tabular_policy
 cd ..
 cd test_softmax_policy
 ./test_softmax_policy
+cd ..
+cd ..
+cd test_eligibility_traces
+./test_eligibility_traces
@@ -0,0 +1,457 @@
+#include "cubeai/io/binary_checkpoint.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cubeai{
+namespace io{
+
+namespace{
+
+const char CHECKPOINT_MAGIC[8] = {'C', 'U', 'B', 'E', 'A', 'I', 'C', 'K'};
+const std::uint32_t CHECKPOINT_VERSION = 1;
+
+///
+/// \brief The FileHeader struct. The first bytes of a checkpoint file
+///
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t n_entries;
+    std::uint64_t table_offset;
+    std::uint64_t file_size;
+    char padding[32];
+};
+
+static_assert(sizeof(FileHeader) == Checkpoint::ALIGNMENT, "The header should fill one aligned block");
+
+uint_t
+align_up(uint_t n){
+    return (n + Checkpoint::ALIGNMENT - 1) & ~(Checkpoint::ALIGNMENT - 1);
+}
+
+uint_t
+element_size(CheckpointDataType dtype){
+
+    switch(dtype){
+        case CheckpointDataType::BYTES: return 1;
+        case CheckpointDataType::FLOAT32: return 4;
+        case CheckpointDataType::FLOAT64: return 8;
+        case CheckpointDataType::INT32: return 4;
+        case CheckpointDataType::INT64: return 8;
+        case CheckpointDataType::UINT32: return 4;
+        case CheckpointDataType::UINT64: return 8;
+    }
+
+    return 0;
+}
+
+void
+write_all(int fd, const char* data, uint_t size, const std::string& filename){
+
+    while(size != 0){
+
+        auto n = ::write(fd, data, size);
+        if(n < 0){
+
+            if(errno == EINTR){
+                continue;
+            }
+
+            throw std::runtime_error("Could not write checkpoint file " + filename);
+        }
+
+        data += n;
+        size -= static_cast<uint_t>(n);
+    }
+}
+
+}
+
+char*
+Checkpoint::append_(const std::string& name, CheckpointDataType dtype,
+                    uint_t rows, uint_t cols, uint_t nbytes){
+
+    if(name.empty() || name.size() > CheckpointEntry::MAX_NAME_SIZE){
+        throw std::logic_error("Invalid checkpoint entry name " + name +
+                               ". Names should have 1 to " + std::to_string(CheckpointEntry::MAX_NAME_SIZE) + " characters");
+    }
+
+    if(contains(name)){
+        throw std::logic_error("Checkpoint entry " + name + " already exists");
+    }
+
+    CheckpointEntry entry;
+    std::memset(&entry, 0, sizeof(CheckpointEntry));
+    std::memcpy(entry.name, name.data(), name.size());
+    entry.dtype = dtype;
+    entry.rows = rows;
+    entry.cols = cols;
+    entry.offset = align_up(data_.size());
+    entry.nbytes = nbytes;
+
+    data_.resize(entry.offset + nbytes);
+    entries_.push_back(entry);
+    return data_.data() + entry.offset;
+}
+
+void
+Checkpoint::add(const std::string& name, const DynMat<real_t>& mat){
+
+    const auto nbytes = mat.size() * sizeof(real_t);
+    auto* dest = append_(name, checkpoint_data_type<real_t>(), mat.rows(), mat.cols(), nbytes);
+    if(nbytes != 0){
+        std::memcpy(dest, mat.data(), nbytes);
+    }
+}
+
+void
+Checkpoint::add(const std::string& name, const DynVec<real_t>& vec){
+
+    const auto nbytes = vec.size() * sizeof(real_t);
+    auto* dest = append_(name, checkpoint_data_type<real_t>(), 1, vec.size(), nbytes);
+    if(nbytes != 0){
+        std::memcpy(dest, vec.data(), nbytes);
+    }
+}
+
+void
+Checkpoint::add_bytes(const std::string& name, std::string_view bytes){
+
+    auto* dest = append_(name, CheckpointDataType::BYTES, bytes.size(), 1, bytes.size());
+    if(!bytes.empty()){
+        std::memcpy(dest, bytes.data(), bytes.size());
+    }
+}
+
+bool
+Checkpoint::contains(const std::string& name)const noexcept{
+
+    return std::any_of(entries_.begin(), entries_.end(),
+                       [&name](const CheckpointEntry& e){return name == e.name;});
+}
+
+void
+Checkpoint::clear()noexcept{
+    entries_.clear();
+    data_.clear();
+}
+
+void
+Checkpoint::swap(Checkpoint& other)noexcept{
+    entries_.swap(other.entries_);
+    data_.swap(other.data_);
+}
+
+void
+write_checkpoint(const Checkpoint& checkpoint, const std::string& filename){
+
+    const auto data_offset = static_cast<uint_t>(sizeof(FileHeader));
+    const auto table_offset = align_up(data_offset + checkpoint.data_size());
+    const auto table_size = checkpoint.n_entries() * sizeof(CheckpointEntry);
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(FileHeader));
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    header.version = CHECKPOINT_VERSION;
+    header.n_entries = static_cast<std::uint32_t>(checkpoint.n_entries());
+    header.table_offset = table_offset;
+    header.file_size = table_offset + table_size;
+
+    // the offsets of the file are relative to its start
+    std::vector<CheckpointEntry> table(checkpoint.entries());
+    for(auto& entry : table){
+        entry.offset += data_offset;
+    }
+
+    const auto tmp_filename = filename + ".tmp";
+    auto fd = ::open(tmp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0){
+        throw std::runtime_error("Could not open checkpoint file " + tmp_filename);
+    }
+
+    try{
+
+        const char zeros[Checkpoint::ALIGNMENT] = {};
+        write_all(fd, reinterpret_cast<const char*>(&header), sizeof(FileHeader), tmp_filename);
+        write_all(fd, checkpoint.data(), checkpoint.data_size(), tmp_filename);
+        write_all(fd, zeros, table_offset - data_offset - checkpoint.data_size(), tmp_filename);
+        write_all(fd, reinterpret_cast<const char*>(table.data()), table_size, tmp_filename);
+
+        if(::fsync(fd) != 0){
+            throw std::runtime_error("Could not sync checkpoint file " + tmp_filename);
+        }
+    }
+    catch(...){
+        ::close(fd);
+        std::remove(tmp_filename.c_str());
+        throw;
+    }
+
+    ::close(fd);
+
+    if(std::rename(tmp_filename.c_str(), filename.c_str()) != 0){
+        std::remove(tmp_filename.c_str());
+        throw std::runtime_error("Could not rename " + tmp_filename + " to " + filename);
+    }
+}
+
+AsyncCheckpointWriter::AsyncCheckpointWriter()
+    :
+      pending_(),
+      pending_filename_(),
+      has_pending_(false),
+      writing_(false),
+      stop_writer_(false),
+      last_error_(),
+      n_written_(0),
+      n_skipped_(0),
+      mutex_(),
+      work_cv_(),
+      done_cv_(),
+      writer_thread_()
+{}
+
+AsyncCheckpointWriter::~AsyncCheckpointWriter(){
+    stop();
+}
+
+void
+AsyncCheckpointWriter::submit(Checkpoint& snapshot, const std::string& filename){
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if(has_pending_){
+            n_skipped_.store(n_skipped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        pending_.swap(snapshot);
+        pending_filename_ = filename;
+        has_pending_ = true;
+
+        if(!writer_thread_.joinable()){
+            stop_writer_ = false;
+            writer_thread_ = std::thread(&AsyncCheckpointWriter::writer_loop_, this);
+        }
+    }
+
+    work_cv_.notify_one();
+}
+
+void
+AsyncCheckpointWriter::wait(){
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // nothing will write the pending snapshot
+    if(!writer_thread_.joinable()){
+        return;
+    }
+
+    done_cv_.wait(lock, [this](){return !has_pending_ && !writing_;});
+}
+
+void
+AsyncCheckpointWriter::stop(){
+
+    if(!writer_thread_.joinable()){
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_writer_ = true;
+    }
+
+    work_cv_.notify_one();
+    writer_thread_.join();
+}
+
+std::string
+AsyncCheckpointWriter::last_error()const{
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_error_;
+}
+
+void
+AsyncCheckpointWriter::writer_loop_(){
+
+    // the snapshot being written. Swapped
+    // with pending_ so that its memory is reused
+    Checkpoint current;
+    std::string filename;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(true){
+
+        work_cv_.wait(lock, [this](){return has_pending_ || stop_writer_;});
+
+        if(!has_pending_){
+            // stop requested and nothing left to write
+            break;
+        }
+
+        current.swap(pending_);
+        filename.swap(pending_filename_);
+        has_pending_ = false;
+        writing_ = true;
+
+        lock.unlock();
+
+        std::string error;
+        try{
+            write_checkpoint(current, filename);
+        }
+        catch(std::exception& e){
+            error = e.what();
+        }
+
+        lock.lock();
+
+        writing_ = false;
+        if(error.empty()){
+            n_written_.store(n_written_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        else{
+            last_error_ = error;
+        }
+
+        done_cv_.notify_all();
+    }
+
+    done_cv_.notify_all();
+}
+
+MappedCheckpoint::MappedCheckpoint(const std::string& filename)
+    :
+      base_(nullptr),
+      size_(0),
+      n_entries_(0),
+      table_(nullptr)
+{
+    auto fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0){
+        throw std::runtime_error("Could not open checkpoint file " + filename);
+    }
+
+    struct stat file_stat;
+    if(::fstat(fd, &file_stat) != 0 || static_cast<uint_t>(file_stat.st_size) < sizeof(FileHeader)){
+        ::close(fd);
+        throw std::runtime_error("Invalid checkpoint file " + filename);
+    }
+
+    size_ = static_cast<uint_t>(file_stat.st_size);
+    auto* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+
+    if(addr == MAP_FAILED){
+        throw std::runtime_error("Could not map checkpoint file " + filename);
+    }
+
+    base_ = static_cast<const char*>(addr);
+
+    FileHeader header;
+    std::memcpy(&header, base_, sizeof(FileHeader));
+
+    const auto table_end = header.table_offset + header.n_entries * sizeof(CheckpointEntry);
+    if(std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0 ||
+       header.version != CHECKPOINT_VERSION ||
+       header.file_size != size_ ||
+       header.table_offset % Checkpoint::ALIGNMENT != 0 ||
+       table_end > size_){
+
+        ::munmap(const_cast<char*>(base_), size_);
+        throw std::runtime_error("Invalid checkpoint file " + filename);
+    }
+
+    n_entries_ = header.n_entries;
+    table_ = reinterpret_cast<const CheckpointEntry*>(base_ + header.table_offset);
+
+    for(uint_t i=0; i<n_entries_; ++i){
+
+        const auto& e = table_[i];
+        const auto esize = element_size(e.dtype);
+        if(esize == 0 || e.offset + e.nbytes > header.table_offset ||
+           e.nbytes != e.rows * e.cols * esize || e.name[CheckpointEntry::MAX_NAME_SIZE] != '\0'){
+
+            ::munmap(const_cast<char*>(base_), size_);
+            throw std::runtime_error("Invalid checkpoint file " + filename);
+        }
+    }
+}
+
+MappedCheckpoint::~MappedCheckpoint(){
+
+    if(base_ != nullptr){
+        ::munmap(const_cast<char*>(base_), size_);
+    }
+}
+
+bool
+MappedCheckpoint::contains(const std::string& name)const noexcept{
+
+    return std::any_of(table_, table_ + n_entries_,
+                       [&name](const CheckpointEntry& e){return name == e.name;});
+}
+
+const CheckpointEntry&
+MappedCheckpoint::entry(const std::string& name)const{
+
+    auto itr = std::find_if(table_, table_ + n_entries_,
+                            [&name](const CheckpointEntry& e){return name == e.name;});
+
+    if(itr == table_ + n_entries_){
+        throw std::logic_error("Checkpoint entry " + name + " does not exist");
+    }
+
+    return *itr;
+}
+
+const CheckpointEntry&
+MappedCheckpoint::typed_entry_(const std::string& name, CheckpointDataType dtype)const{
+
+    const auto& e = entry(name);
+    if(e.dtype != dtype){
+        throw std::logic_error("Checkpoint entry " + name + " has a different element type");
+    }
+
+    return e;
+}
+
+Eigen::Map<const DynMat<real_t>>
+MappedCheckpoint::matrix(const std::string& name)const{
+
+    const auto& e = typed_entry_(name, checkpoint_data_type<real_t>());
+    return Eigen::Map<const DynMat<real_t>>(reinterpret_cast<const real_t*>(base_ + e.offset),
+                                            static_cast<Eigen::Index>(e.rows),
+                                            static_cast<Eigen::Index>(e.cols));
+}
+
+Eigen::Map<const DynVec<real_t>>
+MappedCheckpoint::row_vector(const std::string& name)const{
+
+    const auto& e = typed_entry_(name, checkpoint_data_type<real_t>());
+    return Eigen::Map<const DynVec<real_t>>(reinterpret_cast<const real_t*>(base_ + e.offset),
+                                            static_cast<Eigen::Index>(e.rows * e.cols));
+}
+
+std::string_view
+MappedCheckpoint::bytes(const std::string& name)const{
+
+    const auto& e = typed_entry_(name, CheckpointDataType::BYTES);
+    return std::string_view(base_ + e.offset, e.nbytes);
+}
+
+}
+}
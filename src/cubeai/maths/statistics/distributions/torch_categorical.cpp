@@ -11,13 +11,15 @@ namespace stats {
 
 
 
-TorchCategorical::TorchCategorical(torch_tensor_t probs, bool do_build_from_logits)
+TorchCategorical::TorchCategorical(torch_tensor_t probs, bool do_build_from_logits,
+                                   CategoricalSamplingType sampling_type)
 :
 TorchDistributionBase(),
 probs_(),
 logits_(),
 param_(),
-num_events_()
+num_events_(),
+sampling_type_(sampling_type)
 {
     if(do_build_from_logits){
       build_from_logits(probs);
@@ -30,13 +32,23 @@ num_events_()
 
 torch_tensor_t
 TorchCategorical::entropy(){
-    auto p_log_p = logits_ * probs_;
-    return -p_log_p.sum(-1);
+
+    // the probabilities are only formed if
+    // the distribution was built from logits
+    return -(get_probs() * logits_).sum(-1);
 }
 
 torch_tensor_t
 TorchCategorical::log_prob(torch_tensor_t value){
-    value = value.to(torch::kLong).unsqueeze(-1);
+
+    value = value.to(torch::kLong);
+
+    // fast path: one value per distribution of the batch
+    if(value.sizes() == logits_.sizes().slice(0, logits_.dim() - 1)){
+        return logits_.gather(-1, value.unsqueeze(-1)).squeeze(-1);
+    }
+
+    value = value.unsqueeze(-1);
     auto broadcasted_tensors = torch::broadcast_tensors({value, logits_});
     value = broadcasted_tensors[0];
     value = value.narrow(-1, 0, 1);
@@ -45,22 +57,53 @@ TorchCategorical::log_prob(torch_tensor_t value){
 
 torch_tensor_t
 TorchCategorical::sample(c10::ArrayRef<int64_t> sample_shape){
+
     auto ext_sample_shape = extended_shape(sample_shape);
-    auto param_shape = ext_sample_shape;
-    param_shape.insert(param_shape.end(), {num_events_});
-    auto exp_probs = probs_.expand(param_shape);
-    torch_tensor_t probs_2d;
-
-    if (probs_.dim() == 1 || probs_.size(0) == 1)
-    {
-        probs_2d = exp_probs.view({-1, num_events_});
+
+    if(sampling_type_ == CategoricalSamplingType::INVERSE_CDF){
+        return sample_inverse_cdf_(ext_sample_shape);
     }
-    else
-    {
-        probs_2d = exp_probs.contiguous().view({-1, num_events_});
+
+    return sample_gumbel_max_(ext_sample_shape);
+}
+
+torch_tensor_t
+TorchCategorical::get_probs(){
+
+    if(!probs_.defined()){
+        probs_ = logits_.exp();
     }
-    auto sample_2d = torch::multinomial(probs_2d, 1, true);
-    return sample_2d.contiguous().view(ext_sample_shape);
+
+    return probs_;
+}
+
+torch_tensor_t
+TorchCategorical::sample_gumbel_max_(const std::vector<int64_t>& sample_shape){
+
+    auto param_shape = sample_shape;
+    param_shape.push_back(num_events_);
+
+    // argmax(logits + G) with G = -log(E), E ~ Exp(1),
+    // is distributed according to softmax(logits)
+    auto noise = torch::empty(param_shape, logits_.options()).exponential_();
+    return (logits_.expand(param_shape) - noise.log_()).argmax(-1);
+}
+
+torch_tensor_t
+TorchCategorical::sample_inverse_cdf_(const std::vector<int64_t>& sample_shape){
+
+    auto param_shape = sample_shape;
+    param_shape.push_back(num_events_);
+
+    auto uniform_shape = sample_shape;
+    uniform_shape.push_back(1);
+
+    auto cdf = get_probs().cumsum(-1).expand(param_shape).contiguous();
+
+    // scale by the total mass so that round off in the
+    // cumulative sum never puts u beyond the last bin
+    auto u = torch::rand(uniform_shape, cdf.options()) * cdf.narrow(-1, num_events_ - 1, 1);
+    return torch::searchsorted(cdf, u, /*out_int32=*/false, /*right=*/true).squeeze(-1).clamp_max(num_events_ - 1);
 }
 
 
@@ -71,12 +114,14 @@ TorchCategorical::build_from_logits(torch_tensor_t logits){
         throw std::runtime_error("Logits tensor must have at least one dimension");
     }
 
+    // the probabilities are formed lazily by get_probs
     logits_ = logits - logits.logsumexp(-1, true);
-    probs_ = torch::softmax(logits_, -1);
+    probs_ = torch_tensor_t();
 
     param_ = logits;
     num_events_ = param_.size(-1);
 
+    batch_shape_.clear();
     if (param_.dim() > 1){
         batch_shape_ = param_.sizes().vec();
         batch_shape_.resize(batch_shape_.size() - 1);
@@ -100,6 +145,7 @@ TorchCategorical::build_from_probabilities(torch_tensor_t probs){
     param_ = probs_;
     num_events_ = param_.size(-1);
 
+    batch_shape_.clear();
     if (param_.dim() > 1){
         batch_shape_ = param_.sizes().vec();
         batch_shape_.resize(batch_shape_.size() - 1);
@@ -1,91 +1,350 @@
-#include "cubeai/base/cubeai_config.h"
-
-#ifdef USE_PLANNING
-
 #include "cubeai/planning/diff_drive_dynamic_window.h"
 
+#include <algorithm>
+#include <execution>
+#include <stdexcept>
+#include <string>
+
 
-namespace cengine{
+namespace cubeai{
 namespace planning{
 
+namespace{
+
+// below this yaw rate the trajectory is a straight line
+const real_t STRAIGHT_LINE_YAW_RATE = 1.0e-9;
+const real_t GRID_TOL = 1.0e-9;
+
+// the number of values min + i*reso that do not exceed max
+uint_t
+grid_size(real_t min, real_t max, real_t reso){
+
+    if(max < min){
+        return 0;
+    }
+
+    return static_cast<uint_t>(std::floor((max - min) / reso + GRID_TOL)) + 1;
+}
+
+}
+
 DiffDriveDW::DiffDriveDW(const state_t& state, const config_t& config, const goal_t& goal,
                                   const control_t& control)
     :
     goal_(goal),
     control_(control),
     state_(state),
-    config_(config)
-{}
+    config_(config),
+    w_properties_(),
+    n_steps_(0),
+    best_(npos)
+{
+    if(config_.dt <= 0.0 || config_.v_reso <= 0.0 || config_.yawrate_reso <= 0.0){
+        throw std::logic_error("dt, v_reso and yawrate_reso should be positive");
+    }
+
+    if(config_.skip_n == 0 || config_.rollout_block_size == 0){
+        throw std::logic_error("skip_n and rollout_block_size should be positive");
+    }
+
+    // the steps taken by the loop time = 0; time <= predict_time; time += dt
+    for(auto time = 0.0; time <= config_.predict_time; time += config_.dt){
+        ++n_steps_;
+    }
+}
+
+uint_t
+DiffDriveDW::dwa_control(const ObstacleDistanceMap& map){
+
+    calculate_window();
+
+    ox_.clear();
+    oy_.clear();
+    calculate_control_input_(&map);
+    return best_;
+}
 
 DiffDriveDW::window_properties_t&
 DiffDriveDW::calculate_window(){
 
     // update the dynamic window
     // properties.
-    w_properties_.v_min = std::max(state_["v"] - config_.max_accel * config_.dt, config_.min_speed);
-    w_properties_.v_max = std::min(state_["v"] + config_.max_accel * config_.dt, config_.max_speed);
-    w_properties_.w_min = std::max(state_["w"] - config_.max_delta_yaw_rate * config_.dt, -config_.max_yaw_rate);
-    w_properties_.w_max = std::min(state_["w"] + config_.max_delta_yaw_rate * config_.dt, config_.max_yaw_rate);
+    w_properties_.v_min = std::max(state_[V] - config_.max_accel * config_.dt, config_.min_speed);
+    w_properties_.v_max = std::min(state_[V] + config_.max_accel * config_.dt, config_.max_speed);
+    w_properties_.w_min = std::max(state_[W] - config_.max_delta_yaw_rate * config_.dt, -config_.max_yaw_rate);
+    w_properties_.w_max = std::min(state_[W] + config_.max_delta_yaw_rate * config_.dt, config_.max_yaw_rate);
 
     return this->w_properties_;
 }
 
-DiffDriveDW::trajectory_t
-DiffDriveDW::predict_trajectory_(real_t v, real_t w){
+void
+DiffDriveDW::build_candidates_(){
 
-    trajectory_t traj;
-    traj.push_back(state_.get_values());
+    const auto n_v = grid_size(w_properties_.v_min, w_properties_.v_max, config_.v_reso);
+    const auto n_w = grid_size(w_properties_.w_min, w_properties_.w_max, config_.yawrate_reso);
+    const auto n = n_v * n_w;
+
+    for(auto* array : {&v_, &w_, &cost_, &arc_, &line_, &cos_dw_, &sin_dw_,
+                       &cos_, &sin_, &x_, &y_, &min_d2_}){
+        array->resize(n);
+    }
+
+    for(uint_t i=0; i<n_v; ++i){
+
+        const auto v = w_properties_.v_min + static_cast<real_t>(i) * config_.v_reso;
+        for(uint_t j=0; j<n_w; ++j){
+
+            const auto c = i * n_w + j;
+            const auto w = w_properties_.w_min + static_cast<real_t>(j) * config_.yawrate_reso;
+
+            v_[c] = v;
+            w_[c] = w;
+            cos_dw_[c] = std::cos(w * config_.dt);
+            sin_dw_[c] = std::sin(w * config_.dt);
+
+            if(std::abs(w) > STRAIGHT_LINE_YAW_RATE){
+                arc_[c] = v / w;
+                line_[c] = 0.0;
+            }
+            else{
+                arc_[c] = 0.0;
+                line_[c] = v * config_.dt;
+            }
+        }
+    }
+
+    blocks_.clear();
+    for(uint_t b=0; b<n; b += config_.rollout_block_size){
+        blocks_.push_back(b);
+    }
+}
+
+void
+DiffDriveDW::rollout_(uint_t begin, uint_t end, real_t min_d2_start, const ObstacleDistanceMap* map){
+
+    const auto x0 = state_[X];
+    const auto y0 = state_[Y];
+    const auto theta0 = state_[THETA];
+    const auto cos0 = std::cos(theta0);
+    const auto sin0 = std::sin(theta0);
 
-    typedef kernel::dynamics::DiffDriveDynamics::input_t input_t;
-    input_t model_input;
-    model_input.insert({"v", v});
-    model_input.insert({"w", w});
-    model_input.insert({"dt", config_.dt});
+    const auto n_obstacles = ox_.size();
+    const auto* ox = ox_.data();
+    const auto* oy = oy_.data();
+
+    const auto* arc = arc_.data();
+    const auto* line = line_.data();
+    const auto* cos_dw = cos_dw_.data();
+    const auto* sin_dw = sin_dw_.data();
+    auto* c = cos_.data();
+    auto* s = sin_.data();
+    auto* x = x_.data();
+    auto* y = y_.data();
+    auto* min_d2 = min_d2_.data();
+
+    for(auto j=begin; j<end; ++j){
+        c[j] = cos0;
+        s[j] = sin0;
+        min_d2[j] = min_d2_start;
+    }
 
-#ifdef USE_WARNINGS_FOR_MISSING_IMPLEMENTATION
-    std::cout<<kernel::KernelConsts::warning_str()<<"Errors have not been accounted for in the implementation"<<std::endl;
-#endif
+    for(uint_t k=1; k<=n_steps_; ++k){
 
-    std::array<real_t, 2> errors;
-    errors[0] = errors[1] = 0.0;
-    model_input.insert({"errors", errors});
+        const auto k_cos0 = static_cast<real_t>(k) * cos0;
+        const auto k_sin0 = static_cast<real_t>(k) * sin0;
 
-    auto time = 0.0;
-    kernel::dynamics::SysState<3> init_state({"x", "y", "theta"}, 0.0);
-    kernel::dynamics::SysState<3>::extract(state_, init_state);
-    kernel::dynamics::SysState<5> tmp = state_;
-    tmp["v"] = v;
-    tmp["w"] = w;
+        #pragma omp simd
+        for(auto j=begin; j<end; ++j){
 
-    while (time <= config_.predict_time){
+            const auto ck = c[j] * cos_dw[j] - s[j] * sin_dw[j];
+            const auto sk = s[j] * cos_dw[j] + c[j] * sin_dw[j];
+            c[j] = ck;
+            s[j] = sk;
+            x[j] = x0 + arc[j] * (sk - sin0) + line[j] * k_cos0;
+            y[j] = y0 - arc[j] * (ck - cos0) + line[j] * k_sin0;
+        }
 
-        auto result = kernel::dynamics::DiffDriveDynamics::integrate(init_state, model_input, config_.dynamics_version);
-        tmp["x"] = result["x"];
-        tmp["y"] = result["y"];
-        tmp["theta"] = result["theta"];
-        init_state["x"] = result["x"];
-        init_state["y"] = result["y"];
-        init_state["theta"] = result["theta"];
+        if(k % config_.skip_n != 0){
+            continue;
+        }
 
-        traj.push_back(tmp.get_values());
-        time += config_.dt;
+        for(uint_t o=0; o<n_obstacles; ++o){
+
+            const auto oxo = ox[o];
+            const auto oyo = oy[o];
+
+            #pragma omp simd
+            for(auto j=begin; j<end; ++j){
+                const auto dx = x[j] - oxo;
+                const auto dy = y[j] - oyo;
+                const auto d2 = dx * dx + dy * dy;
+                min_d2[j] = d2 < min_d2[j] ? d2 : min_d2[j];
+            }
+        }
+
+        if(map){
+            for(auto j=begin; j<end; ++j){
+                const auto d = map->distance(x[j], y[j]);
+                min_d2[j] = std::min(min_d2[j], d * d);
+            }
+        }
+    }
+
+    const auto has_obstacles = map != nullptr || n_obstacles != 0;
+    const auto r2 = config_.robot_radius * config_.robot_radius;
+    const auto horizon = static_cast<real_t>(n_steps_) * config_.dt;
+
+    for(auto j=begin; j<end; ++j){
+
+        if(min_d2[j] <= r2){
+            cost_[j] = std::numeric_limits<real_t>::infinity();
+            continue;
+        }
+
+        const auto to_goal_cost = config_.to_goal_cost_gain * calc_to_goal_cost_(x[j], y[j], theta0 + w_[j] * horizon);
+        const auto speed_cost = config_.speed_cost_gain * (config_.max_speed - v_[j]);
+        const auto ob_cost = !has_obstacles ? 0.0 : config_.obstacle_cost_gain / std::sqrt(min_d2[j]);
+        cost_[j] = to_goal_cost + speed_cost + ob_cost;
+    }
+}
+
+void
+DiffDriveDW::calculate_control_input_(const ObstacleDistanceMap* map){
+
+    build_candidates_();
+
+    // the first point of every trajectory is the current state
+    auto min_d2_start = std::numeric_limits<real_t>::max();
+    if(map){
+        const auto d = map->distance(state_[X], state_[Y]);
+        min_d2_start = d * d;
+    }
+
+    for(uint_t o=0; o<ox_.size(); ++o){
+        const auto dx = state_[X] - ox_[o];
+        const auto dy = state_[Y] - oy_[o];
+        min_d2_start = std::min(min_d2_start, dx * dx + dy * dy);
+    }
+
+    // no trajectory leaves the disc of radius reach around the state so
+    // an obstacle further than the closest one plus twice the reach is
+    // never the closest obstacle of a trajectory
+    if(!ox_.empty()){
+
+        const auto reach = std::max(std::abs(w_properties_.v_min), std::abs(w_properties_.v_max)) *
+                static_cast<real_t>(n_steps_) * config_.dt;
+        const auto max_d = std::sqrt(min_d2_start) + 2.0 * reach;
+        const auto max_d2 = max_d * max_d;
+
+        uint_t n_kept = 0;
+        for(uint_t o=0; o<ox_.size(); ++o){
+
+            const auto dx = state_[X] - ox_[o];
+            const auto dy = state_[Y] - oy_[o];
+            if(dx * dx + dy * dy <= max_d2){
+                ox_[n_kept] = ox_[o];
+                oy_[n_kept] = oy_[o];
+                ++n_kept;
+            }
+        }
+
+        ox_.resize(n_kept);
+        oy_.resize(n_kept);
+    }
+
+    const auto n = v_.size();
+    auto rollout_block = [this, n, min_d2_start, map](uint_t b){
+        rollout_(b, std::min(b + config_.rollout_block_size, n), min_d2_start, map);
+    };
+
+    if(config_.parallel_rollout){
+        std::for_each(std::execution::par, blocks_.begin(), blocks_.end(), rollout_block);
+    }
+    else{
+        std::for_each(blocks_.begin(), blocks_.end(), rollout_block);
+    }
+
+    // evaluate all trajectory with sampled input in dynamic window.
+    // On ties the last candidate wins
+    best_ = npos;
+    auto min_cost = std::numeric_limits<real_t>::max();
+    for(uint_t j=0; j<n; ++j){
+        if(cost_[j] <= min_cost){
+            min_cost = cost_[j];
+            best_ = j;
+        }
+    }
+
+    if(best_ == npos){
+        return;
+    }
+
+    control_[0] = v_[best_];
+    control_[1] = w_[best_];
+
+    // to ensure the robot does not get stuck in
+    // best v=0 m/s (in front of an obstacle) and
+    // best omega=0 rad/s (heading to the goal with
+    // angle difference of 0)
+    if(std::abs(control_[0]) < config_.robot_stuck_flag_cons &&
+       std::abs(state_[V]) < config_.robot_stuck_flag_cons){
+        control_[1] = -config_.max_delta_yaw_rate;
+    }
+}
+
+void
+DiffDriveDW::trajectory(uint_t i, trajectory_t& out)const{
+
+    if(i >= v_.size()){
+        throw std::logic_error("Candidate index " + std::to_string(i) + " not in [0, " + std::to_string(v_.size()) + ")");
+    }
+
+    out.clear();
+    out.reserve(n_steps_ + 1);
+    out.push_back(state_);
+
+    const auto cos0 = std::cos(state_[THETA]);
+    const auto sin0 = std::sin(state_[THETA]);
+    auto ck = cos0;
+    auto sk = sin0;
+
+    for(uint_t k=1; k<=n_steps_; ++k){
+
+        const auto c = ck * cos_dw_[i] - sk * sin_dw_[i];
+        sk = sk * cos_dw_[i] + ck * sin_dw_[i];
+        ck = c;
+
+        state_t point;
+        point[X] = state_[X] + arc_[i] * (sk - sin0) + line_[i] * static_cast<real_t>(k) * cos0;
+        point[Y] = state_[Y] - arc_[i] * (ck - cos0) + line_[i] * static_cast<real_t>(k) * sin0;
+        point[THETA] = state_[THETA] + w_[i] * static_cast<real_t>(k) * config_.dt;
+        point[V] = v_[i];
+        point[W] = w_[i];
+        out.push_back(point);
+    }
+}
+
+DiffDriveDW::trajectory_t
+DiffDriveDW::best_trajectory()const{
+
+    trajectory_t traj;
+    if(best_ != npos){
+        trajectory(best_, traj);
     }
 
     return traj;
 }
 
 real_t
-DiffDriveDW::calc_to_goal_cost_(const trajectory_t& trajectory){
+DiffDriveDW::calc_to_goal_cost_(real_t x, real_t y, real_t theta)const{
 
-    auto dx = goal_[0] - trajectory.back()[0];
-    auto dy = goal_[1] - trajectory.back()[1];
+    auto dx = goal_[0] - x;
+    auto dy = goal_[1] - y;
     auto error_angle = std::atan2(dy, dx);
-    auto cost_angle = error_angle - trajectory.back()[2];
+    auto cost_angle = error_angle - theta;
 
     return std::abs(std::atan2(std::sin(cost_angle), std::cos(cost_angle)));
 }
 
 }
 }
-
-#endif
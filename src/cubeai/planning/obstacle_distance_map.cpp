@@ -0,0 +1,246 @@
+#include "cubeai/planning/obstacle_distance_map.h"
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+
+namespace cubeai{
+namespace planning{
+
+namespace{
+
+// the squared distance of a free sample. Finite so that
+// the intersections of the parabolas stay finite
+const real_t FAR = 1.0e20;
+
+}
+
+ObstacleDistanceMap::ObstacleDistanceMap(real_t x_min, real_t y_min, uint_t nx, uint_t ny,
+                                         real_t resolution, real_t max_distance)
+    :
+    x_min_(x_min),
+    y_min_(y_min),
+    nx_(nx),
+    ny_(ny),
+    resolution_(resolution),
+    inv_resolution_(0.0),
+    max_distance_(max_distance),
+    max_cells_(0),
+    n_points_(),
+    distance_()
+{
+    if(nx_ == 0 || ny_ == 0){
+        throw std::logic_error("The map should have at least one cell");
+    }
+
+    if(resolution_ <= 0.0 || max_distance_ <= 0.0){
+        throw std::logic_error("resolution and max_distance should be positive");
+    }
+
+    inv_resolution_ = 1.0 / resolution_;
+    max_cells_ = static_cast<uint_t>(std::ceil(max_distance_ * inv_resolution_));
+    n_points_.resize(nx_ * ny_, 0);
+    distance_.resize(nx_ * ny_, max_distance_);
+    reset_changes_();
+}
+
+void
+ObstacleDistanceMap::set_occupied(uint_t ix, uint_t iy, bool occupied){
+
+    if(ix >= nx_ || iy >= ny_){
+        throw std::logic_error("Cell (" + std::to_string(ix) + ", " + std::to_string(iy) + ") not on the map");
+    }
+
+    auto& cell = n_points_[iy * nx_ + ix];
+    if((cell != 0) == occupied){
+        return;
+    }
+
+    cell = occupied ? 1 : 0;
+    mark_changed_(ix, iy);
+}
+
+bool
+ObstacleDistanceMap::add_point(real_t x, real_t y){
+
+    if(!is_inside(x, y)){
+        return false;
+    }
+
+    const auto ix = cell_x(x);
+    const auto iy = cell_y(y);
+
+    // only the first point of a cell changes the distances
+    if(n_points_[iy * nx_ + ix]++ == 0){
+        mark_changed_(ix, iy);
+    }
+
+    return true;
+}
+
+bool
+ObstacleDistanceMap::remove_point(real_t x, real_t y){
+
+    if(!is_inside(x, y)){
+        return false;
+    }
+
+    const auto ix = cell_x(x);
+    const auto iy = cell_y(y);
+    auto& cell = n_points_[iy * nx_ + ix];
+
+    // the cell is freed with its last point
+    if(cell != 0 && --cell == 0){
+        mark_changed_(ix, iy);
+    }
+
+    return true;
+}
+
+void
+ObstacleDistanceMap::clear(){
+
+    for(uint_t iy=0; iy<ny_; ++iy){
+        for(uint_t ix=0; ix<nx_; ++ix){
+            set_occupied(ix, iy, false);
+        }
+    }
+}
+
+void
+ObstacleDistanceMap::update(){
+
+    if(!has_changes()){
+        return;
+    }
+
+    // a cell further than max_cells_ from every
+    // changed cell keeps its truncated distance
+    transform_(dirty_x_min_ - std::min(dirty_x_min_, max_cells_),
+               std::min(dirty_x_max_ + max_cells_, nx_ - 1),
+               dirty_y_min_ - std::min(dirty_y_min_, max_cells_),
+               std::min(dirty_y_max_ + max_cells_, ny_ - 1));
+    reset_changes_();
+}
+
+void
+ObstacleDistanceMap::rebuild(){
+
+    transform_(0, nx_ - 1, 0, ny_ - 1);
+    reset_changes_();
+}
+
+void
+ObstacleDistanceMap::reset_changes_()noexcept{
+
+    // an empty box
+    dirty_x_min_ = std::numeric_limits<uint_t>::max();
+    dirty_y_min_ = std::numeric_limits<uint_t>::max();
+    dirty_x_max_ = 0;
+    dirty_y_max_ = 0;
+}
+
+void
+ObstacleDistanceMap::mark_changed_(uint_t ix, uint_t iy)noexcept{
+
+    dirty_x_min_ = std::min(dirty_x_min_, ix);
+    dirty_x_max_ = std::max(dirty_x_max_, ix);
+    dirty_y_min_ = std::min(dirty_y_min_, iy);
+    dirty_y_max_ = std::max(dirty_y_max_, iy);
+}
+
+void
+ObstacleDistanceMap::transform_(uint_t x0, uint_t x1, uint_t y0, uint_t y1){
+
+    // the occupied cells that can be closer than
+    // max_distance to a cell of the box
+    const auto sx0 = x0 - std::min(x0, max_cells_);
+    const auto sx1 = std::min(x1 + max_cells_, nx_ - 1);
+    const auto sy0 = y0 - std::min(y0, max_cells_);
+    const auto sy1 = std::min(y1 + max_cells_, ny_ - 1);
+    const auto width = sx1 - sx0 + 1;
+    const auto height = sy1 - sy0 + 1;
+
+    const auto n = std::max(width, height);
+    f_.resize(n);
+    d_.resize(n);
+    z_.resize(n + 1);
+    v_.resize(n);
+    d2_.resize(width * height);
+
+    // squared distances along the columns
+    for(uint_t i=0; i<width; ++i){
+
+        for(uint_t j=0; j<height; ++j){
+            f_[j] = n_points_[(sy0 + j) * nx_ + sx0 + i] != 0 ? 0.0 : FAR;
+        }
+
+        transform_1d_(height);
+        for(uint_t j=0; j<height; ++j){
+            d2_[j * width + i] = d_[j];
+        }
+    }
+
+    // then along the rows of the box
+    const auto max_d2 = static_cast<real_t>(max_cells_) * static_cast<real_t>(max_cells_);
+    for(auto iy=y0; iy<=y1; ++iy){
+
+        const auto* row = &d2_[(iy - sy0) * width];
+        std::copy(row, row + width, f_.begin());
+        transform_1d_(width);
+
+        for(auto ix=x0; ix<=x1; ++ix){
+
+            const auto d2 = d_[ix - sx0];
+            distance_[iy * nx_ + ix] = d2 > max_d2 ? max_distance_ :
+                                                     std::min(std::sqrt(d2) * resolution_, max_distance_);
+        }
+    }
+}
+
+void
+ObstacleDistanceMap::transform_1d_(uint_t n){
+
+    // Felzenszwalb and Huttenlocher, the lower
+    // envelope of the parabolas rooted at the samples
+    const auto inf = std::numeric_limits<real_t>::infinity();
+    auto intersection = [this](uint_t q, uint_t p){
+        const auto rq = static_cast<real_t>(q);
+        const auto rp = static_cast<real_t>(p);
+        return ((f_[q] + rq * rq) - (f_[p] + rp * rp)) / (2.0 * (rq - rp));
+    };
+
+    uint_t k = 0;
+    v_[0] = 0;
+    z_[0] = -inf;
+    z_[1] = inf;
+
+    for(uint_t q=1; q<n; ++q){
+
+        auto s = intersection(q, v_[k]);
+        while(s <= z_[k]){
+            --k;
+            s = intersection(q, v_[k]);
+        }
+
+        ++k;
+        v_[k] = q;
+        z_[k] = s;
+        z_[k + 1] = inf;
+    }
+
+    k = 0;
+    for(uint_t q=0; q<n; ++q){
+
+        while(z_[k + 1] < static_cast<real_t>(q)){
+            ++k;
+        }
+
+        const auto dq = static_cast<real_t>(q) - static_cast<real_t>(v_[k]);
+        d_[q] = dq * dq + f_[v_[k]];
+    }
+}
+
+}
+}
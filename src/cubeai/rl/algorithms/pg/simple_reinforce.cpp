@@ -11,15 +11,15 @@ namespace algos {
 namespace pg {
 
 std::ostream&
-ReinforceOpts::print(std::ostream& out)const{
+ReinforceConfig::print(std::ostream& out)const{
 
-    out<<"Max num episodes=    "<<max_num_of_episodes<<std::endl;
     out<<"Max its per episode= "<<max_itrs_per_episode<<std::endl;
-    out<<"Print frequency=     "<<print_frequency<<std::endl;
-    out<<"Score queue maz size="<<scores_queue_max_size<<std::endl;
+    out<<"Episodes per update= "<<n_episodes_per_update<<std::endl;
     out<<"Gamma=               "<<gamma<<std::endl;
-    out<<"Exit tolerance=      "<<tolerance<<std::endl;
-    out<<"Exit score level=    "<<exit_score_level<<std::endl;
+    out<<"Use baseline=        "<<std::boolalpha<<use_baseline<<std::endl;
+    out<<"Normalize returns=   "<<std::boolalpha<<normalize_returns<<std::endl;
+    out<<"Max grad norm=       "<<max_grad_norm<<std::endl;
+    out<<"Use inference mode=  "<<std::boolalpha<<use_inference_mode<<std::endl;
     return out;
 }
 
@@ -31,13 +31,6 @@ calculate_discounted_return(const std::vector<real_t>& rewards, real_t gamma){
     return discounted_reward;
 }
 
-#ifdef USE_PYTORCH
-std::vector<real_t>
-calculate_discounted_returns(torch_tensor_t /*reward*/, torch_tensor_t /*discounts*/, uint_t /*n_workers*/){
-    return std::vector<real_t>();
-}
-#endif
-
 }
 }
 }
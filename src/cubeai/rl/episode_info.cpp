@@ -6,11 +6,10 @@ namespace rl{
 std::ostream&
 EpisodeInfo::print(std::ostream& out)const noexcept{
 
-    out<<"Episode index........: "<<episode_index<<std::endl;
-    out<<"Episode iterations...: "<<episode_iterations<<std::endl;
-    out<<"Episode reward.......: "<<episode_reward<<std::endl;
-    out<<"Episode time.........: "<<total_time.count()<<std::endl;
-    out<<"Has extra............: "<<std::boolalpha<<!info.empty()<<std::endl;
+    out<<"Episode index........: "<<episode_index<<'\n';
+    out<<"Episode iterations...: "<<episode_iterations<<'\n';
+    out<<"Episode reward.......: "<<episode_reward<<'\n';
+    out<<"Episode time.........: "<<total_time.count()<<'\n';
     return out;
 }
 
@@ -0,0 +1,158 @@
+#include "cubeai/rl/episode_log_sink.h"
+
+namespace cubeai{
+namespace rl{
+
+namespace{
+
+uint_t
+next_power_of_two(uint_t n){
+
+    uint_t result = 1;
+    while(result < n){
+        result <<= 1;
+    }
+
+    return result;
+}
+
+}
+
+AsyncEpisodeLogSink::AsyncEpisodeLogSink(std::ostream& out, uint_t capacity,
+                                         std::chrono::milliseconds flush_interval,
+                                         LogOverflowPolicy overflow)
+    :
+      out_(out),
+      flush_interval_(flush_interval),
+      overflow_(overflow),
+      ring_(next_power_of_two(capacity)),
+      mask_(ring_.size() - 1),
+      head_(0),
+      tail_(0),
+      n_dropped_(0),
+      n_written_(0),
+      n_reported_dropped_(0),
+      mutex_(),
+      writer_cv_(),
+      room_cv_(),
+      writer_thread_(),
+      stop_writer_(false),
+      wake_writer_(false)
+{}
+
+AsyncEpisodeLogSink::~AsyncEpisodeLogSink(){
+    stop();
+}
+
+void
+AsyncEpisodeLogSink::start(){
+
+    if(writer_thread_.joinable()){
+        return;
+    }
+
+    stop_writer_ = false;
+    wake_writer_ = false;
+    writer_thread_ = std::thread(&AsyncEpisodeLogSink::writer_loop_, this);
+}
+
+void
+AsyncEpisodeLogSink::stop(){
+
+    if(writer_thread_.joinable()){
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_writer_ = true;
+        }
+
+        writer_cv_.notify_one();
+        writer_thread_.join();
+    }
+
+    // anything pushed whilst the thread was not running
+    drain_();
+
+    const auto n_dropped = n_dropped_.load(std::memory_order_relaxed);
+    if(n_dropped != n_reported_dropped_){
+        out_<<"AsyncEpisodeLogSink dropped "<<n_dropped - n_reported_dropped_
+            <<" episode records because the ring was full"<<std::endl;
+        n_reported_dropped_ = n_dropped;
+    }
+}
+
+void
+AsyncEpisodeLogSink::request_drain_(){
+
+    if(!writer_thread_.joinable()){
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_writer_ = true;
+    }
+
+    writer_cv_.notify_one();
+}
+
+void
+AsyncEpisodeLogSink::wait_for_room_(uint_t head)noexcept{
+
+    // without a writer the producer is the only thread
+    // touching the ring and can drain it itself
+    if(!writer_thread_.joinable()){
+        drain_();
+        return;
+    }
+
+    // sleep rather than spin so that the writer
+    // gets the core when the two share one
+    request_drain_();
+    std::unique_lock<std::mutex> lock(mutex_);
+    room_cv_.wait(lock, [this, head](){return head - tail_.load(std::memory_order_acquire) < ring_.size();});
+}
+
+void
+AsyncEpisodeLogSink::writer_loop_(){
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(!stop_writer_){
+
+        writer_cv_.wait_for(lock, flush_interval_, [this](){return stop_writer_ || wake_writer_;});
+        wake_writer_ = false;
+
+        lock.unlock();
+        drain_();
+        lock.lock();
+
+        // notified under the mutex so that a producer
+        // that just found the ring full cannot miss it
+        room_cv_.notify_one();
+    }
+}
+
+void
+AsyncEpisodeLogSink::drain_(){
+
+    auto tail = tail_.load(std::memory_order_relaxed);
+    const auto head = head_.load(std::memory_order_acquire);
+
+    if(tail == head){
+        return;
+    }
+
+    for(; tail != head; ++tail){
+
+        ring_[tail & mask_].print(out_)<<'\n';
+    }
+
+    out_.flush();
+
+    n_written_.store(n_written_.load(std::memory_order_relaxed) + (head - tail_.load(std::memory_order_relaxed)),
+                     std::memory_order_relaxed);
+    tail_.store(head, std::memory_order_release);
+}
+
+}
+}
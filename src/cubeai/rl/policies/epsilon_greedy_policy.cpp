@@ -2,6 +2,7 @@
 
 #include "cubeai/base/cubeai_types.h"
 #include "cubeai/base/cubeai_config.h"
+#include "cubeai/io/binary_checkpoint.h"
 
 #ifdef CUBEAI_DEBUG
 #include <cassert>
@@ -71,6 +72,22 @@ EpsilonGreedyPolicy::on_episode(uint_t episode)noexcept{
     }
 }
 
+void
+EpsilonGreedyPolicy::save_checkpoint(io::Checkpoint& checkpoint, const std::string& prefix)const{
+
+    checkpoint.add_scalar(prefix + "eps", eps_);
+    checkpoint.add_rng(prefix + "generator", generator_);
+    random_policy_.save_checkpoint(checkpoint, prefix + "random_policy.");
+}
+
+void
+EpsilonGreedyPolicy::load_checkpoint(const io::MappedCheckpoint& checkpoint, const std::string& prefix){
+
+    eps_ = checkpoint.scalar<real_t>(prefix + "eps");
+    checkpoint.load_rng(prefix + "generator", generator_);
+    random_policy_.load_checkpoint(checkpoint, prefix + "random_policy.");
+}
+
 }
 }
 }
@@ -4,6 +4,7 @@
 #include "cubeai/rl/policies/random_tabular_policy.h"
 #include "cubeai/base/cubeai_types.h"
 #include "cubeai/base/cubeai_config.h"
+#include "cubeai/io/binary_checkpoint.h"
 
 #ifdef CUBEAI_DEBUG
 #include <cassert>
@@ -20,6 +21,15 @@ RandomTabularPolicy::RandomTabularPolicy(uint_t seed)
 generator_(seed)
 {}
 
+void
+RandomTabularPolicy::save_checkpoint(io::Checkpoint& checkpoint, const std::string& prefix)const{
+    checkpoint.add_rng(prefix + "generator", generator_);
+}
+
+void
+RandomTabularPolicy::load_checkpoint(const io::MappedCheckpoint& checkpoint, const std::string& prefix){
+    checkpoint.load_rng(prefix + "generator", generator_);
+}
 
 
 template<>
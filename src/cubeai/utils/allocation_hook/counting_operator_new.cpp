@@ -0,0 +1,87 @@
+///
+/// Replaces the global operator new so that every allocation increments
+/// InstrumentationCounter::ALLOCATIONS whilst the instrumentation is
+/// enabled. The file is not part of cubeailib. An executable opts in by
+/// linking the objects of the cubeai_allocation_hook target. Every form
+/// is replaced, tools such as the address sanitizer otherwise pair their
+/// own versions of the forms left out with the free of this file
+///
+
+#include "cubeai/utils/instrumentation.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace{
+
+///
+/// \brief Set whilst the calling thread records an allocation.
+/// Registering the instrumentation block of a thread allocates
+/// and these allocations are not counted
+///
+thread_local bool recording = false;
+
+void
+count_allocation()noexcept{
+
+    if(recording || !cubeai::utils::Instrumentation::is_enabled()){
+        return;
+    }
+
+    recording = true;
+    cubeai::utils::Instrumentation::increment(cubeai::utils::InstrumentationCounter::ALLOCATIONS);
+    recording = false;
+}
+
+void*
+allocate(std::size_t size)noexcept{
+
+    count_allocation();
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void*
+allocate(std::size_t size, std::align_val_t alignment)noexcept{
+
+    count_allocation();
+
+    // aligned_alloc needs a size that is a multiple of the alignment
+    const auto align = static_cast<std::size_t>(alignment);
+    return std::aligned_alloc(align, size == 0 ? align : (size + align - 1) / align * align);
+}
+
+template<typename... Args>
+void*
+allocate_or_throw(std::size_t size, Args... args){
+
+    if(auto* p = allocate(size, args...)){
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+}
+
+void* operator new(std::size_t size){return allocate_or_throw(size);}
+void* operator new[](std::size_t size){return allocate_or_throw(size);}
+void* operator new(std::size_t size, std::align_val_t alignment){return allocate_or_throw(size, alignment);}
+void* operator new[](std::size_t size, std::align_val_t alignment){return allocate_or_throw(size, alignment);}
+
+void* operator new(std::size_t size, const std::nothrow_t&)noexcept{return allocate(size);}
+void* operator new[](std::size_t size, const std::nothrow_t&)noexcept{return allocate(size);}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&)noexcept{return allocate(size, alignment);}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&)noexcept{return allocate(size, alignment);}
+
+void operator delete(void* p)noexcept{std::free(p);}
+void operator delete[](void* p)noexcept{std::free(p);}
+void operator delete(void* p, std::size_t)noexcept{std::free(p);}
+void operator delete[](void* p, std::size_t)noexcept{std::free(p);}
+void operator delete(void* p, std::align_val_t)noexcept{std::free(p);}
+void operator delete[](void* p, std::align_val_t)noexcept{std::free(p);}
+void operator delete(void* p, std::size_t, std::align_val_t)noexcept{std::free(p);}
+void operator delete[](void* p, std::size_t, std::align_val_t)noexcept{std::free(p);}
+void operator delete(void* p, const std::nothrow_t&)noexcept{std::free(p);}
+void operator delete[](void* p, const std::nothrow_t&)noexcept{std::free(p);}
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&)noexcept{std::free(p);}
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&)noexcept{std::free(p);}
@@ -0,0 +1,240 @@
+#include "cubeai/utils/instrumentation.h"
+#include "cubeai/io/csv_file_writer.h"
+#include "cubeai/io/tensorboard_server.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace cubeai {
+namespace utils {
+
+namespace{
+
+///
+/// \brief Registry of the blocks of all the threads that
+/// recorded something. Blocks are never released so that the
+/// values of finished threads are still reported
+///
+std::mutex&
+registry_mutex(){
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::vector<std::unique_ptr<detail::instrumentation_block>>&
+registry(){
+    static std::vector<std::unique_ptr<detail::instrumentation_block>> blocks;
+    return blocks;
+}
+
+}
+
+std::atomic<bool> Instrumentation::enabled_{false};
+
+std::string
+to_string(InstrumentationPhase phase){
+
+    switch(phase){
+        case InstrumentationPhase::ENV_STEP:
+            return "env_step";
+        case InstrumentationPhase::ACTION_SELECTION:
+            return "action_selection";
+        case InstrumentationPhase::LOSS:
+            return "loss";
+        case InstrumentationPhase::UPDATE:
+            return "update";
+        case InstrumentationPhase::LOGGING:
+            return "logging";
+        case InstrumentationPhase::CHECKPOINT:
+            return "checkpoint";
+        default:
+            break;
+    }
+
+    return "INVALID_PHASE";
+}
+
+std::string
+to_string(InstrumentationCounter counter){
+
+    switch(counter){
+        case InstrumentationCounter::STEPS:
+            return "steps";
+        case InstrumentationCounter::UPDATES:
+            return "updates";
+        case InstrumentationCounter::ALLOCATIONS:
+            return "allocations";
+        default:
+            break;
+    }
+
+    return "INVALID_COUNTER";
+}
+
+InstrumentationSnapshot
+InstrumentationSnapshot::operator-(const InstrumentationSnapshot& other)const noexcept{
+
+    InstrumentationSnapshot result;
+    for(uint_t p=0; p<N_INSTRUMENTATION_PHASES; ++p){
+        result.phase_time_ns[p] = phase_time_ns[p] - other.phase_time_ns[p];
+        result.phase_calls[p] = phase_calls[p] - other.phase_calls[p];
+    }
+
+    for(uint_t c=0; c<N_INSTRUMENTATION_COUNTERS; ++c){
+        result.counters[c] = counters[c] - other.counters[c];
+    }
+
+    return result;
+}
+
+namespace detail{
+
+instrumentation_block&
+local_instrumentation_block(){
+
+    thread_local instrumentation_block* block = nullptr;
+
+    if(block == nullptr){
+
+        auto new_block = std::make_unique<instrumentation_block>();
+        block = new_block.get();
+
+        std::lock_guard<std::mutex> lock(registry_mutex());
+        registry().push_back(std::move(new_block));
+    }
+
+    return *block;
+}
+
+}
+
+InstrumentationSnapshot
+Instrumentation::snapshot(){
+
+    InstrumentationSnapshot result;
+
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    for(const auto& block : registry()){
+
+        for(uint_t p=0; p<N_INSTRUMENTATION_PHASES; ++p){
+            result.phase_time_ns[p] += block->phase_time_ns[p].load(std::memory_order_relaxed);
+            result.phase_calls[p] += block->phase_calls[p].load(std::memory_order_relaxed);
+        }
+
+        for(uint_t c=0; c<N_INSTRUMENTATION_COUNTERS; ++c){
+            result.counters[c] += block->counters[c].load(std::memory_order_relaxed);
+        }
+    }
+
+    return result;
+}
+
+void
+Instrumentation::reset(){
+
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    for(auto& block : registry()){
+
+        for(uint_t p=0; p<N_INSTRUMENTATION_PHASES; ++p){
+            block->phase_time_ns[p].store(0, std::memory_order_relaxed);
+            block->phase_calls[p].store(0, std::memory_order_relaxed);
+        }
+
+        for(uint_t c=0; c<N_INSTRUMENTATION_COUNTERS; ++c){
+            block->counters[c].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void
+EpisodeInstrumentationRecorder::start(){
+
+    records_.clear();
+    last_ = Instrumentation::snapshot();
+}
+
+void
+EpisodeInstrumentationRecorder::on_episode_end(uint_t episode_index, real_t episode_time){
+
+    auto current = Instrumentation::snapshot();
+    records_.push_back({episode_index, episode_time, current - last_});
+    last_ = current;
+}
+
+void
+EpisodeInstrumentationRecorder::write_csv(const std::string& filename)const{
+
+    io::CSVWriter writer(filename, ',');
+    writer.open();
+
+    std::vector<std::string> col_names;
+    col_names.push_back("episode_index");
+    col_names.push_back("episode_time");
+
+    for(uint_t p=0; p<N_INSTRUMENTATION_PHASES; ++p){
+        auto name = to_string(static_cast<InstrumentationPhase>(p));
+        col_names.push_back(name + "_time");
+        col_names.push_back(name + "_calls");
+    }
+
+    for(uint_t c=0; c<N_INSTRUMENTATION_COUNTERS; ++c){
+        col_names.push_back(to_string(static_cast<InstrumentationCounter>(c)));
+    }
+
+    col_names.push_back("steps_per_sec");
+    col_names.push_back("updates_per_sec");
+
+    writer.write_column_names(col_names);
+
+    std::vector<real_t> row;
+    row.reserve(col_names.size());
+
+    for(const auto& record : records_){
+
+        row.clear();
+        row.push_back(static_cast<real_t>(record.episode_index));
+        row.push_back(record.episode_time);
+
+        for(uint_t p=0; p<N_INSTRUMENTATION_PHASES; ++p){
+            auto phase = static_cast<InstrumentationPhase>(p);
+            row.push_back(record.values.phase_time(phase));
+            row.push_back(static_cast<real_t>(record.values.calls(phase)));
+        }
+
+        for(uint_t c=0; c<N_INSTRUMENTATION_COUNTERS; ++c){
+            row.push_back(static_cast<real_t>(record.values.count(static_cast<InstrumentationCounter>(c))));
+        }
+
+        row.push_back(record.rate(InstrumentationCounter::STEPS));
+        row.push_back(record.rate(InstrumentationCounter::UPDATES));
+        writer.write_row(row);
+    }
+
+    writer.close();
+}
+
+void
+EpisodeInstrumentationRecorder::log_to_tensorboard(const io::TensorboardServer& server,
+                                                   const std::string& main_tag)const{
+
+    std::unordered_map<std::string, real_t> phase_times;
+    std::unordered_map<std::string, real_t> rates;
+
+    for(const auto& record : records_){
+
+        for(uint_t p=0; p<N_INSTRUMENTATION_PHASES; ++p){
+            auto phase = static_cast<InstrumentationPhase>(p);
+            phase_times[to_string(phase)] = record.values.phase_time(phase);
+        }
+
+        rates["steps_per_sec"] = record.rate(InstrumentationCounter::STEPS);
+        rates["updates_per_sec"] = record.rate(InstrumentationCounter::UPDATES);
+
+        server.add_scalars(main_tag + "/phase_time", phase_times, record.episode_index);
+        server.add_scalars(main_tag + "/rates", rates, record.episode_index);
+    }
+}
+
+}
+}
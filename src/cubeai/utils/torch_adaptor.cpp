@@ -29,6 +29,34 @@ TorchAdaptor::stack(const std::vector<value_type>& values)const{
     return torch::stack(values, 0);
 }
 
+void
+TorchStagingTensor::allocate(torch::IntArrayRef shape, torch::Device device, torch::ScalarType dtype){
+
+    device_ = device;
+
+    auto options = torch::TensorOptions().dtype(dtype);
+    if(device_.is_cuda()){
+
+        staging_ = torch::empty(shape, options.pinned_memory(true));
+        device_tensor_ = torch::empty(shape, options.device(device_));
+    }
+    else{
+        staging_ = torch::zeros(shape, options);
+        device_tensor_ = torch_tensor_t();
+    }
+}
+
+torch_tensor_t
+TorchStagingTensor::to_device(){
+
+    if(!device_.is_cuda()){
+        return staging_;
+    }
+
+    device_tensor_.copy_(staging_, /*non_blocking=*/true);
+    return device_tensor_;
+}
+
 }
 
 }
@@ -0,0 +1,190 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/data_structs/boost_serial_graph.h"
+#include "cubeai/planning/a_star_search.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::AStarSearch;
+using cubeai::BoostSerialGraph;
+using cubeai::astar_impl::IndexedMinHeap;
+
+///
+/// 4-connected grid with unit costs and random obstacles
+///
+struct TestGrid
+{
+    uint_t nx;
+    uint_t ny;
+    std::vector<bool> blocked;
+
+    TestGrid(uint_t nx_, uint_t ny_, real_t density, uint_t seed)
+        :
+          nx(nx_),
+          ny(ny_),
+          blocked(nx_ * ny_, false)
+    {
+        std::mt19937 gen(seed);
+        std::bernoulli_distribution dist(density);
+        for(uint_t i=0; i<blocked.size(); ++i){
+            blocked[i] = dist(gen);
+        }
+    }
+
+    uint_t n_vertices()const{return nx * ny;}
+
+    template<typename Fn>
+    void for_each_neighbor(uint_t v, Fn&& fn)const{
+
+        const auto x = v % nx;
+        const auto y = v / nx;
+
+        if(x > 0 && !blocked[v - 1]) fn(v - 1, 1.0);
+        if(x + 1 < nx && !blocked[v + 1]) fn(v + 1, 1.0);
+        if(y > 0 && !blocked[v - nx]) fn(v - nx, 1.0);
+        if(y + 1 < ny && !blocked[v + nx]) fn(v + nx, 1.0);
+    }
+
+    real_t manhattan(uint_t v, uint_t goal)const{
+
+        const auto dx = std::abs(static_cast<long>(v % nx) - static_cast<long>(goal % nx));
+        const auto dy = std::abs(static_cast<long>(v / nx) - static_cast<long>(goal / nx));
+        return static_cast<real_t>(dx + dy);
+    }
+};
+
+struct VertexData
+{
+    real_t x{0.0};
+    real_t y{0.0};
+    bool can_move()const{return true;}
+};
+
+struct EuclideanDistance
+{
+    typedef real_t cost_type;
+
+    template<typename VertexTp>
+    real_t operator()(const VertexTp& v1, const VertexTp& v2)const{
+        return std::sqrt((v1.data.x - v2.data.x) * (v1.data.x - v2.data.x) +
+                         (v1.data.y - v2.data.y) * (v1.data.y - v2.data.y));
+    }
+};
+
+}
+
+TEST(TestAStarSearch, Test_indexed_heap) {
+
+    IndexedMinHeap<real_t> heap;
+    heap.resize(10);
+
+    heap.push(0, 5.0);
+    heap.push(1, 3.0);
+    heap.push(2, 4.0);
+    heap.push(3, 1.0);
+    heap.decrease_key(0, 0.5);
+    heap.update(3, 6.0);
+    heap.erase(2);
+
+    ASSERT_EQ(heap.size(), 3);
+    ASSERT_FALSE(heap.contains(2));
+
+    ASSERT_EQ(heap.pop(), 0);
+    ASSERT_EQ(heap.pop(), 1);
+    ASSERT_EQ(heap.pop(), 3);
+    ASSERT_TRUE(heap.empty());
+}
+
+TEST(TestAStarSearch, Test_matches_dijkstra) {
+
+    TestGrid grid(60, 40, 0.25, 42);
+    grid.blocked[0] = false;
+
+    AStarSearch<real_t> astar;
+    AStarSearch<real_t> dijkstra;
+
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<uint_t> dist(0, grid.n_vertices() - 1);
+
+    // the same engines serve all the queries
+    for(uint_t q=0; q<50; ++q){
+
+        const auto goal = dist(gen);
+        if(grid.blocked[goal]){
+            continue;
+        }
+
+        auto found = astar.search(grid, 0, goal, [&](uint_t v){return grid.manhattan(v, goal);});
+        auto found_dijkstra = dijkstra.search(grid, 0, goal, [](uint_t){return 0.0;});
+
+        ASSERT_EQ(found, found_dijkstra);
+
+        if(!found){
+            ASSERT_TRUE(astar.path(goal).empty());
+            continue;
+        }
+
+        ASSERT_DOUBLE_EQ(astar.g_cost(goal), dijkstra.g_cost(goal));
+        ASSERT_LE(astar.n_expanded(), dijkstra.n_expanded());
+
+        auto path = astar.path(goal);
+        ASSERT_EQ(path.front(), 0);
+        ASSERT_EQ(path.back(), goal);
+        ASSERT_EQ(static_cast<real_t>(path.size() - 1), astar.g_cost(goal));
+    }
+}
+
+TEST(TestAStarSearch, Test_unreachable_goal) {
+
+    TestGrid grid(5, 5, 0.0, 42);
+
+    // wall off the last column
+    for(uint_t y=0; y<5; ++y){
+        grid.blocked[y * 5 + 3] = true;
+    }
+
+    AStarSearch<real_t> astar;
+    ASSERT_FALSE(astar.search(grid, 0, 4, [&](uint_t v){return grid.manhattan(v, 4);}));
+    ASSERT_FALSE(astar.reached(4));
+    ASSERT_EQ(astar.g_cost(4), std::numeric_limits<real_t>::infinity());
+
+    // a new query forgets the previous one
+    ASSERT_TRUE(astar.search(grid, 0, 2, [&](uint_t v){return grid.manhattan(v, 2);}));
+    ASSERT_EQ(astar.g_cost(2), 2.0);
+    ASSERT_THROW(astar.search(grid, 0, 25, [](uint_t){return 0.0;}), std::logic_error);
+}
+
+TEST(TestAStarSearch, Test_boost_serial_graph) {
+
+    // 0 - 1 - 2
+    // |       |
+    // 3 ----- 4
+    BoostSerialGraph<VertexData, void> graph;
+    graph.add_vertex({0.0, 0.0});
+    graph.add_vertex({1.0, 0.0});
+    graph.add_vertex({2.0, 0.0});
+    graph.add_vertex({0.0, -1.0});
+    graph.add_vertex({2.0, -1.0});
+
+    graph.add_edge(0, 1);
+    graph.add_edge(1, 2);
+    graph.add_edge(0, 3);
+    graph.add_edge(3, 4);
+    graph.add_edge(4, 2);
+
+    auto& start = graph.get_vertex(0);
+    auto& end = graph.get_vertex(2);
+
+    auto came_from = cubeai::a_star_search(graph, start, end, EuclideanDistance());
+    auto path = cubeai::reconstruct_a_star_path(came_from, end.id);
+
+    ASSERT_EQ(path, (std::vector<uint_t>{0, 1, 2}));
+}
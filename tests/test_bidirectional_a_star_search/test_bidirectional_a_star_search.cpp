@@ -0,0 +1,234 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/data_structs/boost_serial_graph.h"
+#include "cubeai/data_structs/grid_graph.h"
+#include "cubeai/planning/a_star_search.h"
+#include "cubeai/planning/bidirectional_a_star_search.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::GridGraph;
+using cubeai::GridConnectivity;
+using cubeai::AStarSearch;
+using cubeai::BidirectionalAStarSearch;
+using cubeai::BoostSerialGraph;
+
+///
+/// Directed graph given as adjacency lists
+///
+struct DirectedGraph
+{
+    struct Edge
+    {
+        uint_t to;
+        real_t cost;
+    };
+
+    std::vector<std::vector<Edge>> adjacency;
+
+    uint_t n_vertices()const{return adjacency.size();}
+
+    template<typename Fn>
+    void for_each_neighbor(uint_t v, Fn&& fn)const{
+        for(const auto& e : adjacency[v]){
+            fn(e.to, e.cost);
+        }
+    }
+
+    DirectedGraph reversed()const{
+
+        DirectedGraph r;
+        r.adjacency.resize(adjacency.size());
+        for(uint_t v=0; v<adjacency.size(); ++v){
+            for(const auto& e : adjacency[v]){
+                r.adjacency[e.to].push_back({v, e.cost});
+            }
+        }
+
+        return r;
+    }
+};
+
+struct VertexData
+{
+    real_t x{0.0};
+    real_t y{0.0};
+    bool can_move()const{return true;}
+};
+
+struct EuclideanDistance
+{
+    typedef real_t cost_type;
+
+    template<typename VertexTp>
+    real_t operator()(const VertexTp& v1, const VertexTp& v2)const{
+        return std::sqrt((v1.data.x - v2.data.x) * (v1.data.x - v2.data.x) +
+                         (v1.data.y - v2.data.y) * (v1.data.y - v2.data.y));
+    }
+};
+
+template<typename GraphTp>
+real_t
+path_cost(const GraphTp& graph, const std::vector<uint_t>& path){
+
+    real_t cost = 0.0;
+    for(uint_t i=1; i<path.size(); ++i){
+
+        auto edge = std::numeric_limits<real_t>::infinity();
+        graph.for_each_neighbor(path[i - 1], [&](uint_t w, real_t c){
+            if(w == path[i]){
+                edge = std::min(edge, c);
+            }
+        });
+
+        cost += edge;
+    }
+
+    return cost;
+}
+
+}
+
+TEST(TestBidirectionalAStarSearch, Test_matches_a_star_on_grid) {
+
+    GridGraph<2> grid({80, 60}, GridConnectivity::FULL);
+
+    std::mt19937 gen(42);
+    std::bernoulli_distribution blocked(0.3);
+    for(uint_t v=0; v<grid.n_vertices(); ++v){
+        grid.set_blocked(v, blocked(gen));
+    }
+
+    AStarSearch<real_t> astar;
+    BidirectionalAStarSearch<real_t> sequential;
+    BidirectionalAStarSearch<real_t> concurrent(0, true);
+    ASSERT_TRUE(concurrent.is_concurrent());
+
+    std::uniform_int_distribution<uint_t> dist(0, grid.n_vertices() - 1);
+    for(uint_t q=0; q<100; ++q){
+
+        const auto start = dist(gen);
+        const auto goal = dist(gen);
+        if(grid.is_blocked(start) || grid.is_blocked(goal)){
+            continue;
+        }
+
+        auto h_goal = [&](uint_t v){return grid.heuristic(v, goal);};
+        auto h_start = [&](uint_t v){return grid.heuristic(start, v);};
+
+        const auto found = astar.search(grid, start, goal, h_goal);
+
+        for(auto* engine : {&sequential, &concurrent}){
+
+            ASSERT_EQ(engine -> search(grid, start, goal, h_goal, h_start), found);
+
+            if(!found){
+                ASSERT_TRUE(engine -> path().empty());
+                ASSERT_EQ(engine -> cost(), std::numeric_limits<real_t>::infinity());
+                continue;
+            }
+
+            ASSERT_NEAR(engine -> cost(), astar.g_cost(goal), 1.0e-9);
+
+            auto path = engine -> path();
+            ASSERT_EQ(path.front(), start);
+            ASSERT_EQ(path.back(), goal);
+            ASSERT_NEAR(path_cost(grid, path), astar.g_cost(goal), 1.0e-9);
+        }
+    }
+}
+
+TEST(TestBidirectionalAStarSearch, Test_directed_graph) {
+
+    // random directed graph, the
+    // costs differ in the two directions
+    const uint_t n = 300;
+    DirectedGraph graph;
+    graph.adjacency.resize(n);
+
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<uint_t> vertex(0, n - 1);
+    std::uniform_real_distribution<real_t> cost(1.0, 10.0);
+    for(uint_t e=0; e<4 * n; ++e){
+        graph.adjacency[vertex(gen)].push_back({vertex(gen), cost(gen)});
+    }
+
+    const auto reverse = graph.reversed();
+
+    AStarSearch<real_t> dijkstra;
+    BidirectionalAStarSearch<real_t> engine;
+    auto zero = [](uint_t){return 0.0;};
+
+    for(uint_t q=0; q<100; ++q){
+
+        const auto start = vertex(gen);
+        const auto goal = vertex(gen);
+
+        const auto found = dijkstra.search(graph, start, goal, zero);
+        ASSERT_EQ(engine.search(graph, reverse, start, goal, zero, zero), found);
+
+        if(found){
+            ASSERT_NEAR(engine.cost(), dijkstra.g_cost(goal), 1.0e-9);
+            ASSERT_NEAR(path_cost(graph, engine.path()), dijkstra.g_cost(goal), 1.0e-9);
+            ASSERT_LE(engine.n_expanded(), engine.n_expanded_forward() + engine.n_expanded_backward());
+        }
+    }
+}
+
+TEST(TestBidirectionalAStarSearch, Test_trivial_queries) {
+
+    GridGraph<2> grid({5, 5}, GridConnectivity::FACE);
+
+    // wall off the last column
+    for(uint_t y=0; y<5; ++y){
+        grid.set_blocked(grid.id({3, y}));
+    }
+
+    BidirectionalAStarSearch<real_t> engine;
+    auto h_goal = [&](uint_t v){return grid.heuristic(v, 4);};
+    auto h_start = [&](uint_t v){return grid.heuristic(0, v);};
+
+    ASSERT_FALSE(engine.search(grid, 0, 4, h_goal, h_start));
+    ASSERT_EQ(engine.meeting_vertex(), BidirectionalAStarSearch<real_t>::npos);
+
+    ASSERT_TRUE(engine.search(grid, 2, 2, h_goal, h_start));
+    ASSERT_EQ(engine.cost(), 0.0);
+    ASSERT_EQ(engine.path(), (std::vector<uint_t>{2}));
+
+    ASSERT_THROW(engine.search(grid, 0, 25, h_goal, h_start), std::logic_error);
+}
+
+TEST(TestBidirectionalAStarSearch, Test_boost_serial_graph) {
+
+    // 0 - 1 - 2
+    // |       |
+    // 3 ----- 4
+    BoostSerialGraph<VertexData, void> graph;
+    graph.add_vertex({0.0, 0.0});
+    graph.add_vertex({1.0, 0.0});
+    graph.add_vertex({2.0, 0.0});
+    graph.add_vertex({0.0, -1.0});
+    graph.add_vertex({2.0, -1.0});
+
+    graph.add_edge(0, 1);
+    graph.add_edge(1, 2);
+    graph.add_edge(0, 3);
+    graph.add_edge(3, 4);
+    graph.add_edge(4, 2);
+
+    auto& start = graph.get_vertex(0);
+    auto& end = graph.get_vertex(2);
+
+    auto path = cubeai::bidirectional_a_star_search(graph, start, end, EuclideanDistance());
+    ASSERT_EQ(path, (std::vector<uint_t>{0, 1, 2}));
+
+    auto concurrent_path = cubeai::bidirectional_a_star_search(graph, start, end, EuclideanDistance(), true);
+    ASSERT_EQ(concurrent_path, (std::vector<uint_t>{0, 1, 2}));
+}
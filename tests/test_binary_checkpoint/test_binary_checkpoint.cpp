@@ -0,0 +1,444 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/io/binary_checkpoint.h"
+#include "cubeai/rl/policies/epsilon_greedy_policy.h"
+#include "cubeai/rl/algorithms/td/q_learning.h"
+#include "cubeai/rl/algorithms/td/double_q_learning.h"
+#include "cubeai/rl/trainers/rl_serial_agent_trainer.h"
+#include "cubeai/rl/episode_info.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::DynMat;
+using cubeai::DynVec;
+using cubeai::io::Checkpoint;
+using cubeai::io::MappedCheckpoint;
+using cubeai::io::AsyncCheckpointWriter;
+using cubeai::io::write_checkpoint;
+using cubeai::rl::policies::EpsilonGreedyPolicy;
+using cubeai::rl::policies::EpsilonDecayOption;
+using cubeai::rl::algos::td::QLearning;
+using cubeai::rl::algos::td::QLearningConfig;
+using cubeai::rl::algos::td::DoubleQLearning;
+using cubeai::rl::algos::td::DoubleQLearningConfig;
+using cubeai::rl::RLSerialAgentTrainer;
+using cubeai::rl::RLSerialTrainerConfig;
+using cubeai::rl::EpisodeInfo;
+
+// a chain of states. Action 0 moves right and action 1 stays.
+// Entering the last state pays 1 and ends the episode
+struct ChainEnv
+{
+    typedef uint_t state_type;
+    typedef uint_t action_type;
+
+    struct time_step_type
+    {
+        uint_t state;
+        real_t r;
+        bool is_done;
+
+        uint_t observation()const{return state;}
+        real_t reward()const{return r;}
+        bool done()const{return is_done;}
+    };
+
+    uint_t current{0};
+
+    uint_t n_states()const{return 5;}
+    uint_t n_actions()const{return 2;}
+
+    time_step_type reset(){current = 0; return {current, 0.0, false};}
+
+    time_step_type step(uint_t action){
+
+        if(action == 0){
+            ++current;
+        }
+
+        const auto done = current + 1 == n_states();
+        return {current, done ? 1.0 : 0.0, done};
+    }
+};
+
+// the decay keeps exploring for the first few tens
+// of episodes so the random engines matter
+EpsilonGreedyPolicy
+make_policy(uint_t seed){
+    return EpsilonGreedyPolicy(1.0, seed, EpsilonDecayOption::EXPONENTIAL, 0.01, 1.0, 0.05);
+}
+
+QLearningConfig
+make_q_learning_config(){
+
+    QLearningConfig config;
+    config.n_episodes = 0;
+    config.tolerance = 1.0e-8;
+    config.gamma = 0.9;
+    config.eta = 0.5;
+    config.max_num_iterations_per_episode = 20;
+    return config;
+}
+
+template<typename AgentTp>
+void
+run_episodes(AgentTp& agent, ChainEnv& env, uint_t begin, uint_t end){
+
+    for(uint_t e=begin; e<end; ++e){
+
+        agent.actions_before_episode_begins(env, e);
+        auto info = agent.on_training_episode(env, e);
+        agent.actions_after_episode_ends(env, e, info);
+    }
+}
+
+// greedy selector that records the episode indices
+// it is given, e.g. to drive an epsilon schedule
+struct RecordingSelector
+{
+    std::vector<uint_t>* episodes;
+
+    uint_t operator()(const DynMat<real_t>& q_table, uint_t state)const{
+
+        DynMat<real_t>::Index action;
+        q_table.row(state).maxCoeff(&action);
+        return action;
+    }
+
+    void on_episode(uint_t episode_idx){episodes->push_back(episode_idx);}
+};
+
+// moves twice and then stays once
+struct DoubleQSelector
+{
+    uint_t n_calls{0};
+
+    uint_t operator()(const DynMat<real_t>&, const DynMat<real_t>&, uint_t){return n_calls++ % 3 == 2 ? 1 : 0;}
+    void adjust_on_episode(uint_t){}
+};
+
+}
+
+TEST(TestBinaryCheckpoint, Test_round_trip) {
+
+    DynMat<real_t> q_table(3, 2);
+    q_table << 1.0, 2.0,
+               3.0, 4.0,
+               5.0, 6.0;
+
+    DynVec<real_t> values(4);
+    values << 0.5, 1.5, 2.5, 3.5;
+
+    std::mt19937 generator(42);
+    generator.discard(10);
+
+    Checkpoint checkpoint;
+    checkpoint.add("q_table", q_table);
+    checkpoint.add("values", values);
+    checkpoint.add("counts", std::vector<uint_t>{1, 2, 3});
+    checkpoint.add_scalar("episode", static_cast<uint_t>(17));
+    checkpoint.add_bytes("blob", "abc");
+    checkpoint.add_rng("generator", generator);
+
+    const std::string filename = "test_binary_checkpoint_round_trip.bin";
+    write_checkpoint(checkpoint, filename);
+
+    {
+        MappedCheckpoint mapped(filename);
+
+        ASSERT_EQ(mapped.n_entries(), 6);
+        ASSERT_TRUE(mapped.contains("q_table"));
+        ASSERT_FALSE(mapped.contains("missing"));
+
+        auto q_view = mapped.matrix("q_table");
+        ASSERT_EQ(q_view.rows(), 3);
+        ASSERT_EQ(q_view.cols(), 2);
+        ASSERT_TRUE(q_view.isApprox(q_table));
+
+        // the views are aligned
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(q_view.data()) % Checkpoint::ALIGNMENT, 0);
+
+        ASSERT_TRUE(mapped.row_vector("values").isApprox(values));
+
+        std::vector<uint_t> counts;
+        mapped.read("counts", counts);
+        ASSERT_EQ(counts, (std::vector<uint_t>{1, 2, 3}));
+
+        ASSERT_EQ(mapped.scalar<uint_t>("episode"), 17);
+        ASSERT_EQ(mapped.bytes("blob"), "abc");
+
+        std::mt19937 restored;
+        mapped.load_rng("generator", restored);
+        ASSERT_EQ(restored(), generator());
+
+        ASSERT_THROW(mapped.matrix("blob"), std::logic_error);
+        ASSERT_THROW(mapped.entry("missing"), std::logic_error);
+    }
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestBinaryCheckpoint, Test_duplicate_and_invalid_names) {
+
+    Checkpoint checkpoint;
+    checkpoint.add_scalar("a", 1.0);
+
+    ASSERT_THROW(checkpoint.add_scalar("a", 2.0), std::logic_error);
+    ASSERT_THROW(checkpoint.add_scalar("", 2.0), std::logic_error);
+    ASSERT_THROW(checkpoint.add_scalar(std::string(64, 'x'), 2.0), std::logic_error);
+
+    checkpoint.clear();
+    ASSERT_EQ(checkpoint.n_entries(), 0);
+    checkpoint.add_scalar("a", 2.0);
+}
+
+TEST(TestBinaryCheckpoint, Test_invalid_file) {
+
+    const std::string filename = "test_binary_checkpoint_invalid.bin";
+    {
+        std::ofstream out(filename, std::ios::binary);
+        out << std::string(128, 'x');
+    }
+
+    ASSERT_THROW(MappedCheckpoint mapped(filename), std::runtime_error);
+    ASSERT_THROW(MappedCheckpoint mapped("test_binary_checkpoint_does_not_exist.bin"), std::runtime_error);
+    std::remove(filename.c_str());
+}
+
+TEST(TestBinaryCheckpoint, Test_async_writer) {
+
+    const std::string filename = "test_binary_checkpoint_async.bin";
+
+    AsyncCheckpointWriter writer;
+    Checkpoint snapshot;
+
+    for(uint_t i=0; i<5; ++i){
+
+        snapshot.clear();
+        snapshot.add_scalar("step", i);
+        snapshot.add("values", std::vector<real_t>(1000, static_cast<real_t>(i)));
+        writer.submit(snapshot, filename);
+    }
+
+    writer.wait();
+
+    // every snapshot is either written or replaced by a newer one
+    ASSERT_EQ(writer.n_written() + writer.n_skipped(), 5);
+    ASSERT_TRUE(writer.last_error().empty());
+
+    {
+        // the last snapshot is always written
+        MappedCheckpoint mapped(filename);
+        ASSERT_EQ(mapped.scalar<uint_t>("step"), 4);
+        ASSERT_EQ(mapped.data<real_t>("values")[999], 4.0);
+    }
+
+    writer.stop();
+    std::remove(filename.c_str());
+}
+
+TEST(TestBinaryCheckpoint, Test_epsilon_greedy_policy_resume) {
+
+    EpsilonGreedyPolicy policy(0.5, 42);
+    std::vector<real_t> values = {1.0, 2.0, 3.0, 4.0};
+
+    for(uint_t i=0; i<10; ++i){
+        policy(values);
+    }
+
+    Checkpoint checkpoint;
+    policy.save_checkpoint(checkpoint, "policy.");
+
+    const std::string filename = "test_binary_checkpoint_policy.bin";
+    write_checkpoint(checkpoint, filename);
+
+    EpsilonGreedyPolicy resumed(0.1, 7);
+    {
+        MappedCheckpoint mapped(filename);
+        resumed.load_checkpoint(mapped, "policy.");
+    }
+
+    ASSERT_EQ(resumed.eps_value(), policy.eps_value());
+
+    for(uint_t i=0; i<100; ++i){
+        ASSERT_EQ(resumed(values), policy(values));
+    }
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestBinaryCheckpoint, Test_q_learning_save_load) {
+
+    const std::string filename = "test_binary_checkpoint_q_learning.bin";
+
+    ChainEnv env;
+    QLearning<ChainEnv, EpsilonGreedyPolicy> agent(make_q_learning_config(), make_policy(42));
+    agent.actions_before_training_begins(env);
+    run_episodes(agent, env, 0, 10);
+    agent.save(filename);
+
+    // the engines and epsilon of the selector are restored as well
+    QLearning<ChainEnv, EpsilonGreedyPolicy> resumed(make_q_learning_config(), make_policy(7));
+    resumed.load(filename);
+    resumed.actions_before_training_begins(env);
+    ASSERT_TRUE(resumed.q_function() == agent.q_function());
+
+    run_episodes(agent, env, 10, 20);
+    run_episodes(resumed, env, 10, 20);
+    ASSERT_TRUE(resumed.q_function() == agent.q_function());
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestBinaryCheckpoint, Test_double_q_learning_save_load) {
+
+    const std::string filename = "test_binary_checkpoint_double_q_learning.bin";
+    const std::string resumed_filename = "test_binary_checkpoint_double_q_learning_resumed.bin";
+
+    DoubleQLearningConfig config;
+    config.tolerance = 1.0e-8;
+    config.gamma = 0.9;
+    config.eta = 0.5;
+    config.max_num_iterations_per_episode = 10;
+    config.n_episodes = 0;
+
+    ChainEnv env;
+    DoubleQLearning<ChainEnv, DoubleQSelector> agent(config, DoubleQSelector());
+    agent.actions_before_training_begins(env);
+    run_episodes(agent, env, 0, 3);
+    agent.save(filename);
+
+    DoubleQLearning<ChainEnv, DoubleQSelector> resumed(config, DoubleQSelector());
+    resumed.load(filename);
+    resumed.actions_before_training_begins(env);
+    resumed.save(resumed_filename);
+
+    {
+        MappedCheckpoint saved(filename);
+        MappedCheckpoint reloaded(resumed_filename);
+        ASSERT_GT(saved.matrix("q_table_1").cwiseAbs().sum() + saved.matrix("q_table_2").cwiseAbs().sum(), 0.0);
+        ASSERT_TRUE(reloaded.matrix("q_table_1") == saved.matrix("q_table_1"));
+        ASSERT_TRUE(reloaded.matrix("q_table_2") == saved.matrix("q_table_2"));
+    }
+
+    // a table of another shape is rejected
+    struct LongerChainEnv: public ChainEnv{ uint_t n_states()const{return 6;} };
+    DoubleQLearning<LongerChainEnv, DoubleQSelector> mismatched(config, DoubleQSelector());
+    LongerChainEnv longer;
+    mismatched.load(filename);
+    ASSERT_THROW(mismatched.actions_before_training_begins(longer), std::logic_error);
+
+    std::remove(filename.c_str());
+    std::remove(resumed_filename.c_str());
+}
+
+TEST(TestBinaryCheckpoint, Test_trainer_resume) {
+
+    typedef QLearning<ChainEnv, EpsilonGreedyPolicy> agent_type;
+    typedef RLSerialAgentTrainer<ChainEnv, agent_type> trainer_type;
+
+    const std::string filename = "test_binary_checkpoint_trainer.bin";
+    const uint_t n_episodes = 40;
+
+    // the run that is not interrupted
+    ChainEnv env;
+    agent_type reference(make_q_learning_config(), make_policy(42));
+    {
+        RLSerialTrainerConfig config;
+        config.n_episodes = n_episodes;
+        config.tolerance = 1.0e-8;
+        trainer_type trainer(config, reference);
+        trainer.train(env);
+    }
+
+    // the same run stopped half way
+    {
+        agent_type agent(make_q_learning_config(), make_policy(42));
+        RLSerialTrainerConfig config;
+        config.n_episodes = n_episodes / 2;
+        config.tolerance = 1.0e-8;
+        config.checkpoint_frequency = 5;
+        config.checkpoint_path = filename;
+        trainer_type trainer(config, agent);
+        trainer.train(env);
+        ASSERT_EQ(trainer.checkpoint_writer().n_written() + trainer.checkpoint_writer().n_skipped(), 4);
+    }
+
+    // the resumed run ends where the reference ended
+    agent_type resumed(make_q_learning_config(), make_policy(7));
+    RLSerialTrainerConfig config;
+    config.n_episodes = n_episodes;
+    config.tolerance = 1.0e-8;
+    trainer_type trainer(config, resumed);
+    trainer.resume(filename);
+    trainer.train(env);
+
+    ASSERT_EQ(trainer.episodes_total_rewards().size(), n_episodes / 2);
+    ASSERT_TRUE(resumed.q_function() == reference.q_function());
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestBinaryCheckpoint, Test_trainer_resume_continues_episode_index) {
+
+    typedef QLearning<ChainEnv, RecordingSelector> agent_type;
+    typedef RLSerialAgentTrainer<ChainEnv, agent_type> trainer_type;
+
+    const std::string filename = "test_binary_checkpoint_trainer_index.bin";
+
+    ChainEnv env;
+    std::vector<uint_t> episodes;
+    {
+        agent_type agent(make_q_learning_config(), RecordingSelector{&episodes});
+        RLSerialTrainerConfig config;
+        config.n_episodes = 6;
+        config.tolerance = 1.0e-8;
+        config.checkpoint_frequency = 3;
+        config.checkpoint_path = filename;
+        trainer_type trainer(config, agent);
+        trainer.train(env);
+    }
+
+    // the schedules of the selector see the episodes after the
+    // checkpointed one rather than starting again from zero
+    std::vector<uint_t> resumed_episodes;
+    agent_type resumed(make_q_learning_config(), RecordingSelector{&resumed_episodes});
+    RLSerialTrainerConfig config;
+    config.n_episodes = 10;
+    config.tolerance = 1.0e-8;
+    trainer_type trainer(config, resumed);
+    trainer.resume(filename);
+    trainer.train(env);
+
+    ASSERT_EQ(episodes, (std::vector<uint_t>{0, 1, 2, 3, 4, 5}));
+    ASSERT_EQ(resumed_episodes, (std::vector<uint_t>{6, 7, 8, 9}));
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestBinaryCheckpoint, Test_trainer_reports_failed_checkpoint) {
+
+    typedef QLearning<ChainEnv, EpsilonGreedyPolicy> agent_type;
+
+    ChainEnv env;
+    agent_type agent(make_q_learning_config(), make_policy(42));
+
+    RLSerialTrainerConfig config;
+    config.n_episodes = 10;
+    config.tolerance = 1.0e-8;
+    config.checkpoint_frequency = 5;
+    config.checkpoint_path = "test_binary_checkpoint_missing_dir/checkpoint.bin";
+
+    RLSerialAgentTrainer<ChainEnv, agent_type> trainer(config, agent);
+    ASSERT_THROW(trainer.train(env), std::runtime_error);
+}
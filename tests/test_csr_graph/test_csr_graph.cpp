@@ -0,0 +1,163 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/data_structs/boost_serial_graph.h"
+#include "cubeai/data_structs/csr_graph.h"
+#include "cubeai/planning/a_star_search.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::AStarSearch;
+using cubeai::BoostSerialGraph;
+using cubeai::CSRGraph;
+using cubeai::CSRGraphBuilder;
+using cubeai::build_csr_graph;
+
+struct VertexData
+{
+    real_t x{0.0};
+    real_t y{0.0};
+};
+
+typedef BoostSerialGraph<VertexData, real_t> graph_t;
+
+real_t
+distance(const graph_t::vertex_t& v, const graph_t::vertex_t& w){
+    return std::hypot(v.data.x - w.data.x, v.data.y - w.data.y);
+}
+
+// random geometric graph with the edge data set to the edge length
+graph_t
+make_graph(uint_t n, real_t radius, uint_t seed){
+
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<real_t> coord(0.0, 1.0);
+
+    graph_t graph;
+    for(uint_t v=0; v<n; ++v){
+        graph.add_vertex(VertexData{coord(gen), coord(gen)});
+    }
+
+    for(uint_t v=0; v<n; ++v){
+        for(uint_t w=v + 1; w<n; ++w){
+
+            const auto d = distance(graph.get_vertex(v), graph.get_vertex(w));
+            if(d < radius){
+                graph.add_edge(v, w).get_data() = d;
+            }
+        }
+    }
+
+    return graph;
+}
+
+}
+
+TEST(TestCSRGraph, Test_builder) {
+
+    CSRGraphBuilder<real_t, std::uint32_t> builder(5);
+    builder.add_arc(3, 1, 3.1);
+    builder.add_edge(0, 4, 0.4);
+    builder.add_arc(3, 0, 3.0);
+    builder.add_arc(0, 2, 0.2);
+    builder.add_arc(3, 1, 3.5);
+    ASSERT_EQ(builder.n_arcs(), 6);
+    ASSERT_THROW(builder.add_arc(0, 5, 1.0), std::logic_error);
+
+    const auto graph = builder.build();
+    ASSERT_EQ(builder.n_arcs(), 0);
+    ASSERT_EQ(graph.n_vertices(), 5);
+    ASSERT_EQ(graph.n_arcs(), 6);
+
+    // the rows are sorted by target, parallel arcs keep their order
+    const std::vector<std::uint32_t> offsets = {0, 2, 2, 2, 5, 6};
+    const std::vector<std::uint32_t> targets = {2, 4, 0, 1, 1, 0};
+    const std::vector<real_t> weights = {0.2, 0.4, 3.0, 3.1, 3.5, 0.4};
+    ASSERT_EQ(graph.offsets(), offsets);
+    ASSERT_EQ(graph.targets(), targets);
+    ASSERT_EQ(graph.weights(), weights);
+
+    ASSERT_EQ(graph.degree(3), 3);
+    ASSERT_EQ(graph.neighbors(3).size(), 3);
+    ASSERT_EQ(graph.neighbor_weights(0)[1], 0.4);
+    ASSERT_EQ(graph.weight(3, 1), 3.1);
+    ASSERT_TRUE(graph.has_arc(4, 0));
+    ASSERT_FALSE(graph.has_arc(1, 3));
+    ASSERT_EQ(graph.weight(1, 3), std::numeric_limits<real_t>::infinity());
+
+    std::vector<std::pair<uint_t, real_t>> visited;
+    graph.for_each_neighbor(3, [&](uint_t w, real_t c){visited.emplace_back(w, c);});
+    ASSERT_EQ(visited.size(), 3);
+    ASSERT_EQ(visited[2].first, 1);
+    ASSERT_EQ(visited[2].second, 3.5);
+
+    // the arrays are checked
+    ASSERT_THROW((CSRGraph<real_t, std::uint32_t>({0, 2}, {1, 0}, {1.0, 1.0})), std::logic_error);
+    ASSERT_THROW((CSRGraph<real_t, std::uint32_t>({0, 1, 2}, {1, 0}, {1.0})), std::logic_error);
+    ASSERT_THROW((CSRGraph<real_t, std::uint32_t>({0, 1, 1}, {1, 0}, {1.0, 1.0})), std::logic_error);
+    ASSERT_EQ(CSRGraph<real_t>().n_vertices(), 0);
+}
+
+TEST(TestCSRGraph, Test_build_from_boost_serial_graph) {
+
+    auto graph = make_graph(300, 0.1, 42);
+    const auto csr = build_csr_graph(graph);
+    const auto csr_cost = build_csr_graph<float, std::uint32_t>(graph, distance);
+
+    ASSERT_EQ(csr.n_vertices(), graph.n_vertices());
+    ASSERT_EQ(csr.n_arcs(), 2 * graph.n_edges());
+    ASSERT_EQ(csr_cost.n_arcs(), csr.n_arcs());
+
+    for(uint_t v=0; v<graph.n_vertices(); ++v){
+
+        auto ids = graph.get_vertex_neighbors_ids(v);
+        std::sort(ids.begin(), ids.end());
+
+        const auto neighbors = csr.neighbors(v);
+        ASSERT_TRUE(std::equal(ids.begin(), ids.end(), neighbors.begin(), neighbors.end()));
+
+        for(uint_t i=0; i<ids.size(); ++i){
+
+            const auto expected = distance(graph.get_vertex(v), graph.get_vertex(ids[i]));
+            ASSERT_NEAR(csr.neighbor_weights(v)[i], expected, 1.0e-12);
+            ASSERT_EQ(csr_cost.neighbors(v)[i], ids[i]);
+            ASSERT_NEAR(csr_cost.neighbor_weights(v)[i], expected, 1.0e-6);
+        }
+    }
+}
+
+TEST(TestCSRGraph, Test_a_star_search) {
+
+    auto graph = make_graph(500, 0.08, 7);
+    const auto csr = build_csr_graph(graph);
+
+    auto cost = [](const graph_t::vertex_t& v, const graph_t::vertex_t& w){return distance(v, w);};
+    cubeai::astar_impl::BoostGraphView<graph_t, decltype(cost)> view(graph, cost);
+
+    AStarSearch<real_t> on_view;
+    AStarSearch<real_t> on_csr;
+
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<uint_t> vertex(0, graph.n_vertices() - 1);
+    for(uint_t q=0; q<50; ++q){
+
+        const auto start = vertex(gen);
+        const auto goal = vertex(gen);
+        auto h = [&](uint_t v){return distance(graph.get_vertex(v), graph.get_vertex(goal));};
+
+        const auto found = on_view.search(view, start, goal, h);
+        ASSERT_EQ(on_csr.search(csr, start, goal, h), found);
+        if(found){
+            ASSERT_NEAR(on_csr.g_cost(goal), on_view.g_cost(goal), 1.0e-12);
+        }
+    }
+}
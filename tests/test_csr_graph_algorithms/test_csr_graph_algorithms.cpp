@@ -0,0 +1,254 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/data_structs/csr_graph.h"
+#include "cubeai/data_structs/csr_graph_algorithms.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::CubeAIConsts;
+using cubeai::CSRAlgorithmsConfig;
+using cubeai::CSRGraph;
+using cubeai::CSRGraphBuilder;
+
+const auto npos = CubeAIConsts::INVALID_SIZE_TYPE;
+const auto inf = std::numeric_limits<real_t>::infinity();
+
+// random geometric graph with the edge weight set to the edge length
+CSRGraph<real_t>
+make_graph(uint_t n, real_t radius, uint_t seed){
+
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<real_t> coord(0.0, 1.0);
+
+    std::vector<std::pair<real_t, real_t>> points(n);
+    for(auto& p : points){
+        p = {coord(gen), coord(gen)};
+    }
+
+    CSRGraphBuilder<real_t> builder(n);
+    for(uint_t v=0; v<n; ++v){
+        for(uint_t w=v + 1; w<n; ++w){
+
+            const auto d = std::hypot(points[v].first - points[w].first, points[v].second - points[w].second);
+            if(d < radius){
+                builder.add_edge(v, w, d);
+            }
+        }
+    }
+
+    return builder.build();
+}
+
+std::vector<CSRAlgorithmsConfig>
+make_configs(){
+
+    std::vector<CSRAlgorithmsConfig> configs(3);
+    configs[0].parallel = false;
+    configs[1].chunk_size = 7;
+    configs[2].chunk_size = 100000;
+    return configs;
+}
+
+std::vector<uint_t>
+serial_bfs(const CSRGraph<real_t>& graph, uint_t source){
+
+    std::vector<uint_t> level(graph.n_vertices(), npos);
+    std::deque<uint_t> queue(1, source);
+    level[source] = 0;
+    while(!queue.empty()){
+
+        const auto v = queue.front();
+        queue.pop_front();
+        for(const auto w : graph.neighbors(v)){
+            if(level[w] == npos){
+                level[w] = level[v] + 1;
+                queue.push_back(w);
+            }
+        }
+    }
+
+    return level;
+}
+
+std::vector<real_t>
+serial_dijkstra(const CSRGraph<real_t>& graph, uint_t source){
+
+    typedef std::pair<real_t, uint_t> entry_t;
+    std::vector<real_t> dist(graph.n_vertices(), inf);
+    std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>> queue;
+    dist[source] = 0.0;
+    queue.push({0.0, source});
+    while(!queue.empty()){
+
+        const auto [d, v] = queue.top();
+        queue.pop();
+        if(d > dist[v]){
+            continue;
+        }
+
+        graph.for_each_neighbor(v, [&](uint_t w, real_t c){
+            if(d + c < dist[w]){
+                dist[w] = d + c;
+                queue.push({dist[w], w});
+            }
+        });
+    }
+
+    return dist;
+}
+
+}
+
+TEST(TestCSRGraphAlgorithms, Test_bfs_levels) {
+
+    const auto graph = make_graph(2000, 0.04, 42);
+
+    for(const auto& config : make_configs()){
+        for(const uint_t source : {uint_t(0), uint_t(1234)}){
+
+            std::vector<uint_t> level;
+            std::vector<uint_t> parent;
+            const auto n_levels = cubeai::bfs_levels(graph, source, level, parent, config);
+            const auto expected = serial_bfs(graph, source);
+            ASSERT_EQ(level, expected);
+
+            uint_t max_level = 0;
+            for(uint_t v=0; v<graph.n_vertices(); ++v){
+
+                if(level[v] == npos || v == source){
+                    ASSERT_EQ(parent[v], npos);
+                    continue;
+                }
+
+                max_level = std::max(max_level, level[v]);
+                ASSERT_TRUE(graph.has_arc(parent[v], v));
+                ASSERT_EQ(level[parent[v]] + 1, level[v]);
+            }
+
+            ASSERT_EQ(n_levels, max_level + 1);
+        }
+    }
+
+    std::vector<uint_t> level;
+    std::vector<uint_t> parent;
+    ASSERT_THROW(cubeai::bfs_levels(graph, graph.n_vertices(), level, parent), std::logic_error);
+}
+
+TEST(TestCSRGraphAlgorithms, Test_delta_stepping) {
+
+    const auto graph = make_graph(2000, 0.04, 7);
+    const auto expected = serial_dijkstra(graph, 3);
+
+    for(const auto& config : make_configs()){
+        for(const real_t delta : {0.0, 0.001, 0.02, 10.0}){
+
+            std::vector<real_t> dist;
+            std::vector<uint_t> parent;
+            cubeai::delta_stepping(graph, 3, delta, dist, parent, config);
+            ASSERT_EQ(dist.size(), graph.n_vertices());
+
+            for(uint_t v=0; v<graph.n_vertices(); ++v){
+
+                if(expected[v] == inf || v == 3){
+                    ASSERT_EQ(dist[v], expected[v]);
+                    ASSERT_EQ(parent[v], npos);
+                    continue;
+                }
+
+                ASSERT_NEAR(dist[v], expected[v], 1.0e-12);
+                ASSERT_NEAR(dist[parent[v]] + graph.weight(parent[v], v), dist[v], 1.0e-12);
+            }
+        }
+    }
+
+    // negative weights are rejected and infinite weights ignored
+    CSRGraphBuilder<real_t> builder(3);
+    builder.add_arc(0, 1, 1.0);
+    builder.add_arc(0, 2, inf);
+    const auto ignored = builder.build();
+
+    std::vector<real_t> dist;
+    std::vector<uint_t> parent;
+    cubeai::delta_stepping(ignored, 0, 0.0, dist, parent);
+    ASSERT_EQ(dist[1], 1.0);
+    ASSERT_EQ(dist[2], inf);
+
+    builder.add_arc(0, 1, -1.0);
+    const auto negative = builder.build();
+    ASSERT_THROW(cubeai::delta_stepping(negative, 0, 0.0, dist, parent), std::logic_error);
+
+    // a long chain with a delta far below the weights, the
+    // distances span many times the buckets that are kept
+    const uint_t n_chain = 1000;
+    CSRGraphBuilder<real_t> chain_builder(n_chain);
+    for(uint_t v=0; v + 1<n_chain; ++v){
+        chain_builder.add_edge(v, v + 1, v % 2 == 0 ? 10.0 : 0.5);
+    }
+
+    const auto chain = chain_builder.build();
+    for(const auto& config : make_configs()){
+
+        cubeai::delta_stepping(chain, 0, 0.01, dist, parent, config);
+
+        real_t expected_dist = 0.0;
+        for(uint_t v=0; v<n_chain; ++v){
+
+            ASSERT_DOUBLE_EQ(dist[v], expected_dist);
+            ASSERT_EQ(parent[v], v == 0 ? npos : v - 1);
+            expected_dist += v % 2 == 0 ? 10.0 : 0.5;
+        }
+    }
+}
+
+TEST(TestCSRGraphAlgorithms, Test_connected_components) {
+
+    const auto graph = make_graph(2000, 0.025, 3);
+
+    // the components found by the serial search
+    std::vector<uint_t> expected(graph.n_vertices(), npos);
+    uint_t n_expected = 0;
+    for(uint_t v=0; v<graph.n_vertices(); ++v){
+        if(expected[v] == npos){
+
+            const auto level = serial_bfs(graph, v);
+            for(uint_t w=0; w<graph.n_vertices(); ++w){
+                if(level[w] != npos){
+                    expected[w] = n_expected;
+                }
+            }
+
+            ++n_expected;
+        }
+    }
+
+    ASSERT_GT(n_expected, 1);
+    for(const auto& config : make_configs()){
+
+        std::vector<uint_t> component;
+        ASSERT_EQ(cubeai::connected_components(graph, component, config), n_expected);
+        ASSERT_EQ(component, expected);
+    }
+
+    // the arcs of a directed graph join their ends
+    CSRGraphBuilder<real_t> builder(5);
+    builder.add_arc(4, 1, 1.0);
+    builder.add_arc(2, 0, 1.0);
+    builder.add_arc(1, 2, 1.0);
+
+    std::vector<uint_t> component;
+    ASSERT_EQ(cubeai::connected_components(builder.build(), component), 2);
+    ASSERT_EQ(component, (std::vector<uint_t>{0, 0, 0, 1, 0}));
+}
@@ -0,0 +1,142 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/data_structs/grid_graph.h"
+#include "cubeai/planning/a_star_search.h"
+#include "cubeai/planning/d_star_lite.h"
+
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::GridGraph;
+using cubeai::GridConnectivity;
+using cubeai::AStarSearch;
+using cubeai::DStarLite;
+
+template<uint_t dim>
+real_t
+path_cost(const GridGraph<dim>& grid, const std::vector<uint_t>& path){
+
+    real_t cost = 0.0;
+    for(uint_t i=1; i<path.size(); ++i){
+
+        auto edge = std::numeric_limits<real_t>::infinity();
+        grid.for_each_neighbor(path[i - 1], [&](uint_t w, real_t c){
+            if(w == path[i]){
+                edge = c;
+            }
+        });
+
+        cost += edge;
+    }
+
+    return cost;
+}
+
+}
+
+TEST(TestDStarLite, Test_replanning_matches_a_star) {
+
+    for(auto connectivity : {GridConnectivity::FACE, GridConnectivity::FULL}){
+
+        GridGraph<2> grid({40, 30}, connectivity);
+
+        std::mt19937 gen(42);
+        std::bernoulli_distribution blocked(0.25);
+        for(uint_t v=0; v<grid.n_vertices(); ++v){
+            grid.set_blocked(v, blocked(gen));
+        }
+
+        const auto goal = grid.id({39, 29});
+        auto start = grid.id({0, 0});
+        grid.set_blocked(start, false);
+        grid.set_blocked(goal, false);
+
+        auto h = [&grid](uint_t v, uint_t w){return grid.heuristic(v, w);};
+        DStarLite planner(grid, h);
+        planner.initialize(start, goal);
+
+        AStarSearch<real_t> astar;
+        std::uniform_int_distribution<uint_t> cell(0, grid.n_vertices() - 1);
+
+        for(uint_t step=0; step<60; ++step){
+
+            const auto found = planner.plan();
+            const auto found_astar = astar.search(grid, start, goal, [&](uint_t v){return grid.heuristic(v, goal);});
+
+            ASSERT_EQ(found, found_astar);
+            if(found){
+
+                ASSERT_NEAR(planner.cost(), astar.g_cost(goal), 1.0e-9);
+
+                auto path = planner.path();
+                ASSERT_EQ(path.front(), start);
+                ASSERT_EQ(path.back(), goal);
+                ASSERT_NEAR(path_cost(grid, path), astar.g_cost(goal), 1.0e-9);
+
+                // the robot moves one step
+                if(path.size() > 1){
+                    start = path[1];
+                    planner.set_start(start);
+                }
+            }
+            else{
+                ASSERT_TRUE(planner.path().empty());
+            }
+
+            // a batch of cells is toggled, never the start and the goal
+            std::vector<uint_t> changed;
+            for(uint_t c=0; c<10; ++c){
+
+                const auto v = cell(gen);
+                if(v == start || v == goal){
+                    continue;
+                }
+
+                grid.set_blocked(v, !grid.is_blocked(v));
+                changed.push_back(v);
+            }
+
+            planner.update_cells(changed);
+        }
+    }
+}
+
+TEST(TestDStarLite, Test_update_vertices) {
+
+    // block a wall with a gap and report the
+    // cells and their neighbours one by one
+    GridGraph<2> grid({10, 10}, GridConnectivity::FACE);
+    auto h = [&grid](uint_t v, uint_t w){return grid.heuristic(v, w);};
+
+    DStarLite planner(grid, h);
+    planner.initialize(grid.id({0, 5}), grid.id({9, 5}));
+    ASSERT_TRUE(planner.plan());
+    ASSERT_EQ(planner.cost(), 9.0);
+
+    std::vector<uint_t> changed;
+    for(uint_t y=1; y<10; ++y){
+
+        const auto v = grid.id({5, y});
+        grid.set_blocked(v);
+        changed.push_back(v);
+        grid.for_each_adjacent(v, [&](uint_t w){changed.push_back(w);});
+    }
+
+    planner.update_vertices(changed);
+    ASSERT_TRUE(planner.plan());
+    ASSERT_EQ(planner.cost(), 19.0);
+
+    // close the gap
+    grid.set_blocked(grid.id({5, 0}));
+    planner.update_cells(std::vector<uint_t>{grid.id({5, 0})});
+    ASSERT_FALSE(planner.plan());
+    ASSERT_EQ(planner.cost(), std::numeric_limits<real_t>::infinity());
+    ASSERT_TRUE(planner.path().empty());
+
+    ASSERT_THROW(planner.set_start(100), std::logic_error);
+}
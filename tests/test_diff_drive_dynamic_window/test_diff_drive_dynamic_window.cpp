@@ -0,0 +1,209 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/planning/diff_drive_dynamic_window.h"
+
+#include <gtest/gtest.h>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::planning::DiffDriveDW;
+using cubeai::planning::DiffDriveDWConfig;
+
+DiffDriveDWConfig
+make_config(){
+
+    DiffDriveDWConfig config;
+    config.max_speed = 1.0;
+    config.min_speed = -0.5;
+    config.max_yaw_rate = 40.0 * 3.14159265358979 / 180.0;
+    config.max_accel = 0.2;
+    config.max_delta_yaw_rate = 40.0 * 3.14159265358979 / 180.0;
+    config.dt = 0.1;
+    config.min_cost = 0.0;
+    config.v_reso = 0.001;
+    config.yawrate_reso = 0.2 * 3.14159265358979 / 180.0;
+    config.robot_radius = 1.0;
+    config.skip_n = 2;
+    config.predict_time = 3.0;
+    config.speed_cost_gain = 1.0;
+    config.to_goal_cost_gain = 0.15;
+    config.obstacle_cost_gain = 1.0;
+    config.robot_stuck_flag_cons = 0.001;
+    return config;
+}
+
+std::vector<std::array<real_t, 2>>
+make_obstacles(uint_t n, uint_t seed){
+
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<real_t> coord(-2.0, 12.0);
+
+    std::vector<std::array<real_t, 2>> obstacles(n);
+    for(auto& o : obstacles){
+        o = {coord(gen), coord(gen)};
+        if(o[0] * o[0] + o[1] * o[1] < 4.0){
+            o[0] += 3.0;
+        }
+    }
+
+    return obstacles;
+}
+
+// forward Euler of the unicycle with a small step
+std::array<real_t, 3>
+integrate(const DiffDriveDW::state_t& state, real_t v, real_t w, real_t time){
+
+    const uint_t n = 10000;
+    const auto dt = time / n;
+
+    auto x = state[0];
+    auto y = state[1];
+    auto theta = state[2];
+    for(uint_t i=0; i<n; ++i){
+        x += v * std::cos(theta + 0.5 * w * dt) * dt;
+        y += v * std::sin(theta + 0.5 * w * dt) * dt;
+        theta += w * dt;
+    }
+
+    return {x, y, theta};
+}
+
+}
+
+TEST(TestDiffDriveDW, Test_trajectory_follows_unicycle) {
+
+    const auto config = make_config();
+    DiffDriveDW::state_t state = {1.0, -0.5, 0.3, 0.5, 0.2};
+    DiffDriveDW dw(state, config, DiffDriveDW::goal_t({10.0, 10.0}), {0.0, 0.0});
+
+    const auto best = dw.dwa_control(make_obstacles(20, 42));
+    ASSERT_NE(best, DiffDriveDW::npos);
+    ASSERT_GT(dw.n_candidates(), 1000);
+
+    DiffDriveDW::trajectory_t traj;
+    for(auto i : {uint_t(0), dw.n_candidates() / 2, dw.n_candidates() - 1}){
+
+        dw.trajectory(i, traj);
+        ASSERT_EQ(traj.size(), 31);
+        ASSERT_EQ(traj.front(), state);
+
+        const auto [v, w] = dw.candidate_control(i);
+        for(auto k : {uint_t(1), uint_t(15), uint_t(30)}){
+
+            const auto expected = integrate(state, v, w, k * config.dt);
+            ASSERT_NEAR(traj[k][DiffDriveDW::X], expected[0], 1.0e-6);
+            ASSERT_NEAR(traj[k][DiffDriveDW::Y], expected[1], 1.0e-6);
+            ASSERT_NEAR(traj[k][DiffDriveDW::THETA], expected[2], 1.0e-9);
+            ASSERT_EQ(traj[k][DiffDriveDW::V], v);
+            ASSERT_EQ(traj[k][DiffDriveDW::W], w);
+        }
+    }
+
+    ASSERT_EQ(dw.best_trajectory().back(), (dw.trajectory(best, traj), traj.back()));
+    ASSERT_THROW(dw.trajectory(dw.n_candidates(), traj), std::logic_error);
+}
+
+TEST(TestDiffDriveDW, Test_costs_match_brute_force) {
+
+    const auto config = make_config();
+    DiffDriveDW::state_t state = {0.0, 0.0, 0.7, 0.6, -0.1};
+    const auto obstacles = make_obstacles(30, 7);
+    const DiffDriveDW::goal_t goal({10.0, 8.0});
+
+    DiffDriveDW dw(state, config, goal, {0.0, 0.0});
+    const auto best = dw.dwa_control(obstacles);
+    ASSERT_NE(best, DiffDriveDW::npos);
+
+    // score every candidate from its trajectory
+    auto min_cost = std::numeric_limits<real_t>::max();
+    auto expected_best = DiffDriveDW::npos;
+    DiffDriveDW::trajectory_t traj;
+    for(uint_t i=0; i<dw.n_candidates(); ++i){
+
+        dw.trajectory(i, traj);
+
+        auto min_r = std::numeric_limits<real_t>::max();
+        for(uint_t k=0; k<traj.size(); k += config.skip_n){
+            for(const auto& o : obstacles){
+                min_r = std::min(min_r, std::hypot(traj[k][0] - o[0], traj[k][1] - o[1]));
+            }
+        }
+
+        auto cost = std::numeric_limits<real_t>::infinity();
+        if(min_r > config.robot_radius){
+
+            const auto angle = std::atan2(goal[1] - traj.back()[1], goal[0] - traj.back()[0]) - traj.back()[2];
+            cost = config.to_goal_cost_gain * std::abs(std::atan2(std::sin(angle), std::cos(angle))) +
+                   config.speed_cost_gain * (config.max_speed - traj.back()[3]) +
+                   config.obstacle_cost_gain / min_r;
+        }
+
+        if(std::isinf(cost)){
+            ASSERT_TRUE(std::isinf(dw.candidate_cost(i)));
+        }
+        else{
+            ASSERT_NEAR(dw.candidate_cost(i), cost, 1.0e-9);
+        }
+
+        if(cost <= min_cost){
+            min_cost = cost;
+            expected_best = i;
+        }
+    }
+
+    ASSERT_EQ(best, expected_best);
+    ASSERT_EQ(dw.get_control()[0], dw.candidate_control(best)[0]);
+    ASSERT_EQ(dw.get_control()[1], dw.candidate_control(best)[1]);
+}
+
+TEST(TestDiffDriveDW, Test_parallel_rollout) {
+
+    auto config = make_config();
+    DiffDriveDW::state_t state = {0.0, 0.0, 0.0, 0.4, 0.0};
+    const auto obstacles = make_obstacles(100, 3);
+    const DiffDriveDW::goal_t goal({10.0, 10.0});
+
+    DiffDriveDW serial(state, config, goal, {0.0, 0.0});
+    serial.dwa_control(obstacles);
+
+    config.parallel_rollout = true;
+    config.rollout_block_size = 50;
+    DiffDriveDW parallel(state, config, goal, {0.0, 0.0});
+    parallel.dwa_control(obstacles);
+
+    ASSERT_EQ(serial.n_candidates(), parallel.n_candidates());
+    ASSERT_EQ(serial.best_index(), parallel.best_index());
+    for(uint_t i=0; i<serial.n_candidates(); ++i){
+        ASSERT_EQ(serial.candidate_cost(i), parallel.candidate_cost(i));
+    }
+}
+
+TEST(TestDiffDriveDW, Test_all_candidates_collide) {
+
+    auto config = make_config();
+    config.v_reso = 0.01;
+
+    DiffDriveDW::state_t state = {0.0, 0.0, 0.0, 0.0, 0.0};
+    DiffDriveDW dw(state, config, DiffDriveDW::goal_t({10.0, 0.0}), {0.3, 0.1});
+
+    // the robot stands on an obstacle
+    std::vector<std::array<real_t, 2>> obstacles = {{0.1, 0.0}};
+    ASSERT_EQ(dw.dwa_control(obstacles), DiffDriveDW::npos);
+    ASSERT_TRUE(dw.best_trajectory().empty());
+    ASSERT_EQ(dw.get_control()[0], 0.3);
+    ASSERT_EQ(dw.get_control()[1], 0.1);
+
+    // without obstacles the speed stays in the window
+    dw.set_goal(DiffDriveDW::goal_t({-10.0, 0.0}));
+    ASSERT_NE(dw.dwa_control(std::vector<std::array<real_t, 2>>()), DiffDriveDW::npos);
+    ASSERT_LE(dw.get_control()[0], config.max_accel * config.dt + 1.0e-12);
+
+    config.skip_n = 0;
+    ASSERT_THROW(DiffDriveDW(state, config, DiffDriveDW::goal_t({10.0, 0.0}), {0.0, 0.0}), std::logic_error);
+}
@@ -0,0 +1,126 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/algorithms/td/dyna_q.h"
+
+#include <gtest/gtest.h>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::DynMat;
+using cubeai::rl::algos::td::DynaQ;
+using cubeai::rl::algos::td::DynaQConfig;
+
+const real_t GAMMA = 0.9;
+const real_t ETA = 0.5;
+
+// a chain of four states. Action 0 moves right, action 1 stays.
+// Entering the last state pays 1 and ends the episode
+struct ChainEnv
+{
+    typedef uint_t state_type;
+    typedef uint_t action_type;
+
+    struct time_step_type
+    {
+        uint_t state;
+        real_t r;
+        bool is_done;
+
+        uint_t observation()const{return state;}
+        real_t reward()const{return r;}
+        bool done()const{return is_done;}
+    };
+
+    uint_t current{0};
+
+    uint_t n_states()const{return 4;}
+    uint_t n_actions()const{return 2;}
+
+    time_step_type reset(){current = 0; return {current, 0.0, false};}
+
+    time_step_type step(uint_t action){
+
+        if(action == 1){
+            return {current, 0.0, false};
+        }
+
+        current += 1;
+        return {current, current == 3 ? 1.0 : 0.0, current == 3};
+    }
+};
+
+// always moves right
+struct RightSelector
+{
+    uint_t operator()(const DynMat<real_t>&, uint_t){return 0;}
+    void on_episode(uint_t){}
+};
+
+DynaQConfig
+make_config(uint_t n_planning_steps, bool background){
+
+    DynaQConfig config;
+    config.gamma = GAMMA;
+    config.eta = ETA;
+    config.max_num_iterations_per_episode = 10;
+    config.n_planning_steps = n_planning_steps;
+    config.background_planning = background;
+    return config;
+}
+
+void
+train_one_episode(DynaQ<ChainEnv, RightSelector>& solver){
+
+    ChainEnv env;
+    solver.actions_before_training_begins(env);
+    solver.actions_before_episode_begins(env, 0);
+    auto info = solver.on_training_episode(env, 0);
+    solver.actions_after_episode_ends(env, 0, info);
+    solver.actions_after_training_ends(env);
+}
+
+}
+
+TEST(TestDynaQ, Test_no_planning) {
+
+    DynaQ<ChainEnv, RightSelector> solver(make_config(0, false), RightSelector());
+    train_one_episode(solver);
+
+    // as in Q-learning only the last pair has seen a reward
+    const auto& q = solver.q_table();
+    ASSERT_DOUBLE_EQ(q(2, 0), ETA);
+    ASSERT_DOUBLE_EQ(q(1, 0), 0.0);
+    ASSERT_DOUBLE_EQ(q(0, 0), 0.0);
+    ASSERT_EQ(solver.model().size(), static_cast<uint_t>(3));
+    ASSERT_EQ(solver.n_planning_backups(), static_cast<uint_t>(0));
+}
+
+TEST(TestDynaQ, Test_planning_propagates_values) {
+
+    DynaQ<ChainEnv, RightSelector> solver(make_config(200, false), RightSelector());
+    train_one_episode(solver);
+
+    // the backups on the deterministic model converge to the
+    // optimal values of the pairs seen in the episode
+    const auto& q = solver.q_table();
+    ASSERT_NEAR(q(2, 0), 1.0, 1.0e-8);
+    ASSERT_NEAR(q(1, 0), GAMMA, 1.0e-8);
+    ASSERT_NEAR(q(0, 0), GAMMA * GAMMA, 1.0e-8);
+    ASSERT_DOUBLE_EQ(q.col(1).cwiseAbs().sum(), 0.0);
+    ASSERT_EQ(solver.n_planning_backups(), static_cast<uint_t>(600));
+}
+
+TEST(TestDynaQ, Test_background_planning) {
+
+    DynaQ<ChainEnv, RightSelector> solver(make_config(200, true), RightSelector());
+    train_one_episode(solver);
+
+    // stopping the planning thread performs the queued backups
+    ASSERT_EQ(solver.n_planning_backups(), static_cast<uint_t>(600));
+
+    const auto& q = solver.q_table();
+    ASSERT_NEAR(q(2, 0), 1.0, 1.0e-8);
+    ASSERT_NEAR(q(1, 0), GAMMA, 1.0e-8);
+    ASSERT_NEAR(q(0, 0), GAMMA * GAMMA, 1.0e-8);
+}
@@ -0,0 +1,153 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/data_structs/dynamic_kd_tree.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::containers::DynamicKDTree;
+
+template<uint_t dim>
+real_t
+distance(const std::array<real_t, dim>& a, const std::array<real_t, dim>& b){
+
+    real_t d = 0.0;
+    for(uint_t i=0; i<dim; ++i){
+        d += (a[i] - b[i]) * (a[i] - b[i]);
+    }
+    return std::sqrt(d);
+}
+
+template<uint_t dim>
+std::array<real_t, dim>
+random_point(std::mt19937& gen){
+
+    // a coarse grid so that there are duplicates and ties
+    std::uniform_int_distribution<int> dist(0, 50);
+    std::array<real_t, dim> p;
+    for(uint_t i=0; i<dim; ++i){
+        p[i] = 0.1 * dist(gen);
+    }
+    return p;
+}
+
+template<uint_t dim>
+void
+check_against_brute_force(const DynamicKDTree<dim>& tree, std::mt19937& gen){
+
+    std::vector<uint_t> found;
+    for(uint_t q=0; q<200; ++q){
+
+        const auto query = random_point<dim>(gen);
+
+        real_t best = std::numeric_limits<real_t>::max();
+        for(uint_t i=0; i<tree.size(); ++i){
+            best = std::min(best, distance<dim>(tree.point(i), query));
+        }
+
+        const auto id = tree.nearest(query);
+        ASSERT_NEAR(distance<dim>(tree.point(id), query), best, 1.0e-12);
+
+        // L-infinity through the generic overload
+        auto linf = [&](uint_t i){
+            real_t d = 0.0;
+            for(uint_t k=0; k<dim; ++k){
+                d = std::max(d, std::abs(tree.point(i)[k] - query[k]));
+            }
+            return d;
+        };
+
+        real_t best_linf = std::numeric_limits<real_t>::max();
+        for(uint_t i=0; i<tree.size(); ++i){
+            best_linf = std::min(best_linf, linf(i));
+        }
+        ASSERT_EQ(linf(tree.nearest(query, linf)), best_linf);
+
+        const real_t r = 0.6;
+        tree.radius_search(query, r, found);
+        std::sort(found.begin(), found.end());
+
+        std::vector<uint_t> expected;
+        for(uint_t i=0; i<tree.size(); ++i){
+            if(distance<dim>(tree.point(i), query) <= r){
+                expected.push_back(i);
+            }
+        }
+
+        ASSERT_EQ(found, expected);
+    }
+}
+
+}
+
+TEST(TestDynamicKDTree, Test_empty) {
+
+    DynamicKDTree<2> tree;
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQ(tree.nearest({0.0, 0.0}), DynamicKDTree<2>::npos);
+    ASSERT_EQ(tree.depth(), 0);
+
+    std::vector<uint_t> found{1, 2};
+    tree.radius_search({0.0, 0.0}, 1.0, found);
+    ASSERT_TRUE(found.empty());
+
+    ASSERT_EQ(tree.insert({1.0, 2.0}), 0);
+    ASSERT_EQ(tree.nearest({0.0, 0.0}), 0);
+
+    tree.clear();
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQ(tree.insert({1.0, 2.0}), 0);
+}
+
+TEST(TestDynamicKDTree, Test_matches_brute_force) {
+
+    std::mt19937 gen(42);
+
+    DynamicKDTree<2> tree_2d;
+    DynamicKDTree<3> tree_3d;
+    for(uint_t i=0; i<2000; ++i){
+        ASSERT_EQ(tree_2d.insert(random_point<2>(gen)), i);
+        ASSERT_EQ(tree_3d.insert(random_point<3>(gen)), i);
+    }
+
+    check_against_brute_force(tree_2d, gen);
+    check_against_brute_force(tree_3d, gen);
+
+    // incremental insertion after the queries
+    for(uint_t i=0; i<500; ++i){
+        tree_2d.insert(random_point<2>(gen));
+    }
+    check_against_brute_force(tree_2d, gen);
+}
+
+TEST(TestDynamicKDTree, Test_rebuild) {
+
+    // sorted points make a degenerate tree
+    // unless the tree is rebuilt as it grows
+    DynamicKDTree<2> tree;
+    for(uint_t i=0; i<1024; ++i){
+        tree.insert({0.01 * i, 0.02 * i});
+    }
+    ASSERT_GT(tree.n_rebuilds(), 0);
+    ASSERT_LE(tree.depth(), 2 + std::log(1025.0) / std::log(4.0 / 3.0));
+
+    tree.rebuild();
+    ASSERT_LE(tree.depth(), 11);
+    ASSERT_EQ(tree.point(10)[0], 0.1);
+
+    std::mt19937 gen(3);
+    check_against_brute_force(tree, gen);
+
+    // the tree keeps growing after the rebuild
+    for(uint_t i=0; i<500; ++i){
+        tree.insert(random_point<2>(gen));
+    }
+    check_against_brute_force(tree, gen);
+}
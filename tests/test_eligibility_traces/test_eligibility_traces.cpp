@@ -0,0 +1,292 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/algorithms/td/eligibility_traces.h"
+#include "cubeai/rl/algorithms/td/sarsa_lambda.h"
+#include "cubeai/rl/algorithms/td/watkins_q_lambda.h"
+#include "cubeai/rl/algorithms/td/n_step_sarsa.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::DynMat;
+using cubeai::rl::algos::td::SparseEligibilityTraces;
+using cubeai::rl::algos::td::EligibilityTraceType;
+using cubeai::rl::algos::td::SarsaLambdaSolver;
+using cubeai::rl::algos::td::SarsaLambdaConfig;
+using cubeai::rl::algos::td::WatkinsQLambda;
+using cubeai::rl::algos::td::QLambdaConfig;
+using cubeai::rl::algos::td::NStepSarsa;
+using cubeai::rl::algos::td::NStepSarsaConfig;
+
+const real_t GAMMA = 0.9;
+const real_t ETA = 0.5;
+const real_t LAMBDA = 0.5;
+
+// a chain of n_states states. Action 0 moves right, action 1 stays.
+// Moving right pays right_reward and entering the last state, when it is
+// terminal, pays 1 and ends the episode. With a non terminal last state
+// moving right from it goes back to state 0
+struct ChainEnv
+{
+    typedef uint_t state_type;
+    typedef uint_t action_type;
+
+    struct time_step_type
+    {
+        uint_t state;
+        real_t r;
+        bool is_done;
+
+        uint_t observation()const{return state;}
+        real_t reward()const{return r;}
+        bool done()const{return is_done;}
+    };
+
+    uint_t states{4};
+    bool terminal{true};
+    real_t right_reward{0.0};
+    uint_t current{0};
+
+    uint_t n_states()const{return states;}
+    uint_t n_actions()const{return 2;}
+
+    time_step_type reset(){current = 0; return {current, 0.0, false};}
+
+    time_step_type step(uint_t action){
+
+        if(action == 1){
+            return {current, 0.0, false};
+        }
+
+        current = (current + 1) % states;
+        if(terminal && current + 1 == states){
+            return {current, 1.0, true};
+        }
+
+        return {current, right_reward, false};
+    }
+};
+
+// selects the actions of a script in turn
+struct ScriptedSelector
+{
+    std::vector<uint_t> script;
+    uint_t next{0};
+
+    uint_t operator()(const DynMat<real_t>&, uint_t){return script[next++ % script.size()];}
+    void on_episode(uint_t){}
+};
+
+template<typename SolverTp>
+void
+run_episode(SolverTp& solver, ChainEnv& env, uint_t episode_idx){
+
+    solver.actions_before_episode_begins(env, episode_idx);
+    auto info = solver.on_training_episode(env, episode_idx);
+    solver.actions_after_episode_ends(env, episode_idx, info);
+}
+
+template<typename SolverTp>
+void
+run_episodes(SolverTp& solver, ChainEnv& env, uint_t n_episodes){
+
+    solver.actions_before_training_begins(env);
+    for(uint_t e=0; e<n_episodes; ++e){
+        run_episode(solver, env, e);
+    }
+}
+
+}
+
+TEST(TestSparseEligibilityTraces, Test_visit_replacing) {
+
+    SparseEligibilityTraces traces(EligibilityTraceType::REPLACING, 1.0e-4);
+    traces.initialize(10, 4);
+
+    ASSERT_TRUE(traces.empty());
+
+    traces.visit(2, 1);
+    traces.visit(2, 1);
+    traces.visit(3, 0);
+
+    ASSERT_EQ(traces.size(), static_cast<uint_t>(2));
+    ASSERT_DOUBLE_EQ(traces.value(2, 1), 1.0);
+    ASSERT_DOUBLE_EQ(traces.value(3, 0), 1.0);
+    ASSERT_DOUBLE_EQ(traces.value(0, 0), 0.0);
+}
+
+TEST(TestSparseEligibilityTraces, Test_visit_accumulating) {
+
+    SparseEligibilityTraces traces(EligibilityTraceType::ACCUMULATING, 1.0e-4);
+    traces.initialize(10, 4);
+
+    traces.visit(2, 1);
+    traces.visit(2, 1);
+
+    ASSERT_EQ(traces.size(), static_cast<uint_t>(1));
+    ASSERT_DOUBLE_EQ(traces.value(2, 1), 2.0);
+}
+
+TEST(TestSparseEligibilityTraces, Test_update) {
+
+    SparseEligibilityTraces traces(EligibilityTraceType::REPLACING, 1.0e-4);
+    traces.initialize(10, 4);
+
+    DynMat<real_t> q_table = DynMat<real_t>::Zero(10, 4);
+
+    traces.visit(1, 1);
+    traces.update(q_table, 0.5, 0.5);
+
+    traces.visit(4, 2);
+    traces.update(q_table, 1.0, 0.5);
+
+    ASSERT_DOUBLE_EQ(q_table(1, 1), 1.0);
+    ASSERT_DOUBLE_EQ(q_table(4, 2), 1.0);
+    ASSERT_DOUBLE_EQ(traces.value(1, 1), 0.25);
+    ASSERT_DOUBLE_EQ(traces.value(4, 2), 0.5);
+}
+
+TEST(TestSparseEligibilityTraces, Test_cutoff_removes_entries) {
+
+    SparseEligibilityTraces traces(EligibilityTraceType::REPLACING, 0.1);
+    traces.initialize(10, 4);
+
+    DynMat<real_t> q_table = DynMat<real_t>::Zero(10, 4);
+
+    traces.visit(0, 0);
+    traces.visit(5, 3);
+    traces.visit(9, 1);
+
+    // a zero decay drops every trace
+    traces.update(q_table, 1.0, 0.0);
+    ASSERT_TRUE(traces.empty());
+
+    // the position index must be consistent after removal
+    traces.visit(9, 1);
+    ASSERT_EQ(traces.size(), static_cast<uint_t>(1));
+    ASSERT_DOUBLE_EQ(traces.value(9, 1), 1.0);
+    ASSERT_DOUBLE_EQ(traces.value(0, 0), 0.0);
+}
+
+TEST(TestSparseEligibilityTraces, Test_clear) {
+
+    SparseEligibilityTraces traces(EligibilityTraceType::REPLACING, 1.0e-4);
+    traces.initialize(10, 4);
+
+    traces.visit(0, 0);
+    traces.visit(5, 3);
+    traces.clear();
+
+    ASSERT_TRUE(traces.empty());
+    ASSERT_DOUBLE_EQ(traces.value(5, 3), 0.0);
+}
+
+TEST(TestSarsaLambdaSolver, Test_chain_episode) {
+
+    SarsaLambdaConfig config;
+    config.gamma = GAMMA;
+    config.eta = ETA;
+    config.lambda = LAMBDA;
+    config.max_num_iterations_per_episode = 10;
+
+    ChainEnv env;
+    SarsaLambdaSolver<ChainEnv, ScriptedSelector> solver(config, ScriptedSelector{{0}});
+    run_episodes(solver, env, 1);
+
+    // the only non zero TD error is at the last step and
+    // reaches the earlier pairs through their decayed traces
+    const auto decay = GAMMA * LAMBDA;
+    const auto& q = solver.q_table();
+    ASSERT_DOUBLE_EQ(q(2, 0), ETA);
+    ASSERT_DOUBLE_EQ(q(1, 0), ETA * decay);
+    ASSERT_DOUBLE_EQ(q(0, 0), ETA * decay * decay);
+    ASSERT_DOUBLE_EQ(q.col(1).cwiseAbs().sum(), 0.0);
+    ASSERT_EQ(solver.traces().size(), static_cast<uint_t>(3));
+}
+
+TEST(TestWatkinsQLambda, Test_exploratory_action_cuts_traces) {
+
+    QLambdaConfig config;
+    config.gamma = GAMMA;
+    config.eta = ETA;
+    config.lambda = LAMBDA;
+    config.max_num_iterations_per_episode = 3;
+    config.trace_cutoff = 0.0;
+
+    // two states in a loop, moving pays 1
+    ChainEnv env;
+    env.states = 2;
+    env.terminal = false;
+    env.right_reward = 1.0;
+
+    // move, move and then stay twice, the stays are exploratory
+    WatkinsQLambda<ChainEnv, ScriptedSelector> solver(config, ScriptedSelector{{0, 0, 1, 1}});
+    run_episodes(solver, env, 1);
+
+    const auto decay = GAMMA * LAMBDA;
+    const auto q00 = ETA;
+    const auto td_1 = 1.0 + GAMMA * q00;
+    const auto q10 = ETA * td_1;
+    const auto q00_2 = q00 + ETA * td_1 * decay;
+    const auto q01 = ETA * GAMMA * q00_2;
+
+    const auto& q = solver.q_table();
+    ASSERT_DOUBLE_EQ(q(0, 0), q00_2);
+    ASSERT_DOUBLE_EQ(q(1, 0), q10);
+    ASSERT_DOUBLE_EQ(q(0, 1), q01);
+    ASSERT_DOUBLE_EQ(q(1, 1), 0.0);
+
+    // the last action was exploratory so no trace survives
+    // even though the zero cutoff removes no decayed entry
+    ASSERT_TRUE(solver.traces().empty());
+}
+
+TEST(TestNStepSarsa, Test_chain_episodes) {
+
+    NStepSarsaConfig config;
+    config.gamma = GAMMA;
+    config.eta = ETA;
+    config.n = 2;
+    config.max_num_iterations_per_episode = 10;
+
+    ChainEnv env;
+    NStepSarsa<ChainEnv, ScriptedSelector> solver(config, ScriptedSelector{{0}});
+    run_episodes(solver, env, 1);
+
+    // the reward of the last step reaches two steps back
+    const auto& q = solver.q_table();
+    ASSERT_DOUBLE_EQ(q(0, 0), 0.0);
+    ASSERT_DOUBLE_EQ(q(1, 0), ETA * GAMMA);
+    ASSERT_DOUBLE_EQ(q(2, 0), ETA);
+
+    // the second episode bootstraps from the first
+    run_episode(solver, env, 1);
+    ASSERT_DOUBLE_EQ(q(0, 0), ETA * GAMMA * GAMMA * ETA);
+    ASSERT_DOUBLE_EQ(q(1, 0), ETA * GAMMA + ETA * (GAMMA - ETA * GAMMA));
+    ASSERT_DOUBLE_EQ(q(2, 0), ETA + ETA * (1.0 - ETA));
+}
+
+TEST(TestNStepSarsa, Test_episode_shorter_than_n) {
+
+    NStepSarsaConfig config;
+    config.gamma = GAMMA;
+    config.eta = ETA;
+    config.n = 5;
+    config.max_num_iterations_per_episode = 10;
+
+    ChainEnv env;
+    NStepSarsa<ChainEnv, ScriptedSelector> solver(config, ScriptedSelector{{0}});
+    run_episodes(solver, env, 2);
+
+    // every update uses the Monte Carlo return. The first
+    // episode gives eta * G and the second halves the error
+    const auto& q = solver.q_table();
+    const auto g0 = GAMMA * GAMMA;
+    const auto g1 = GAMMA;
+    ASSERT_DOUBLE_EQ(q(0, 0), ETA * g0 + ETA * (g0 - ETA * g0));
+    ASSERT_DOUBLE_EQ(q(1, 0), ETA * g1 + ETA * (g1 - ETA * g1));
+    ASSERT_DOUBLE_EQ(q(2, 0), ETA + ETA * (1.0 - ETA));
+}
@@ -0,0 +1,152 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/episode_log_sink.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::rl::AsyncEpisodeLogSink;
+using cubeai::rl::EpisodeInfo;
+using cubeai::rl::LogOverflowPolicy;
+
+EpisodeInfo
+make_info(uint_t index, uint_t iterations, real_t reward, real_t time){
+
+    EpisodeInfo info;
+    info.episode_index = index;
+    info.episode_iterations = iterations;
+    info.episode_reward = reward;
+    info.total_time = std::chrono::duration<real_t>(time);
+    return info;
+}
+
+uint_t
+count_occurences(const std::string& text, const std::string& pattern){
+
+    uint_t count = 0;
+    auto pos = text.find(pattern);
+    while(pos != std::string::npos){
+        count += 1;
+        pos = text.find(pattern, pos + pattern.size());
+    }
+
+    return count;
+}
+
+}
+
+TEST(TestEpisodeLogSink, Test_capacity_is_power_of_two) {
+
+    std::ostringstream out;
+    AsyncEpisodeLogSink sink(out, 1000);
+    ASSERT_EQ(sink.capacity(), static_cast<uint_t>(1024));
+}
+
+TEST(TestEpisodeLogSink, Test_stop_drains_pending_records) {
+
+    std::ostringstream out;
+    AsyncEpisodeLogSink sink(out, 64, std::chrono::milliseconds(1000));
+    sink.start();
+
+    for(uint_t i=0; i<50; ++i){
+        ASSERT_TRUE(sink.push(make_info(i, 10, -1.0, 0.5)));
+    }
+
+    sink.stop();
+
+    ASSERT_FALSE(sink.is_running());
+    ASSERT_EQ(sink.n_written(), static_cast<uint_t>(50));
+    ASSERT_EQ(sink.n_dropped(), static_cast<uint_t>(0));
+    ASSERT_EQ(count_occurences(out.str(), "Episode index"), static_cast<uint_t>(50));
+    ASSERT_NE(out.str().find("Episode index........: 49"), std::string::npos);
+}
+
+TEST(TestEpisodeLogSink, Test_full_ring_drops_records) {
+
+    std::ostringstream out;
+    AsyncEpisodeLogSink sink(out, 8, std::chrono::milliseconds(100), LogOverflowPolicy::DROP);
+
+    // the writer is not running so nothing is consumed
+    for(uint_t i=0; i<12; ++i){
+        sink.push(make_info(i, 1, 0.0, 0.0));
+    }
+
+    ASSERT_EQ(sink.n_dropped(), static_cast<uint_t>(4));
+
+    sink.stop();
+    ASSERT_EQ(sink.n_written(), static_cast<uint_t>(8));
+
+    // the oldest records are kept and the drops are reported once
+    ASSERT_NE(out.str().find("Episode index........: 7\n"), std::string::npos);
+    ASSERT_EQ(out.str().find("Episode index........: 8\n"), std::string::npos);
+    ASSERT_EQ(count_occurences(out.str(), "dropped 4 episode records"), static_cast<uint_t>(1));
+
+    sink.stop();
+    ASSERT_EQ(count_occurences(out.str(), "dropped"), static_cast<uint_t>(1));
+}
+
+TEST(TestEpisodeLogSink, Test_full_ring_blocks) {
+
+    // without a writer a full ring is drained on the pushing thread
+    std::ostringstream out;
+    AsyncEpisodeLogSink sink(out, 8);
+    ASSERT_EQ(sink.overflow_policy(), LogOverflowPolicy::BLOCK);
+
+    for(uint_t i=0; i<12; ++i){
+        ASSERT_TRUE(sink.push(make_info(i, 1, 0.0, 0.0)));
+    }
+
+    ASSERT_EQ(sink.n_written(), static_cast<uint_t>(8));
+    sink.stop();
+    ASSERT_EQ(sink.n_written(), static_cast<uint_t>(12));
+    ASSERT_EQ(sink.n_dropped(), static_cast<uint_t>(0));
+    ASSERT_EQ(out.str().find("dropped"), std::string::npos);
+}
+
+TEST(TestEpisodeLogSink, Test_half_full_ring_wakes_writer) {
+
+    // the flush interval alone would take minutes to write a burst
+    // that is many times the capacity
+    std::ostringstream out;
+    AsyncEpisodeLogSink sink(out, 64, std::chrono::milliseconds(60000));
+    sink.start();
+
+    const uint_t n_records = 10000;
+    auto start = std::chrono::steady_clock::now();
+    for(uint_t i=0; i<n_records; ++i){
+        ASSERT_TRUE(sink.push(make_info(i, 1, 0.0, 0.0)));
+    }
+
+    std::chrono::duration<real_t> elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_LT(elapsed.count(), 10.0);
+
+    sink.stop();
+    ASSERT_EQ(sink.n_written(), n_records);
+    ASSERT_EQ(sink.n_dropped(), static_cast<uint_t>(0));
+    ASSERT_EQ(count_occurences(out.str(), "Episode index"), n_records);
+}
+
+TEST(TestEpisodeLogSink, Test_writer_flushes_periodically) {
+
+    std::ostringstream out;
+    AsyncEpisodeLogSink sink(out, 16, std::chrono::milliseconds(1));
+    sink.start();
+
+    for(uint_t i=0; i<100; ++i){
+
+        // wait for the writer to make room
+        while(!sink.push(make_info(i, 1, 0.0, 0.0))){
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    sink.stop();
+    ASSERT_EQ(sink.n_written(), static_cast<uint_t>(100));
+    ASSERT_EQ(count_occurences(out.str(), "Episode index"), static_cast<uint_t>(100));
+}
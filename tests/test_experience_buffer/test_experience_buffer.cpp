@@ -82,3 +82,50 @@ TEST(TestA2C, Test_replacement) {
 
 
 
+
+TEST(TestA2C, Test_sample) {
+
+    ExperienceBuffer<Experience> buffer(10);
+
+    for(uint_t i=0; i<10; ++i){
+        buffer.append(Experience{i});
+    }
+
+    std::vector<Experience> batch;
+    buffer.sample(5, batch, 42);
+    ASSERT_EQ(batch.size(), static_cast<std::size_t>(5));
+
+    for(const auto& exp : batch){
+        ASSERT_LT(exp.item, static_cast<uint_t>(10));
+    }
+
+    // the same seed gives the same batch
+    std::vector<Experience> other;
+    buffer.sample(5, other, 42);
+    for(uint_t i=0; i<5; ++i){
+        ASSERT_EQ(batch[i].item, other[i].item);
+    }
+}
+
+TEST(TestA2C, Test_sample_indices) {
+
+    ExperienceBuffer<Experience> buffer(4);
+    buffer.append(Experience{1});
+    buffer.append(Experience{2});
+
+    std::mt19937 generator(42);
+    std::vector<uint_t> indices;
+    buffer.sample_indices(100, indices, generator);
+
+    ASSERT_EQ(indices.size(), static_cast<std::size_t>(100));
+    for(auto idx : indices){
+        ASSERT_LT(idx, buffer.size());
+    }
+}
+
+TEST(TestA2C, Test_sample_empty_throws) {
+
+    ExperienceBuffer<Experience> buffer(4);
+    std::vector<Experience> batch;
+    ASSERT_THROW(buffer.sample(1, batch, 42), std::logic_error);
+}
@@ -0,0 +1,178 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/algorithms/utils.h"
+#include "cubeai/rl/worlds/serial_vector_env.h"
+#include "cubeai/rl/worlds/grid_world.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::rl::algos::generalized_advantage_estimate;
+using cubeai::rl::algos::monte_carlo_returns;
+using cubeai::rl::envs::SerialVectorEnv;
+using cubeai::rl::envs::GridWorld;
+
+}
+
+TEST(TestGeneralizedAdvantageEstimate, Test_lambda_one_gives_n_step_returns) {
+
+    const uint_t n_steps = 3;
+    const uint_t n_envs = 1;
+    const real_t gamma = 0.9;
+
+    std::vector<real_t> rewards = {1.0, 2.0, 3.0};
+    std::vector<real_t> values = {0.5, 0.5, 0.5};
+    std::vector<real_t> dones = {0.0, 0.0, 0.0};
+    std::vector<real_t> last_values = {10.0};
+
+    std::vector<real_t> advantages(n_steps * n_envs);
+    std::vector<real_t> returns(n_steps * n_envs);
+
+    generalized_advantage_estimate(rewards.data(), values.data(), dones.data(), last_values.data(),
+                                   n_steps, n_envs, gamma, 1.0, advantages.data(), returns.data());
+
+    const auto g2 = 3.0 + gamma * 10.0;
+    const auto g1 = 2.0 + gamma * g2;
+    const auto g0 = 1.0 + gamma * g1;
+
+    ASSERT_NEAR(returns[0], g0, 1.0e-10);
+    ASSERT_NEAR(returns[1], g1, 1.0e-10);
+    ASSERT_NEAR(returns[2], g2, 1.0e-10);
+    ASSERT_NEAR(advantages[0], g0 - 0.5, 1.0e-10);
+}
+
+TEST(TestGeneralizedAdvantageEstimate, Test_done_cuts_bootstrap) {
+
+    // two environments laid out as [step * n_envs + env]
+    const uint_t n_steps = 2;
+    const uint_t n_envs = 2;
+    const real_t gamma = 0.5;
+    const real_t lambda = 0.8;
+
+    std::vector<real_t> rewards = {1.0, 1.0,
+                                   1.0, 1.0};
+    std::vector<real_t> values = {0.0, 0.0,
+                                  0.0, 0.0};
+
+    // the first environment finishes at step 0
+    std::vector<real_t> dones = {1.0, 0.0,
+                                 0.0, 0.0};
+    std::vector<real_t> last_values = {4.0, 4.0};
+
+    std::vector<real_t> advantages(n_steps * n_envs);
+    std::vector<real_t> returns(n_steps * n_envs);
+
+    generalized_advantage_estimate(rewards.data(), values.data(), dones.data(), last_values.data(),
+                                   n_steps, n_envs, gamma, lambda, advantages.data(), returns.data());
+
+    // env 0: step 1 bootstraps from the last value, step 0 sees nothing after
+    ASSERT_NEAR(advantages[2], 1.0 + gamma * 4.0, 1.0e-10);
+    ASSERT_NEAR(advantages[0], 1.0, 1.0e-10);
+
+    // env 1: no episode end
+    const auto delta1 = 1.0 + gamma * 4.0;
+    ASSERT_NEAR(advantages[3], delta1, 1.0e-10);
+    ASSERT_NEAR(advantages[1], 1.0 + gamma * lambda * delta1, 1.0e-10);
+}
+
+TEST(TestGeneralizedAdvantageEstimate, Test_serial_vector_env_auto_reset) {
+
+    SerialVectorEnv<GridWorld> env(3, [](){return std::make_unique<GridWorld>(2);});
+
+    std::vector<float> observations;
+    env.reset(observations);
+
+    ASSERT_EQ(env.n_copies(), static_cast<uint_t>(3));
+    ASSERT_EQ(env.observation_size(), static_cast<uint_t>(1));
+    ASSERT_EQ(observations.size(), static_cast<std::size_t>(3));
+
+    std::vector<float> rewards(3);
+    std::vector<float> dones(3);
+
+    // up then right reaches the goal of a 2x2 grid
+    std::vector<uint_t> up = {0, 0, 1};
+    env.step(up.data(), observations.data(), rewards.data(), dones.data());
+    ASSERT_EQ(observations[0], 2.0f);
+    ASSERT_EQ(observations[2], 0.0f);
+
+    std::vector<uint_t> right = {3, 2, 2};
+    env.step(right.data(), observations.data(), rewards.data(), dones.data());
+
+    // the first copy finished and was reset
+    ASSERT_EQ(dones[0], 1.0f);
+    ASSERT_EQ(observations[0], 0.0f);
+    ASSERT_EQ(dones[1], 0.0f);
+    ASSERT_EQ(observations[1], 2.0f);
+    ASSERT_EQ(rewards[2], -1.0f);
+}
+
+TEST(TestGeneralizedAdvantageEstimate, Test_monte_carlo_returns) {
+
+    // two environments over three steps. The first finishes at
+    // step 1 and starts a new episode that is still running at
+    // the end, the second finishes at the last step
+    const uint_t n_steps = 3;
+    const uint_t n_envs = 2;
+    const real_t gamma = 0.5;
+
+    std::vector<real_t> rewards = {1.0, 1.0,
+                                   2.0, 2.0,
+                                   4.0, 4.0};
+    std::vector<real_t> dones = {0.0, 0.0,
+                                 1.0, 0.0,
+                                 0.0, 1.0};
+
+    std::vector<real_t> returns(n_steps * n_envs);
+    std::vector<real_t> mask(n_steps * n_envs);
+
+    auto n_valid = monte_carlo_returns(rewards.data(), dones.data(), n_steps, n_envs,
+                                       gamma, false, returns.data(), mask.data());
+
+    ASSERT_EQ(n_valid, static_cast<uint_t>(5));
+
+    ASSERT_DOUBLE_EQ(returns[0], 1.0 + 0.5 * 2.0);
+    ASSERT_DOUBLE_EQ(returns[2], 2.0);
+    ASSERT_DOUBLE_EQ(mask[4], 0.0);
+
+    ASSERT_DOUBLE_EQ(returns[5], 4.0);
+    ASSERT_DOUBLE_EQ(returns[3], 2.0 + 0.5 * 4.0);
+    ASSERT_DOUBLE_EQ(returns[1], 1.0 + 0.5 * (2.0 + 0.5 * 4.0));
+
+    // with truncation the unfinished tail gets a return
+    n_valid = monte_carlo_returns(rewards.data(), dones.data(), n_steps, n_envs,
+                                  gamma, true, returns.data(), mask.data());
+
+    ASSERT_EQ(n_valid, static_cast<uint_t>(6));
+    ASSERT_DOUBLE_EQ(returns[4], 4.0);
+    ASSERT_DOUBLE_EQ(mask[4], 1.0);
+}
+
+TEST(TestGeneralizedAdvantageEstimate, Test_monte_carlo_returns_active_mask) {
+
+    // one environment over three steps that stops counting after
+    // the first step. The rewards of the later steps still enter
+    // the return of the first
+    const real_t gamma = 0.5;
+
+    std::vector<real_t> rewards = {1.0, 2.0, 4.0};
+    std::vector<real_t> dones = {0.0, 0.0, 1.0};
+    std::vector<real_t> active = {1.0, 0.0, 0.0};
+
+    std::vector<real_t> returns(3);
+    std::vector<real_t> mask(3);
+
+    auto n_valid = monte_carlo_returns(rewards.data(), dones.data(), 3, 1,
+                                       gamma, false, returns.data(), mask.data(), active.data());
+
+    ASSERT_EQ(n_valid, static_cast<uint_t>(1));
+    ASSERT_DOUBLE_EQ(returns[0], 1.0 + 0.5 * (2.0 + 0.5 * 4.0));
+    ASSERT_DOUBLE_EQ(mask[0], 1.0);
+    ASSERT_DOUBLE_EQ(mask[1], 0.0);
+    ASSERT_DOUBLE_EQ(returns[2], 0.0);
+    ASSERT_DOUBLE_EQ(mask[2], 0.0);
+}
@@ -0,0 +1,215 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/data_structs/grid_graph.h"
+#include "cubeai/planning/a_star_search.h"
+#include "cubeai/planning/jump_point_search.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::GridGraph;
+using cubeai::GridConnectivity;
+using cubeai::AStarSearch;
+using cubeai::JumpPointSearch;
+
+template<uint_t dim>
+void
+add_random_obstacles(GridGraph<dim>& grid, real_t density, uint_t seed){
+
+    std::mt19937 gen(seed);
+    std::bernoulli_distribution dist(density);
+    for(uint_t v=0; v<grid.n_vertices(); ++v){
+        grid.set_blocked(v, dist(gen));
+    }
+}
+
+}
+
+TEST(TestGridGraph, Test_neighbors_2d) {
+
+    GridGraph<2> full({5, 4}, GridConnectivity::FULL);
+    GridGraph<2> face({5, 4}, GridConnectivity::FACE);
+
+    const auto center = full.id({2, 2});
+    uint_t n_full = 0;
+    uint_t n_face = 0;
+    full.for_each_neighbor(center, [&](uint_t, real_t){n_full += 1;});
+    face.for_each_neighbor(center, [&](uint_t, real_t){n_face += 1;});
+    ASSERT_EQ(n_full, 8);
+    ASSERT_EQ(n_face, 4);
+
+    // the corner has 3 neighbours
+    uint_t n_corner = 0;
+    full.for_each_neighbor(0, [&](uint_t, real_t){n_corner += 1;});
+    ASSERT_EQ(n_corner, 3);
+
+    // blocking (3, 2) forbids the moves to (3, 1) and (3, 3)
+    full.set_blocked(full.id({3, 2}));
+    ASSERT_EQ(full.n_blocked(), 1);
+
+    std::vector<uint_t> neighbors;
+    full.for_each_neighbor(center, [&](uint_t w, real_t){neighbors.push_back(w);});
+    ASSERT_EQ(neighbors.size(), 5);
+
+    for(auto w : neighbors){
+        ASSERT_LE(full.cell(w)[0], 2);
+    }
+
+    ASSERT_EQ(full.cell(full.id({4, 3})), (GridGraph<2>::index_type{4, 3}));
+    ASSERT_DOUBLE_EQ(full.heuristic(full.id({0, 0}), full.id({3, 1})), 2.0 + std::sqrt(2.0));
+}
+
+TEST(TestGridGraph, Test_neighbors_3d) {
+
+    GridGraph<3> full({3, 3, 3}, GridConnectivity::FULL);
+    GridGraph<3> face({3, 3, 3}, GridConnectivity::FACE);
+
+    const auto center = full.id({1, 1, 1});
+    uint_t n_full = 0;
+    uint_t n_face = 0;
+    real_t corner_cost = 0.0;
+    full.for_each_neighbor(center, [&](uint_t w, real_t cost){
+        n_full += 1;
+        if(w == 0){ corner_cost = cost; }
+    });
+    face.for_each_neighbor(center, [&](uint_t, real_t){n_face += 1;});
+
+    ASSERT_EQ(n_full, 26);
+    ASSERT_EQ(n_face, 6);
+    ASSERT_DOUBLE_EQ(corner_cost, std::sqrt(3.0));
+
+    // the corner move passes by (0, 1, 1)
+    full.set_blocked(full.id({0, 1, 1}));
+    bool corner_reached = false;
+    full.for_each_neighbor(center, [&](uint_t w, real_t){corner_reached |= (w == 0);});
+    ASSERT_FALSE(corner_reached);
+}
+
+TEST(TestGridGraph, Test_a_star_3d_matches_dijkstra) {
+
+    GridGraph<3> grid({20, 20, 20});
+    add_random_obstacles(grid, 0.3, 42);
+    grid.set_blocked(0, false);
+
+    AStarSearch<real_t> astar;
+    AStarSearch<real_t> dijkstra;
+
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<uint_t> dist(0, grid.n_vertices() - 1);
+
+    for(uint_t q=0; q<20; ++q){
+
+        const auto goal = dist(gen);
+        auto found = astar.search(grid, 0, goal, [&](uint_t v){return grid.heuristic(v, goal);});
+        ASSERT_EQ(found, dijkstra.search(grid, 0, goal, [](uint_t){return 0.0;}));
+
+        if(found){
+            ASSERT_NEAR(astar.g_cost(goal), dijkstra.g_cost(goal), 1.0e-9);
+        }
+    }
+}
+
+TEST(TestGridGraph, Test_jump_point_search_is_optimal) {
+
+    for(uint_t seed=0; seed<10; ++seed){
+
+        GridGraph<2> grid({64, 48});
+        add_random_obstacles(grid, 0.05 + 0.03 * seed, seed);
+
+        AStarSearch<real_t> astar;
+        JumpPointSearch jps(grid);
+
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<uint_t> dist(0, grid.n_vertices() - 1);
+
+        for(uint_t q=0; q<20; ++q){
+
+            const auto start = dist(gen);
+            const auto goal = dist(gen);
+            if(grid.is_blocked(start) || grid.is_blocked(goal)){
+                continue;
+            }
+
+            auto found = astar.search(grid, start, goal, [&](uint_t v){return grid.heuristic(v, goal);});
+            ASSERT_EQ(found, jps.search(start, goal));
+
+            if(!found){
+                continue;
+            }
+
+            ASSERT_NEAR(jps.cost(goal), astar.g_cost(goal), 1.0e-9);
+
+            // the expanded path is a valid grid path of the same cost
+            std::vector<uint_t> path;
+            jps.path(goal, path);
+            ASSERT_EQ(path.front(), start);
+            ASSERT_EQ(path.back(), goal);
+
+            real_t cost = 0.0;
+            for(uint_t p=1; p<path.size(); ++p){
+
+                bool adjacent = false;
+                grid.for_each_neighbor(path[p - 1], [&](uint_t w, real_t c){
+                    if(w == path[p]){ adjacent = true; cost += c; }
+                });
+                ASSERT_TRUE(adjacent);
+            }
+
+            ASSERT_NEAR(cost, astar.g_cost(goal), 1.0e-9);
+        }
+    }
+}
+
+TEST(TestGridGraph, Test_jump_point_search_expands_fewer_vertices_than_a_star) {
+
+    // on an open grid a straight query needs only the start
+    GridGraph<2> empty({64, 48});
+    JumpPointSearch empty_jps(empty);
+    ASSERT_TRUE(empty_jps.search(empty.id({0, 10}), empty.id({63, 10})));
+    ASSERT_EQ(empty_jps.n_expanded(), static_cast<uint_t>(1));
+
+    for(uint_t seed=0; seed<10; ++seed){
+
+        GridGraph<2> grid({64, 48});
+        add_random_obstacles(grid, 0.05 + 0.03 * seed, seed);
+
+        AStarSearch<real_t> astar;
+        JumpPointSearch jps(grid);
+
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<uint_t> dist(0, grid.n_vertices() - 1);
+
+        uint_t n_astar = 0;
+        uint_t n_jps = 0;
+        for(uint_t q=0; q<20; ++q){
+
+            const auto start = dist(gen);
+            const auto goal = dist(gen);
+            if(grid.is_blocked(start) || grid.is_blocked(goal)){
+                continue;
+            }
+
+            astar.search(grid, start, goal, [&](uint_t v){return grid.heuristic(v, goal);});
+            jps.search(start, goal);
+
+            n_astar += astar.n_expanded();
+            n_jps += jps.n_expanded();
+        }
+
+        // only the forced neighbours are expanded so
+        // well under half the vertices of A* are
+        ASSERT_LT(2 * n_jps, n_astar);
+    }
+}
+
+TEST(TestGridGraph, Test_jump_point_search_needs_full_connectivity) {
+
+    GridGraph<2> grid({4, 4}, GridConnectivity::FACE);
+    ASSERT_THROW(JumpPointSearch jps(grid), std::logic_error);
+}
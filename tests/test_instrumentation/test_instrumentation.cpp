@@ -0,0 +1,197 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/utils/instrumentation.h"
+#include "cubeai/rl/algorithms/td/q_learning.h"
+
+#include <gtest/gtest.h>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::DynMat;
+using cubeai::rl::algos::td::QLearning;
+using cubeai::rl::algos::td::QLearningConfig;
+using cubeai::utils::Instrumentation;
+using cubeai::utils::InstrumentationPhase;
+using cubeai::utils::InstrumentationCounter;
+using cubeai::utils::ScopedPhaseTimer;
+using cubeai::utils::EpisodeInstrumentationRecorder;
+
+// a chain of four states walked to the right, the
+// last state ends the episode
+struct ChainEnv
+{
+    typedef uint_t state_type;
+    typedef uint_t action_type;
+
+    struct time_step_type
+    {
+        uint_t state;
+        bool is_done;
+
+        uint_t observation()const{return state;}
+        real_t reward()const{return is_done ? 1.0 : 0.0;}
+        bool done()const{return is_done;}
+    };
+
+    uint_t current{0};
+
+    uint_t n_states()const{return 4;}
+    uint_t n_actions()const{return 1;}
+    time_step_type reset(){current = 0; return {current, false};}
+    time_step_type step(uint_t){current += 1; return {current, current == 3};}
+};
+
+struct FirstActionSelector
+{
+    uint_t operator()(const DynMat<real_t>&, uint_t){return 0;}
+    void on_episode(uint_t){}
+};
+
+}
+
+TEST(TestInstrumentation, Test_disabled_records_nothing) {
+
+    Instrumentation::disable();
+    Instrumentation::reset();
+
+    {
+        ScopedPhaseTimer timer(InstrumentationPhase::UPDATE);
+        Instrumentation::increment(InstrumentationCounter::STEPS);
+    }
+
+    auto snapshot = Instrumentation::snapshot();
+    ASSERT_EQ(snapshot.calls(InstrumentationPhase::UPDATE), static_cast<uint_t>(0));
+    ASSERT_EQ(snapshot.count(InstrumentationCounter::STEPS), static_cast<uint_t>(0));
+}
+
+TEST(TestInstrumentation, Test_enabled_records) {
+
+    Instrumentation::enable();
+    Instrumentation::reset();
+
+    for(uint_t i=0; i<10; ++i){
+        ScopedPhaseTimer timer(InstrumentationPhase::ENV_STEP);
+        Instrumentation::increment(InstrumentationCounter::STEPS);
+    }
+
+    Instrumentation::increment(InstrumentationCounter::UPDATES, 5);
+
+    auto snapshot = Instrumentation::snapshot();
+    ASSERT_EQ(snapshot.calls(InstrumentationPhase::ENV_STEP), static_cast<uint_t>(10));
+    ASSERT_EQ(snapshot.count(InstrumentationCounter::STEPS), static_cast<uint_t>(10));
+    ASSERT_EQ(snapshot.count(InstrumentationCounter::UPDATES), static_cast<uint_t>(5));
+    ASSERT_GE(snapshot.phase_time(InstrumentationPhase::ENV_STEP), 0.0);
+
+    Instrumentation::disable();
+}
+
+TEST(TestInstrumentation, Test_aggregates_threads) {
+
+    Instrumentation::enable();
+    Instrumentation::reset();
+
+    std::vector<std::thread> threads;
+    for(uint_t t=0; t<4; ++t){
+        threads.emplace_back([](){
+            for(uint_t i=0; i<1000; ++i){
+                Instrumentation::increment(InstrumentationCounter::STEPS);
+            }
+        });
+    }
+
+    for(auto& thread : threads){
+        thread.join();
+    }
+
+    auto snapshot = Instrumentation::snapshot();
+    ASSERT_EQ(snapshot.count(InstrumentationCounter::STEPS), static_cast<uint_t>(4000));
+
+    Instrumentation::disable();
+}
+
+TEST(TestInstrumentation, Test_allocation_hook) {
+
+    // the test links the cubeai_allocation_hook objects. The calls
+    // of operator new are explicit so that they are not elided
+    Instrumentation::disable();
+    Instrumentation::reset();
+
+    ::operator delete(::operator new(16));
+    ASSERT_EQ(Instrumentation::snapshot().count(InstrumentationCounter::ALLOCATIONS), static_cast<uint_t>(0));
+
+    Instrumentation::enable();
+
+    ::operator delete(::operator new(16));
+    ::operator delete[](::operator new[](32));
+    ::operator delete(::operator new(64, std::align_val_t(64)), std::align_val_t(64));
+
+    auto* p = ::operator new(8, std::nothrow);
+    ASSERT_NE(p, nullptr);
+    ::operator delete(p);
+
+    ASSERT_EQ(Instrumentation::snapshot().count(InstrumentationCounter::ALLOCATIONS), static_cast<uint_t>(4));
+
+    // the allocations of a thread registering its block are not counted
+    uint_t thread_allocations = 0;
+    std::thread thread([&thread_allocations](){
+
+        const auto before = Instrumentation::snapshot().count(InstrumentationCounter::ALLOCATIONS);
+        ::operator delete(::operator new(16));
+        thread_allocations = Instrumentation::snapshot().count(InstrumentationCounter::ALLOCATIONS) - before;
+    });
+
+    thread.join();
+    ASSERT_EQ(thread_allocations, static_cast<uint_t>(1));
+
+    Instrumentation::disable();
+}
+
+TEST(TestInstrumentation, Test_episode_recorder) {
+
+    Instrumentation::enable();
+    Instrumentation::reset();
+
+    EpisodeInstrumentationRecorder recorder;
+    recorder.start();
+
+    Instrumentation::increment(InstrumentationCounter::STEPS, 10);
+    recorder.on_episode_end(0, 2.0);
+
+    Instrumentation::increment(InstrumentationCounter::STEPS, 4);
+    recorder.on_episode_end(1, 1.0);
+
+    ASSERT_EQ(recorder.records().size(), static_cast<uint_t>(2));
+    ASSERT_EQ(recorder.records()[0].values.count(InstrumentationCounter::STEPS), static_cast<uint_t>(10));
+    ASSERT_EQ(recorder.records()[1].values.count(InstrumentationCounter::STEPS), static_cast<uint_t>(4));
+    ASSERT_DOUBLE_EQ(recorder.records()[0].rate(InstrumentationCounter::STEPS), 5.0);
+
+    Instrumentation::disable();
+}
+
+TEST(TestInstrumentation, Test_q_learning_counts_every_update) {
+
+    Instrumentation::enable();
+    Instrumentation::reset();
+
+    QLearningConfig config;
+    config.gamma = 0.9;
+    config.eta = 0.5;
+    config.max_num_iterations_per_episode = 10;
+
+    ChainEnv env;
+    QLearning<ChainEnv, FirstActionSelector> solver(config, FirstActionSelector());
+    solver.actions_before_training_begins(env);
+    solver.on_training_episode(env, 0);
+
+    // the terminal step updates the table too
+    auto snapshot = Instrumentation::snapshot();
+    ASSERT_EQ(snapshot.count(InstrumentationCounter::STEPS), static_cast<uint_t>(3));
+    ASSERT_EQ(snapshot.count(InstrumentationCounter::UPDATES), static_cast<uint_t>(3));
+    ASSERT_EQ(snapshot.calls(InstrumentationPhase::UPDATE), static_cast<uint_t>(3));
+
+    Instrumentation::disable();
+}
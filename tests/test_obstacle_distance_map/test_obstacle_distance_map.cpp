@@ -0,0 +1,208 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/planning/obstacle_distance_map.h"
+#include "cubeai/planning/diff_drive_dynamic_window.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::planning::ObstacleDistanceMap;
+using cubeai::planning::DiffDriveDW;
+using cubeai::planning::DiffDriveDWConfig;
+
+// the distance of every cell to the closest occupied cell by brute force
+real_t
+brute_force_distance(const ObstacleDistanceMap& map, uint_t ix, uint_t iy){
+
+    auto d2 = std::numeric_limits<real_t>::max();
+    for(uint_t y=0; y<map.ny(); ++y){
+        for(uint_t x=0; x<map.nx(); ++x){
+            if(map.is_occupied(x, y)){
+                const auto dx = static_cast<real_t>(x) - static_cast<real_t>(ix);
+                const auto dy = static_cast<real_t>(y) - static_cast<real_t>(iy);
+                d2 = std::min(d2, dx * dx + dy * dy);
+            }
+        }
+    }
+
+    return std::min(std::sqrt(d2) * map.resolution(), map.max_distance());
+}
+
+void
+assert_distances(const ObstacleDistanceMap& map){
+
+    for(uint_t iy=0; iy<map.ny(); ++iy){
+        for(uint_t ix=0; ix<map.nx(); ++ix){
+            ASSERT_NEAR(map.cell_distance(ix, iy), brute_force_distance(map, ix, iy), 1.0e-12)
+                    <<"cell ("<<ix<<", "<<iy<<")";
+        }
+    }
+}
+
+}
+
+TEST(TestObstacleDistanceMap, Test_rebuild_matches_brute_force) {
+
+    ObstacleDistanceMap map(-1.0, 2.0, 47, 31, 0.1, 0.8);
+    ASSERT_EQ(map.distance(0.0, 3.0), 0.8);
+
+    std::mt19937 gen(42);
+    std::bernoulli_distribution occupied(0.03);
+    for(uint_t iy=0; iy<map.ny(); ++iy){
+        for(uint_t ix=0; ix<map.nx(); ++ix){
+            map.set_occupied(ix, iy, occupied(gen));
+        }
+    }
+
+    ASSERT_TRUE(map.has_changes());
+    map.rebuild();
+    ASSERT_FALSE(map.has_changes());
+    assert_distances(map);
+
+    // points are looked up by their cell, outside the map nothing is close
+    ASSERT_EQ(map.distance(-1.0 + 0.1 * 3.5, 2.0 + 0.1 * 7.2), map.cell_distance(3, 7));
+    ASSERT_EQ(map.distance(-2.0, 3.0), map.max_distance());
+    ASSERT_FALSE(map.add_point(100.0, 3.0));
+    ASSERT_THROW(map.set_occupied(47, 0), std::logic_error);
+    ASSERT_THROW(ObstacleDistanceMap(0.0, 0.0, 10, 10, 0.0, 1.0), std::logic_error);
+}
+
+TEST(TestObstacleDistanceMap, Test_incremental_scans) {
+
+    ObstacleDistanceMap map(0.0, 0.0, 80, 60, 0.05, 0.5);
+
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<real_t> offset(-0.5, 0.5);
+    std::vector<std::array<real_t, 2>> scan;
+
+    for(uint_t step=0; step<20; ++step){
+
+        // the previous scan is replaced by points around a moving center
+        map.remove_points(scan);
+
+        const auto cx = 0.5 + 0.15 * step;
+        const auto cy = 1.5;
+        scan.clear();
+        for(uint_t i=0; i<40; ++i){
+            scan.push_back({cx + offset(gen), cy + 3.0 * offset(gen)});
+        }
+
+        map.add_points(scan);
+        map.update();
+        ASSERT_FALSE(map.has_changes());
+        assert_distances(map);
+    }
+
+    map.clear();
+    map.update();
+    ASSERT_EQ(map.distance(2.0, 1.5), map.max_distance());
+}
+
+TEST(TestObstacleDistanceMap, Test_points_are_counted_per_cell) {
+
+    ObstacleDistanceMap map(0.0, 0.0, 20, 20, 0.1, 0.5);
+
+    // two scans with a point in the same cell
+    map.add_point(0.52, 0.51);
+    map.add_point(0.58, 0.57);
+    map.update();
+    ASSERT_EQ(map.n_points(5, 5), 2);
+    ASSERT_EQ(map.distance(0.55, 0.55), 0.0);
+
+    // removing the older scan keeps the cell of the newer one
+    map.remove_point(0.52, 0.51);
+    ASSERT_FALSE(map.has_changes());
+    ASSERT_TRUE(map.is_occupied(5, 5));
+    ASSERT_EQ(map.distance(0.55, 0.55), 0.0);
+
+    map.remove_point(0.58, 0.57);
+    ASSERT_TRUE(map.has_changes());
+    map.update();
+    ASSERT_FALSE(map.is_occupied(5, 5));
+    ASSERT_EQ(map.distance(0.55, 0.55), map.max_distance());
+
+    // a cell without points stays free
+    map.remove_point(0.55, 0.55);
+    ASSERT_EQ(map.n_points(5, 5), 0);
+    ASSERT_FALSE(map.has_changes());
+
+    // set_occupied overrides the count
+    map.add_point(0.55, 0.55);
+    map.add_point(0.55, 0.55);
+    map.set_occupied(5, 5, false);
+    ASSERT_EQ(map.n_points(5, 5), 0);
+    map.set_occupied(5, 5);
+    ASSERT_EQ(map.n_points(5, 5), 1);
+}
+
+TEST(TestObstacleDistanceMap, Test_dynamic_window_with_map) {
+
+    DiffDriveDWConfig config;
+    config.max_speed = 1.0;
+    config.min_speed = -0.5;
+    config.max_yaw_rate = 0.7;
+    config.max_accel = 0.2;
+    config.max_delta_yaw_rate = 0.7;
+    config.dt = 0.1;
+    config.min_cost = 0.0;
+    config.v_reso = 0.005;
+    config.yawrate_reso = 0.01;
+    config.robot_radius = 0.5;
+    config.skip_n = 2;
+    config.predict_time = 3.0;
+    config.speed_cost_gain = 1.0;
+    config.to_goal_cost_gain = 0.15;
+    config.obstacle_cost_gain = 1.0;
+    config.robot_stuck_flag_cons = 0.001;
+
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<real_t> coord(1.0, 9.0);
+    std::vector<std::array<real_t, 2>> obstacles(40);
+    for(auto& o : obstacles){
+        o = {coord(gen), coord(gen)};
+    }
+
+    // cell centers so that the map distances are exact
+    const real_t resolution = 0.02;
+    for(auto& o : obstacles){
+        o[0] = (std::floor(o[0] / resolution) + 0.5) * resolution;
+        o[1] = (std::floor(o[1] / resolution) + 0.5) * resolution;
+    }
+
+    ObstacleDistanceMap map(-5.0, -5.0, 1000, 1000, resolution, 4.0);
+    map.add_points(obstacles);
+    map.update();
+
+    const DiffDriveDW::state_t state = {0.0, 0.0, 0.5, 0.5, 0.0};
+    const DiffDriveDW::goal_t goal({10.0, 10.0});
+
+    DiffDriveDW with_points(state, config, goal, {0.0, 0.0});
+    DiffDriveDW with_map(state, config, goal, {0.0, 0.0});
+    with_points.dwa_control(obstacles);
+    with_map.dwa_control(map);
+
+    // a trajectory point is off by at most half a cell diagonal
+    const auto tol = std::sqrt(0.5) * resolution;
+    ASSERT_EQ(with_points.n_candidates(), with_map.n_candidates());
+    for(uint_t i=0; i<with_map.n_candidates(); ++i){
+
+        const auto c_points = with_points.candidate_cost(i);
+        const auto c_map = with_map.candidate_cost(i);
+        if(std::isinf(c_points) || std::isinf(c_map)){
+            continue;
+        }
+
+        // only the obstacle term differs and both distances exceed the radius
+        ASSERT_NEAR(c_points, c_map, tol / (config.robot_radius * config.robot_radius));
+    }
+
+    ASSERT_NE(with_map.best_index(), DiffDriveDW::npos);
+}
@@ -0,0 +1,69 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/rl/algorithms/td/q_learning.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::DynMat;
+using cubeai::rl::algos::td::QLearning;
+using cubeai::rl::algos::td::QLearningConfig;
+
+// a chain of four states walked to the right, the
+// last state ends the episode
+struct ChainEnv
+{
+    typedef uint_t state_type;
+    typedef uint_t action_type;
+
+    struct time_step_type
+    {
+        uint_t state;
+        bool is_done;
+
+        uint_t observation()const{return state;}
+        real_t reward()const{return is_done ? 1.0 : 0.0;}
+        bool done()const{return is_done;}
+    };
+
+    uint_t current{0};
+
+    uint_t n_states()const{return 4;}
+    uint_t n_actions()const{return 1;}
+    time_step_type reset(){current = 0; return {current, false};}
+    time_step_type step(uint_t){current += 1; return {current, current == 3};}
+};
+
+// records the state every action is selected in
+struct RecordingActionSelector
+{
+    std::vector<uint_t>* states;
+
+    uint_t operator()(const DynMat<real_t>&, uint_t state){states->push_back(state); return 0;}
+    void on_episode(uint_t){}
+};
+
+}
+
+TEST(TestQLearning, Test_next_action_is_selected_in_next_state) {
+
+    QLearningConfig config;
+    config.gamma = 0.9;
+    config.eta = 0.5;
+    config.max_num_iterations_per_episode = 10;
+
+    std::vector<uint_t> states;
+
+    ChainEnv env;
+    QLearning<ChainEnv, RecordingActionSelector> solver(config, RecordingActionSelector{&states});
+    solver.actions_before_training_begins(env);
+    solver.on_training_episode(env, 0);
+
+    // the first action is selected in the start state and every
+    // other one in the state the previous step reached. The
+    // terminal state selects nothing
+    ASSERT_EQ(states, std::vector<uint_t>({0, 1, 2}));
+}
@@ -0,0 +1,146 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/planning/rapidly_exploring_random_tree.h"
+
+#include <gtest/gtest.h>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::RRT;
+
+typedef std::array<real_t, 2> State;
+typedef RRT<State, real_t> Tree;
+
+struct EuclideanMetric
+{
+    template<typename VertexTp>
+    real_t operator()(const VertexTp& v1, const VertexTp& v2)const{
+        return std::sqrt((v1.data[0] - v2.data[0]) * (v1.data[0] - v2.data[0]) +
+                         (v1.data[1] - v2.data[1]) * (v1.data[1] - v2.data[1]));
+    }
+};
+
+///
+/// Uniform samples in [0, 10]^2
+///
+struct StateSelector
+{
+    mutable std::mt19937 gen{42};
+    State operator()()const{
+        std::uniform_real_distribution<real_t> dist(0.0, 10.0);
+        return {dist(gen), dist(gen)};
+    }
+};
+
+///
+/// Move at most step towards the sample. The
+/// input stored on the edge is the distance moved
+///
+struct Dynamics
+{
+    real_t step{0.25};
+
+    template<typename VertexTp>
+    std::tuple<State, real_t> operator()(const VertexTp& xnear, const State& xrand)const{
+
+        const auto dx = xrand[0] - xnear.data[0];
+        const auto dy = xrand[1] - xnear.data[1];
+        const auto d = std::sqrt(dx * dx + dy * dy);
+        if(d <= step){
+            return {xrand, d};
+        }
+
+        return {State{xnear.data[0] + step * dx / d, xnear.data[1] + step * dy / d}, step};
+    }
+};
+
+}
+
+TEST(TestRRT, Test_nearest_neighbor_matches_linear_scan) {
+
+    Tree tree;
+    StateSelector selector;
+    Dynamics dynamics;
+    EuclideanMetric metric;
+
+    Tree::vertex_t xinit;
+    xinit.data = {5.0, 5.0};
+    tree.build(3000, xinit, selector, metric, dynamics);
+
+    ASSERT_EQ(tree.n_vertices(), 3001);
+    ASSERT_EQ(tree.n_edges(), 3000);
+    ASSERT_EQ(tree.index().size(), tree.n_vertices());
+
+    // every vertex but the root has one parent with a smaller
+    // id and the input of the move is stored on the edge
+    for(uint_t v=1; v<tree.n_vertices(); ++v){
+
+        uint_t n_parents = 0;
+        auto [start, end] = tree.get_vertex_neighbors(v);
+        for(; start != end; ++start){
+
+            const auto& w = tree.get_vertex(start);
+            if(w.id < v){
+                n_parents += 1;
+                const auto u = tree.get_edge(w.id, v).get_data();
+                ASSERT_GT(u, 0.0);
+                ASSERT_LE(u, dynamics.step + 1.0e-12);
+                ASSERT_NEAR(u, metric(w, tree.get_vertex(v)), 1.0e-12);
+            }
+        }
+
+        ASSERT_EQ(n_parents, 1);
+    }
+
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<real_t> dist(-1.0, 11.0);
+    for(uint_t q=0; q<500; ++q){
+
+        const State x{dist(gen), dist(gen)};
+        Tree::vertex_t query;
+        query.data = x;
+
+        real_t best = std::numeric_limits<real_t>::max();
+        for(uint_t v=0; v<tree.n_vertices(); ++v){
+            best = std::min(best, metric(tree.get_vertex(v), query));
+        }
+
+        ASSERT_EQ(metric(tree.find_nearest_neighbor(x, metric), query), best);
+        ASSERT_EQ(metric(tree.find_nearest_neighbor(query, metric), query), best);
+    }
+}
+
+TEST(TestRRT, Test_build_with_goal) {
+
+    Tree tree;
+    StateSelector selector;
+    Dynamics dynamics;
+    EuclideanMetric metric;
+
+    ASSERT_THROW(tree.find_nearest_neighbor(State{0.0, 0.0}, metric), std::logic_error);
+
+    Tree::vertex_t xinit;
+    xinit.data = {1.0, 1.0};
+
+    Tree::vertex_t goal;
+    goal.data = {9.0, 9.0};
+
+    auto [found, root, last] = tree.build(20000, xinit, goal, selector, metric, dynamics, 0.3);
+    ASSERT_TRUE(found);
+    ASSERT_EQ(root, 0);
+    ASSERT_EQ(last, tree.n_vertices() - 1);
+    ASSERT_LT(metric(tree.get_vertex(last), goal), 0.3);
+
+    // clearing the tree clears the index
+    tree.clear();
+    ASSERT_EQ(tree.n_vertices(), 0);
+    ASSERT_TRUE(tree.index().empty());
+}
@@ -0,0 +1,228 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/planning/rrt_star.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::RRTStar;
+using cubeai::RRTStarConfig;
+
+typedef std::array<real_t, 2> State;
+
+///
+/// Disc obstacles
+///
+struct DiscChecker
+{
+    struct Disc
+    {
+        real_t x;
+        real_t y;
+        real_t r;
+    };
+
+    std::vector<Disc> discs;
+
+    bool is_free(const State& p)const{
+        for(const auto& d : discs){
+            if((p[0] - d.x) * (p[0] - d.x) + (p[1] - d.y) * (p[1] - d.y) <= d.r * d.r){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool is_segment_free(const State& a, const State& b)const{
+
+        const auto vx = b[0] - a[0];
+        const auto vy = b[1] - a[1];
+        const auto len2 = vx * vx + vy * vy;
+
+        for(const auto& d : discs){
+
+            // the point of the segment closest to the centre
+            auto t = len2 > 0.0 ? ((d.x - a[0]) * vx + (d.y - a[1]) * vy) / len2 : 0.0;
+            t = std::clamp(t, 0.0, 1.0);
+            const auto px = a[0] + t * vx - d.x;
+            const auto py = a[1] + t * vy - d.y;
+            if(px * px + py * py <= d.r * d.r){
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+///
+/// The same obstacles with a batch interface
+///
+struct BatchDiscChecker: public DiscChecker
+{
+    mutable uint_t n_batches{0};
+
+    void are_segments_free(const State& x, const std::vector<State>& ys, std::vector<std::uint8_t>& out)const{
+
+        n_batches += 1;
+        for(uint_t i=0; i<ys.size(); ++i){
+            out[i] = is_segment_free(ys[i], x);
+        }
+    }
+};
+
+real_t
+distance(const State& a, const State& b){
+    return std::hypot(a[0] - b[0], a[1] - b[1]);
+}
+
+///
+/// Every vertex holds the cost of its parent plus the length
+/// of the edge and the edges of the tree are free
+///
+template<typename PlannerTp, typename CheckerTp>
+void
+check_tree(const PlannerTp& planner, const CheckerTp& checker){
+
+    ASSERT_EQ(planner.parent(0), PlannerTp::npos);
+    ASSERT_EQ(planner.cost_to_come(0), 0.0);
+
+    for(uint_t v=1; v<planner.n_vertices(); ++v){
+
+        const auto p = planner.parent(v);
+        ASSERT_NE(p, PlannerTp::npos);
+        ASSERT_NEAR(planner.cost_to_come(v),
+                    planner.cost_to_come(p) + distance(planner.state(p), planner.state(v)), 1.0e-9);
+        ASSERT_TRUE(checker.is_segment_free(planner.state(p), planner.state(v)));
+    }
+}
+
+}
+
+TEST(TestRRTStar, Test_free_space) {
+
+    DiscChecker checker;
+
+    RRTStarConfig config;
+    config.n_iterations = 4000;
+    config.max_step = 1.0;
+    config.goal_radius = 0.25;
+
+    RRTStar<2, DiscChecker> planner(config, {0.0, 0.0}, {10.0, 10.0}, checker);
+
+    const State start{1.0, 1.0};
+    const State goal{9.0, 9.0};
+    ASSERT_TRUE(planner.plan(start, goal));
+    ASSERT_EQ(planner.n_vertices(), config.n_iterations + 1);
+    ASSERT_GT(planner.n_rewires(), 0);
+
+    // close to the straight line
+    const auto straight = distance(start, goal);
+    ASSERT_GE(planner.cost(), straight - config.goal_radius);
+    ASSERT_LE(planner.cost(), 1.05 * straight);
+
+    const auto path = planner.path();
+    ASSERT_EQ(path.front(), start);
+    ASSERT_LE(distance(path.back(), goal), config.goal_radius);
+
+    check_tree(planner, checker);
+}
+
+TEST(TestRRTStar, Test_obstacles_and_batches) {
+
+    // a wall of discs with a gap at the top
+    BatchDiscChecker checker;
+    for(uint_t i=0; i<8; ++i){
+        checker.discs.push_back({5.0, 0.5 + 1.0 * i, 0.6});
+    }
+
+    RRTStarConfig config;
+    config.n_iterations = 3000;
+    config.goal_radius = 0.3;
+
+    RRTStar<2, BatchDiscChecker> planner(config, {0.0, 0.0}, {10.0, 10.0}, checker);
+
+    const State start{1.0, 1.0};
+    const State goal{9.0, 1.0};
+    ASSERT_TRUE(planner.plan(start, goal));
+    ASSERT_GT(checker.n_batches, 0);
+
+    // the path goes over the wall
+    const auto path = planner.path();
+    const auto top = std::max_element(path.begin(), path.end(), [](const State& a, const State& b){return a[1] < b[1];});
+    ASSERT_GT((*top)[1], 7.5);
+    ASSERT_LT(planner.cost(), 2.0 * std::hypot(4.0, 7.6));
+
+    check_tree(planner, checker);
+
+    // the batches are only a way to check the segments
+    DiscChecker plain;
+    plain.discs = checker.discs;
+    RRTStar<2, DiscChecker> same(config, {0.0, 0.0}, {10.0, 10.0}, plain);
+    ASSERT_TRUE(same.plan(start, goal));
+    ASSERT_EQ(same.cost(), planner.cost());
+    ASSERT_EQ(same.n_collision_checks(), planner.n_collision_checks());
+}
+
+TEST(TestRRTStar, Test_sampling_threads) {
+
+    DiscChecker checker;
+    for(uint_t i=0; i<8; ++i){
+        checker.discs.push_back({5.0, 0.5 + 1.0 * i, 0.6});
+    }
+
+    RRTStarConfig config;
+    config.n_iterations = 3000;
+    config.goal_radius = 0.3;
+    config.n_sampling_threads = 3;
+    config.sample_batch_size = 64;
+
+    RRTStar<2, DiscChecker> planner(config, {0.0, 0.0}, {10.0, 10.0}, checker);
+
+    // the planner can be run again
+    for(uint_t run=0; run<3; ++run){
+
+        ASSERT_TRUE(planner.plan({1.0, 1.0}, {9.0, 1.0}));
+        ASSERT_LT(planner.cost(), 2.0 * std::hypot(4.0, 7.6));
+        check_tree(planner, checker);
+
+        for(uint_t v=0; v<planner.n_vertices(); ++v){
+            ASSERT_TRUE(checker.is_free(planner.state(v)));
+        }
+    }
+}
+
+TEST(TestRRTStar, Test_errors) {
+
+    DiscChecker checker;
+    checker.discs.push_back({1.0, 1.0, 0.5});
+
+    RRTStarConfig config;
+    config.n_iterations = 100;
+
+    RRTStar<2, DiscChecker> planner(config, {0.0, 0.0}, {10.0, 10.0}, checker);
+    ASSERT_THROW(planner.plan({1.0, 1.0}, {9.0, 9.0}), std::logic_error);
+    ASSERT_TRUE(planner.path().empty());
+
+    ASSERT_THROW((RRTStar<2, DiscChecker>(config, {0.0, 0.0}, {0.0, 10.0}, checker)), std::logic_error);
+
+    // nothing but the start is free, with and without sampling threads
+    DiscChecker blocked;
+    blocked.discs.push_back({5.0, 5.0, 20.0});
+
+    for(uint_t n_threads : {0, 2}){
+
+        config.n_sampling_threads = n_threads;
+        config.sample_batch_size = 4;
+        RRTStar<2, DiscChecker> hopeless(config, {0.0, 0.0}, {10.0, 10.0}, blocked);
+        ASSERT_THROW(hopeless.plan({25.0, 25.0}, {9.0, 9.0}), std::logic_error);
+    }
+}
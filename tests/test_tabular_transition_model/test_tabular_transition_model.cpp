@@ -0,0 +1,102 @@
+#include "cubeai/base/cubeai_types.h"
+#include "cubeai/base/cubeai_consts.h"
+#include "cubeai/rl/algorithms/td/tabular_transition_model.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace{
+
+using cubeai::real_t;
+using cubeai::uint_t;
+using cubeai::CubeAIConsts;
+using cubeai::rl::algos::td::TabularTransitionModel;
+using cubeai::rl::algos::td::TransitionModelType;
+
+}
+
+TEST(TestTabularTransitionModel, Test_empty) {
+
+    TabularTransitionModel model;
+    model.initialize(4);
+
+    ASSERT_TRUE(model.empty());
+    ASSERT_EQ(model.find(0, 0), CubeAIConsts::invalid_size_type());
+}
+
+TEST(TestTabularTransitionModel, Test_deterministic_update) {
+
+    TabularTransitionModel model(TransitionModelType::DETERMINISTIC);
+    model.initialize(4);
+
+    model.update(3, 1, 4, 1.0, false);
+    model.update(3, 1, 5, 2.0, true);
+
+    ASSERT_EQ(model.size(), static_cast<uint_t>(1));
+    ASSERT_EQ(model.n_outcomes(), static_cast<uint_t>(1));
+
+    std::mt19937 engine(42);
+    uint_t state = 0;
+    uint_t action = 0;
+    const auto& outcome = model.sample(engine, state, action);
+
+    ASSERT_EQ(state, static_cast<uint_t>(3));
+    ASSERT_EQ(action, static_cast<uint_t>(1));
+    ASSERT_EQ(outcome.next_state, static_cast<uint_t>(5));
+    ASSERT_DOUBLE_EQ(outcome.reward, 2.0);
+    ASSERT_TRUE(outcome.done);
+}
+
+TEST(TestTabularTransitionModel, Test_stochastic_update) {
+
+    TabularTransitionModel model(TransitionModelType::STOCHASTIC);
+    model.initialize(4);
+
+    model.update(3, 1, 4, 1.0, false);
+    model.update(3, 1, 4, 3.0, false);
+    model.update(3, 1, 5, 2.0, false);
+
+    ASSERT_EQ(model.size(), static_cast<uint_t>(1));
+    ASSERT_EQ(model.n_outcomes(), static_cast<uint_t>(2));
+
+    const auto& entry = model.entry(model.find(3, 1));
+    ASSERT_EQ(entry.total_count, static_cast<uint_t>(3));
+
+    const auto& first = model.outcome(entry.first_outcome);
+    ASSERT_EQ(first.count, static_cast<uint_t>(2));
+    ASSERT_DOUBLE_EQ(first.reward, 2.0);
+
+    // the empirical frequency of next_state=4 should be 2/3
+    std::mt19937 engine(42);
+    uint_t state = 0;
+    uint_t action = 0;
+    uint_t hits = 0;
+    const uint_t n_samples = 30000;
+    for(uint_t i=0; i<n_samples; ++i){
+        if(model.sample(engine, state, action).next_state == 4){
+            hits += 1;
+        }
+    }
+
+    ASSERT_NEAR(static_cast<real_t>(hits) / n_samples, 2.0 / 3.0, 0.02);
+}
+
+TEST(TestTabularTransitionModel, Test_grow) {
+
+    TabularTransitionModel model;
+    model.initialize(4, 2);
+
+    for(uint_t s=0; s<1000; ++s){
+        model.update(s, s % 4, s + 1, 0.0, false);
+    }
+
+    ASSERT_EQ(model.size(), static_cast<uint_t>(1000));
+
+    for(uint_t s=0; s<1000; ++s){
+        auto idx = model.find(s, s % 4);
+        ASSERT_NE(idx, CubeAIConsts::invalid_size_type());
+        ASSERT_EQ(model.entry(idx).state, s);
+    }
+
+    ASSERT_EQ(model.find(0, 1), CubeAIConsts::invalid_size_type());
+}